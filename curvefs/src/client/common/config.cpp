@@ -211,6 +211,51 @@ void InitDiskCacheOption(Configuration *conf,
                               &diskCacheOption->avgReadFileBytes);
     conf->GetValueFatalIfFail("diskCache.avgReadFileIops",
                               &diskCacheOption->avgReadFileIops);
+    LOG_IF(WARNING, !conf->GetUInt32Value("diskCache.readFdCacheSize",
+                                          &diskCacheOption->readFdCacheSize))
+        << "Not found `diskCache.readFdCacheSize` in conf, use default value `"
+        << diskCacheOption->readFdCacheSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("diskCache.uploadThreads",
+                                          &diskCacheOption->uploadThreads))
+        << "Not found `diskCache.uploadThreads` in conf, use default value `"
+        << diskCacheOption->uploadThreads << '`';
+    LOG_IF(WARNING,
+           !conf->GetUInt64Value("diskCache.uploadMaxInflightBytes",
+                                 &diskCacheOption->uploadMaxInflightBytes))
+        << "Not found `diskCache.uploadMaxInflightBytes` in conf, "
+        << "use default value `" << diskCacheOption->uploadMaxInflightBytes
+        << '`';
+    LOG_IF(WARNING, !conf->GetUInt64Value("diskCache.uploadLimitBps",
+                                          &diskCacheOption->uploadLimitBps))
+        << "Not found `diskCache.uploadLimitBps` in conf, use default value `"
+        << diskCacheOption->uploadLimitBps << '`';
+
+    DiskCacheSegmentOption *segmentOpt = &diskCacheOption->segmentOpt;
+    LOG_IF(WARNING, !conf->GetBoolValue("diskCache.segment.enable",
+                                        &segmentOpt->enable))
+        << "Not found `diskCache.segment.enable` in conf, use default value `"
+        << segmentOpt->enable << '`';
+    LOG_IF(WARNING, !conf->GetUInt64Value("diskCache.segment.segmentSize",
+                                          &segmentOpt->segmentSize))
+        << "Not found `diskCache.segment.segmentSize` in conf, "
+        << "use default value `" << segmentOpt->segmentSize << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("diskCache.segment.segmentNum",
+                                          &segmentOpt->segmentNum))
+        << "Not found `diskCache.segment.segmentNum` in conf, "
+        << "use default value `" << segmentOpt->segmentNum << '`';
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value("diskCache.segment.checkpointIntervalSec",
+                                 &segmentOpt->checkpointIntervalSec))
+        << "Not found `diskCache.segment.checkpointIntervalSec` in conf, "
+        << "use default value `" << segmentOpt->checkpointIntervalSec << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("diskCache.segment.directIo",
+                                        &segmentOpt->directIo))
+        << "Not found `diskCache.segment.directIo` in conf, "
+        << "use default value `" << segmentOpt->directIo << '`';
+    LOG_IF(WARNING, !conf->GetUInt32Value("diskCache.segment.compactRatio",
+                                          &segmentOpt->compactRatio))
+        << "Not found `diskCache.segment.compactRatio` in conf, "
+        << "use default value `" << segmentOpt->compactRatio << '`';
 }
 
 void InitS3Option(Configuration *conf, S3Option *s3Opt) {
@@ -252,6 +297,21 @@ void InitS3Option(Configuration *conf, S3Option *s3Opt) {
         &s3Opt->s3ClientAdaptorOpt.maxReadRetryIntervalMs);
     conf->GetValueFatalIfFail("s3.readRetryIntervalMs",
                               &s3Opt->s3ClientAdaptorOpt.readRetryIntervalMs);
+    LOG_IF(WARNING, !conf->GetUInt32Value(
+                        "s3.maxPrefetchBlocks",
+                        &s3Opt->s3ClientAdaptorOpt.maxPrefetchBlocks))
+        << "Not found `s3.maxPrefetchBlocks` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.maxPrefetchBlocks << '`';
+    LOG_IF(WARNING, !conf->GetUInt64Value(
+                        "s3.pageArenaSlabSize",
+                        &s3Opt->s3ClientAdaptorOpt.pageArenaSlabSize))
+        << "Not found `s3.pageArenaSlabSize` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.pageArenaSlabSize << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue(
+                        "s3.readSingleFlight",
+                        &s3Opt->s3ClientAdaptorOpt.readSingleFlight))
+        << "Not found `s3.readSingleFlight` in conf, use default value `"
+        << s3Opt->s3ClientAdaptorOpt.readSingleFlight << '`';
     ::curve::common::InitS3AdaptorOptionExceptS3InfoOption(conf,
                                                            &s3Opt->s3AdaptrOpt);
 
@@ -314,6 +374,20 @@ void InitKVClientManagerOpt(Configuration *conf,
                               &config->setThreadPooln);
     conf->GetValueFatalIfFail("fuseClient.getThreadPool",
                               &config->getThreadPooln);
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value("fuseClient.kvcacheServerFailureLimit",
+                                 &config->serverFailureLimit))
+        << "Not found `fuseClient.kvcacheServerFailureLimit` in conf, "
+        << "use default value `" << config->serverFailureLimit << '`';
+    LOG_IF(WARNING,
+           !conf->GetUInt32Value("fuseClient.kvcacheServerRetryTimeoutSec",
+                                 &config->serverRetryTimeoutSec))
+        << "Not found `fuseClient.kvcacheServerRetryTimeoutSec` in conf, "
+        << "use default value `" << config->serverRetryTimeoutSec << '`';
+    LOG_IF(WARNING, !conf->GetBoolValue("fuseClient.kvcacheSetNoReply",
+                                        &config->setNoReply))
+        << "Not found `fuseClient.kvcacheSetNoReply` in conf, "
+        << "use default value `" << config->setNoReply << '`';
 }
 
 void GetGids(
@@ -436,6 +510,16 @@ void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption) {
                               &clientOption->downloadMaxRetryTimes);
     conf->GetValueFatalIfFail("fuseClient.warmupThreadsNum",
                               &clientOption->warmupThreadsNum);
+    LOG_IF(WARNING,
+           !conf->GetUInt64Value("fuseClient.warmupMaxInflightBytes",
+                                 &clientOption->warmupMaxInflightBytes))
+        << "Not found `fuseClient.warmupMaxInflightBytes` in conf, "
+        << "use default value `" << clientOption->warmupMaxInflightBytes
+        << '`';
+    LOG_IF(WARNING, !conf->GetUInt64Value("fuseClient.warmupLimitBps",
+                                          &clientOption->warmupLimitBps))
+        << "Not found `fuseClient.warmupLimitBps` in conf, use default value `"
+        << clientOption->warmupLimitBps << '`';
     LOG_IF(WARNING, conf->GetBoolValue("fuseClient.enableSplice",
                                        &clientOption->enableFuseSplice))
         << "Not found `fuseClient.enableSplice` in conf, use default value `"
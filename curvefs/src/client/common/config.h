@@ -77,6 +77,29 @@ struct LeaseOpt {
 struct KVClientManagerOpt {
     int setThreadPooln = 4;
     int getThreadPooln = 4;
+    // consecutive failures before a cache node is ejected from the hash
+    // ring, 0 means never eject
+    uint32_t serverFailureLimit = 2;
+    // an ejected cache node is retried after this interval
+    uint32_t serverRetryTimeoutSec = 5;
+    // send set without waiting for the reply, so sets are pipelined
+    bool setNoReply = true;
+};
+
+struct DiskCacheSegmentOption {
+    // store read cache objects in segment files instead of one file
+    // per object
+    bool enable = false;
+    // size of each preallocated segment file
+    uint64_t segmentSize = 256ULL * 1024 * 1024;
+    // number of segment files
+    uint32_t segmentNum = 64;
+    // interval of persisting the object index
+    uint32_t checkpointIntervalSec = 60;
+    // read and write segment files with O_DIRECT
+    bool directIo = true;
+    // compact sealed segment whose live data ratio is lower than it
+    uint32_t compactRatio = 30;
 };
 
 struct DiskCacheOption {
@@ -115,6 +138,15 @@ struct DiskCacheOption {
     uint64_t avgFlushIops;
     // the read throttle iops of disk cache
     uint64_t avgReadFileIops;
+    // the max opened read cache files kept for reuse, 0 means no cache
+    uint32_t readFdCacheSize = 1024;
+    // threads uploading write cache files to s3
+    uint32_t uploadThreads = 4;
+    // max bytes of write cache files being uploaded, 0 means no limit
+    uint64_t uploadMaxInflightBytes = 256 * 1024 * 1024;
+    // bandwidth limit of background upload, 0 means no limit
+    uint64_t uploadLimitBps = 0;
+    DiskCacheSegmentOption segmentOpt;
 };
 
 struct S3ClientAdaptorOption {
@@ -122,6 +154,8 @@ struct S3ClientAdaptorOption {
     uint64_t chunkSize;
     uint64_t pageSize;
     uint32_t prefetchBlocks;
+    // the prefetch window grows up to it while reads are sequential
+    uint32_t maxPrefetchBlocks = 16;
     uint32_t prefetchExecQueueNum;
     uint32_t intervalSec;
     uint32_t chunkFlushThreads;
@@ -139,6 +173,10 @@ struct S3ClientAdaptorOption {
     uint32_t maxReadRetryIntervalMs;
     uint32_t readRetryIntervalMs;
     uint32_t objectPrefix;
+    // size of the slab which data cache pages are carved from
+    uint64_t pageArenaSlabSize = 2 * 1024 * 1024;
+    // share in-flight s3 GETs between overlapping reads of one object
+    bool readSingleFlight = true;
     DiskCacheOption diskCacheOpt;
 };
 
@@ -273,6 +311,10 @@ struct FuseClientOption {
     bool enableFuseSplice = false;
     uint32_t downloadMaxRetryTimes;
     uint32_t warmupThreadsNum = 10;
+    // max bytes being downloaded by all the warmup tasks, 0 means no limit
+    uint64_t warmupMaxInflightBytes = 256ULL * 1024 * 1024;
+    // download bandwidth of all the warmup tasks, 0 means no limit
+    uint64_t warmupLimitBps = 0;
 };
 
 void InitFuseClientOption(Configuration *conf, FuseClientOption *clientOption);
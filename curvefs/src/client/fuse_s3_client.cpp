@@ -123,7 +123,7 @@ bool FuseS3Client::InitKVCache(const KVClientManagerOpt &opt) {
 
     // init kvcache client
     auto memcacheClient = std::make_shared<MemCachedClient>();
-    if (!memcacheClient->Init(kvcachecluster, fsInfo_->fsname())) {
+    if (!memcacheClient->Init(kvcachecluster, fsInfo_->fsname(), opt)) {
         LOG(ERROR) << "FLAGS_supportKVcache = " << FLAGS_supportKVcache
                    << ", but init memcache client fail";
         return false;
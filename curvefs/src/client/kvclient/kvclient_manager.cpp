@@ -23,6 +23,7 @@
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
 
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "curvefs/src/client/metric/client_metric.h"
@@ -111,6 +112,28 @@ void KVClientManager::Get(std::shared_ptr<GetKVCacheTask> task) {
     });
 }
 
+void KVClientManager::MGet(
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks) {
+    kvClientManagerMetric_->getQueueSize << tasks.size();
+    threadPool_.Enqueue([tasks, this]() {
+        std::vector<KVGetRequest> requests;
+        requests.reserve(tasks.size());
+        for (const auto& task : tasks) {
+            requests.emplace_back(task->key, task->value, task->offset,
+                                  task->valueLength);
+        }
+        client_->MGet(&requests);
+        for (size_t i = 0; i < tasks.size(); i++) {
+            tasks[i]->res = requests[i].res;
+            tasks[i]->length = requests[i].actLength;
+            kvClientManagerMetric_->getQueueSize << -1;
+            UpdateHitMissMetric(requests[i].retCode,
+                                kvClientManagerMetric_.get());
+            OnReturn(&kvClientManagerMetric_->get, tasks[i]);
+        }
+    });
+}
+
 void KVClientManager::Enqueue(std::shared_ptr<GetObjectAsyncContext> context) {
     auto task = [this, context]() { this->GetKvCache(context); };
     threadPool_.Enqueue(task);
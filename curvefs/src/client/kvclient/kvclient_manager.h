@@ -30,6 +30,7 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "curvefs/src/client/common/config.h"
@@ -146,6 +147,12 @@ class KVClientManager {
 
     void Get(std::shared_ptr<GetKVCacheTask> task);
 
+    /**
+     * Get the keys of the tasks by one batch, the done of each task
+     * is called after the batch returns.
+     */
+    void MGet(std::vector<std::shared_ptr<GetKVCacheTask>> tasks);
+
     KVClientManagerMetric* GetMetricForTesting() {
         return kvClientManagerMetric_.get();
     }
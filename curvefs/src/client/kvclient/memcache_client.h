@@ -30,9 +30,12 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "curvefs/proto/topology.pb.h"
+#include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/kvclient/kvclient.h"
 #include "curvefs/src/client/metric/client_metric.h"
 
@@ -40,6 +43,7 @@ namespace curvefs {
 
 namespace client {
 
+using curvefs::client::common::KVClientManagerOpt;
 using curvefs::mds::topology::MemcacheClusterInfo;
 
 /**
@@ -81,14 +85,22 @@ extern thread_local memcached_st *tcli;
 
 class MemCachedClient : public KVClient {
  public:
-    MemCachedClient() : server_(nullptr) {
+    MemCachedClient() : server_(nullptr), serverFailureLimit_(0) {
         client_ = memcached_create(nullptr);
     }
-    explicit MemCachedClient(memcached_st *cli) : client_(cli) {}
+    explicit MemCachedClient(memcached_st *cli)
+        : client_(cli), serverFailureLimit_(0) {}
     ~MemCachedClient() { UnInit(); }
 
+    /**
+     * The keys are distributed to the servers by a consistent hash ring.
+     * A server which fails opt.serverFailureLimit times in a row is ejected
+     * from the ring and its keys go to the other servers, it joins again
+     * after opt.serverRetryTimeoutSec.
+     */
     bool Init(const MemcacheClusterInfo& kvcachecluster,
-              const std::string& fsName) {
+              const std::string& fsName,
+              const KVClientManagerOpt& opt = KVClientManagerOpt()) {
         metric_ = absl::make_unique<metric::MemcacheClientMetric>(fsName);
         client_ = memcached(nullptr, 0);
 
@@ -100,7 +112,23 @@ class MemCachedClient : public KVClient {
         }
         memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_DISTRIBUTION,
                                MEMCACHED_DISTRIBUTION_CONSISTENT);
-        memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_RETRY_TIMEOUT, 5);
+        memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_RETRY_TIMEOUT,
+                               opt.serverRetryTimeoutSec);
+        if (opt.serverFailureLimit > 0) {
+            memcached_behavior_set(client_,
+                                   MEMCACHED_BEHAVIOR_SERVER_FAILURE_LIMIT,
+                                   opt.serverFailureLimit);
+            memcached_behavior_set(client_,
+                                   MEMCACHED_BEHAVIOR_REMOVE_FAILED_SERVERS, 1);
+            // an ejected server is back in the ring after dead timeout
+            memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_DEAD_TIMEOUT,
+                                   opt.serverRetryTimeoutSec);
+        }
+        serverFailureLimit_ = opt.serverFailureLimit;
+        // sets don't wait for the reply, the following requests of the
+        // connection are pipelined behind them
+        memcached_behavior_set(client_, MEMCACHED_BEHAVIOR_NOREPLY,
+                               opt.setNoReply);
 
         return PushServer();
     }
@@ -127,8 +155,7 @@ class MemCachedClient : public KVClient {
             return true;
         }
         *errorlog = ResError(res);
-        memcached_free(tcli);
-        tcli = nullptr;
+        ResetThreadClient();
         LOG(ERROR) << "Set key = " << key << " error = " << *errorlog;
         metric_->set.eps.count << 1;
         return false;
@@ -170,14 +197,96 @@ class MemCachedClient : public KVClient {
             << " error = " << *errorlog << ", get_value_len = "
             << value_length << ", expect_value_len = " << length;
           free(res);
-          memcached_free(tcli);
-          tcli = nullptr;
+          ResetThreadClient();
         }
 
         metric_->get.eps.count << 1;
         return false;
     }
 
+    /**
+     * @brief: get the keys by one memcached_mget, which sends one get
+     *         command with all the keys of a server to each server and
+     *         reads the replies of the servers together.
+     */
+    void MGet(std::vector<KVGetRequest>* requests) override {
+        if (requests->empty()) {
+            return;
+        }
+        uint64_t start = butil::cpuwide_time_us();
+        if (nullptr == tcli) {
+            tcli = memcached_clone(nullptr, client_);
+        }
+
+        std::unordered_map<std::string, std::vector<KVGetRequest*>> reqs;
+        std::vector<const char*> keys;
+        std::vector<size_t> keyLengths;
+        for (auto& req : *requests) {
+            req.res = false;
+            req.actLength = 0;
+            req.retCode = MEMCACHED_NOTFOUND;
+            auto& keyReqs = reqs[req.key];
+            if (keyReqs.empty()) {
+                keys.push_back(req.key.c_str());
+                keyLengths.push_back(req.key.length());
+            }
+            keyReqs.push_back(&req);
+        }
+
+        memcached_return_t ue =
+            memcached_mget(tcli, keys.data(), keyLengths.data(), keys.size());
+        uint64_t hitBytes = 0;
+        // on MEMCACHED_SOME_ERRORS the keys of the healthy servers are
+        // still fetched
+        if (MEMCACHED_SUCCESS == ue || MEMCACHED_SOME_ERRORS == ue) {
+            memcached_result_st* result;
+            memcached_return_t fetchRet;
+            while ((result = memcached_fetch_result(tcli, nullptr,
+                                                    &fetchRet)) != nullptr) {
+                std::string key(memcached_result_key_value(result),
+                                memcached_result_key_length(result));
+                const char* value = memcached_result_value(result);
+                size_t valueLength = memcached_result_length(result);
+                auto iter = reqs.find(key);
+                if (iter == reqs.end()) {
+                    memcached_result_free(result);
+                    continue;
+                }
+                for (auto* req : iter->second) {
+                    req->actLength = valueLength;
+                    req->retCode = MEMCACHED_SUCCESS;
+                    if (req->value != nullptr &&
+                        valueLength >= req->offset + req->length) {
+                        memcpy(req->value, value + req->offset, req->length);
+                        req->res = true;
+                        hitBytes += req->length;
+                    }
+                }
+                memcached_result_free(result);
+            }
+            if (MEMCACHED_SUCCESS == ue) {
+                ue = fetchRet;
+            }
+        }
+
+        if (MEMCACHED_SUCCESS != ue && MEMCACHED_END != ue &&
+            MEMCACHED_NOTFOUND != ue) {
+            for (auto& req : *requests) {
+                if (req.retCode != MEMCACHED_SUCCESS) {
+                    req.retCode = ue;
+                }
+            }
+            LOG_EVERY_N(WARNING, 1000) << "MGet " << requests->size()
+                                       << " keys error = " << ResError(ue);
+            ResetThreadClient();
+            metric_->mget.eps.count << 1;
+            return;
+        }
+        VLOG(9) << "MGet " << requests->size() << " keys OK";
+        curve::client::CollectMetrics(&metric_->mget, hitBytes,
+                                      butil::cpuwide_time_us() - start);
+    }
+
     // transform the res to a error string
     const std::string ResError(const memcached_return_t res) {
         return memcached_strerror(nullptr, res);
@@ -218,9 +327,21 @@ class MemCachedClient : public KVClient {
         return static_cast<int>(memcached_server_count(client_));
     }
 
+ private:
+    // the client of this thread is dropped after an error, unless failed
+    // servers are ejected, which relies on the failure counts it keeps
+    void ResetThreadClient() {
+        if (serverFailureLimit_ > 0) {
+            return;
+        }
+        memcached_free(tcli);
+        tcli = nullptr;
+    }
+
  private:
     memcached_server_st *server_;
     memcached_st* client_;
+    uint32_t serverFailureLimit_;
     std::unique_ptr<metric::MemcacheClientMetric> metric_;
 };
 
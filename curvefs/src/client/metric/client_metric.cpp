@@ -40,6 +40,7 @@ const std::string S3MultiManagerMetric::prefix = "curvefs_client_manager";  // N
 const std::string FSMetric::prefix = "curvefs_client";  // NOLINT
 const std::string S3Metric::prefix = "curvefs_s3";  // NOLINT
 const std::string DiskCacheMetric::prefix = "curvefs_disk_cache";  // NOLINT
+const std::string PageArenaMetric::prefix = "curvefs_page_arena";  // NOLINT
 const std::string KVClientManagerMetric::prefix =                  // NOLINT
     "curvefs_kvclient_manager";                                    // NOLINT
 const std::string MemcacheClientMetric::prefix =                   // NOLINT
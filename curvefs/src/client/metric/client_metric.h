@@ -269,6 +269,14 @@ struct S3Metric {
     InterfaceMetric readFromKVCache;
     bvar::Status<uint32_t> readSize;
     bvar::Status<uint32_t> writeSize;
+    // bytes prefetched to disk cache
+    bvar::Adder<uint64_t> prefetchBytes;
+    // prefetched bytes read later
+    bvar::Adder<uint64_t> prefetchUsefulBytes;
+    // prefetched bytes never read before the file cache is released
+    bvar::Adder<uint64_t> prefetchWastedBytes;
+    // reads from s3 served by the GET of another read
+    bvar::Adder<uint64_t> readFromS3Merged;
 
     explicit S3Metric(const std::string& name = "")
         : fsName(!name.empty() ? name
@@ -286,7 +294,11 @@ struct S3Metric {
           writeToKVCache(prefix, fsName + "_write_to_kv_cache"),
           readFromKVCache(prefix, fsName + "_read_from_kv_cache"),
           readSize(prefix, fsName + "_adaptor_read_size", 0),
-          writeSize(prefix, fsName + "_adaptor_write_size", 0) {}
+          writeSize(prefix, fsName + "_adaptor_write_size", 0),
+          prefetchBytes(prefix, fsName + "_prefetch_bytes"),
+          prefetchUsefulBytes(prefix, fsName + "_prefetch_useful_bytes"),
+          prefetchWastedBytes(prefix, fsName + "_prefetch_wasted_bytes"),
+          readFromS3Merged(prefix, fsName + "_read_from_s3_merged") {}
 };
 
 template <typename Tp>
@@ -317,6 +329,48 @@ struct DiskCacheMetric {
           trim_(prefix, fsName + "_diskcache_trim") {}
 };
 
+struct PageArenaMetric {
+    static const std::string prefix;
+
+    std::string fsName;
+    std::atomic<int64_t>* usedPagesValue;
+    std::atomic<int64_t>* totalPagesValue;
+    // pages allocated to data cache
+    bvar::PassiveStatus<uint64_t> usedPages;
+    // pages held by the arena, including free ones
+    bvar::PassiveStatus<uint64_t> totalPages;
+    bvar::PassiveStatus<uint64_t> slabNum;
+    // ratio of free pages held by the arena
+    bvar::PassiveStatus<double> fragmentation;
+
+    static double GetFragmentation(void* arg) {
+        auto* metric = reinterpret_cast<PageArenaMetric*>(arg);
+        int64_t total = metric->totalPagesValue->load();
+        if (total <= 0) {
+            return 0;
+        }
+        return 1.0 - static_cast<double>(metric->usedPagesValue->load()) /
+                         static_cast<double>(total);
+    }
+
+    explicit PageArenaMetric(const std::string& name,
+                             std::atomic<int64_t>* used,
+                             std::atomic<int64_t>* total,
+                             std::atomic<int64_t>* slabs)
+        : fsName(!name.empty() ? name
+                               : prefix + curve::common::ToHexString(this)),
+          usedPagesValue(used),
+          totalPagesValue(total),
+          usedPages(prefix, fsName + "_used_pages",
+                    LoadAtomicValue<int64_t>, used),
+          totalPages(prefix, fsName + "_total_pages",
+                     LoadAtomicValue<int64_t>, total),
+          slabNum(prefix, fsName + "_slab_num",
+                  LoadAtomicValue<int64_t>, slabs),
+          fragmentation(prefix, fsName + "_fragmentation",
+                        GetFragmentation, this) {}
+};
+
 struct KVClientManagerMetric {
     static const std::string prefix;
 
@@ -352,12 +406,14 @@ struct MemcacheClientMetric {
     std::string fsName;
     InterfaceMetric get;
     InterfaceMetric set;
+    InterfaceMetric mget;
 
     explicit MemcacheClientMetric(const std::string& name = "")
         : fsName(!name.empty() ? name
                                : prefix + curve::common::ToHexString(this)),
           get(prefix, fsName + "_get"),
-          set(prefix, fsName + "_set") {}
+          set(prefix, fsName + "_set"),
+          mget(prefix, fsName + "_mget") {}
 };
 
 struct S3ChunkInfoMetric {
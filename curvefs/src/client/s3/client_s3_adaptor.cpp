@@ -76,7 +76,11 @@ S3ClientAdaptorImpl::Init(
                    << blockSize_;
         return CURVEFS_ERROR::INVALID_PARAM;
     }
+    pageArena_ =
+        std::make_shared<PageArena>(pageSize_, option.pageArenaSlabSize);
     prefetchBlocks_ = option.prefetchBlocks;
+    maxPrefetchBlocks_ =
+        std::max(option.prefetchBlocks, option.maxPrefetchBlocks);
     prefetchExecQueueNum_ = option.prefetchExecQueueNum;
     diskCacheType_ = option.diskCacheOpt.diskCacheType;
     memCacheNearfullRatio_ = option.nearfullRatio;
@@ -92,6 +96,9 @@ S3ClientAdaptorImpl::Init(
     readRetryIntervalMs_ = option.readRetryIntervalMs;
     objectPrefix_ = option.objectPrefix;
     client_ = client;
+    if (option.readSingleFlight) {
+        readSingleFlight_ = std::make_shared<S3ReadSingleFlight>(client_);
+    }
     inodeManager_ = inodeManager;
     mdsClient_ = mdsClient;
     fsCacheManager_ = fsCacheManager;
@@ -123,6 +130,7 @@ S3ClientAdaptorImpl::Init(
     LOG(INFO) << "S3ClientAdaptorImpl Init. block size:" << blockSize_
               << ", chunk size: " << chunkSize_
               << ", prefetchBlocks: " << prefetchBlocks_
+              << ", maxPrefetchBlocks: " << maxPrefetchBlocks_
               << ", prefetchExecQueueNum: " << prefetchExecQueueNum_
               << ", intervalSec: " << option.intervalSec
               << ", flushIntervalSec: " << option.flushIntervalSec
@@ -131,6 +139,8 @@ S3ClientAdaptorImpl::Init(
               << ", readCacheThreads: " << option.readCacheThreads
               << ", nearfullRatio: " << option.nearfullRatio
               << ", baseSleepUs: " << option.baseSleepUs
+              << ", pageArenaSlabSize: " << option.pageArenaSlabSize
+              << ", readSingleFlight: " << option.readSingleFlight
               << ", memClusterToLocal: " << FLAGS_memClusterToLocal
               << ", s3ToLocal: " << FLAGS_s3ToLocal
               << ", bigIoSize: " << FLAGS_bigIoSize
@@ -212,6 +222,20 @@ int S3ClientAdaptorImpl::Read(uint64_t inodeId, uint64_t offset,
     return ret;
 }
 
+int S3ClientAdaptorImpl::ReadFromS3(const std::string &name, char *buf,
+                                    uint64_t offset, uint64_t length) {
+    if (readSingleFlight_ == nullptr) {
+        return client_->Download(name, buf, offset, length);
+    }
+
+    bool merged = false;
+    int ret = readSingleFlight_->Read(name, buf, offset, length, &merged);
+    if (merged && s3Metric_.get() != nullptr) {
+        s3Metric_->readFromS3Merged << 1;
+    }
+    return ret;
+}
+
 CURVEFS_ERROR S3ClientAdaptorImpl::Truncate(InodeWrapper *inodeWrapper,
                                             uint64_t size) {
     const auto *inode = inodeWrapper->GetInodeLocked();
@@ -386,6 +410,9 @@ int S3ClientAdaptorImpl::ExecAsyncDownloadTask(
 void S3ClientAdaptorImpl::InitMetrics(const std::string &fsName) {
     fsName_ = fsName;
     s3Metric_ = std::make_shared<S3Metric>(fsName);
+    if (pageArena_ != nullptr) {
+        pageArena_->InitMetrics(fsName);
+    }
     if (HasDiskCache()) {
         diskCacheManagerImpl_->InitMetrics(fsName, s3Metric_);
     }
@@ -39,6 +39,7 @@
 #include "curvefs/src/client/s3/client_s3.h"
 #include "curvefs/src/client/s3/client_s3_cache_manager.h"
 #include "curvefs/src/client/s3/disk_cache_manager_impl.h"
+#include "curvefs/src/client/s3/read_single_flight.h"
 #include "src/common/wait_interval.h"
 namespace curvefs {
 namespace client {
@@ -164,10 +165,19 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
 
     std::shared_ptr<S3Client> GetS3Client() { return client_; }
 
+    // read a range of an object from s3, concurrent reads of the same
+    // object are merged if readSingleFlight is enabled
+    int ReadFromS3(const std::string &name, char *buf, uint64_t offset,
+                   uint64_t length);
+
     uint32_t GetPrefetchBlocks() {
         return prefetchBlocks_;
     }
 
+    uint32_t GetMaxPrefetchBlocks() {
+        return maxPrefetchBlocks_;
+    }
+
     uint32_t GetDiskCacheType() {
         return diskCacheType_;
     }
@@ -223,6 +233,10 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
         return pageSize_;
     }
 
+    std::shared_ptr<PageArena> GetPageArena() {
+        return pageArena_;
+    }
+
     void InitMetrics(const std::string &fsName);
 
     void SetDiskCache(DiskCacheType type) {
@@ -267,6 +281,7 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
     uint64_t blockSize_;
     uint64_t chunkSize_;
     uint32_t prefetchBlocks_;
+    uint32_t maxPrefetchBlocks_;
     uint32_t prefetchExecQueueNum_;
     std::string allocateServerEps_;
     uint32_t flushIntervalSec_;
@@ -297,6 +312,9 @@ class S3ClientAdaptorImpl : public S3ClientAdaptor {
     std::vector<bthread::ExecutionQueueId<AsyncDownloadTask>>
       downloadTaskQueues_;
     uint32_t pageSize_;
+    // pages of all data caches of this fs are allocated from it
+    std::shared_ptr<PageArena> pageArena_;
+    std::shared_ptr<S3ReadSingleFlight> readSingleFlight_;
 
     int FlushChunkClosure(std::shared_ptr<FlushChunkCacheContext> context);
 
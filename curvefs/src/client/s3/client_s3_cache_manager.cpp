@@ -25,6 +25,7 @@
 #include <bvar/bvar.h>
 #include <sys/types.h>
 
+#include <cstdlib>
 #include <utility>
 
 #include "absl/cleanup/cleanup.h"
@@ -90,10 +91,11 @@ void FsCacheManager::DataCacheByteDec(uint64_t v) {
 }
 
 FileCacheManagerPtr FsCacheManager::FindFileCacheManager(uint64_t inodeId) {
-    ReadLockGuard readLockGuard(rwLock_);
+    auto &shard = GetFileCacheShard(inodeId);
+    ReadLockGuard readLockGuard(shard.rwLock);
 
-    auto it = fileCacheManagerMap_.find(inodeId);
-    if (it != fileCacheManagerMap_.end()) {
+    auto it = shard.fileCacheManagerMap.find(inodeId);
+    if (it != shard.fileCacheManagerMap.end()) {
         return it->second;
     }
 
@@ -102,16 +104,22 @@ FileCacheManagerPtr FsCacheManager::FindFileCacheManager(uint64_t inodeId) {
 
 FileCacheManagerPtr
 FsCacheManager::FindOrCreateFileCacheManager(uint64_t fsId, uint64_t inodeId) {
-    WriteLockGuard writeLockGuard(rwLock_);
+    FileCacheManagerPtr fileCacheManager = FindFileCacheManager(inodeId);
+    if (fileCacheManager != nullptr) {
+        return fileCacheManager;
+    }
+
+    auto &shard = GetFileCacheShard(inodeId);
+    WriteLockGuard writeLockGuard(shard.rwLock);
 
-    auto it = fileCacheManagerMap_.find(inodeId);
-    if (it != fileCacheManagerMap_.end()) {
+    auto it = shard.fileCacheManagerMap.find(inodeId);
+    if (it != shard.fileCacheManagerMap.end()) {
         return it->second;
     }
 
-    FileCacheManagerPtr fileCacheManager = std::make_shared<FileCacheManager>(
+    fileCacheManager = std::make_shared<FileCacheManager>(
         fsId, inodeId, s3ClientAdaptor_, kvClientManager_, readTaskPool_);
-    auto ret = fileCacheManagerMap_.emplace(inodeId, fileCacheManager);
+    auto ret = shard.fileCacheManagerMap.emplace(inodeId, fileCacheManager);
     g_s3MultiManagerMetric->fileManagerNum << 1;
     assert(ret.second);
     (void)ret;
@@ -119,17 +127,18 @@ FsCacheManager::FindOrCreateFileCacheManager(uint64_t fsId, uint64_t inodeId) {
 }
 
 void FsCacheManager::ReleaseFileCacheManager(uint64_t inodeId) {
-    WriteLockGuard writeLockGuard(rwLock_);
+    auto &shard = GetFileCacheShard(inodeId);
+    WriteLockGuard writeLockGuard(shard.rwLock);
 
-    auto iter = fileCacheManagerMap_.find(inodeId);
-    if (iter == fileCacheManagerMap_.end()) {
+    auto iter = shard.fileCacheManagerMap.find(inodeId);
+    if (iter == shard.fileCacheManagerMap.end()) {
         VLOG(1) << "ReleaseFileCacheManager, do not find file cache manager of "
                    "inode: "
                 << inodeId;
         return;
     }
 
-    fileCacheManagerMap_.erase(iter);
+    shard.fileCacheManagerMap.erase(iter);
     g_s3MultiManagerMetric->fileManagerNum << -1;
     return;
 }
@@ -147,20 +156,27 @@ bool FsCacheManager::Set(DataCachePtr dataCache,
     // expected to be very smaller than `readCacheMaxByte_`
     if (lruByte_ >= readCacheMaxByte_) {
         uint64_t retiredBytes = 0;
-        auto iter = lruReadDataCacheList_.end();
+        std::list<DataCachePtr> retired;
+        // CLOCK: sweep from the tail, a data cache referenced since the last
+        // sweep gets a second chance and is moved to the head, the second
+        // chances are bounded in case hits keep setting the reference bits
+        size_t chances = lruReadDataCacheList_.size();
 
         while (lruByte_ >= readCacheMaxByte_) {
-            --iter;
+            auto iter = std::prev(lruReadDataCacheList_.end());
             auto &trim = *iter;
+            if (trim->ClearReferenced() && chances > 0) {
+                chances--;
+                lruReadDataCacheList_.splice(lruReadDataCacheList_.begin(),
+                                             lruReadDataCacheList_, iter);
+                continue;
+            }
             trim->SetReadCacheState(false);
             lruByte_ -= trim->GetActualLen();
             retiredBytes += trim->GetActualLen();
+            retired.splice(retired.begin(), lruReadDataCacheList_, iter);
         }
 
-        std::list<DataCachePtr> retired;
-        retired.splice(retired.end(), lruReadDataCacheList_, iter,
-                       lruReadDataCacheList_.end());
-
         VLOG(3) << "lru release " << retiredBytes << " bytes, retired "
                 << retired.size() << " data cache";
 
@@ -175,14 +191,9 @@ bool FsCacheManager::Set(DataCachePtr dataCache,
 }
 
 void FsCacheManager::Get(std::list<DataCachePtr>::iterator iter) {
-    std::lock_guard<std::mutex> lk(lruMtx_);
-
-    if (!(*iter)->InReadCache()) {
-        return;
-    }
-
-    lruReadDataCacheList_.splice(lruReadDataCacheList_.begin(),
-                                 lruReadDataCacheList_, iter);
+    // the caller holds the read lock of the chunk's read cache, so the
+    // data cache is not released, and no lruMtx_ is needed for a hit
+    (*iter)->SetReferenced();
 }
 
 bool FsCacheManager::Delete(std::list<DataCachePtr>::iterator iter) {
@@ -199,20 +210,33 @@ bool FsCacheManager::Delete(std::list<DataCachePtr>::iterator iter) {
 }
 
 CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
+    for (auto &shard : fileCacheShards_) {
+        CURVEFS_ERROR ret = SyncFileCacheShard(&shard, force);
+        if (ret != CURVEFS_ERROR::OK) {
+            return ret;
+        }
+    }
+
+    return CURVEFS_ERROR::OK;
+}
+
+CURVEFS_ERROR FsCacheManager::SyncFileCacheShard(FileCacheShard *shard,
+                                                 bool force) {
     CURVEFS_ERROR ret;
     std::unordered_map<uint64_t, FileCacheManagerPtr> tmp;
     {
-        WriteLockGuard writeLockGuard(rwLock_);
-        tmp = fileCacheManagerMap_;
+        ReadLockGuard readLockGuard(shard->rwLock);
+        tmp = shard->fileCacheManagerMap;
     }
 
+    auto &fileCacheManagerMap = shard->fileCacheManagerMap;
     auto iter = tmp.begin();
     for (; iter != tmp.end(); iter++) {
         ret = iter->second->Flush(force);
         if (ret == CURVEFS_ERROR::OK) {
-            WriteLockGuard writeLockGuard(rwLock_);
-            auto iter1 = fileCacheManagerMap_.find(iter->first);
-            if (iter1 == fileCacheManagerMap_.end()) {
+            WriteLockGuard writeLockGuard(shard->rwLock);
+            auto iter1 = fileCacheManagerMap.find(iter->first);
+            if (iter1 == fileCacheManagerMap.end()) {
                 VLOG(1) << "FsSync, chunk cache for inodeid: " << iter->first
                         << " is removed";
                 continue;
@@ -220,7 +244,7 @@ CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
                 VLOG(9) << "FileCacheManagerPtr count:"
                         << iter1->second.use_count()
                         << ", inodeId:" << iter1->first;
-                // tmp and fileCacheManagerMap_ has this FileCacheManagerPtr, so
+                // tmp and fileCacheManagerMap has this FileCacheManagerPtr, so
                 // count is 2 if count more than 2, this mean someone thread has
                 // this FileCacheManagerPtr
                 // TODO(@huyao) https://github.com/opencurve/curve/issues/1473
@@ -228,18 +252,18 @@ CURVEFS_ERROR FsCacheManager::FsSync(bool force) {
                     (iter1->second.use_count() <= 2)) {
                     VLOG(9) << "Release FileCacheManager, inode id: "
                             << iter1->second->GetInodeId();
-                    fileCacheManagerMap_.erase(iter1);
+                    fileCacheManagerMap.erase(iter1);
                     g_s3MultiManagerMetric->fileManagerNum << -1;
                 }
             }
         } else if (ret == CURVEFS_ERROR::NOT_EXIST) {
             iter->second->ReleaseCache();
-            WriteLockGuard writeLockGuard(rwLock_);
-            auto iter1 = fileCacheManagerMap_.find(iter->first);
-            if (iter1 != fileCacheManagerMap_.end()) {
+            WriteLockGuard writeLockGuard(shard->rwLock);
+            auto iter1 = fileCacheManagerMap.find(iter->first);
+            if (iter1 != fileCacheManagerMap.end()) {
                 VLOG(9) << "Release FileCacheManager, inode id: "
                         << iter1->second->GetInodeId();
-                fileCacheManagerMap_.erase(iter1);
+                fileCacheManagerMap.erase(iter1);
                 g_s3MultiManagerMetric->fileManagerNum << -1;
             }
         } else {
@@ -296,19 +320,39 @@ void FileCacheManager::WriteChunk(uint64_t index, uint64_t chunkPos,
     return;
 }
 
+FileCacheManager::~FileCacheManager() {
+    uint64_t wasted = 0;
+    for (const auto &obj : prefetchedObjs_) {
+        wasted += obj.second;
+    }
+    if (wasted > 0 && s3ClientAdaptor_ != nullptr &&
+        s3ClientAdaptor_->s3Metric_ != nullptr) {
+        s3ClientAdaptor_->s3Metric_->prefetchWastedBytes << wasted;
+    }
+}
+
 ChunkCacheManagerPtr
 FileCacheManager::FindOrCreateChunkCacheManager(uint64_t index) {
-    WriteLockGuard writeLockGuard(rwLock_);
+    auto &shard = GetChunkCacheShard(index);
+    {
+        ReadLockGuard readLockGuard(shard.rwLock);
+        auto it = shard.chunkCacheMap.find(index);
+        if (it != shard.chunkCacheMap.end()) {
+            return it->second;
+        }
+    }
 
-    auto it = chunkCacheMap_.find(index);
-    if (it != chunkCacheMap_.end()) {
+    WriteLockGuard writeLockGuard(shard.rwLock);
+
+    auto it = shard.chunkCacheMap.find(index);
+    if (it != shard.chunkCacheMap.end()) {
         return it->second;
     }
 
     ChunkCacheManagerPtr chunkCacheManager =
         std::make_shared<ChunkCacheManager>(index, s3ClientAdaptor_,
                                             kvClientManager_);
-    auto ret = chunkCacheMap_.emplace(index, chunkCacheManager);
+    auto ret = shard.chunkCacheMap.emplace(index, chunkCacheManager);
     g_s3MultiManagerMetric->chunkManagerNum << 1;
     assert(ret.second);
     (void)ret;
@@ -438,6 +482,8 @@ int FileCacheManager::HandleReadS3NotExist(
 
 int FileCacheManager::Read(uint64_t inodeId, uint64_t offset, uint64_t length,
                            char *dataBuf) {
+    readahead_.OnRead(offset, length);
+
     // 1. read from memory cache
     uint64_t actualReadLen = 0;
     std::vector<ReadRequest> memCacheMissRequest;
@@ -517,6 +563,7 @@ bool FileCacheManager::ReadKVRequestFromLocalCache(const std::string& name,
         LOG(WARNING) << "object " << name << " not cached in disk";
         return false;
     }
+    ConsumePrefetchedObj(name);
 
     if (s3ClientAdaptor_->s3Metric_) {
         curve::client::CollectMetrics(
@@ -556,12 +603,53 @@ bool FileCacheManager::ReadKVRequestFromRemoteCache(const std::string &name,
     return task->res;
 }
 
+void FileCacheManager::BatchReadKVRequestFromRemoteCache(
+    std::vector<ObjectRead> *objs) {
+    if (!kvClientManager_) {
+        return;
+    }
+
+    std::vector<ObjectRead *> pending;
+    for (auto &obj : *objs) {
+        if (!obj.done) {
+            pending.push_back(&obj);
+        }
+    }
+    if (pending.empty()) {
+        return;
+    } else if (pending.size() == 1) {
+        ObjectRead *obj = pending[0];
+        obj->done = ReadKVRequestFromRemoteCache(obj->name, obj->buf,
+                                                 obj->offset, obj->length);
+        return;
+    }
+
+    CountDownEvent event(pending.size());
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks;
+    tasks.reserve(pending.size());
+    for (auto *obj : pending) {
+        GetKVCacheDone cb = [&event, obj, this](
+                                const std::shared_ptr<GetKVCacheTask> &task) {
+            if (task->res && s3ClientAdaptor_->s3Metric_ != nullptr) {
+                curve::client::CollectMetrics(
+                    &s3ClientAdaptor_->s3Metric_->readFromKVCache,
+                    task->length, task->timer.u_elapsed());
+            }
+            obj->done = task->res;
+            event.Signal();
+        };
+        tasks.push_back(std::make_shared<GetKVCacheTask>(
+            obj->name, obj->buf, obj->offset, obj->length, cb));
+    }
+    kvClientManager_->MGet(std::move(tasks));
+    event.Wait();
+}
+
 bool FileCacheManager::ReadKVRequestFromS3(const std::string &name,
                                            char *databuf, uint64_t offset,
                                            uint64_t length, int *ret) {
     uint64_t start = butil::cpuwide_time_us();
-    *ret = s3ClientAdaptor_->GetS3Client()->Download(name, databuf, offset,
-                                                     length);
+    *ret = s3ClientAdaptor_->ReadFromS3(name, databuf, offset, length);
     if (*ret < 0) {
         LOG(ERROR) << "object " << name << " read from s3 fail, ret = " << *ret;
         return false;
@@ -659,6 +747,7 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
     uint64_t currentReadLen = 0;
     uint64_t readBufOffset = 0;
     uint64_t objectOffset = req.objectOffset;
+    std::vector<ObjectRead> objs;
 
     while (length > 0) {
         currentReadLen =
@@ -668,38 +757,9 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
             req.chunkId, blockIndex, req.compaction, req.fsId, req.inodeId,
             objectPrefix);
         char *currentBuf = dataBuf + req.readOffset + readBufOffset;
-
-        // read from localcache -> remotecache -> s3
-        do {
-            if (ReadKVRequestFromLocalCache(name, currentBuf,
-                                            blockPos - objectOffset,
-                                            currentReadLen)) {
-                VLOG(9) << "read " << name << " from local cache ok";
-                break;
-            }
-
-            if (ReadKVRequestFromRemoteCache(name, currentBuf,
-                                             blockPos - objectOffset,
-                                             currentReadLen)) {
-                VLOG(9) << "read " << name << " from remote cache ok";
-                break;
-            }
-
-            int ret = 0;
-            if (ReadKVRequestFromS3(name, currentBuf, blockPos - objectOffset,
-                                    currentReadLen, &ret)) {
-                VLOG(9) << "read " << name << " from s3 ok";
-                break;
-            }
-
-            LOG(ERROR) << "read " << name << " fail";
-            // make sure variable is set only once
-            std::call_once(cancelFlag, [&]() {
-                isCanceled.store(true);
-                retCode.store(ret);
-            });
-            return;
-        } while (false);
+        objs.push_back(ObjectRead{std::move(name), currentBuf,
+                                  blockPos - objectOffset, currentReadLen,
+                                  false});
 
         // update param
         {
@@ -711,6 +771,39 @@ void FileCacheManager::ProcessKVRequest(const S3ReadRequest &req, char *dataBuf,
         }
     }
 
+    // read from localcache -> remotecache -> s3, the objects missed in
+    // localcache are got from remotecache by one batch
+    for (auto &obj : objs) {
+        if (ReadKVRequestFromLocalCache(obj.name, obj.buf, obj.offset,
+                                        obj.length)) {
+            VLOG(9) << "read " << obj.name << " from local cache ok";
+            obj.done = true;
+        }
+    }
+
+    BatchReadKVRequestFromRemoteCache(&objs);
+
+    for (auto &obj : objs) {
+        if (obj.done) {
+            continue;
+        }
+
+        int ret = 0;
+        if (ReadKVRequestFromS3(obj.name, obj.buf, obj.offset, obj.length,
+                                &ret)) {
+            VLOG(9) << "read " << obj.name << " from s3 ok";
+            continue;
+        }
+
+        LOG(ERROR) << "read " << obj.name << " fail";
+        // make sure variable is set only once
+        std::call_once(cancelFlag, [&]() {
+            isCanceled.store(true);
+            retCode.store(ret);
+        });
+        return;
+    }
+
     // add data to memory read cache
     if (!curvefs::client::common::FLAGS_enableCto) {
         auto chunkCacheManager = FindOrCreateChunkCacheManager(chunkIndex);
@@ -730,24 +823,54 @@ void FileCacheManager::PrefetchForBlock(const S3ReadRequest& req,
     if (prefetchBlocks == 0) {
         return;
     }
+    prefetchBlocks = readahead_.NextWindow(
+        prefetchBlocks, s3ClientAdaptor_->GetMaxPrefetchBlocks());
+    if (prefetchBlocks == 0) {
+        VLOG(9) << "random read, skip prefetch, inode: " << inode_;
+        return;
+    }
     uint32_t objectPrefix = s3ClientAdaptor_->GetObjectPrefix();
     std::vector<std::pair<std::string, uint64_t>> prefetchObjs;
-    uint64_t blockIndex = startBlockIndex;
-    for (uint32_t i = 0; i < prefetchBlocks; i++) {
+    auto addObj = [&](uint64_t blockIndex) {
         std::string name = curvefs::common::s3util::GenObjName(
             req.chunkId, blockIndex, req.compaction, req.fsId, req.inodeId,
             objectPrefix);
         uint64_t maxReadLen = (blockIndex + 1) * blockSize;
         uint64_t needReadLen =
             maxReadLen > fileLen ? fileLen - blockIndex * blockSize : blockSize;
-
         prefetchObjs.push_back(std::make_pair(name, needReadLen));
+    };
 
-        blockIndex++;
-        if (maxReadLen > fileLen || blockIndex >= chunkSize / blockSize) {
-            break;
+    int64_t stride = readahead_.GetStride();
+    if (readahead_.GetPattern() == AccessPattern::kStrided &&
+        std::abs(stride) > static_cast<int64_t>(blockSize)) {
+        // prefetch the blocks the next strided reads will hit,
+        // only within the chunk of the current request
+        int64_t chunkStart = req.offset / chunkSize * chunkSize;
+        int64_t chunkEnd = chunkStart + chunkSize;
+        int64_t pos = req.offset;
+        for (uint32_t i = 0; i < prefetchBlocks; i++) {
+            if (pos < chunkStart || pos >= chunkEnd ||
+                pos >= static_cast<int64_t>(fileLen)) {
+                break;
+            }
+            addObj((pos - chunkStart) / blockSize);
+            pos += stride;
+        }
+    } else {
+        uint64_t blockIndex = startBlockIndex;
+        for (uint32_t i = 0; i < prefetchBlocks; i++) {
+            addObj(blockIndex);
+            uint64_t maxReadLen = (blockIndex + 1) * blockSize;
+            blockIndex++;
+            if (maxReadLen > fileLen || blockIndex >= chunkSize / blockSize) {
+                break;
+            }
         }
     }
+    VLOG(9) << "prefetch inode: " << inode_ << ", window: " << prefetchBlocks
+            << ", pattern: " << static_cast<int>(readahead_.GetPattern())
+            << ", objs: " << prefetchObjs.size();
 
     // It is configurable whether to write to local cache or not
     if (!kvClientManager_ && FLAGS_s3ToLocal) {
@@ -815,6 +938,12 @@ class AsyncPrefetchCallback {
         {
             curve::common::LockGuard lg(fileCache->downloadMtx_);
             fileCache->downloadingObj_.erase(context->key);
+            if (ret >= 0) {
+                fileCache->prefetchedObjs_[context->key] = context->actualLen;
+            }
+        }
+        if (ret >= 0 && s3Client_->s3Metric_ != nullptr) {
+            s3Client_->s3Metric_->prefetchBytes << context->actualLen;
         }
         VLOG(9) << "prefetch success: " << context->key;
     }
@@ -825,6 +954,22 @@ class AsyncPrefetchCallback {
     bool fromS3_;
 };
 
+void FileCacheManager::ConsumePrefetchedObj(const std::string &name) {
+    uint64_t length = 0;
+    {
+        curve::common::LockGuard lg(downloadMtx_);
+        auto iter = prefetchedObjs_.find(name);
+        if (iter == prefetchedObjs_.end()) {
+            return;
+        }
+        length = iter->second;
+        prefetchedObjs_.erase(iter);
+    }
+    if (s3ClientAdaptor_->s3Metric_ != nullptr) {
+        s3ClientAdaptor_->s3Metric_->prefetchUsefulBytes << length;
+    }
+}
+
 void FileCacheManager::PrefetchS3Objs(
     const std::vector<std::pair<std::string, uint64_t>>& prefetchObjs,
     bool fromS3) {
@@ -1110,16 +1255,18 @@ void FileCacheManager::GenerateS3Request(ReadRequest request,
 
 
 void FileCacheManager::ReleaseCache() {
-    WriteLockGuard writeLockGuard(rwLock_);
+    for (auto &shard : chunkCacheShards_) {
+        WriteLockGuard writeLockGuard(shard.rwLock);
 
-    uint64_t chunNum = chunkCacheMap_.size();
-    for (auto &chunk : chunkCacheMap_) {
-        chunk.second->ReleaseCache();
-    }
+        uint64_t chunNum = shard.chunkCacheMap.size();
+        for (auto &chunk : shard.chunkCacheMap) {
+            chunk.second->ReleaseCache();
+        }
 
-    chunkCacheMap_.clear();
-    g_s3MultiManagerMetric->chunkManagerNum
-        << -1 * static_cast<int64_t>(chunNum);
+        shard.chunkCacheMap.clear();
+        g_s3MultiManagerMetric->chunkManagerNum
+            << -1 * static_cast<int64_t>(chunNum);
+    }
     return;
 }
 
@@ -1153,9 +1300,9 @@ CURVEFS_ERROR FileCacheManager::Flush(bool force, bool toS3) {
     // instead of multiple file flushes may be better
     CURVEFS_ERROR ret = CURVEFS_ERROR::OK;
     std::map<uint64_t, ChunkCacheManagerPtr> tmp;
-    {
-        WriteLockGuard writeLockGuard(rwLock_);
-        tmp = chunkCacheMap_;
+    for (auto &shard : chunkCacheShards_) {
+        ReadLockGuard readLockGuard(shard.rwLock);
+        tmp.insert(shard.chunkCacheMap.begin(), shard.chunkCacheMap.end());
     }
 
     std::atomic<uint64_t> pendingReq(0);
@@ -1172,12 +1319,14 @@ CURVEFS_ERROR FileCacheManager::Flush(bool force, bool toS3) {
             }
 
             {
-                WriteLockGuard writeLockGuard(rwLock_);
-                auto iter1 =
-                    chunkCacheMap_.find(context->chunkCacheManptr->GetIndex());
-                if (iter1 != chunkCacheMap_.end() && iter1->second->IsEmpty() &&
+                uint64_t index = context->chunkCacheManptr->GetIndex();
+                auto &shard = GetChunkCacheShard(index);
+                WriteLockGuard writeLockGuard(shard.rwLock);
+                auto iter1 = shard.chunkCacheMap.find(index);
+                if (iter1 != shard.chunkCacheMap.end() &&
+                    iter1->second->IsEmpty() &&
                     (iter1->second.use_count() <= 3)) {
-                    // tmp、chunkCacheMap_ and context->chunkCacheManptr has
+                    // tmp、chunkCacheMap and context->chunkCacheManptr has
                     // this ChunkCacheManagerPtr, so count is 3 if count more
                     // than 3, this mean someone thread has this
                     // ChunkCacheManagerPtr
@@ -1187,7 +1336,7 @@ CURVEFS_ERROR FileCacheManager::Flush(bool force, bool toS3) {
                         << ",inode:" << inode_
                         << ", index:" << context->chunkCacheManptr->GetIndex()
                         << "erase iter: " << iter1->first;
-                    chunkCacheMap_.erase(iter1);
+                    shard.chunkCacheMap.erase(iter1);
                     g_s3MultiManagerMetric->chunkManagerNum << -1;
                 }
             }
@@ -1874,7 +2023,8 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
                      std::shared_ptr<KVClientManager> kvClientManager)
     : s3ClientAdaptor_(std::move(s3ClientAdaptor)),
       chunkCacheManager_(chunkCacheManager), status_(DataCacheStatus::Dirty),
-      inReadCache_(false) {
+      inReadCache_(false), referenced_(false),
+      pageArena_(s3ClientAdaptor->GetPageArena()) {
     uint64_t blockSize = s3ClientAdaptor->GetBlockSize();
     uint32_t pageSize = s3ClientAdaptor->GetPageSize();
     chunkPos_ = chunkPos;
@@ -1895,7 +2045,7 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
         } else {
             n = len;
         }
-        PageDataMap &pdMap = dataMap_[blockIndex];
+        PageDataMap *pdMap = GetPageDataMap(blockIndex);
         blockLen = n;
         pageIndex = blockPos / pageSize;
         pagePos = blockPos % pageSize;
@@ -1906,16 +2056,12 @@ DataCache::DataCache(S3ClientAdaptorImpl *s3ClientAdaptor,
                 m = blockLen;
             }
 
-            PageData *pageData = new PageData();
-            pageData->data = new char[pageSize];
-            memset(pageData->data, 0, pageSize);
+            assert(pdMap->Get(pageIndex) == nullptr);
+            PageData *pageData = AllocPageData(pdMap, pageIndex);
             memcpy(pageData->data + pagePos, data + dataOffset, m);
             if (pagePos + m < pageSize) {
                 tailZeroLen = pageSize - pagePos - m;
             }
-            pageData->index = pageIndex;
-            assert(pdMap.count(pageIndex) == 0);
-            pdMap.emplace(pageIndex, pageData);
             pageIndex++;
             blockLen -= m;
             dataOffset += m;
@@ -1959,7 +2105,7 @@ void DataCache::CopyBufToDataCache(uint64_t dataCachePos, uint64_t len,
             n = len;
         }
         blockLen = n;
-        PageDataMap &pdMap = dataMap_[blockIndex];
+        PageDataMap *pdMap = GetPageDataMap(blockIndex);
         PageData *pageData;
         pageIndex = blockPos / pageSize;
         pagePos = blockPos % pageSize;
@@ -1969,14 +2115,9 @@ void DataCache::CopyBufToDataCache(uint64_t dataCachePos, uint64_t len,
             } else {
                 m = blockLen;
             }
-            if (pdMap.count(pageIndex)) {
-                pageData = pdMap[pageIndex];
-            } else {
-                pageData = new PageData();
-                pageData->data = new char[pageSize];
-                memset(pageData->data, 0, pageSize);
-                pageData->index = pageIndex;
-                pdMap.emplace(pageIndex, pageData);
+            pageData = pdMap->Get(pageIndex);
+            if (pageData == nullptr) {
+                pageData = AllocPageData(pdMap, pageIndex);
                 addLen += pageSize;
             }
             memcpy(pageData->data + pagePos, data + dataOffset, m);
@@ -2017,7 +2158,7 @@ void DataCache::AddDataBefore(uint64_t len, const char *data) {
             n = tmpLen;
         }
 
-        PageDataMap &pdMap = dataMap_[blockIndex];
+        PageDataMap *pdMap = GetPageDataMap(blockIndex);
         blockLen = n;
         PageData *pageData = NULL;
         pageIndex = blockPos / pageSize;
@@ -2029,14 +2170,9 @@ void DataCache::AddDataBefore(uint64_t len, const char *data) {
                 m = blockLen;
             }
 
-            if (pdMap.count(pageIndex)) {
-                pageData = pdMap[pageIndex];
-            } else {
-                pageData = new PageData();
-                pageData->data = new char[pageSize];
-                memset(pageData->data, 0, pageSize);
-                pageData->index = pageIndex;
-                pdMap.emplace(pageIndex, pageData);
+            pageData = pdMap->Get(pageIndex);
+            if (pageData == nullptr) {
+                pageData = AllocPageData(pdMap, pageIndex);
             }
             memcpy(pageData->data + pagePos, data + dataOffset, m);
             pageIndex++;
@@ -2062,6 +2198,23 @@ void DataCache::AddDataBefore(uint64_t len, const char *data) {
             << ",actualLen:" << actualLen_;
 }
 
+PageDataMap *DataCache::GetPageDataMap(uint64_t blockIndex) {
+    auto iter = dataMap_.find(blockIndex);
+    if (iter == dataMap_.end()) {
+        uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
+        uint32_t pageSize = s3ClientAdaptor_->GetPageSize();
+        uint64_t pageNum = (blockSize + pageSize - 1) / pageSize;
+        iter = dataMap_.emplace(blockIndex, PageDataMap(pageNum)).first;
+    }
+    return &iter->second;
+}
+
+PageData *DataCache::AllocPageData(PageDataMap *pdMap, uint64_t pageIndex) {
+    char *data = pageArena_->Allocate();
+    memset(data, 0, s3ClientAdaptor_->GetPageSize());
+    return pdMap->Add(pageIndex, data);
+}
+
 void DataCache::MergeDataCacheToDataCache(DataCachePtr mergeDataCache,
                                           uint64_t dataOffset, uint64_t len) {
     uint64_t blockSize = s3ClientAdaptor_->GetBlockSize();
@@ -2075,7 +2228,8 @@ void DataCache::MergeDataCacheToDataCache(DataCachePtr mergeDataCache,
     uint64_t pagePos = blockPos % pageSize;
     char *data = nullptr;
     PageData *mergePage = nullptr;
-    PageDataMap *pdMap = &dataMap_[blockIndex];
+    PageDataMap *pdMap = GetPageDataMap(blockIndex);
+    PageData *pageData = nullptr;
     uint64_t n = 0;
 
     VLOG(9) << "MergeDataCacheToDataCache dataOffset:" << dataOffset
@@ -2089,12 +2243,13 @@ void DataCache::MergeDataCacheToDataCache(DataCachePtr mergeDataCache,
         if (pageIndex == maxPageInBlock) {
             blockIndex++;
             pageIndex = 0;
-            pdMap = &dataMap_[blockIndex];
+            pdMap = GetPageDataMap(blockIndex);
         }
         mergePage = mergeDataCache->GetPageData(blockIndex, pageIndex);
         assert(mergePage);
-        if (pdMap->count(pageIndex)) {
-            data = (*pdMap)[pageIndex]->data;
+        pageData = pdMap->Get(pageIndex);
+        if (pageData != nullptr) {
+            data = pageData->data;
             if (pagePos + len > pageSize) {
                 n = pageSize - pagePos;
             } else {
@@ -2105,7 +2260,7 @@ void DataCache::MergeDataCacheToDataCache(DataCachePtr mergeDataCache,
             memcpy(data + pagePos, mergePage->data + pagePos, n);
             // mergeDataCache->ReleasePageData(blockIndex, pageIndex);
         } else {
-            pdMap->emplace(pageIndex, mergePage);
+            pdMap->Add(pageIndex, mergePage->data);
             mergeDataCache->ErasePageData(blockIndex, pageIndex);
             n = pageSize;
             actualLen_ += pageSize;
@@ -2265,7 +2420,7 @@ void DataCache::Truncate(uint64_t size) {
         } else {
             n = truncateLen;
         }
-        PageDataMap &pdMap = dataMap_[blockIndex];
+        PageDataMap *pdMap = GetPageDataMap(blockIndex);
         blockLen = n;
         pageIndex = blockPos / pageSize;
         uint64_t pagePos = blockPos % pageSize;
@@ -2278,15 +2433,14 @@ void DataCache::Truncate(uint64_t size) {
             }
 
             if (pagePos == 0) {
-                if (pdMap.count(pageIndex)) {
-                    pageData = pdMap[pageIndex];
-                    delete pageData->data;
-                    pdMap.erase(pageIndex);
+                char *pageBuf = pdMap->Erase(pageIndex);
+                if (pageBuf != nullptr) {
+                    pageArena_->Free(pageBuf);
                     actualLen_ -= pageSize;
                 }
             } else {
-                if (pdMap.count(pageIndex)) {
-                    pageData = pdMap[pageIndex];
+                pageData = pdMap->Get(pageIndex);
+                if (pageData != nullptr) {
                     memset(pageData->data + pagePos, 0, m);
                 }
             }
@@ -2294,7 +2448,7 @@ void DataCache::Truncate(uint64_t size) {
             blockLen -= m;
             pagePos = (pagePos + m) % pageSize;
         }
-        if (pdMap.empty()) {
+        if (pdMap->Empty()) {
             dataMap_.erase(blockIndex);
         }
         blockIndex++;
@@ -2340,7 +2494,7 @@ void DataCache::CopyDataCacheToBuf(uint64_t offset, uint64_t len, char *data) {
             n = len;
         }
         blockLen = n;
-        PageDataMap &pdMap = dataMap_[blockIndex];
+        PageDataMap *pdMap = GetPageDataMap(blockIndex);
         PageData *pageData = NULL;
         pageIndex = blockPos / pageSize;
         pagePos = blockPos % pageSize;
@@ -2351,8 +2505,8 @@ void DataCache::CopyDataCacheToBuf(uint64_t offset, uint64_t len, char *data) {
                 m = blockLen;
             }
 
-            assert(pdMap.count(pageIndex));
-            pageData = pdMap[pageIndex];
+            pageData = pdMap->Get(pageIndex);
+            assert(pageData);
             memcpy(data + dataOffset, pageData->data + pagePos, m);
             pageIndex++;
             blockLen -= m;
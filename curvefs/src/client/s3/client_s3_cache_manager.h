@@ -23,6 +23,8 @@
 #define CURVEFS_SRC_CLIENT_S3_CLIENT_S3_CACHE_MANAGER_H_
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <cstring>
 #include <list>
 #include <map>
@@ -38,6 +40,8 @@
 #include "curvefs/src/client/inode_wrapper.h"
 #include "curvefs/src/client/kvclient/kvclient_manager.h"
 #include "curvefs/src/client/s3/client_s3.h"
+#include "curvefs/src/client/s3/page_arena.h"
+#include "curvefs/src/client/s3/readahead.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/task_thread_pool.h"
 
@@ -125,7 +129,60 @@ struct PageData {
     uint64_t index;
     char *data;
 };
-using PageDataMap = std::map<uint64_t, PageData *>;
+
+// pages of one block, indexed by the page index in the block.
+// the slots are preallocated so that locating a page is O(1),
+// a slot whose data is nullptr means the page is not cached.
+class PageDataMap {
+ public:
+    explicit PageDataMap(uint64_t pageNum) : pages_(pageNum), count_(0) {
+        for (uint64_t i = 0; i < pageNum; i++) {
+            pages_[i].index = i;
+            pages_[i].data = nullptr;
+        }
+    }
+
+    PageData *Get(uint64_t pageIndex) {
+        assert(pageIndex < pages_.size());
+        PageData *page = &pages_[pageIndex];
+        return page->data != nullptr ? page : nullptr;
+    }
+
+    PageData *Add(uint64_t pageIndex, char *data) {
+        assert(pageIndex < pages_.size());
+        assert(pages_[pageIndex].data == nullptr);
+        pages_[pageIndex].data = data;
+        count_++;
+        return &pages_[pageIndex];
+    }
+
+    // remove the page from map and return its data, the caller takes
+    // the ownership of the data
+    char *Erase(uint64_t pageIndex) {
+        assert(pageIndex < pages_.size());
+        char *data = pages_[pageIndex].data;
+        if (data != nullptr) {
+            pages_[pageIndex].data = nullptr;
+            count_--;
+        }
+        return data;
+    }
+
+    bool Empty() const { return count_ == 0; }
+
+    template <typename Func>
+    void ForEach(Func func) {
+        for (auto &page : pages_) {
+            if (page.data != nullptr) {
+                func(&page);
+            }
+        }
+    }
+
+ private:
+    std::vector<PageData> pages_;
+    uint64_t count_;
+};
 
 enum DataCacheStatus {
     Dirty = 1,
@@ -141,11 +198,9 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     virtual ~DataCache() {
         auto iter = dataMap_.begin();
         for (; iter != dataMap_.end(); iter++) {
-            auto pageIter = iter->second.begin();
-            for (; pageIter != iter->second.end(); pageIter++) {
-                delete[] pageIter->second->data;
-                delete pageIter->second;
-            }
+            iter->second.ForEach([this](PageData *page) {
+                pageArena_->Free(page->data);
+            });
         }
     }
 
@@ -155,22 +210,24 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     uint64_t GetChunkPos() { return chunkPos_; }
     uint64_t GetLen() { return len_; }
     PageData *GetPageData(uint64_t blockIndex, uint64_t pageIndex) {
-        PageDataMap &pdMap = dataMap_[blockIndex];
-        if (pdMap.count(pageIndex)) {
-            return pdMap[pageIndex];
+        auto iter = dataMap_.find(blockIndex);
+        if (iter == dataMap_.end()) {
+            return nullptr;
         }
-        return nullptr;
+        return iter->second.Get(pageIndex);
     }
 
+    // remove the page without freeing it, the page has been taken over
+    // by another data cache
     void ErasePageData(uint64_t blockIndex, uint64_t pageIndex) {
         curve::common::LockGuard lg(mtx_);
-        PageDataMap &pdMap = dataMap_[blockIndex];
-        auto iter = pdMap.find(pageIndex);
-        if (iter != pdMap.end()) {
-            pdMap.erase(iter);
+        auto iter = dataMap_.find(blockIndex);
+        if (iter == dataMap_.end()) {
+            return;
         }
-        if (pdMap.empty()) {
-            dataMap_.erase(blockIndex);
+        iter->second.Erase(pageIndex);
+        if (iter->second.Empty()) {
+            dataMap_.erase(iter);
         }
     }
 
@@ -191,6 +248,16 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
         inReadCache_.store(inCache, std::memory_order_release);
     }
 
+    // reference bit of the CLOCK read cache, it's set on read cache hit
+    // and cleared when the eviction sweeps over this data cache
+    void SetReferenced() {
+        referenced_.store(true, std::memory_order_relaxed);
+    }
+
+    bool ClearReferenced() {
+        return referenced_.exchange(false, std::memory_order_relaxed);
+    }
+
     void Lock() {
         mtx_.lock();
     }
@@ -208,6 +275,8 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     void CopyBufToDataCache(uint64_t dataCachePos, uint64_t len,
                              const char *data);
     void AddDataBefore(uint64_t len, const char *data);
+    PageDataMap *GetPageDataMap(uint64_t blockIndex);
+    PageData *AllocPageData(PageDataMap *pdMap, uint64_t pageIndex);
 
     CURVEFS_ERROR PrepareFlushTasks(
         uint64_t inodeId, char *data,
@@ -233,7 +302,9 @@ class DataCache : public std::enable_shared_from_this<DataCache> {
     uint64_t createTime_;
     std::atomic<int> status_;
     std::atomic<bool> inReadCache_;
+    std::atomic<bool> referenced_;
     std::map<uint64_t, PageDataMap> dataMap_;  // first is block index
+    std::shared_ptr<PageArena> pageArena_;
 
     std::shared_ptr<KVClientManager> kvClientManager_;
 };
@@ -338,7 +409,7 @@ class FileCacheManager {
           kvClientManager_(std::move(kvClientManager)),
           readTaskPool_(threadPool) {}
     FileCacheManager() = default;
-    ~FileCacheManager() = default;
+    ~FileCacheManager();
 
     ChunkCacheManagerPtr FindOrCreateChunkCacheManager(uint64_t index);
 
@@ -353,15 +424,24 @@ class FileCacheManager {
     virtual int Read(uint64_t inodeId, uint64_t offset, uint64_t length,
                      char *dataBuf);
 
-    bool IsEmpty() { return chunkCacheMap_.empty(); }
+    bool IsEmpty() {
+        for (auto &shard : chunkCacheShards_) {
+            ReadLockGuard readLockGuard(shard.rwLock);
+            if (!shard.chunkCacheMap.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
 
     uint64_t GetInodeId() const { return inode_; }
 
     void SetChunkCacheManagerForTest(uint64_t index,
                                      ChunkCacheManagerPtr chunkCacheManager) {
-        WriteLockGuard writeLockGuard(rwLock_);
+        auto &shard = GetChunkCacheShard(index);
+        WriteLockGuard writeLockGuard(shard.rwLock);
 
-        auto ret = chunkCacheMap_.emplace(index, chunkCacheManager);
+        auto ret = shard.chunkCacheMap.emplace(index, chunkCacheManager);
         assert(ret.second);
         (void)ret;
     }
@@ -444,6 +524,18 @@ class FileCacheManager {
     bool ReadKVRequestFromRemoteCache(const std::string &name, char *databuf,
                                       uint64_t offset, uint64_t length);
 
+    // the part of an object read by a kv request
+    struct ObjectRead {
+        std::string name;
+        char *buf;
+        uint64_t offset;
+        uint64_t length;
+        bool done;
+    };
+
+    // read the objects not done yet from remote cache in one batch
+    void BatchReadKVRequestFromRemoteCache(std::vector<ObjectRead> *objs);
+
     // read kv request from s3
     bool ReadKVRequestFromS3(const std::string &name, char *databuf,
                              uint64_t offset, uint64_t length, int *ret);
@@ -457,17 +549,36 @@ class FileCacheManager {
                          uint64_t blockSize, uint64_t chunkSize,
                          uint64_t startBlockIndex);
 
+    // the prefetched obj is read, count it as useful prefetch
+    void ConsumePrefetchedObj(const std::string &name);
+
+    // chunk cache managers are striped by chunk index, so that the reads
+    // and writes to different chunks of one file don't share one lock
+    struct ChunkCacheShard {
+        RWLock rwLock;
+        // first is chunk index
+        std::map<uint64_t, ChunkCacheManagerPtr> chunkCacheMap;
+    };
+
+    static constexpr uint32_t kChunkCacheShardNum = 8;
+
+    ChunkCacheShard &GetChunkCacheShard(uint64_t index) {
+        return chunkCacheShards_[index % kChunkCacheShardNum];
+    }
+
  private:
     friend class AsyncPrefetchCallback;
 
     uint64_t fsId_;
     uint64_t inode_;
-    std::map<uint64_t, ChunkCacheManagerPtr> chunkCacheMap_;  // first is index
-    RWLock rwLock_;
+    std::array<ChunkCacheShard, kChunkCacheShardNum> chunkCacheShards_;
     curve::common::Mutex mtx_;
-    S3ClientAdaptorImpl *s3ClientAdaptor_;
+    S3ClientAdaptorImpl *s3ClientAdaptor_ = nullptr;
     curve::common::Mutex downloadMtx_;
     std::set<std::string> downloadingObj_;
+    // prefetched objs not read yet, protected by downloadMtx_
+    std::unordered_map<std::string, uint64_t> prefetchedObjs_;
+    ReadaheadDetector readahead_;
 
     std::shared_ptr<KVClientManager> kvClientManager_;
     std::shared_ptr<TaskThreadPool<>> readTaskPool_;
@@ -496,7 +607,6 @@ class FsCacheManager {
     bool Set(DataCachePtr dataCache,
              std::list<DataCachePtr>::iterator *outIter);
     bool Delete(std::list<DataCachePtr>::iterator iter);
-    void Get(std::list<DataCachePtr>::iterator iter);
 
     CURVEFS_ERROR FsSync(bool force);
     uint64_t GetDataCacheNum() {
@@ -537,6 +647,10 @@ class FsCacheManager {
                writeCacheMaxByte_;
     }
 
+    // a read cache hit only sets the reference bit of the data cache,
+    // the list is reordered by CLOCK eviction in Set()
+    void Get(std::list<DataCachePtr>::iterator iter);
+
     uint64_t GetLruByte() {
         std::lock_guard<std::mutex> lk(lruMtx_);
         return lruByte_;
@@ -544,9 +658,10 @@ class FsCacheManager {
 
     void SetFileCacheManagerForTest(uint64_t inodeId,
                                     FileCacheManagerPtr fileCacheManager) {
-        WriteLockGuard writeLockGuard(rwLock_);
+        auto &shard = GetFileCacheShard(inodeId);
+        WriteLockGuard writeLockGuard(shard.rwLock);
 
-        auto ret = fileCacheManagerMap_.emplace(inodeId, fileCacheManager);
+        auto ret = shard.fileCacheManagerMap.emplace(inodeId, fileCacheManager);
         assert(ret.second);
         (void)ret;
     }
@@ -576,11 +691,24 @@ class FsCacheManager {
         std::thread t_;
     };
 
+    // file cache managers are striped by inode id
+    struct FileCacheShard {
+        RWLock rwLock;
+        std::unordered_map<uint64_t, FileCacheManagerPtr>
+            fileCacheManagerMap;  // first is inodeid
+    };
+
+    static constexpr uint32_t kFileCacheShardNum = 64;
+
+    FileCacheShard &GetFileCacheShard(uint64_t inodeId) {
+        return fileCacheShards_[inodeId % kFileCacheShardNum];
+    }
+
+    CURVEFS_ERROR SyncFileCacheShard(FileCacheShard *shard, bool force);
+
  private:
-    std::unordered_map<uint64_t, FileCacheManagerPtr>
-        fileCacheManagerMap_;  // first is inodeid
-    RWLock rwLock_;
-    std::mutex lruMtx_;
+    std::array<FileCacheShard, kFileCacheShardNum> fileCacheShards_;
+    std::mutex lruMtx_;  // for lruReadDataCacheList_ and lruByte_
 
     std::list<DataCachePtr> lruReadDataCacheList_;
     uint64_t lruByte_;
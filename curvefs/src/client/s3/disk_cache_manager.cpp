@@ -26,6 +26,7 @@
 #include <glog/logging.h>
 #include <sys/vfs.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdio>
 #include <list>
@@ -110,12 +111,18 @@ int DiskCacheManager::Init(std::shared_ptr<S3Client> client,
     cacheWrite_->Init(client_, posixWrapper_, cacheDir_, objectPrefix_,
         option.diskCacheOpt.asyncLoadPeriodMs, cachedObjName_);
     cacheRead_->Init(posixWrapper_, cacheDir_, objectPrefix_);
+    cacheRead_->InitFdCache(option.diskCacheOpt.readFdCacheSize);
     int ret;
     ret = CreateDir();
     if (ret < 0) {
         LOG(ERROR) << "create cache dir error, ret = " << ret;
         return ret;
     }
+    ret = InitSegmentStore();
+    if (ret < 0) {
+        LOG(ERROR) << "init segment store error, ret = " << ret;
+        return ret;
+    }
     // load all cache read file
     // the all value of cachedObjName_ is set false
     ret = cacheRead_->LoadAllCacheReadFile(cachedObjName_);
@@ -125,6 +132,9 @@ int DiskCacheManager::Init(std::shared_ptr<S3Client> client,
     }
 
     // start async upload thread
+    cacheWrite_->SetUploadOption(option.diskCacheOpt.uploadThreads,
+                                 option.diskCacheOpt.uploadMaxInflightBytes,
+                                 option.diskCacheOpt.uploadLimitBps);
     cacheWrite_->AsyncUploadRun();
     std::thread uploadThread =
         std::thread(&DiskCacheManager::UploadAllCacheWriteFile, this);
@@ -155,6 +165,28 @@ int DiskCacheManager::Init(std::shared_ptr<S3Client> client,
     return 0;
 }
 
+int DiskCacheManager::InitSegmentStore() {
+    const auto &segmentOpt = option_.diskCacheOpt.segmentOpt;
+    if (!segmentOpt.enable) {
+        return 0;
+    }
+    auto store =
+        std::make_shared<DiskCacheSegmentStore>(posixWrapper_, segmentOpt);
+    int ret = store->Init(cacheDir_ + "/cachesegment");
+    if (ret < 0) {
+        return ret;
+    }
+    // the space of evicted objects is reclaimed by segment reuse
+    store->SetEvictCallback([this](const std::string &name, uint64_t length) {
+        cachedObjName_->Remove(name);
+        UpdateDiskUsedBytes(-static_cast<int64_t>(length));
+    });
+    segmentStore_ = store;
+    cacheRead_->SetSegmentStore(segmentStore_);
+    cacheWrite_->SetCacheRead(cacheRead_);
+    return 0;
+}
+
 void DiskCacheManager::InitQosParam() {
     ReadWriteThrottleParams params;
     params.iopsWrite = ThrottleParams(FLAGS_avgFlushIops, 0, 0);
@@ -200,6 +232,9 @@ int DiskCacheManager::UmountDiskCache() {
     LOG(INFO) << "umount disk cache.";
     TrimStop();
     cacheWrite_->AsyncUploadStop();
+    if (segmentStore_ != nullptr) {
+        segmentStore_->Close();
+    }
     LOG_IF(ERROR, !IsCacheClean()) << "umount disk cache error.";
     LOG(INFO) << "umount disk cache end.";
     return 0;
@@ -294,6 +329,12 @@ int64_t DiskCacheManager::UpdateDiskFsUsedRatio() {
     int64_t freeBytes = stat.f_bfree * frsize;
     int64_t availableBytes = stat.f_bavail * frsize;
     int64_t usedBytes = totalBytes - freeBytes;
+    if (segmentStore_ != nullptr) {
+        // segment files are preallocated, only live objects are counted
+        int64_t idleBytes = segmentStore_->GetAllocatedBytes() -
+                            segmentStore_->GetLiveBytes();
+        usedBytes = std::max<int64_t>(usedBytes - idleBytes, 0);
+    }
     if ((usedBytes == 0) &&
       (availableBytes == 0)) {
         LOG_EVERY_N(WARNING, 100) << "get cache disk space zero.";
@@ -306,8 +347,11 @@ int64_t DiskCacheManager::UpdateDiskFsUsedRatio() {
 }
 
 void DiskCacheManager::SetDiskInitUsedBytes() {
-    std::string cmd = "timeout " + std::to_string(cmdTimeoutSec_) + " du -sb " +
-                      cacheDir_ + " | awk '{printf $1}' ";
+    // size of segment files is counted by live bytes of segment store
+    std::string exclude =
+        segmentStore_ != nullptr ? " --exclude=cachesegment" : "";
+    std::string cmd = "timeout " + std::to_string(cmdTimeoutSec_) + " du -sb" +
+                      exclude + " " + cacheDir_ + " | awk '{printf $1}' ";
     SysUtils sysUtils;
     std::string result = sysUtils.RunSysCmd(cmd);
     if (result.empty()) {
@@ -321,6 +365,9 @@ void DiskCacheManager::SetDiskInitUsedBytes() {
             << "get disk used size failed.";
         return;
     }
+    if (segmentStore_ != nullptr) {
+        usedBytes += segmentStore_->GetLiveBytes();
+    }
     usedBytes_.fetch_add(usedBytes);
     diskUsedInit_.store(true);
     VLOG(9) << "cache disk used size is: " << result;
@@ -426,6 +473,10 @@ void DiskCacheManager::TrimCache() {
         }
         VLOG(9) << "trim thread wake up.";
         InitQosParam();
+        if (segmentStore_ != nullptr) {
+            segmentStore_->CheckpointIfExpired();
+            segmentStore_->Compact();
+        }
         if (!IsDiskCacheSafe(kRatioLevel)) {
             while (!IsDiskCacheSafe(FLAGS_diskTrimRatio)) {
                 if (!isRunning_) {
@@ -462,6 +513,18 @@ void DiskCacheManager::TrimCache() {
                     continue;
                 }
                 cachedObjName_->Remove(cacheKey);
+                if (segmentStore_ != nullptr) {
+                    int64_t length = segmentStore_->Remove(cacheKey);
+                    if (length >= 0) {
+                        curve::client::CollectMetrics(
+                            &metric_->trim_, length,
+                            butil::cpuwide_time_us() - start);
+                        UpdateDiskUsedBytes(-length);
+                        VLOG(6) << "remove obj from segment store success"
+                                << ", obj is: " << cacheKey;
+                        continue;
+                    }
+                }
                 struct stat statReadFile;
                 ret = posixWrapper_->stat(cacheReadFile.c_str(), &statReadFile);
                 if (ret != 0) {
@@ -474,6 +537,9 @@ void DiskCacheManager::TrimCache() {
                 const char *toDelFile;
                 toDelFile = cacheReadFile.c_str();
                 ret = posixWrapper_->remove(toDelFile);
+                // release fd after removing, so concurrent read can't
+                // cache the fd of the removed file again
+                cacheRead_->ReleaseFd(cacheKey);
                 if (ret < 0) {
                     LOG(ERROR)
                         << "remove disk file error, file is: " << cacheKey
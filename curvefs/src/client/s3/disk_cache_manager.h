@@ -35,6 +35,7 @@
 #include "curvefs/src/client/metric/client_metric.h"
 #include "curvefs/src/client/s3/client_s3.h"
 #include "curvefs/src/client/s3/disk_cache_read.h"
+#include "curvefs/src/client/s3/disk_cache_segment_store.h"
 #include "curvefs/src/client/s3/disk_cache_write.h"
 #include "curvefs/src/common/utils.h"
 #include "curvefs/src/common/wrap_posix.h"
@@ -156,6 +157,11 @@ class DiskCacheManager {
      */
     void InitQosParam();
 
+    /**
+     * @brief create segment store for read cache if it is enabled
+     */
+    int InitSegmentStore();
+
     /**
      * @brief trim cache func.
      */
@@ -188,6 +194,8 @@ class DiskCacheManager {
     std::string cacheDir_;
     std::shared_ptr<DiskCacheWrite> cacheWrite_;
     std::shared_ptr<DiskCacheRead> cacheRead_;
+    // nullptr if read cache is stored one file per object
+    std::shared_ptr<DiskCacheSegmentStore> segmentStore_;
 
     std::shared_ptr<SglLRUCache<std::string>> cachedObjName_;
 
@@ -42,40 +42,76 @@ void DiskCacheRead::Init(std::shared_ptr<PosixWrapper> posixWrapper,
     DiskCacheBase::Init(posixWrapper, cacheDir, objectPrefix);
 }
 
+void DiskCacheRead::InitFdCache(uint32_t fdCacheSize) {
+    if (fdCacheSize == 0) {
+        fdCache_ = nullptr;
+        return;
+    }
+    fdCache_ = std::make_shared<
+        LRUCache<std::string, std::shared_ptr<CacheReadFd>>>(
+        fdCacheSize, std::make_shared<CacheMetrics>("diskcache_read_fd"));
+}
+
+void DiskCacheRead::ReleaseFd(const std::string &name) {
+    if (fdCache_ != nullptr) {
+        fdCache_->Remove(name);
+    }
+}
+
+bool DiskCacheRead::IsSameFile(const std::string &path, int fd) {
+    struct stat statPath;
+    struct stat statFd;
+    if (posixWrapper_->stat(path.c_str(), &statPath) < 0 ||
+        posixWrapper_->fstat(fd, &statFd) < 0) {
+        return false;
+    }
+    return statPath.st_dev == statFd.st_dev &&
+           statPath.st_ino == statFd.st_ino;
+}
+
 int DiskCacheRead::ReadDiskFile(const std::string name, char *buf,
                                 uint64_t offset, uint64_t length) {
     VLOG(6) << "ReadDiskFile start. name = " << name << ", offset = " << offset
             << ", length = " << length;
-    std::string fileFullPath;
-    int fd;
-    fileFullPath = GetCacheIoFullDir() + "/" + name;
-    fd = posixWrapper_->open(fileFullPath.c_str(), O_RDONLY, MODE);
-    if (fd < 0) {
-        LOG(ERROR) << "open disk file error. file = " << name
-                   << ", errno = " << errno;
-        return fd;
+    if (segmentStore_ != nullptr &&
+        segmentStore_->Read(name, buf, offset, length) >= 0) {
+        VLOG(6) << "ReadDiskFile from segment store success. name = " << name
+                << ", offset = " << offset << ", length = " << length;
+        return length;
     }
-    off_t seekPos = posixWrapper_->lseek(fd, offset, SEEK_SET);
-    if (seekPos < 0) {
-        LOG(ERROR) << "lseek disk file error. file = " << name
-                   << ", errno = " << errno;
-        posixWrapper_->close(fd);
-        return seekPos;
+    std::shared_ptr<CacheReadFd> cachedFd;
+    if (fdCache_ == nullptr || !fdCache_->Get(name, &cachedFd)) {
+        std::string fileFullPath = GetCacheIoFullDir() + "/" + name;
+        int fd = posixWrapper_->open(fileFullPath.c_str(), O_RDONLY, MODE);
+        if (fd < 0) {
+            LOG(ERROR) << "open disk file error. file = " << name
+                       << ", errno = " << errno;
+            return fd;
+        }
+        cachedFd = std::make_shared<CacheReadFd>(posixWrapper_, fd);
+        if (fdCache_ != nullptr) {
+            fdCache_->Put(name, cachedFd);
+            // the file may be removed after it is opened, its fd is released
+            // after the removal, so check the file after put, otherwise the
+            // fd of removed file is kept in cache
+            if (!IsSameFile(fileFullPath, fd)) {
+                fdCache_->Remove(name);
+            }
+        }
     }
-    ssize_t readLen = posixWrapper_->read(fd, buf, length);
+    ssize_t readLen =
+        posixWrapper_->pread(cachedFd->fd, buf, length, offset);
     if (readLen < 0) {
         LOG(ERROR) << "read disk error, ret = " << readLen
                    << ", errno = " << errno << ", file = " << name;
-        posixWrapper_->close(fd);
+        ReleaseFd(name);
         return readLen;
     }
     if (readLen < static_cast<ssize_t>(length)) {
         LOG(ERROR) << "read disk file is not entirely. read len = " << readLen
                    << ", but want len = " << length << ", file = " << name;
-        posixWrapper_->close(fd);
         return readLen;
     }
-    posixWrapper_->close(fd);
     VLOG(6) << "ReadDiskFile success. name = " << name
             << ", offset = " << offset << ", length = " << length;
     return readLen;
@@ -131,6 +167,18 @@ int DiskCacheRead::LoadAllCacheReadFile(
         cachedObj->Put(std::move(*iter));
     }
 
+    if (segmentStore_ != nullptr) {
+        // least recently accessed first, so the hot objects are
+        // at the front of lru after load
+        std::list<std::string> objs;
+        segmentStore_->ListObjects(&objs);
+        for (auto &obj : objs) {
+            cachedObj->Put(std::move(obj));
+        }
+        VLOG(3) << "LoadAllCacheReadFile, load " << objs.size()
+                << " objects from segment store";
+    }
+
     return ret;
 }
 
@@ -138,6 +186,9 @@ int DiskCacheRead::WriteDiskFile(const std::string fileName, const char *buf,
                                  uint64_t length) {
     VLOG(9) << "WriteDiskFile start. name = " << fileName
             << ", length = " << length;
+    if (segmentStore_ != nullptr) {
+        return segmentStore_->Write(fileName, buf, length);
+    }
     std::string fileFullPath;
     int fd, ret;
     fileFullPath = GetCacheIoFullDir() + "/" + fileName;
@@ -166,9 +217,33 @@ int DiskCacheRead::WriteDiskFile(const std::string fileName, const char *buf,
     return writeLen;
 }
 
+int DiskCacheRead::WriteSegmentStore(const std::string &fileName,
+                                     const char *buf, uint64_t length) {
+    int ret = segmentStore_->Write(fileName, buf, length);
+    if (ret < 0) {
+        // keep the link file, obj can still be read from it
+        LOG(WARNING) << "write segment store failed, file = " << fileName;
+        return ret;
+    }
+    std::string fileFullPath = GetCacheIoFullDir() + "/" + fileName;
+    if (posixWrapper_->remove(fileFullPath.c_str()) < 0 && errno != ENOENT) {
+        LOG(WARNING) << "remove read cache file error, file = " << fileName
+                     << ", errno = " << errno;
+    }
+    ReleaseFd(fileName);
+    VLOG(9) << "WriteSegmentStore success, file = " << fileName;
+    return ret;
+}
+
 int DiskCacheRead::ClearReadCache(const std::list<std::string> &files) {
     VLOG(1) << "ClearReadCache start";
 
+    if (segmentStore_ != nullptr) {
+        for (const auto &file : files) {
+            segmentStore_->Remove(file);
+        }
+    }
+
     std::string cachePath = GetCacheIoFullDir();
     if (!IsFileExist(cachePath)) {
         LOG(ERROR) << "ClearReadCache, cache read dir is not exist";
@@ -180,6 +255,7 @@ int DiskCacheRead::ClearReadCache(const std::list<std::string> &files) {
     for (auto iter = files.begin(); iter != files.end(); iter++) {
         std::string toDel = cachePath + "/" + *iter;
         ret = posixWrapper_->remove(toDel.c_str());
+        ReleaseFd(*iter);
         if (ret < 0) {
             if (IsFileExist(toDel)) {
                  LOG(ERROR) << "ClearReadCache, remove " << toDel
@@ -33,19 +33,46 @@
 #include "src/common/lru_cache.h"
 #include "curvefs/src/common/wrap_posix.h"
 #include "curvefs/src/client/s3/disk_cache_base.h"
+#include "curvefs/src/client/s3/disk_cache_segment_store.h"
 
 namespace curvefs {
 namespace client {
 
+using curve::common::CacheMetrics;
+using curve::common::LRUCache;
 using curve::common::SglLRUCache;
 using curvefs::common::PosixWrapper;
 
+// fd of opened read cache file, closed when the last user releases it,
+// so that the fd evicted from cache is not closed under a reader.
+struct CacheReadFd {
+    CacheReadFd(std::shared_ptr<PosixWrapper> wrapper, int fd)
+        : posixWrapper(wrapper), fd(fd) {}
+    ~CacheReadFd() { posixWrapper->close(fd); }
+
+    std::shared_ptr<PosixWrapper> posixWrapper;
+    int fd;
+};
+
 class DiskCacheRead : public DiskCacheBase {
  public:
     DiskCacheRead() {}
     virtual ~DiskCacheRead() {}
     virtual void Init(std::shared_ptr<PosixWrapper> posixWrapper,
                       const std::string cacheDir, uint32_t objectPrefix);
+
+    /**
+     * @brief keep at most fdCacheSize read cache files opened,
+     *        0 means open and close file on every read
+     */
+    void InitFdCache(uint32_t fdCacheSize);
+
+    /**
+     * @brief close the cached fd of the file, should be called after
+     *        the file is removed, so a read opening the file concurrently
+     *        finds it removed and doesn't cache its fd
+     */
+    void ReleaseFd(const std::string &name);
     virtual int ReadDiskFile(const std::string name, char *buf, uint64_t offset,
                              uint64_t length);
     virtual int WriteDiskFile(const std::string fileName, const char *buf,
@@ -65,9 +92,36 @@ class DiskCacheRead : public DiskCacheBase {
         metric_ = metric;
     }
 
+    /**
+     * @brief store read cache objects in segment store instead of one
+     *        file per object. objects not uploaded yet are still linked
+     *        from write cache, and are read from file.
+     */
+    void SetSegmentStore(std::shared_ptr<DiskCacheSegmentStore> store) {
+        segmentStore_ = store;
+    }
+
+    std::shared_ptr<DiskCacheSegmentStore> GetSegmentStore() {
+        return segmentStore_;
+    }
+
+    /**
+     * @brief move the uploaded obj into segment store,
+     *        then remove its link file from read cache dir.
+     */
+    virtual int WriteSegmentStore(const std::string &fileName,
+                                  const char *buf, uint64_t length);
+
  private:
+    // whether fd is the opened file of path
+    bool IsSameFile(const std::string &path, int fd);
+
     // file system operation encapsulation
     std::shared_ptr<PosixWrapper> posixWrapper_;
+    std::shared_ptr<DiskCacheSegmentStore> segmentStore_;
+    // name -> opened read cache file
+    std::shared_ptr<LRUCache<std::string, std::shared_ptr<CacheReadFd>>>
+        fdCache_;
     std::shared_ptr<DiskCacheMetric> metric_;
 };
 
@@ -0,0 +1,829 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-22
+ */
+
+#include "curvefs/src/client/s3/disk_cache_segment_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glog/logging.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+#include "src/common/crc32.h"
+#include "src/common/timeutility.h"
+
+namespace curvefs {
+namespace client {
+
+using ::curve::common::LockGuard;
+using ::curve::common::TimeUtility;
+
+namespace {
+
+const uint32_t kRecordMagic = 0x47455343;  // "CSEG"
+const uint64_t kAlignSize = 4096;
+const char kIndexFileName[] = "index";
+const char kIndexHeader[] = "curve_disk_cache_segment_v2";
+
+// every record starts at an aligned offset:
+// | RecordHeader | name | data | padding to kAlignSize |
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t nameLen;
+    uint64_t length;
+    // seq of the segment when the record is appended
+    uint64_t seq;
+    // crc of name and data
+    uint32_t crc;
+    uint32_t reserved;
+};
+
+uint64_t AlignUp(uint64_t value, uint64_t align) {
+    return (value + align - 1) / align * align;
+}
+
+char *AllocAligned(uint64_t size) {
+    void *buf = nullptr;
+    if (posix_memalign(&buf, kAlignSize, size) != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<char *>(buf);
+}
+
+}  // namespace
+
+DiskCacheSegmentStore::DiskCacheSegmentStore(
+    std::shared_ptr<PosixWrapper> posixWrapper,
+    const DiskCacheSegmentOption &option)
+    : posixWrapper_(posixWrapper),
+      option_(option),
+      alignSize_(kAlignSize),
+      active_(-1),
+      seqCounter_(0),
+      accessClock_(0),
+      liveBytes_(0),
+      allocatedBytes_(0),
+      lastCheckpointTime_(0) {
+    option_.segmentSize = AlignUp(option_.segmentSize, alignSize_);
+}
+
+DiskCacheSegmentStore::~DiskCacheSegmentStore() {
+    Close();
+}
+
+std::string DiskCacheSegmentStore::SegmentPath(uint32_t id) {
+    return dir_ + "/segment_" + std::to_string(id);
+}
+
+std::string DiskCacheSegmentStore::IndexPath() {
+    return dir_ + "/" + kIndexFileName;
+}
+
+uint64_t DiskCacheSegmentStore::RecordLength(uint64_t nameLen,
+                                             uint64_t length) {
+    return AlignUp(sizeof(RecordHeader) + nameLen + length, alignSize_);
+}
+
+int DiskCacheSegmentStore::Init(const std::string &dir) {
+    dir_ = dir;
+    struct stat statDir;
+    if (posixWrapper_->stat(dir_.c_str(), &statDir) < 0) {
+        int ret = posixWrapper_->mkdir(dir_.c_str(), 0755);
+        if (ret < 0 && errno != EEXIST) {
+            LOG(ERROR) << "create segment dir error, dir = " << dir_
+                       << ", errno = " << errno;
+            return -1;
+        }
+    }
+
+    LockGuard lk(mtx_);
+    segments_.clear();
+    segments_.resize(option_.segmentNum);
+    allocatedBytes_ = 0;
+    for (uint32_t i = 0; i < option_.segmentNum; i++) {
+        if (OpenSegment(i) < 0) {
+            return -1;
+        }
+    }
+    int ret = LoadIndex();
+    lastCheckpointTime_ = TimeUtility::GetTimeofDaySec();
+    LOG(INFO) << "DiskCacheSegmentStore init, dir = " << dir_
+              << ", segment size = " << option_.segmentSize
+              << ", segment num = " << option_.segmentNum
+              << ", direct io = " << option_.directIo
+              << ", objects = " << index_.size()
+              << ", live bytes = " << liveBytes_;
+    return ret;
+}
+
+int DiskCacheSegmentStore::OpenSegment(uint32_t id) {
+    std::string path = SegmentPath(id);
+    int flags = O_RDWR | O_CREAT;
+    int fd = -1;
+    if (option_.directIo) {
+        fd = posixWrapper_->open(path.c_str(), flags | O_DIRECT, 0644);
+        if (fd < 0 && errno == EINVAL) {
+            LOG(WARNING) << "open segment with O_DIRECT not supported, "
+                         << "fallback to buffered io, file = " << path;
+            option_.directIo = false;
+        }
+    }
+    if (fd < 0) {
+        fd = posixWrapper_->open(path.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        LOG(ERROR) << "open segment error, file = " << path
+                   << ", errno = " << errno;
+        return -1;
+    }
+
+    struct stat statFile;
+    if (posixWrapper_->fstat(fd, &statFile) < 0) {
+        LOG(ERROR) << "stat segment error, file = " << path
+                   << ", errno = " << errno;
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    if (static_cast<uint64_t>(statFile.st_size) < option_.segmentSize) {
+        int ret = posixWrapper_->fallocate(fd, 0, 0, option_.segmentSize);
+        LOG_IF(WARNING, ret < 0) << "preallocate segment error, file = "
+                                 << path << ", errno = " << errno;
+        if (ret == 0) {
+            posixWrapper_->fstat(fd, &statFile);
+        }
+    }
+    allocatedBytes_ += statFile.st_blocks * 512;
+    segments_[id].fd = fd;
+    return 0;
+}
+
+bool DiskCacheSegmentStore::ReadRecordHeader(uint32_t id, uint64_t offset,
+                                             void *header) {
+    if (offset + alignSize_ > option_.segmentSize) {
+        return false;
+    }
+    char *buf = AllocAligned(alignSize_);
+    if (buf == nullptr) {
+        return false;
+    }
+    ssize_t ret =
+        posixWrapper_->pread(segments_[id].fd, buf, alignSize_, offset);
+    bool ok = ret == static_cast<ssize_t>(alignSize_);
+    if (ok) {
+        memcpy(header, buf, sizeof(RecordHeader));
+        ok = reinterpret_cast<RecordHeader *>(header)->magic == kRecordMagic;
+    }
+    free(buf);
+    return ok;
+}
+
+bool DiskCacheSegmentStore::CheckRecordHeader(const char *record,
+                                              const std::string &name,
+                                              const Location &loc) {
+    const RecordHeader *header =
+        reinterpret_cast<const RecordHeader *>(record);
+    return header->magic == kRecordMagic && header->seq == loc.seq &&
+           header->nameLen == name.size() && header->length == loc.length &&
+           memcmp(record + sizeof(RecordHeader), name.data(), name.size()) ==
+               0;
+}
+
+int DiskCacheSegmentStore::LoadIndex() {
+    std::string content;
+    int fd = posixWrapper_->open(IndexPath().c_str(), O_RDONLY, 0644);
+    if (fd >= 0) {
+        struct stat statFile;
+        if (posixWrapper_->fstat(fd, &statFile) == 0) {
+            content.resize(statFile.st_size);
+            ssize_t ret =
+                posixWrapper_->read(fd, &content[0], statFile.st_size);
+            if (ret != statFile.st_size) {
+                LOG(WARNING) << "read segment index error, errno = " << errno;
+                content.clear();
+            }
+        }
+        posixWrapper_->close(fd);
+    }
+
+    std::istringstream is(content);
+    std::string line;
+    // max seq assigned when the index is checkpointed
+    uint64_t checkpointSeq = 0;
+    if (std::getline(is, line)) {
+        std::istringstream header(line);
+        std::string magic;
+        uint64_t segmentSize = 0;
+        uint32_t segmentNum = 0;
+        header >> magic >> segmentSize >> segmentNum >> checkpointSeq;
+        if (header.fail() || magic != kIndexHeader ||
+            segmentSize != option_.segmentSize ||
+            segmentNum != option_.segmentNum) {
+            LOG(WARNING) << "segment index does not match, drop it, "
+                         << "header = " << line;
+            checkpointSeq = 0;
+            is.setstate(std::ios::eofbit);
+        }
+    }
+    while (std::getline(is, line)) {
+        std::istringstream ls(line);
+        std::string type;
+        ls >> type;
+        if (type == "S") {
+            uint32_t id = 0;
+            Segment seg;
+            ls >> id >> seg.seq >> seg.writeOffset >> seg.lastAccess;
+            if (ls.fail() || id >= segments_.size() ||
+                seg.writeOffset > option_.segmentSize) {
+                continue;
+            }
+            segments_[id].seq = seg.seq;
+            segments_[id].writeOffset = seg.writeOffset;
+            segments_[id].lastAccess = seg.lastAccess;
+        } else if (type == "O") {
+            Location loc;
+            std::string name;
+            ls >> loc.segment >> loc.offset >> loc.length;
+            ls.get();
+            std::getline(ls, name);
+            if (ls.fail() || name.empty() ||
+                loc.segment >= segments_.size()) {
+                continue;
+            }
+            const Segment &seg = segments_[loc.segment];
+            if (seg.seq == 0 ||
+                loc.offset + RecordLength(name.size(), loc.length) >
+                    seg.writeOffset) {
+                continue;
+            }
+            loc.seq = seg.seq;
+            // the record may be overwritten if the segment is reused
+            // after the checkpoint, it's checked on the first read
+            loc.verified = false;
+            AddLocked(name, loc);
+        }
+    }
+
+    // recover the records appended after the checkpoint
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        Segment &seg = segments_[i];
+        RecordHeader header;
+        if (ReadRecordHeader(i, 0, &header) && header.seq > checkpointSeq) {
+            // segment is activated after checkpoint, the segments free
+            // at checkpoint keep the old records which must not be replayed
+            ResetSegmentLocked(i, false);
+            seg.seq = header.seq;
+            ReplaySegment(i, 0);
+        } else if (seg.seq != 0) {
+            ReplaySegment(i, seg.writeOffset);
+        }
+    }
+
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        const Segment &seg = segments_[i];
+        accessClock_ = std::max(accessClock_, seg.lastAccess);
+        if (seg.seq > seqCounter_) {
+            seqCounter_ = seg.seq;
+            active_ = i;
+        }
+    }
+    return 0;
+}
+
+void DiskCacheSegmentStore::ReplaySegment(uint32_t id, uint64_t offset) {
+    Segment &seg = segments_[id];
+    uint64_t replayed = 0;
+    RecordHeader header;
+    while (ReadRecordHeader(id, offset, &header)) {
+        if (header.seq != seg.seq) {
+            break;
+        }
+        uint64_t recordLen = RecordLength(header.nameLen, header.length);
+        if (offset + recordLen > option_.segmentSize) {
+            break;
+        }
+        char *record = AllocAligned(recordLen);
+        if (record == nullptr) {
+            break;
+        }
+        ssize_t ret =
+            posixWrapper_->pread(seg.fd, record, recordLen, offset);
+        uint64_t payloadLen = header.nameLen + header.length;
+        bool valid = ret == static_cast<ssize_t>(recordLen) &&
+                     curve::common::CRC32(record + sizeof(RecordHeader),
+                                          payloadLen) == header.crc;
+        if (valid) {
+            std::string name(record + sizeof(RecordHeader), header.nameLen);
+            auto iter = index_.find(name);
+            if (iter == index_.end() || iter->second.seq <= seg.seq) {
+                RemoveLocked(name);
+                AddLocked(name, {id, offset, header.length, seg.seq, true});
+                replayed++;
+            }
+        }
+        free(record);
+        if (!valid) {
+            break;
+        }
+        offset += recordLen;
+    }
+    seg.writeOffset = std::max(seg.writeOffset, offset);
+    if (replayed > 0) {
+        seg.lastAccess = ++accessClock_;
+        LOG(INFO) << "replay segment " << id << ", records = " << replayed;
+    }
+}
+
+void DiskCacheSegmentStore::AddLocked(const std::string &name,
+                                      const Location &loc) {
+    index_[name] = loc;
+    Segment &seg = segments_[loc.segment];
+    seg.objects.emplace(name);
+    seg.liveBytes += loc.length;
+    liveBytes_ += loc.length;
+}
+
+void DiskCacheSegmentStore::RemoveLocked(const std::string &name) {
+    auto iter = index_.find(name);
+    if (iter == index_.end()) {
+        return;
+    }
+    Segment &seg = segments_[iter->second.segment];
+    seg.objects.erase(name);
+    seg.liveBytes -= iter->second.length;
+    liveBytes_ -= iter->second.length;
+    index_.erase(iter);
+}
+
+void DiskCacheSegmentStore::ResetSegmentLocked(uint32_t id, bool notify) {
+    Segment &seg = segments_[id];
+    for (const auto &name : seg.objects) {
+        auto iter = index_.find(name);
+        if (iter == index_.end()) {
+            continue;
+        }
+        uint64_t length = iter->second.length;
+        liveBytes_ -= length;
+        index_.erase(iter);
+        if (notify && evictCallback_) {
+            evictCallback_(name, length);
+        }
+    }
+    seg.objects.clear();
+    seg.liveBytes = 0;
+    seg.seq = 0;
+    seg.writeOffset = 0;
+    if (active_ == static_cast<int32_t>(id)) {
+        active_ = -1;
+    }
+}
+
+bool DiskCacheSegmentStore::SwitchActiveSegmentLocked() {
+    int32_t target = -1;
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        if (segments_[i].seq == 0 && segments_[i].inflight == 0) {
+            target = i;
+            break;
+        }
+    }
+
+    if (target < 0) {
+        // evict the least recently accessed segment
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (uint32_t i = 0; i < segments_.size(); i++) {
+            const Segment &seg = segments_[i];
+            if (static_cast<int32_t>(i) == active_ || seg.inflight > 0) {
+                continue;
+            }
+            if (seg.lastAccess < oldest) {
+                oldest = seg.lastAccess;
+                target = i;
+            }
+        }
+        if (target < 0) {
+            return false;
+        }
+        VLOG(3) << "evict segment " << target << ", objects = "
+                << segments_[target].objects.size()
+                << ", live bytes = " << segments_[target].liveBytes;
+        ResetSegmentLocked(target, true);
+    }
+
+    Segment &seg = segments_[target];
+    seg.seq = ++seqCounter_;
+    seg.writeOffset = 0;
+    seg.lastAccess = ++accessClock_;
+    active_ = target;
+    return true;
+}
+
+int DiskCacheSegmentStore::Write(const std::string &name, const char *buf,
+                                 uint64_t length) {
+    uint64_t recordLen = RecordLength(name.size(), length);
+    if (recordLen > option_.segmentSize) {
+        LOG(WARNING) << "object is larger than segment, name = " << name
+                     << ", length = " << length;
+        return -1;
+    }
+
+    uint32_t id;
+    uint64_t offset;
+    uint64_t seq;
+    {
+        LockGuard lk(mtx_);
+        RemoveLocked(name);
+        if (active_ < 0 ||
+            segments_[active_].writeOffset + recordLen > option_.segmentSize) {
+            if (!SwitchActiveSegmentLocked()) {
+                LOG(WARNING) << "no segment can be used, name = " << name;
+                return -1;
+            }
+        }
+        Segment &seg = segments_[active_];
+        id = active_;
+        offset = seg.writeOffset;
+        seq = seg.seq;
+        seg.writeOffset += recordLen;
+        seg.inflight++;
+        seg.pendingWrites.emplace(offset);
+    }
+
+    int ret = -1;
+    char *record = AllocAligned(recordLen);
+    if (record != nullptr) {
+        RecordHeader *header = reinterpret_cast<RecordHeader *>(record);
+        uint64_t payloadLen = name.size() + length;
+        header->magic = kRecordMagic;
+        header->nameLen = name.size();
+        header->length = length;
+        header->seq = seq;
+        header->reserved = 0;
+        memcpy(record + sizeof(RecordHeader), name.data(), name.size());
+        memcpy(record + sizeof(RecordHeader) + name.size(), buf, length);
+        memset(record + sizeof(RecordHeader) + payloadLen, 0,
+               recordLen - sizeof(RecordHeader) - payloadLen);
+        header->crc =
+            curve::common::CRC32(record + sizeof(RecordHeader), payloadLen);
+        ssize_t writeLen =
+            posixWrapper_->pwrite(segments_[id].fd, record, recordLen, offset);
+        if (writeLen == static_cast<ssize_t>(recordLen)) {
+            ret = length;
+        } else {
+            LOG(ERROR) << "write segment error, segment = " << id
+                       << ", offset = " << offset << ", ret = " << writeLen
+                       << ", errno = " << errno;
+        }
+        free(record);
+    }
+
+    LockGuard lk(mtx_);
+    Segment &seg = segments_[id];
+    seg.inflight--;
+    seg.pendingWrites.erase(offset);
+    if (ret >= 0) {
+        RemoveLocked(name);
+        AddLocked(name, {id, offset, length, seq, true});
+        seg.lastAccess = ++accessClock_;
+    }
+    return ret;
+}
+
+int DiskCacheSegmentStore::Read(const std::string &name, char *buf,
+                                uint64_t offset, uint64_t length) {
+    Location loc;
+    {
+        LockGuard lk(mtx_);
+        auto iter = index_.find(name);
+        if (iter == index_.end()) {
+            VLOG(9) << "object not in segment store, name = " << name;
+            return -1;
+        }
+        loc = iter->second;
+        if (offset + length > loc.length) {
+            LOG(ERROR) << "read beyond object, name = " << name
+                       << ", offset = " << offset << ", length = " << length
+                       << ", object length = " << loc.length;
+            return -1;
+        }
+        Segment &seg = segments_[loc.segment];
+        seg.inflight++;
+        seg.lastAccess = ++accessClock_;
+    }
+
+    // read the aligned range that covers the data, the whole record is
+    // read to check its crc if it is loaded from the checkpoint
+    uint64_t dataStart =
+        loc.offset + sizeof(RecordHeader) + name.size() + offset;
+    uint64_t alignedStart = dataStart / alignSize_ * alignSize_;
+    uint64_t alignedLen = AlignUp(dataStart + length, alignSize_) -
+                          alignedStart;
+    if (!loc.verified) {
+        alignedStart = loc.offset;
+        alignedLen = RecordLength(name.size(), loc.length);
+    }
+    int ret = -1;
+    bool corrupted = false;
+    char *aligned = AllocAligned(alignedLen);
+    if (aligned != nullptr) {
+        ssize_t readLen = posixWrapper_->pread(
+            segments_[loc.segment].fd, aligned, alignedLen, alignedStart);
+        if (readLen == static_cast<ssize_t>(alignedLen)) {
+            if (!loc.verified) {
+                const RecordHeader *header =
+                    reinterpret_cast<const RecordHeader *>(aligned);
+                corrupted = !CheckRecordHeader(aligned, name, loc) ||
+                            curve::common::CRC32(
+                                aligned + sizeof(RecordHeader),
+                                name.size() + loc.length) != header->crc;
+            }
+            if (!corrupted) {
+                memcpy(buf, aligned + (dataStart - alignedStart), length);
+                ret = length;
+            }
+        } else {
+            LOG(ERROR) << "read segment error, segment = " << loc.segment
+                       << ", offset = " << alignedStart
+                       << ", ret = " << readLen << ", errno = " << errno;
+        }
+        free(aligned);
+    }
+
+    LockGuard lk(mtx_);
+    segments_[loc.segment].inflight--;
+    if ((!loc.verified && ret >= 0) || corrupted) {
+        auto iter = index_.find(name);
+        if (iter != index_.end() && iter->second.segment == loc.segment &&
+            iter->second.offset == loc.offset) {
+            if (corrupted) {
+                LOG(WARNING) << "object in segment is corrupted, name = "
+                             << name << ", segment = " << loc.segment
+                             << ", offset = " << loc.offset;
+                RemoveLocked(name);
+            } else {
+                iter->second.verified = true;
+            }
+        }
+    }
+    return ret;
+}
+
+int64_t DiskCacheSegmentStore::Remove(const std::string &name) {
+    LockGuard lk(mtx_);
+    auto iter = index_.find(name);
+    if (iter == index_.end()) {
+        return -1;
+    }
+    int64_t length = iter->second.length;
+    RemoveLocked(name);
+    return length;
+}
+
+bool DiskCacheSegmentStore::IsCached(const std::string &name) {
+    LockGuard lk(mtx_);
+    return index_.find(name) != index_.end();
+}
+
+void DiskCacheSegmentStore::ListObjects(std::list<std::string> *names) {
+    LockGuard lk(mtx_);
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        if (!segments_[i].objects.empty()) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return segments_[a].lastAccess < segments_[b].lastAccess;
+    });
+    for (auto id : order) {
+        names->insert(names->end(), segments_[id].objects.begin(),
+                      segments_[id].objects.end());
+    }
+}
+
+int DiskCacheSegmentStore::Checkpoint() {
+    struct SegmentSnapshot {
+        uint32_t id;
+        uint64_t seq;
+        uint64_t offset;
+        uint64_t lastAccess;
+    };
+    // take a snapshot under lock and format it outside,
+    // so lookups are not blocked by the formatting
+    std::vector<SegmentSnapshot> segs;
+    std::vector<std::pair<std::string, Location>> objs;
+    std::vector<int> fds;
+    uint64_t maxSeq;
+    {
+        LockGuard lk(mtx_);
+        if (segments_.empty()) {
+            return 0;
+        }
+        maxSeq = seqCounter_;
+        for (uint32_t i = 0; i < segments_.size(); i++) {
+            const Segment &seg = segments_[i];
+            if (seg.seq == 0) {
+                continue;
+            }
+            fds.push_back(seg.fd);
+            // replay after restart must start before the unfinished writes
+            uint64_t offset = seg.pendingWrites.empty()
+                                  ? seg.writeOffset
+                                  : *seg.pendingWrites.begin();
+            segs.push_back({i, seg.seq, offset, seg.lastAccess});
+        }
+        objs.reserve(index_.size());
+        objs.assign(index_.begin(), index_.end());
+    }
+
+    std::ostringstream os;
+    os << kIndexHeader << " " << option_.segmentSize << " "
+       << option_.segmentNum << " " << maxSeq << "\n";
+    for (const auto &seg : segs) {
+        os << "S " << seg.id << " " << seg.seq << " " << seg.offset << " "
+           << seg.lastAccess << "\n";
+    }
+    for (const auto &item : objs) {
+        os << "O " << item.second.segment << " " << item.second.offset
+           << " " << item.second.length << " " << item.first << "\n";
+    }
+
+    // the records referenced by the index must be durable before it
+    for (int fd : fds) {
+        if (posixWrapper_->fdatasync(fd) < 0) {
+            LOG(ERROR) << "sync segment error, errno = " << errno;
+            return -1;
+        }
+    }
+
+    std::string content = os.str();
+    std::string tmpPath = IndexPath() + ".tmp";
+    int fd = posixWrapper_->open(tmpPath.c_str(),
+                                 O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG(ERROR) << "open segment index error, errno = " << errno;
+        return -1;
+    }
+    ssize_t ret = posixWrapper_->write(fd, content.data(), content.size());
+    if (ret != static_cast<ssize_t>(content.size()) ||
+        posixWrapper_->fsync(fd) < 0) {
+        LOG(ERROR) << "write segment index error, errno = " << errno;
+        posixWrapper_->close(fd);
+        return -1;
+    }
+    posixWrapper_->close(fd);
+    if (posixWrapper_->rename(tmpPath.c_str(), IndexPath().c_str()) < 0) {
+        LOG(ERROR) << "rename segment index error, errno = " << errno;
+        return -1;
+    }
+    lastCheckpointTime_ = TimeUtility::GetTimeofDaySec();
+    VLOG(3) << "checkpoint segment index success, size = " << content.size();
+    return 0;
+}
+
+void DiskCacheSegmentStore::CheckpointIfExpired() {
+    uint64_t now = TimeUtility::GetTimeofDaySec();
+    if (now - lastCheckpointTime_ >= option_.checkpointIntervalSec) {
+        Checkpoint();
+    }
+}
+
+void DiskCacheSegmentStore::Compact() {
+    int32_t victim = -1;
+    std::vector<std::string> names;
+    {
+        LockGuard lk(mtx_);
+        if (active_ < 0) {
+            return;
+        }
+        double lowest = option_.compactRatio / 100.0;
+        for (uint32_t i = 0; i < segments_.size(); i++) {
+            const Segment &seg = segments_[i];
+            if (seg.seq == 0 && seg.inflight == 0) {
+                // there is free segment, no need to compact
+                return;
+            }
+            if (static_cast<int32_t>(i) == active_ || seg.inflight > 0 ||
+                seg.writeOffset == 0) {
+                continue;
+            }
+            double ratio = static_cast<double>(seg.liveBytes) /
+                           static_cast<double>(seg.writeOffset);
+            if (ratio < lowest) {
+                lowest = ratio;
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return;
+        }
+
+        // live objects must fit into the active segment,
+        // otherwise compaction will evict other segment
+        uint64_t need = 0;
+        for (const auto &name : segments_[victim].objects) {
+            need += RecordLength(name.size(), index_[name].length);
+        }
+        if (segments_[active_].writeOffset + need > option_.segmentSize) {
+            return;
+        }
+        names.assign(segments_[victim].objects.begin(),
+                     segments_[victim].objects.end());
+    }
+
+    std::string data;
+    for (const auto &name : names) {
+        uint64_t length;
+        {
+            LockGuard lk(mtx_);
+            auto iter = index_.find(name);
+            if (iter == index_.end() ||
+                iter->second.segment != static_cast<uint32_t>(victim)) {
+                continue;
+            }
+            length = iter->second.length;
+        }
+        data.resize(length);
+        if (Read(name, &data[0], 0, length) != static_cast<int>(length)) {
+            continue;
+        }
+        Write(name, data.data(), length);
+    }
+
+    LockGuard lk(mtx_);
+    Segment &seg = segments_[victim];
+    if (seg.objects.empty() && seg.inflight == 0 && seg.seq != 0 &&
+        active_ != victim) {
+        ResetSegmentLocked(victim, false);
+        VLOG(3) << "compact segment " << victim << " done, objects = "
+                << names.size();
+    }
+}
+
+void DiskCacheSegmentStore::Close() {
+    bool opened = false;
+    {
+        LockGuard lk(mtx_);
+        for (const auto &seg : segments_) {
+            opened = opened || seg.fd >= 0;
+        }
+    }
+    if (!opened) {
+        return;
+    }
+
+    Checkpoint();
+    LockGuard lk(mtx_);
+    for (auto &seg : segments_) {
+        if (seg.fd >= 0) {
+            posixWrapper_->close(seg.fd);
+            seg.fd = -1;
+        }
+    }
+}
+
+uint64_t DiskCacheSegmentStore::GetLiveBytes() {
+    LockGuard lk(mtx_);
+    return liveBytes_;
+}
+
+uint64_t DiskCacheSegmentStore::GetAllocatedBytes() {
+    LockGuard lk(mtx_);
+    return allocatedBytes_;
+}
+
+uint32_t DiskCacheSegmentStore::GetFreeSegmentNum() {
+    LockGuard lk(mtx_);
+    uint32_t num = 0;
+    for (const auto &seg : segments_) {
+        if (seg.seq == 0) {
+            num++;
+        }
+    }
+    return num;
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-22
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SEGMENT_STORE_H_
+#define CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SEGMENT_STORE_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "curvefs/src/client/common/config.h"
+#include "curvefs/src/common/wrap_posix.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curvefs {
+namespace client {
+
+using curvefs::client::common::DiskCacheSegmentOption;
+using curvefs::common::PosixWrapper;
+
+/**
+ * Log structured store for the read cache objects.
+ *
+ * Objects are appended to a fixed number of preallocated segment files
+ * instead of being stored one file per object, which avoids inode
+ * exhaustion and open/close on every read. The object index lives in
+ * memory and is checkpointed periodically, records appended after the
+ * last checkpoint are recovered by scanning the tail of the segments,
+ * so startup only needs to load the index.
+ *
+ * Space is reclaimed by whole segments: when there is no free segment,
+ * the least recently accessed segment is evicted, and sealed segments
+ * with little live data are compacted by moving their live objects to
+ * the active segment.
+ */
+class DiskCacheSegmentStore {
+ public:
+    // called for every object dropped by segment eviction
+    using EvictCallback =
+        std::function<void(const std::string &name, uint64_t length)>;
+
+    DiskCacheSegmentStore(std::shared_ptr<PosixWrapper> posixWrapper,
+                          const DiskCacheSegmentOption &option);
+
+    virtual ~DiskCacheSegmentStore();
+
+    /**
+     * @brief open or create the segment files under dir and load the index
+     * @return success: 0, fail : < 0
+     */
+    virtual int Init(const std::string &dir);
+
+    void SetEvictCallback(EvictCallback cb) { evictCallback_ = cb; }
+
+    /**
+     * @brief append the object, the old version of it is replaced
+     * @return success: length, fail : < 0
+     */
+    virtual int Write(const std::string &name, const char *buf,
+                      uint64_t length);
+
+    /**
+     * @brief read part of the object
+     * @return success: length, fail : < 0
+     */
+    virtual int Read(const std::string &name, char *buf, uint64_t offset,
+                     uint64_t length);
+
+    /**
+     * @brief remove the object from index
+     * @return the length of the removed object, -1 if not exist
+     */
+    virtual int64_t Remove(const std::string &name);
+
+    virtual bool IsCached(const std::string &name);
+
+    /**
+     * @brief list all cached objects, least recently accessed first
+     */
+    virtual void ListObjects(std::list<std::string> *names);
+
+    /**
+     * @brief persist the object index
+     * @return success: 0, fail : < 0
+     */
+    virtual int Checkpoint();
+
+    /**
+     * @brief checkpoint if checkpointIntervalSec passed since last one
+     */
+    virtual void CheckpointIfExpired();
+
+    /**
+     * @brief compact one sealed segment whose live data ratio is lower
+     *        than compactRatio if there is no free segment
+     */
+    virtual void Compact();
+
+    /**
+     * @brief checkpoint and close all segment files
+     */
+    virtual void Close();
+
+    uint64_t GetLiveBytes();
+
+    // disk space occupied by the segment files
+    uint64_t GetAllocatedBytes();
+
+    uint32_t GetFreeSegmentNum();
+
+ private:
+    struct Location {
+        uint32_t segment;
+        // offset of the record in segment
+        uint64_t offset;
+        uint64_t length;
+        uint64_t seq;
+        // loaded from the checkpoint and not checked against its crc yet,
+        // the segment may be overwritten after the checkpoint
+        bool verified;
+    };
+
+    struct Segment {
+        // sequence assigned when segment becomes active, 0 means free
+        uint64_t seq = 0;
+        // bytes reserved by appended records
+        uint64_t writeOffset = 0;
+        // bytes of live objects
+        uint64_t liveBytes = 0;
+        uint64_t lastAccess = 0;
+        // reads and writes in progress, segment can not be reused
+        uint32_t inflight = 0;
+        // offsets of the records being written
+        std::set<uint64_t> pendingWrites;
+        std::set<std::string> objects;
+        int fd = -1;
+    };
+
+    int OpenSegment(uint32_t id);
+    int LoadIndex();
+    bool ReadRecordHeader(uint32_t id, uint64_t offset, void *header);
+    bool CheckRecordHeader(const char *record, const std::string &name,
+                           const Location &loc);
+    void ReplaySegment(uint32_t id, uint64_t offset);
+    bool SwitchActiveSegmentLocked();
+    void ResetSegmentLocked(uint32_t id, bool notify);
+    void RemoveLocked(const std::string &name);
+    void AddLocked(const std::string &name, const Location &loc);
+    uint64_t RecordLength(uint64_t nameLen, uint64_t length);
+    std::string SegmentPath(uint32_t id);
+    std::string IndexPath();
+
+ private:
+    std::shared_ptr<PosixWrapper> posixWrapper_;
+    DiskCacheSegmentOption option_;
+    std::string dir_;
+    uint64_t alignSize_;
+
+    curve::common::Mutex mtx_;
+    std::vector<Segment> segments_;
+    std::unordered_map<std::string, Location> index_;
+    // segment being appended, -1 means none
+    int32_t active_;
+    uint64_t seqCounter_;
+    uint64_t accessClock_;
+    uint64_t liveBytes_;
+    uint64_t allocatedBytes_;
+    uint64_t lastCheckpointTime_;
+
+    EvictCallback evictCallback_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_DISK_CACHE_SEGMENT_STORE_H_
@@ -28,6 +28,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "curvefs/src/common/s3util.h"
@@ -51,6 +52,50 @@ void DiskCacheWrite::Init(std::shared_ptr<S3Client> client,
     DiskCacheBase::Init(posixWrapper, cacheDir, objectPrefix);
 }
 
+void DiskCacheWrite::SetUploadOption(uint32_t threads,
+                                     uint64_t maxInflightBytes,
+                                     uint64_t limitBps) {
+    uploadThreads_ = std::max(threads, 1U);
+    maxInflightBytes_ = maxInflightBytes;
+    ReadWriteThrottleParams params;
+    params.bpsWrite = ThrottleParams(limitBps, 0, 0);
+    uploadThrottle_.UpdateThrottleParams(params);
+}
+
+void DiskCacheWrite::AcquireInflight(uint64_t size, bool urgent) {
+    std::unique_lock<std::mutex> lock(inflightMtx_);
+    if (urgent) {
+        urgentWaiters_++;
+    }
+    inflightCond_.wait(lock, [&]() {
+        if (!urgent && urgentWaiters_ > 0) {
+            return false;
+        }
+        // let one upload go at least, even if it exceeds the budget
+        return maxInflightBytes_ == 0 || inflightBytes_ == 0 ||
+               inflightBytes_ + size <= maxInflightBytes_;
+    });
+    if (urgent) {
+        urgentWaiters_--;
+    }
+    inflightBytes_ += size;
+    inflightNum_++;
+}
+
+void DiskCacheWrite::ReleaseInflight(uint64_t size) {
+    {
+        std::lock_guard<std::mutex> lock(inflightMtx_);
+        inflightBytes_ -= size;
+        inflightNum_--;
+    }
+    inflightCond_.notify_all();
+}
+
+void DiskCacheWrite::WaitInflight() {
+    std::unique_lock<std::mutex> lock(inflightMtx_);
+    inflightCond_.wait(lock, [&]() { return inflightNum_ == 0; });
+}
+
 void DiskCacheWrite::AsyncUploadEnqueue(const std::string objName) {
     std::lock_guard<std::mutex> lock(mtx_);
     waitUpload_.push_back(objName);
@@ -137,10 +182,15 @@ int DiskCacheWrite::UploadFile(const std::string &name,
         LOG(ERROR) << "read file failed";
         return -1;
     }
+    bool urgent = (syncTask != nullptr);
+    AcquireInflight(fileSize, urgent);
+    if (!urgent) {
+        uploadThrottle_.Add(false, fileSize);
+    }
     VLOG(9) << "async upload start, file = " << name;
     PutObjectAsyncCallBack cb =
-        [&, buffer, syncTask,
-         name](const std::shared_ptr<PutObjectAsyncContext>& context) {
+        [&, buffer, syncTask, name,
+         fileSize](const std::shared_ptr<PutObjectAsyncContext>& context) {
             if (context->retCode >= 0) {
                 if (metric_ != nullptr) {
                     curve::client::CollectMetrics(&metric_->writeS3,
@@ -150,10 +200,16 @@ int DiskCacheWrite::UploadFile(const std::string &name,
                 if (s3Metric_ != nullptr) {
                     metric::AsyncContextCollectMetrics(s3Metric_, context);
                 }
+                if (cacheRead_ != nullptr &&
+                    cacheRead_->GetSegmentStore() != nullptr) {
+                    cacheRead_->WriteSegmentStore(name, buffer,
+                                                  context->bufferSize);
+                }
                 RemoveFile(context->key);
                 VLOG(9) << " PutObjectAsyncCallBack success, "
                         << "remove file: " << context->key;
                 posixWrapper_->free(buffer);
+                ReleaseInflight(fileSize);
                 if (syncTask) {
                     VLOG(9) << "UploadFile, name = "
                             << name << " signal start";
@@ -275,34 +331,34 @@ int DiskCacheWrite::AsyncUploadFunc() {
         return -1;
     }
 
-    std::list<std::string> toUpload;
-    std::shared_ptr<SynchronizationTask> syncTask;
-
     VLOG(3) << "async upload function start.";
     while (sleeper_.wait_for(std::chrono::milliseconds(asyncLoadPeriodMs_))) {
         if (!isRunning_) {
             LOG(INFO) << "async upload thread stop.";
             return 0;
         }
-        toUpload.clear();
-        int num = GetUploadFile("", &toUpload);
-        if (num <= 0) {
-            std::unique_lock<std::mutex> lock(mtx_);
-            if (waitUpload_.empty()) {
-                cond_.notify_all();
-            }
-            continue;
+        // upload threads take files one by one until the queue is drained,
+        // the memory is bounded by the inflight budget
+        std::string name;
+        uint64_t num = 0;
+        while (isRunning_ && PopUploadFile(&name)) {
+            UploadFile(name);
+            num++;
         }
-        VLOG(6) << "async upload file size = " << num;
-        syncTask.reset(new SynchronizationTask(num));
-        UploadFile(toUpload, syncTask);
-        VLOG(6) << "async upload all files";
+        VLOG_IF(6, num > 0) << "async upload file num = " << num;
     }
+    return 0;
+}
 
-    if (syncTask) {
-        syncTask->Wait();
+bool DiskCacheWrite::PopUploadFile(std::string *name) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (waitUpload_.empty()) {
+        cond_.notify_all();
+        return false;
     }
-    return 0;
+    *name = std::move(waitUpload_.front());
+    waitUpload_.pop_front();
+    return true;
 }
 
 int DiskCacheWrite::AsyncUploadRun() {
@@ -310,8 +366,11 @@ int DiskCacheWrite::AsyncUploadRun() {
         LOG(INFO) << "AsyncUpload thread is on running.";
         return -1;
     }
-    LOG(INFO) << "AsyncUpload thread is on running.";
-    backEndThread_ = std::thread(&DiskCacheWrite::AsyncUploadFunc, this);
+    LOG(INFO) << "AsyncUpload thread is on running, threads: "
+              << uploadThreads_ << ", maxInflightBytes: " << maxInflightBytes_;
+    for (uint32_t i = 0; i < uploadThreads_; i++) {
+        backEndThreads_.emplace_back(&DiskCacheWrite::AsyncUploadFunc, this);
+    }
     return 0;
 }
 
@@ -325,7 +384,11 @@ int DiskCacheWrite::AsyncUploadStop() {
     if (isRunning_.exchange(false)) {
         LOG(INFO) << "stop AsyncUpload thread...";
         sleeper_.interrupt();
-        backEndThread_.join();
+        for (auto &t : backEndThreads_) {
+            t.join();
+        }
+        backEndThreads_.clear();
+        WaitInflight();
         LOG(INFO) << "stop AsyncUpload thread ok.";
         return -1;
     }
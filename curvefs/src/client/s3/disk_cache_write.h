@@ -30,6 +30,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "curvefs/src/client/common/config.h"
 #include "curvefs/src/client/s3/client_s3.h"
@@ -48,6 +49,9 @@ namespace client {
 
 using curve::common::InterruptibleSleeper;
 using curve::common::PutObjectAsyncCallBack;
+using curve::common::ReadWriteThrottleParams;
+using curve::common::Throttle;
+using curve::common::ThrottleParams;
 using ::curve::common::SglLRUCache;
 using curvefs::client::metric::S3Metric;
 using curvefs::common::PosixWrapper;
@@ -77,7 +81,9 @@ class DiskCacheWrite : public DiskCacheBase {
     // init isRunning_ should here，
     // otherwise when call AsyncUploadStop in ~DiskCacheWrite will failed:
     // "terminate called after throwing an instance of 'std::system_error'"
-    DiskCacheWrite() : isRunning_(false) {}
+    DiskCacheWrite()
+        : isRunning_(false), uploadThreads_(1), maxInflightBytes_(0),
+          inflightBytes_(0), inflightNum_(0), urgentWaiters_(0) {}
     virtual ~DiskCacheWrite() {
        AsyncUploadStop();
     }
@@ -117,6 +123,16 @@ class DiskCacheWrite : public DiskCacheBase {
 
     virtual int UploadFileByInode(const std::string &inode);
 
+    /**
+     * @brief set the options of async upload, must be called before
+     *        AsyncUploadRun
+     * @param[in] threads number of upload threads
+     * @param[in] maxInflightBytes max bytes of files being uploaded,
+     *            0 means no limit
+     * @param[in] limitBps bandwidth of background upload, 0 means no limit
+     */
+    void SetUploadOption(uint32_t threads, uint64_t maxInflightBytes,
+                         uint64_t limitBps);
     /**
      * @brief: start async upload thread
      */
@@ -142,9 +158,23 @@ class DiskCacheWrite : public DiskCacheBase {
      */
     virtual bool IsCacheClean();
 
+    /**
+     * @brief uploaded obj will be moved to segment store of cacheRead
+     *        if it is enabled
+     */
+    void SetCacheRead(std::shared_ptr<DiskCacheRead> cacheRead) {
+        cacheRead_ = cacheRead;
+    }
+
  private:
     using DiskCacheBase::Init;
     int AsyncUploadFunc();
+    bool PopUploadFile(std::string *name);
+    // uploads waited by fsync are urgent, they get the inflight budget
+    // before background uploads and are not limited by uploadThrottle_
+    void AcquireInflight(uint64_t size, bool urgent);
+    void ReleaseInflight(uint64_t size);
+    void WaitInflight();
     void UploadFile(const std::list<std::string> &toUpload,
                     std::shared_ptr<SynchronizationTask> syncTask = nullptr);
     bool WriteCacheValid();
@@ -152,7 +182,7 @@ class DiskCacheWrite : public DiskCacheBase {
                       std::list<std::string> *toUpload);
     int FileExist(const std::string &inode);
 
-    curve::common::Thread backEndThread_;
+    std::vector<curve::common::Thread> backEndThreads_;
     curve::common::Atomic<bool> isRunning_;
     std::list<std::string> waitUpload_;
     std::mutex mtx_;
@@ -160,12 +190,21 @@ class DiskCacheWrite : public DiskCacheBase {
     InterruptibleSleeper sleeper_;
     uint64_t asyncLoadPeriodMs_;
     std::shared_ptr<S3Client> client_;
+    uint32_t uploadThreads_;
+    uint64_t maxInflightBytes_;
+    uint64_t inflightBytes_;
+    uint64_t inflightNum_;
+    uint32_t urgentWaiters_;
+    std::mutex inflightMtx_;
+    std::condition_variable inflightCond_;
+    Throttle uploadThrottle_;
     // file system operation encapsulation
     std::shared_ptr<PosixWrapper> posixWrapper_;
     std::shared_ptr<DiskCacheMetric> metric_;
     std::shared_ptr<S3Metric> s3Metric_;
 
     std::shared_ptr<SglLRUCache<std::string>> cachedObjName_;
+    std::shared_ptr<DiskCacheRead> cacheRead_;
 };
 
 }  // namespace client
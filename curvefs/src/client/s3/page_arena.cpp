@@ -0,0 +1,187 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-21
+ */
+
+#include "curvefs/src/client/s3/page_arena.h"
+
+#include <glog/logging.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "absl/memory/memory.h"
+
+namespace curvefs {
+namespace client {
+
+using ::curve::common::LockGuard;
+
+namespace {
+const uint64_t kHugePageSize = 2ULL * 1024 * 1024;
+}  // namespace
+
+PageArena::PageArena(uint32_t pageSize, uint64_t slabSize)
+    : pageSize_(pageSize),
+      emptySlabNum_(0),
+      usedPages_(0),
+      totalPages_(0),
+      slabNum_(0) {
+    CHECK(pageSize_ > 0) << "page size must be greater than 0";
+    pagesPerSlab_ = std::max<uint64_t>(slabSize / pageSize_, 1);
+    slabBytes_ = static_cast<uint64_t>(pagesPerSlab_) * pageSize_;
+    metric_ = absl::make_unique<PageArenaMetric>("", &usedPages_,
+                                                 &totalPages_, &slabNum_);
+    LOG(INFO) << "PageArena init, page size: " << pageSize_
+              << ", slab size: " << slabBytes_
+              << ", pages per slab: " << pagesPerSlab_;
+}
+
+PageArena::~PageArena() {
+    LOG_IF(WARNING, usedPages_.load() != 0)
+        << "PageArena destroyed with " << usedPages_.load()
+        << " pages in use";
+    for (auto &slab : slabs_) {
+        ReleaseSlab(slab.second.get());
+    }
+}
+
+void PageArena::InitMetrics(const std::string &fsName) {
+    metric_ = absl::make_unique<PageArenaMetric>(fsName, &usedPages_,
+                                                 &totalPages_, &slabNum_);
+}
+
+char *PageArena::Allocate() {
+    LockGuard lk(mtx_);
+    if (partialSlabs_.empty()) {
+        Slab *slab = NewSlab();
+        uintptr_t key = reinterpret_cast<uintptr_t>(slab->base);
+        slabs_.emplace(key, std::unique_ptr<Slab>(slab));
+        partialSlabs_.emplace(key);
+        emptySlabNum_++;
+    }
+
+    Slab *slab = slabs_[*partialSlabs_.begin()].get();
+    if (slab->freePages.size() == pagesPerSlab_) {
+        emptySlabNum_--;
+    }
+    char *page = slab->freePages.back();
+    slab->freePages.pop_back();
+    if (slab->freePages.empty()) {
+        partialSlabs_.erase(partialSlabs_.begin());
+    }
+    usedPages_.fetch_add(1, std::memory_order_relaxed);
+    return page;
+}
+
+void PageArena::Free(char *page) {
+    if (page == nullptr) {
+        return;
+    }
+
+    LockGuard lk(mtx_);
+    auto iter = slabs_.upper_bound(reinterpret_cast<uintptr_t>(page));
+    CHECK(iter != slabs_.begin()) << "page not belong to arena";
+    --iter;
+    Slab *slab = iter->second.get();
+    assert(page < slab->base + slabBytes_);
+    slab->freePages.push_back(page);
+    usedPages_.fetch_sub(1, std::memory_order_relaxed);
+    if (slab->freePages.size() == 1) {
+        partialSlabs_.emplace(iter->first);
+    }
+    if (slab->freePages.size() < pagesPerSlab_) {
+        return;
+    }
+
+    if (emptySlabNum_ == 0) {
+        emptySlabNum_++;
+        return;
+    }
+    partialSlabs_.erase(iter->first);
+    ReleaseSlab(slab);
+    slabs_.erase(iter);
+}
+
+PageArena::Slab *PageArena::NewSlab() {
+    Slab *slab = new Slab();
+    slab->base = nullptr;
+    slab->mmaped = false;
+
+    // map one more huge page, so that the slab can be aligned to the huge
+    // page size and be backed by transparent huge pages
+    uint64_t mapBytes = slabBytes_;
+    if (slabBytes_ >= kHugePageSize) {
+        mapBytes += kHugePageSize;
+    }
+    void *addr = mmap(nullptr, mapBytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr != MAP_FAILED) {
+        uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+        uintptr_t end = start + mapBytes;
+        uintptr_t aligned = start;
+        if (mapBytes > slabBytes_) {
+            aligned = (start + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        }
+        if (aligned > start) {
+            munmap(addr, aligned - start);
+        }
+        if (end > aligned + slabBytes_) {
+            munmap(reinterpret_cast<void *>(aligned + slabBytes_),
+                   end - aligned - slabBytes_);
+        }
+        slab->base = reinterpret_cast<char *>(aligned);
+        slab->mmaped = true;
+#ifdef MADV_HUGEPAGE
+        if (slabBytes_ >= kHugePageSize) {
+            (void)madvise(slab->base, slabBytes_, MADV_HUGEPAGE);
+        }
+#endif
+    } else {
+        LOG(WARNING) << "PageArena mmap slab failed, size: " << mapBytes
+                     << ", fallback to heap";
+        slab->base = new char[slabBytes_];
+    }
+
+    // pages are popped from the back, keep low address pages at the back
+    slab->freePages.reserve(pagesPerSlab_);
+    for (uint32_t i = pagesPerSlab_; i > 0; i--) {
+        slab->freePages.push_back(slab->base +
+                                  static_cast<uint64_t>(i - 1) * pageSize_);
+    }
+    totalPages_.fetch_add(pagesPerSlab_, std::memory_order_relaxed);
+    slabNum_.fetch_add(1, std::memory_order_relaxed);
+    return slab;
+}
+
+void PageArena::ReleaseSlab(Slab *slab) {
+    if (slab->mmaped) {
+        munmap(slab->base, slabBytes_);
+    } else {
+        delete[] slab->base;
+    }
+    slab->base = nullptr;
+    totalPages_.fetch_sub(pagesPerSlab_, std::memory_order_relaxed);
+    slabNum_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace client
+}  // namespace curvefs
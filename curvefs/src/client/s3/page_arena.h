@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-21
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_PAGE_ARENA_H_
+#define CURVEFS_SRC_CLIENT_S3_PAGE_ARENA_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "curvefs/src/client/metric/client_metric.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curvefs {
+namespace client {
+
+using curvefs::client::metric::PageArenaMetric;
+
+// PageArena hands out fixed size pages for the data cache.
+// Pages are carved from big slabs (mmap'ed and advised to be backed by
+// transparent huge pages) instead of one heap allocation per page, which
+// reduces allocator overhead and TLB misses under heavy write load.
+// Every slab keeps its own free list, and pages are always taken from the
+// lowest addressed slab that has free pages, so that pages are packed into
+// as few slabs as possible and fully free slabs can be returned to the OS.
+class PageArena {
+ public:
+    PageArena(uint32_t pageSize, uint64_t slabSize);
+
+    ~PageArena();
+
+    PageArena(const PageArena &) = delete;
+    PageArena &operator=(const PageArena &) = delete;
+
+    // allocate one page, the content of the page is undefined
+    char *Allocate();
+
+    // give back a page allocated by Allocate()
+    void Free(char *page);
+
+    void InitMetrics(const std::string &fsName);
+
+    uint32_t GetPageSize() const { return pageSize_; }
+
+    uint32_t GetPagesPerSlab() const { return pagesPerSlab_; }
+
+    int64_t GetUsedPages() const {
+        return usedPages_.load(std::memory_order_relaxed);
+    }
+
+    int64_t GetTotalPages() const {
+        return totalPages_.load(std::memory_order_relaxed);
+    }
+
+    int64_t GetSlabNum() const {
+        return slabNum_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    struct Slab {
+        char *base;
+        bool mmaped;
+        std::vector<char *> freePages;
+    };
+
+    Slab *NewSlab();
+
+    void ReleaseSlab(Slab *slab);
+
+ private:
+    uint32_t pageSize_;
+    uint32_t pagesPerSlab_;
+    uint64_t slabBytes_;
+
+    curve::common::Mutex mtx_;
+    // all slabs, key is the base address of slab
+    std::map<uintptr_t, std::unique_ptr<Slab>> slabs_;
+    // base address of the slabs which have free pages
+    std::set<uintptr_t> partialSlabs_;
+    // number of slabs whose pages are all free, one of them is kept
+    // to avoid mmap/munmap back and forth at the boundary
+    uint32_t emptySlabNum_;
+
+    std::atomic<int64_t> usedPages_;
+    std::atomic<int64_t> totalPages_;
+    std::atomic<int64_t> slabNum_;
+    std::unique_ptr<PageArenaMetric> metric_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_PAGE_ARENA_H_
@@ -0,0 +1,140 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-26
+ */
+
+#include "curvefs/src/client/s3/read_single_flight.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace curvefs {
+namespace client {
+
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
+
+int S3ReadSingleFlight::Flight::Wait() {
+    UniqueLock lk(mtx);
+    cond.wait(lk, [this]() { return done; });
+    return ret;
+}
+
+void S3ReadSingleFlight::Flight::Finish(int r) {
+    {
+        LockGuard lk(mtx);
+        ret = r;
+        done = true;
+    }
+    cond.notify_all();
+}
+
+void S3ReadSingleFlight::Split(FlightList *flights, uint64_t offset,
+                               uint64_t end, std::vector<Piece> *pieces) {
+    uint64_t pos = offset;
+    auto iter = flights->begin();
+    while (pos < end) {
+        // skip the flights before pos, adjacent ones included
+        while (iter != flights->end() && (*iter)->end <= pos) {
+            ++iter;
+        }
+
+        if (iter != flights->end() && (*iter)->offset <= pos) {
+            uint64_t pieceEnd = std::min(end, (*iter)->end);
+            pieces->push_back(Piece{*iter, pos, pieceEnd, false});
+            pos = pieceEnd;
+            continue;
+        }
+
+        uint64_t gapEnd = end;
+        if (iter != flights->end()) {
+            gapEnd = std::min(end, (*iter)->offset);
+        }
+        auto flight = std::make_shared<Flight>(pos, gapEnd);
+        flights->insert(iter, flight);
+        pieces->push_back(Piece{flight, pos, gapEnd, true});
+        pos = gapEnd;
+    }
+}
+
+void S3ReadSingleFlight::Remove(const std::string &name,
+                                const FlightPtr &flight) {
+    LockGuard lk(mtx_);
+    auto iter = flights_.find(name);
+    iter->second.remove(flight);
+    if (iter->second.empty()) {
+        flights_.erase(iter);
+    }
+}
+
+int S3ReadSingleFlight::Read(const std::string &name, char *buf,
+                             uint64_t offset, uint64_t length, bool *merged) {
+    std::vector<Piece> pieces;
+    {
+        LockGuard lk(mtx_);
+        Split(&flights_[name], offset, offset + length, &pieces);
+    }
+
+    bool joined = std::any_of(pieces.begin(), pieces.end(),
+                              [](const Piece &p) { return !p.own; });
+    if (joined) {
+        merged_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (merged != nullptr) {
+        *merged = joined;
+    }
+
+    // send the GETs of this read before waiting for others, so that the
+    // GETs joined by other reads are never blocked
+    int ret = 0;
+    for (const auto &piece : pieces) {
+        if (!piece.own) {
+            continue;
+        }
+        const auto &flight = piece.flight;
+        issued_.fetch_add(1, std::memory_order_relaxed);
+        int r = client_->Download(name, flight->buf.get(), flight->offset,
+                                  flight->end - flight->offset);
+        flight->Finish(r);
+        Remove(name, flight);
+    }
+
+    for (const auto &piece : pieces) {
+        const auto &flight = piece.flight;
+        if (!piece.own) {
+            VLOG(9) << "read " << name << ", offset: " << offset
+                    << ", length: " << length << " joins flight ["
+                    << flight->offset << ", " << flight->end << ")";
+        }
+        int r = flight->Wait();
+        if (r < 0) {
+            ret = r;
+            continue;
+        }
+        memcpy(buf + (piece.offset - offset),
+               flight->buf.get() + (piece.offset - flight->offset),
+               piece.end - piece.offset);
+    }
+    return ret;
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-26
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_READ_SINGLE_FLIGHT_H_
+#define CURVEFS_SRC_CLIENT_S3_READ_SINGLE_FLIGHT_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "curvefs/src/client/s3/client_s3.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curvefs {
+namespace client {
+
+// S3ReadSingleFlight merges concurrent range reads of the same object,
+// so that readers of overlapping ranges share the s3 GETs in flight.
+//
+// The part of a read overlapping in-flight GETs is copied from them once
+// they finish, and only the rest of the read is fetched by GETs of its
+// own, which are sent at once and can be joined by later reads. A read
+// never waits for GETs which are only adjacent to it, and every reader
+// waits on the GETs it joined, not on a shared condition.
+class S3ReadSingleFlight {
+ public:
+    explicit S3ReadSingleFlight(std::shared_ptr<S3Client> client)
+        : client_(std::move(client)), issued_(0), merged_(0) {}
+
+    // read [offset, offset + length) of object name into buf,
+    // return 0 on success, otherwise the error returned by
+    // S3Client::Download, *merged is set to true if part of the read
+    // is served by the GETs of other reads
+    int Read(const std::string &name, char *buf, uint64_t offset,
+             uint64_t length, bool *merged = nullptr);
+
+    // GETs sent to s3
+    uint64_t GetIssuedCount() const { return issued_.load(); }
+
+    // reads served by the GETs of other reads
+    uint64_t GetMergedCount() const { return merged_.load(); }
+
+ private:
+    struct Flight {
+        uint64_t offset;
+        uint64_t end;
+        // protects done and ret, buf is filled before done is set
+        curve::common::Mutex mtx;
+        curve::common::ConditionVariable cond;
+        bool done = false;
+        int ret = 0;
+        std::unique_ptr<char[]> buf;
+
+        Flight(uint64_t off, uint64_t e)
+            : offset(off), end(e), buf(new char[e - off]) {}
+
+        // wait until the GET finishes, return its result
+        int Wait();
+
+        void Finish(int r);
+    };
+    using FlightPtr = std::shared_ptr<Flight>;
+    using FlightList = std::list<FlightPtr>;
+
+    // part [offset, end) of a read served by flight
+    struct Piece {
+        FlightPtr flight;
+        uint64_t offset;
+        uint64_t end;
+        // the flight is sent by this read
+        bool own;
+    };
+
+    // split the read [offset, end) into the parts covered by the flights
+    // in flight and the gaps between them, a new flight is added to
+    // flights for every gap
+    static void Split(FlightList *flights, uint64_t offset, uint64_t end,
+                      std::vector<Piece> *pieces);
+
+    void Remove(const std::string &name, const FlightPtr &flight);
+
+ private:
+    std::shared_ptr<S3Client> client_;
+    // protects flights_ only, GETs are waited on their own flights
+    curve::common::Mutex mtx_;
+    // object name -> flights of the object, ordered by offset
+    std::unordered_map<std::string, FlightList> flights_;
+    std::atomic<uint64_t> issued_;
+    std::atomic<uint64_t> merged_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_READ_SINGLE_FLIGHT_H_
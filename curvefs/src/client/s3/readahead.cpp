@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-25
+ */
+
+#include "curvefs/src/client/s3/readahead.h"
+
+#include <algorithm>
+
+namespace curvefs {
+namespace client {
+
+using ::curve::common::LockGuard;
+
+namespace {
+// fuse may handle the reads of a sequential stream concurrently,
+// so a read a little ahead of or behind the last one is still sequential
+const uint64_t kSequentialSlack = 1024 * 1024;
+// a single read breaking the pattern is ignored
+const uint32_t kMaxMismatch = 2;
+}  // namespace
+
+ReadaheadDetector::ReadaheadDetector()
+    : pattern_(AccessPattern::kUnknown),
+      hasLast_(false),
+      lastOffset_(0),
+      lastEnd_(0),
+      lastStride_(0),
+      mismatch_(0),
+      window_(0) {}
+
+void ReadaheadDetector::OnRead(uint64_t offset, uint64_t length) {
+    LockGuard lk(mtx_);
+    int64_t stride =
+        static_cast<int64_t>(offset) - static_cast<int64_t>(lastOffset_);
+    if (!hasLast_) {
+        hasLast_ = true;
+    } else if (offset + kSequentialSlack >= lastOffset_ &&
+               offset <= lastEnd_ + kSequentialSlack) {
+        pattern_ = AccessPattern::kSequential;
+        mismatch_ = 0;
+    } else if (stride == lastStride_) {
+        pattern_ = AccessPattern::kStrided;
+        mismatch_ = 0;
+    } else if (++mismatch_ < kMaxMismatch &&
+               pattern_ != AccessPattern::kUnknown &&
+               pattern_ != AccessPattern::kRandom) {
+        // keep the position of the stream
+        return;
+    } else {
+        pattern_ = AccessPattern::kRandom;
+        mismatch_ = 0;
+    }
+
+    if (pattern_ != AccessPattern::kSequential || offset >= lastOffset_) {
+        lastStride_ = stride;
+        lastOffset_ = offset;
+    }
+    lastEnd_ = std::max(lastEnd_, offset + length);
+    if (pattern_ != AccessPattern::kSequential) {
+        lastEnd_ = offset + length;
+    }
+}
+
+uint32_t ReadaheadDetector::NextWindow(uint32_t minWindow,
+                                       uint32_t maxWindow) {
+    LockGuard lk(mtx_);
+    maxWindow = std::max(minWindow, maxWindow);
+    switch (pattern_) {
+    case AccessPattern::kUnknown:
+        window_ = minWindow;
+        break;
+    case AccessPattern::kSequential:
+    case AccessPattern::kStrided:
+        if (window_ < minWindow) {
+            window_ = minWindow;
+        } else {
+            window_ = std::min(std::max(window_ * 2, 1U), maxWindow);
+        }
+        break;
+    case AccessPattern::kRandom:
+        window_ /= 2;
+        break;
+    }
+    return window_;
+}
+
+AccessPattern ReadaheadDetector::GetPattern() {
+    LockGuard lk(mtx_);
+    return pattern_;
+}
+
+int64_t ReadaheadDetector::GetStride() {
+    LockGuard lk(mtx_);
+    return lastStride_;
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-25
+ */
+
+#ifndef CURVEFS_SRC_CLIENT_S3_READAHEAD_H_
+#define CURVEFS_SRC_CLIENT_S3_READAHEAD_H_
+
+#include <cstdint>
+
+#include "src/common/concurrent/concurrent.h"
+
+namespace curvefs {
+namespace client {
+
+enum class AccessPattern {
+    kUnknown = 0,
+    kSequential = 1,
+    kStrided = 2,
+    kRandom = 3,
+};
+
+// ReadaheadDetector tracks the read pattern of a file and decides how many
+// blocks to prefetch when a read misses the local cache.
+// The prefetch window doubles on every miss while the reads are sequential
+// or strided, and halves while they are random, so large sequential reads
+// prefetch more and random reads stop wasting s3 requests.
+class ReadaheadDetector {
+ public:
+    ReadaheadDetector();
+
+    // record a read of the file
+    void OnRead(uint64_t offset, uint64_t length);
+
+    // get the prefetch window for a miss, in blocks,
+    // the window is at least minWindow unless the reads are random
+    uint32_t NextWindow(uint32_t minWindow, uint32_t maxWindow);
+
+    AccessPattern GetPattern();
+
+    // distance between the offsets of two strided reads
+    int64_t GetStride();
+
+ private:
+    curve::common::Mutex mtx_;
+    AccessPattern pattern_;
+    bool hasLast_;
+    uint64_t lastOffset_;
+    uint64_t lastEnd_;
+    int64_t lastStride_;
+    // reads not matching the current pattern in a row
+    uint32_t mismatch_;
+    uint32_t window_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_SRC_CLIENT_S3_READAHEAD_H_
@@ -49,6 +49,8 @@ namespace curvefs {
 namespace client {
 namespace warmup {
 
+using curve::common::ReadWriteThrottleParams;
+using curve::common::ThrottleParams;
 using curve::common::WriteLockGuard;
 
 #define WARMUP_CHECKINTERVAL_US (1000 * 1000)
@@ -195,6 +197,10 @@ void WarmupManagerS3Impl::UnInit() {
 
 void WarmupManagerS3Impl::Init(const FuseClientOption& option) {
     WarmupManager::Init(option);
+    maxInflightBytes_ = option.warmupMaxInflightBytes;
+    ReadWriteThrottleParams params;
+    params.bpsRead = ThrottleParams(option.warmupLimitBps, 0, 0);
+    downloadThrottle_.UpdateThrottleParams(params);
     bgFetchStop_.store(false, std::memory_order_release);
     bgFetchThread_ = Thread(&WarmupManagerS3Impl::BackGroundFetch, this);
     initbgFetchThread_ = true;
@@ -362,18 +368,67 @@ void WarmupManagerS3Impl::FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
                    << ", key=" << key << ", parent=" << ino;
         return;
     }
+    UpdateProgress(key, [](WarmupProgress* progress) {
+        progress->ListedDirPlusOne();
+    });
+
+    // the listed dentries are handled here directly, the subdirectories
+    // are listed by the pool concurrently, and the files go to the data
+    // fetch pool without waiting for the whole tree
+    std::set<uint64_t> files;
     for (const auto& dentry : dentryList) {
         VLOG(9) << "FetchChildDentry: key:" << key
                 << " dentry: " << dentry.name();
-        std::string lastName = dentry.name();
-        auto task = [this, key, ino, lastName, symlink_depth]() {
-            FetchDentry(key, ino, lastName, symlink_depth);
-        };
-        AddFetchDentryTask(key, task);
+        if (FsFileType::TYPE_S3 == dentry.type()) {
+            files.insert(dentry.inodeid());
+        } else if (FsFileType::TYPE_DIRECTORY == dentry.type()) {
+            fuse_ino_t child = dentry.inodeid();
+            auto task = [this, key, child, symlink_depth]() {
+                FetchChildDentry(key, child, symlink_depth);
+            };
+            AddFetchDentryTask(key, task);
+        } else if (FsFileType::TYPE_SYM_LINK == dentry.type()) {
+            std::string lastName = dentry.name();
+            auto task = [this, key, ino, lastName, symlink_depth]() {
+                FetchDentry(key, ino, lastName, symlink_depth);
+            };
+            AddFetchDentryTask(key, task);
+        } else {
+            VLOG(3) << "unkown, file: " << dentry.name() << ", ino: " << ino;
+        }
     }
+    FetchFilesEnqueue(key, ino, files);
     VLOG(9) << "FetchChildDentry end: key:" << key << " inode: " << ino;
 }
 
+void WarmupManagerS3Impl::FetchFilesEnqueue(fuse_ino_t key, fuse_ino_t ino,
+                                            const std::set<uint64_t>& files) {
+    if (files.empty()) {
+        return;
+    }
+    UpdateProgress(key, [&files](WarmupProgress* progress) {
+        progress->AddFiles(files.size());
+    });
+
+    // attrs are got by one request per partition concurrently
+    std::set<uint64_t> inodeIds = files;
+    std::map<uint64_t, InodeAttr> attrs;
+    CURVEFS_ERROR ret =
+        inodeManager_->BatchGetInodeAttrAsync(ino, &inodeIds, &attrs);
+    if (ret != CURVEFS_ERROR::OK) {
+        LOG(WARNING) << "batch get inode attr fail, ret = " << ret
+                     << ", key = " << key << ", parent = " << ino;
+    }
+    for (const auto& file : files) {
+        auto iter = attrs.find(file);
+        if (iter != attrs.end() && iter->second.length() == 0) {
+            VLOG(9) << "skip empty file, key: " << key << " inode: " << file;
+            continue;
+        }
+        FetchDataEnqueue(key, file);
+    }
+}
+
 void WarmupManagerS3Impl::FetchDataEnqueue(fuse_ino_t key, fuse_ino_t ino) {
     VLOG(9) << "FetchDataEnqueue start: key:" << key << " inode: " << ino;
     auto task = [key, ino, this]() {
@@ -532,12 +587,14 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
             (void)adapter;
             if (bgFetchStop_.load(std::memory_order_acquire)) {
                 VLOG(9) << "need stop warmup";
+                ReleaseInflight(context->len);
                 cond.Signal();
                 return;
             }
             if (context->retCode >= 0) {
                 VLOG(9) << "Get Object success: " << context->key;
                 PutObjectToCache(key, context);
+                ReleaseInflight(context->len);
                 curve::client::CollectMetrics(&warmupS3Metric_.warmupS3Cached,
                                               context->len,
                                               butil::cpuwide_time_us() - start);
@@ -550,6 +607,10 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
             }
             warmupS3Metric_.warmupS3Cached.eps.count << 1;
             if (++context->retry >= option_.downloadMaxRetryTimes) {
+                ReleaseInflight(context->len);
+                UpdateProgress(key, [](WarmupProgress* progress) {
+                    progress->FailedPlusOne();
+                });
                 if (pendingReq.fetch_sub(1, std::memory_order_seq_cst) == 1) {
                     VLOG(6) << "pendingReq is over";
                     cond.Signal();
@@ -586,6 +647,9 @@ void WarmupManagerS3Impl::WarmUpAllObjs(
                     continue;
                 }
             }
+            // the downloads of all the warmup tasks share one budget
+            AcquireInflight(readLen);
+            downloadThrottle_.Add(true, readLen);
             char* cacheS3 = new char[readLen];
             memset(cacheS3, 0, readLen);
             auto context = std::make_shared<GetObjectAsyncContext>(
@@ -659,7 +723,8 @@ void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
     ReadLockGuard lock(inode2ProgressMutex_);
     for (auto iter = inode2Progress_.begin(); iter != inode2Progress_.end();) {
         if (ProgressDone(iter->first)) {
-            LOG(INFO) << "warmup task: " << iter->first << " done!";
+            LOG(INFO) << "warmup task: " << iter->first
+                      << " done! progress: " << iter->second.ToString();
             iter = inode2Progress_.erase(iter);
         } else {
             ++iter;
@@ -670,7 +735,7 @@ void WarmupManagerS3Impl::ScanCleanWarmupProgress() {
 void WarmupManagerS3Impl::ScanWarmupInodes() {
     // file need warmup
     WriteLockGuard lock(warmupInodesDequeMutex_);
-    if (!warmupInodesDeque_.empty()) {
+    while (!warmupInodesDeque_.empty()) {
         WarmupInodes inodes = warmupInodesDeque_.front();
         for (auto const& iter : inodes.GetReadAheadFiles()) {
             VLOG(9) << "BackGroundFetch: key: " << inodes.GetKey()
@@ -773,6 +838,7 @@ void WarmupManagerS3Impl::PutObjectToCache(
     int ret;
     // update progress
     iter->second.FinishedPlusOne();
+    iter->second.AddFinishedBytes(context->len);
     switch (iter->second.GetStorageType()) {
         case curvefs::client::common::WarmupStorageType::kWarmupStorageTypeDisk:
             ret = s3Adaptor_->GetDiskCacheManager()->WriteReadDirect(
@@ -798,6 +864,33 @@ void WarmupManagerS3Impl::PutObjectToCache(
     }
 }
 
+void WarmupManagerS3Impl::UpdateProgress(
+    fuse_ino_t key, const std::function<void(WarmupProgress*)>& update) {
+    ReadLockGuard lock(inode2ProgressMutex_);
+    auto iter = FindWarmupProgressByKeyLocked(key);
+    if (iter != inode2Progress_.end()) {
+        update(&iter->second);
+    }
+}
+
+void WarmupManagerS3Impl::AcquireInflight(uint64_t size) {
+    std::unique_lock<std::mutex> lock(inflightMtx_);
+    inflightCond_.wait(lock, [&]() {
+        // let one download go at least, even if it exceeds the budget
+        return maxInflightBytes_ == 0 || inflightBytes_ == 0 ||
+               inflightBytes_ + size <= maxInflightBytes_;
+    });
+    inflightBytes_ += size;
+}
+
+void WarmupManagerS3Impl::ReleaseInflight(uint64_t size) {
+    {
+        std::lock_guard<std::mutex> lock(inflightMtx_);
+        inflightBytes_ -= size;
+    }
+    inflightCond_.notify_all();
+}
+
 bool WarmupManagerS3Impl::GetInodeSubPathParent(
     fuse_ino_t inode, const std::vector<std::string>& subPath, fuse_ino_t* ret,
     std::string* lastPath, uint32_t* symlink_depth) {
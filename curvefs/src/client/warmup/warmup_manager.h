@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <deque>
 #include <functional>
@@ -51,6 +52,7 @@
 #include "curvefs/src/common/task_thread_pool.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/concurrent/rw_lock.h"
+#include "src/common/throttle.h"
 
 namespace curvefs {
 namespace client {
@@ -61,6 +63,7 @@ using common::FuseClientOption;
 using ThreadPool = curvefs::common::TaskThreadPool2<bthread::Mutex,
                                                     bthread::ConditionVariable>;
 using curve::common::BthreadRWLock;
+using curve::common::Throttle;
 
 using curvefs::client::common::WarmupStorageType;
 
@@ -121,13 +124,21 @@ class WarmupProgress {
         : total_(0),
           finished_(0),
           storageType_(type),
-          filePathInClient_(filePath) {}
+          filePathInClient_(filePath),
+          failed_(0),
+          dirs_(0),
+          files_(0),
+          finishedBytes_(0) {}
 
     WarmupProgress(const WarmupProgress& wp)
         : total_(wp.total_),
           finished_(wp.finished_),
           storageType_(wp.storageType_),
-          filePathInClient_(wp.filePathInClient_) {}
+          filePathInClient_(wp.filePathInClient_),
+          failed_(wp.failed_.load()),
+          dirs_(wp.dirs_.load()),
+          files_(wp.files_.load()),
+          finishedBytes_(wp.finishedBytes_.load()) {}
 
     void AddTotal(uint64_t add) {
         std::lock_guard<std::mutex> lock(totalMutex_);
@@ -137,6 +148,10 @@ class WarmupProgress {
     WarmupProgress& operator=(const WarmupProgress& wp) {
         total_ = wp.total_;
         finished_ = wp.finished_;
+        failed_ = wp.failed_.load();
+        dirs_ = wp.dirs_.load();
+        files_ = wp.files_.load();
+        finishedBytes_ = wp.finishedBytes_.load();
         return *this;
     }
 
@@ -155,11 +170,31 @@ class WarmupProgress {
         return finished_;
     }
 
+    // objects failed to download
+    void FailedPlusOne() { ++failed_; }
+    uint64_t GetFailed() const { return failed_.load(); }
+
+    // directories listed
+    void ListedDirPlusOne() { ++dirs_; }
+    uint64_t GetListedDirs() const { return dirs_.load(); }
+
+    // files found
+    void AddFiles(uint64_t add) { files_ += add; }
+    uint64_t GetFiles() const { return files_.load(); }
+
+    // bytes of the objects cached
+    void AddFinishedBytes(uint64_t add) { finishedBytes_ += add; }
+    uint64_t GetFinishedBytes() const { return finishedBytes_.load(); }
+
     std::string ToString() {
         std::lock_guard<std::mutex> lockT(totalMutex_);
         std::lock_guard<std::mutex> lockF(finishedMutex_);
         return "total:" + std::to_string(total_) +
-               ",finished:" + std::to_string(finished_);
+               ",finished:" + std::to_string(finished_) +
+               ",failed:" + std::to_string(failed_.load()) +
+               ",dirs:" + std::to_string(dirs_.load()) +
+               ",files:" + std::to_string(files_.load()) +
+               ",finishedBytes:" + std::to_string(finishedBytes_.load());
     }
 
     std::string GetFilePathInClient() { return filePathInClient_; }
@@ -173,6 +208,10 @@ class WarmupProgress {
     std::mutex finishedMutex_;
     WarmupStorageType storageType_;
     std::string filePathInClient_;
+    std::atomic<uint64_t> failed_;
+    std::atomic<uint64_t> dirs_;
+    std::atomic<uint64_t> files_;
+    std::atomic<uint64_t> finishedBytes_;
 };
 
 using FuseOpReadFunctionType =
@@ -364,7 +403,9 @@ class WarmupManagerS3Impl : public WarmupManager {
                         std::move(dentryManager), std::move(fsInfo),
                         std::move(readFunc), std::move(readLinkFunc),
                         std::move(kvClientManager)),
-          s3Adaptor_(std::move(s3Adaptor)) {}
+          s3Adaptor_(std::move(s3Adaptor)),
+          maxInflightBytes_(0),
+          inflightBytes_(0) {}
 
     bool AddWarmupFilelist(fuse_ino_t key, WarmupStorageType type,
                            const std::string& path,
@@ -418,6 +459,11 @@ class WarmupManagerS3Impl : public WarmupManager {
     void FetchChildDentry(fuse_ino_t key, fuse_ino_t ino,
                           uint32_t symlink_depth);
 
+    // get the attrs of the files under directory ino in batches, and
+    // enqueue the non-empty ones to fetch data
+    void FetchFilesEnqueue(fuse_ino_t key, fuse_ino_t ino,
+                           const std::set<uint64_t>& files);
+
     /**
      * @brief
      * Please use it with the lock warmupInodesDequeMutex_
@@ -515,6 +561,14 @@ class WarmupManagerS3Impl : public WarmupManager {
     void PutObjectToCache(
         fuse_ino_t key, const std::shared_ptr<GetObjectAsyncContext>& context);
 
+    void UpdateProgress(fuse_ino_t key,
+                        const std::function<void(WarmupProgress*)>& update);
+
+    // wait until the download of size bytes fits in the budget
+    void AcquireInflight(uint64_t size);
+
+    void ReleaseInflight(uint64_t size);
+
  protected:
     std::deque<WarmupFilelist> warmupFilelistDeque_;
     mutable RWLock warmupFilelistDequeMutex_;
@@ -540,6 +594,13 @@ class WarmupManagerS3Impl : public WarmupManager {
     mutable RWLock inode2FetchS3ObjectsPoolMutex_;
 
     curvefs::client::metric::WarmupManagerS3Metric warmupS3Metric_;
+
+    // the budget of downloading is shared by all the warmup tasks
+    uint64_t maxInflightBytes_;
+    uint64_t inflightBytes_;
+    std::mutex inflightMtx_;
+    std::condition_variable inflightCond_;
+    Throttle downloadThrottle_;
 };
 
 }  // namespace warmup
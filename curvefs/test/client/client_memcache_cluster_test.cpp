@@ -0,0 +1,241 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-28
+ */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "curvefs/src/client/kvclient/kvclient_manager.h"
+#include "curvefs/src/client/kvclient/memcache_client.h"
+#include "curvefs/test/client/fake_memcached_server.h"
+#include "src/common/concurrent/count_down_event.h"
+
+using curve::common::CountDownEvent;
+
+namespace curvefs {
+namespace client {
+
+namespace {
+const int kServerNum = 3;
+const int kKeyNum = 30;
+const uint64_t kValueLen = 64;
+
+std::string Key(int i) { return "key_" + std::to_string(i); }
+
+std::string Value(int i) {
+    std::string value = "value_" + std::to_string(i) + "_";
+    value.resize(kValueLen, 'x');
+    return value;
+}
+}  // namespace
+
+class MemCachedClusterTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        for (int i = 0; i < kServerNum; i++) {
+            servers_.emplace_back(new FakeMemcachedServer());
+            ASSERT_TRUE(servers_.back()->Start());
+        }
+    }
+
+    void TearDown() override {
+        manager_.reset();
+        for (auto& server : servers_) {
+            server->Stop();
+        }
+    }
+
+    void InitManager(const KVClientManagerOpt& opt) {
+        MemcacheClusterInfo info;
+        info.set_clusterid(1);
+        for (auto& server : servers_) {
+            auto* serverInfo = info.add_servers();
+            serverInfo->set_ip("127.0.0.1");
+            serverInfo->set_port(server->GetPort());
+        }
+        client_ = std::make_shared<MemCachedClient>();
+        ASSERT_TRUE(client_->Init(info, "test", opt));
+        ASSERT_EQ(kServerNum, client_->ServerCount());
+        manager_.reset(new KVClientManager());
+        ASSERT_TRUE(manager_->Init(opt, client_, "test"));
+    }
+
+    void SetKeys(int num) {
+        CountDownEvent event(num);
+        std::vector<std::string> values;
+        for (int i = 0; i < num; i++) {
+            values.push_back(Value(i));
+        }
+        for (int i = 0; i < num; i++) {
+            auto task = std::make_shared<SetKVCacheTask>(
+                Key(i), values[i].c_str(), values[i].length(),
+                [&event](const std::shared_ptr<SetKVCacheTask>&) {
+                    event.Signal();
+                });
+            manager_->Set(task);
+        }
+        event.Wait();
+    }
+
+    // the thread local memcached client is bound to the MemCachedClient
+    // first used by the thread, so use the client of each test in a new
+    // thread
+    void InNewThread(const std::function<void()>& fn) {
+        std::thread t(fn);
+        t.join();
+    }
+
+    size_t StoredKeys() {
+        size_t size = 0;
+        for (auto& server : servers_) {
+            size += server->Size();
+        }
+        return size;
+    }
+
+    uint64_t GetCommands() {
+        uint64_t count = 0;
+        for (auto& server : servers_) {
+            count += server->GetCount();
+        }
+        return count;
+    }
+
+    std::vector<std::unique_ptr<FakeMemcachedServer>> servers_;
+    std::shared_ptr<MemCachedClient> client_;
+    std::unique_ptr<KVClientManager> manager_;
+};
+
+TEST_F(MemCachedClusterTest, MGetBatchedPerServer) {
+    KVClientManagerOpt opt;
+    opt.setNoReply = false;
+    InitManager(opt);
+    SetKeys(kKeyNum);
+    ASSERT_EQ(kKeyNum, StoredKeys());
+    // keys are spread over all the servers
+    for (auto& server : servers_) {
+        ASSERT_GT(server->Size(), 0);
+    }
+
+    // one get command for each server
+    std::vector<std::string> keys;
+    for (int i = 0; i <= kKeyNum; i++) {
+        keys.push_back(Key(i));
+    }
+    std::vector<std::vector<char>> bufs(keys.size(),
+                                        std::vector<char>(kValueLen));
+    std::vector<std::shared_ptr<GetKVCacheTask>> tasks;
+    CountDownEvent event(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        tasks.push_back(std::make_shared<GetKVCacheTask>(
+            keys[i], bufs[i].data(), 0, kValueLen,
+            [&event](const std::shared_ptr<GetKVCacheTask>&) {
+                event.Signal();
+            }));
+    }
+    uint64_t getCommands = GetCommands();
+    manager_->MGet(tasks);
+    event.Wait();
+    ASSERT_EQ(getCommands + kServerNum, GetCommands());
+
+    for (int i = 0; i < kKeyNum; i++) {
+        ASSERT_TRUE(tasks[i]->res);
+        ASSERT_EQ(kValueLen, tasks[i]->length);
+        ASSERT_EQ(Value(i), std::string(bufs[i].data(), kValueLen));
+    }
+    // Key(kKeyNum) is not set
+    ASSERT_FALSE(tasks[kKeyNum]->res);
+    ASSERT_EQ(kKeyNum, manager_->GetMetricForTesting()->hit.get_value());
+    ASSERT_EQ(1, manager_->GetMetricForTesting()->miss.get_value());
+}
+
+TEST_F(MemCachedClusterTest, PipelinedSet) {
+    KVClientManagerOpt opt;
+    opt.setNoReply = true;
+    InitManager(opt);
+    SetKeys(kKeyNum);
+
+    // sets are not acknowledged, wait for the servers to apply them
+    int retry = 0;
+    while (StoredKeys() < kKeyNum && retry++ < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(kKeyNum, StoredKeys());
+
+    InNewThread([this]() {
+        std::string errorlog;
+        for (int i = 0; i < kKeyNum; i++) {
+            std::vector<char> buf(kValueLen);
+            ASSERT_TRUE(client_->Get(Key(i), buf.data(), 0, kValueLen,
+                                     &errorlog, nullptr, nullptr));
+            ASSERT_EQ(Value(i), std::string(buf.data(), kValueLen));
+        }
+    });
+}
+
+TEST_F(MemCachedClusterTest, FailedServerEjected) {
+    KVClientManagerOpt opt;
+    opt.setNoReply = false;
+    opt.serverFailureLimit = 1;
+    opt.serverRetryTimeoutSec = 60;
+    InitManager(opt);
+
+    servers_[0]->Stop();
+    // the keys of the failed server are remapped to the others once it is
+    // ejected, only the first requests to it fail
+    InNewThread([this]() {
+        std::string errorlog;
+        for (int i = 0; i < kKeyNum; i++) {
+            std::string value = Value(i);
+            bool ok = false;
+            for (int retry = 0; retry < 3 && !ok; retry++) {
+                ok = client_->Set(Key(i), value.c_str(), value.length(),
+                                  &errorlog);
+            }
+            ASSERT_TRUE(ok) << errorlog;
+        }
+    });
+    ASSERT_EQ(0, servers_[0]->Size());
+    ASSERT_EQ(kKeyNum, StoredKeys());
+
+    InNewThread([this]() {
+        std::vector<KVGetRequest> requests;
+        std::vector<std::vector<char>> bufs(kKeyNum,
+                                            std::vector<char>(kValueLen));
+        for (int i = 0; i < kKeyNum; i++) {
+            requests.emplace_back(Key(i), bufs[i].data(), 0, kValueLen);
+        }
+        client_->MGet(&requests);
+        for (int i = 0; i < kKeyNum; i++) {
+            ASSERT_TRUE(requests[i].res) << Key(i);
+            ASSERT_EQ(Value(i), std::string(bufs[i].data(), kValueLen));
+        }
+    });
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -153,14 +153,18 @@ TEST_F(DataCacheTest, test_write6) {
 
 TEST_F(DataCacheTest, test_truncate1) {
     uint64_t size = 0;
+    auto pageArena = s3ClientAdaptor_->GetPageArena();
+    ASSERT_EQ(16, pageArena->GetUsedPages());
     dataCache_->Truncate(size);
     ASSERT_EQ(0, dataCache_->GetLen());
+    ASSERT_EQ(0, pageArena->GetUsedPages());
 }
 
 TEST_F(DataCacheTest, test_truncate2) {
     uint64_t size = 512 * 1024;
     dataCache_->Truncate(size);
     ASSERT_EQ(512 * 1024, dataCache_->GetLen());
+    ASSERT_EQ(8, s3ClientAdaptor_->GetPageArena()->GetUsedPages());
 }
 
 TEST_F(DataCacheTest, test_truncate3) {
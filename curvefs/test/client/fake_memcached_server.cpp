@@ -0,0 +1,229 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-28
+ */
+
+#include "curvefs/test/client/fake_memcached_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <sstream>
+
+namespace curvefs {
+namespace client {
+
+bool FakeMemcachedServer::Start(uint16_t port) {
+    if (running_) {
+        return true;
+    }
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        return false;
+    }
+    int on = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t len = sizeof(addr);
+    if (bind(listenFd_, reinterpret_cast<struct sockaddr*>(&addr), len) != 0 ||
+        listen(listenFd_, 128) != 0 ||
+        getsockname(listenFd_, reinterpret_cast<struct sockaddr*>(&addr),
+                    &len) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    port_ = ntohs(addr.sin_port);
+    running_ = true;
+    acceptThread_ = std::thread(&FakeMemcachedServer::AcceptLoop, this);
+    return true;
+}
+
+void FakeMemcachedServer::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    shutdown(listenFd_, SHUT_RDWR);
+    acceptThread_.join();
+    close(listenFd_);
+    listenFd_ = -1;
+
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lk(connMtx_);
+        for (int fd : connFds_) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        threads.swap(connThreads_);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+size_t FakeMemcachedServer::Size() {
+    std::lock_guard<std::mutex> lk(dataMtx_);
+    return data_.size();
+}
+
+void FakeMemcachedServer::AcceptLoop() {
+    while (running_) {
+        int fd = accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lk(connMtx_);
+        if (!running_) {
+            close(fd);
+            break;
+        }
+        connFds_.insert(fd);
+        connThreads_.emplace_back(&FakeMemcachedServer::Serve, this, fd);
+    }
+}
+
+void FakeMemcachedServer::Serve(int fd) {
+    std::string in;
+    char buf[64 * 1024];
+    bool quit = false;
+    while (!quit) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        in.append(buf, n);
+        int ret;
+        while ((ret = HandleCommand(fd, &in)) > 0) {}
+        quit = (ret < 0);
+    }
+
+    std::lock_guard<std::mutex> lk(connMtx_);
+    connFds_.erase(fd);
+    close(fd);
+}
+
+int FakeMemcachedServer::HandleCommand(int fd, std::string* in) {
+    size_t pos = in->find("\r\n");
+    if (pos == std::string::npos) {
+        return 0;
+    }
+    std::vector<std::string> tokens;
+    std::istringstream line(in->substr(0, pos));
+    std::string token;
+    while (line >> token) {
+        tokens.push_back(token);
+    }
+    size_t consumed = pos + 2;
+    if (tokens.empty()) {
+        in->erase(0, consumed);
+        return 1;
+    }
+
+    const std::string& cmd = tokens[0];
+    std::string out;
+    if (cmd == "get" || cmd == "gets") {
+        getCount_++;
+        getKeyCount_ += tokens.size() - 1;
+        std::lock_guard<std::mutex> lk(dataMtx_);
+        for (size_t i = 1; i < tokens.size(); i++) {
+            auto iter = data_.find(tokens[i]);
+            if (iter == data_.end()) {
+                continue;
+            }
+            out += "VALUE " + tokens[i] + " 0 " +
+                   std::to_string(iter->second.size());
+            if (cmd == "gets") {
+                out += " 1";
+            }
+            out += "\r\n" + iter->second + "\r\n";
+        }
+        out += "END\r\n";
+    } else if (cmd == "set" || cmd == "add" || cmd == "replace") {
+        if (tokens.size() < 5) {
+            in->erase(0, consumed);
+            return WriteAll(fd, "ERROR\r\n") ? 1 : -1;
+        }
+        size_t bytes = std::strtoull(tokens[4].c_str(), nullptr, 10);
+        if (in->size() < consumed + bytes + 2) {
+            return 0;
+        }
+        bool noreply = tokens.size() > 5 && tokens[5] == "noreply";
+        bool stored = true;
+        {
+            std::lock_guard<std::mutex> lk(dataMtx_);
+            bool exist = data_.count(tokens[1]) > 0;
+            if ((cmd == "add" && exist) || (cmd == "replace" && !exist)) {
+                stored = false;
+            } else {
+                data_[tokens[1]] = in->substr(consumed, bytes);
+            }
+        }
+        setCount_++;
+        consumed += bytes + 2;
+        if (!noreply) {
+            out = stored ? "STORED\r\n" : "NOT_STORED\r\n";
+        }
+    } else if (cmd == "delete" && tokens.size() >= 2) {
+        bool noreply = tokens.back() == "noreply";
+        size_t erased;
+        {
+            std::lock_guard<std::mutex> lk(dataMtx_);
+            erased = data_.erase(tokens[1]);
+        }
+        if (!noreply) {
+            out = erased > 0 ? "DELETED\r\n" : "NOT_FOUND\r\n";
+        }
+    } else if (cmd == "version") {
+        out = "VERSION 1.6.21\r\n";
+    } else if (cmd == "quit") {
+        in->erase(0, consumed);
+        return -1;
+    } else {
+        out = "ERROR\r\n";
+    }
+
+    in->erase(0, consumed);
+    if (!out.empty() && !WriteAll(fd, out)) {
+        return -1;
+    }
+    return 1;
+}
+
+bool FakeMemcachedServer::WriteAll(int fd, const std::string& out) {
+    size_t written = 0;
+    while (written < out.size()) {
+        ssize_t n = send(fd, out.data() + written, out.size() - written,
+                         MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+}  // namespace client
+}  // namespace curvefs
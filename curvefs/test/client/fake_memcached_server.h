@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-28
+ */
+
+#ifndef CURVEFS_TEST_CLIENT_FAKE_MEMCACHED_SERVER_H_
+#define CURVEFS_TEST_CLIENT_FAKE_MEMCACHED_SERVER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace curvefs {
+namespace client {
+
+/**
+ * An in-process stand-in of memcached for tests. It speaks the ascii
+ * protocol commands used by libmemcached: get/gets, set/add/replace
+ * (with noreply), delete, version and quit.
+ *
+ * FakeMemcachedServer server;
+ * ASSERT_TRUE(server.Start());
+ * client->AddServer("127.0.0.1", server.GetPort());
+ */
+class FakeMemcachedServer {
+ public:
+    FakeMemcachedServer()
+        : listenFd_(-1),
+          port_(0),
+          running_(false),
+          getCount_(0),
+          getKeyCount_(0),
+          setCount_(0) {}
+
+    ~FakeMemcachedServer() { Stop(); }
+
+    // listen on 127.0.0.1:port, 0 means a random free port
+    bool Start(uint16_t port = 0);
+
+    // close the listen socket and all the connections, the stored
+    // values are kept, so the server can be started again
+    void Stop();
+
+    uint16_t GetPort() const { return port_; }
+
+    // number of stored keys
+    size_t Size();
+
+    // number of get commands received, a multi-get is one command
+    uint64_t GetCount() const { return getCount_.load(); }
+
+    // number of keys asked by get commands
+    uint64_t GetKeyCount() const { return getKeyCount_.load(); }
+
+    // number of storage commands received
+    uint64_t SetCount() const { return setCount_.load(); }
+
+ private:
+    void AcceptLoop();
+
+    void Serve(int fd);
+
+    // handle the first command in `in`,
+    // return 1 if handled, 0 if more data is needed, -1 to close
+    int HandleCommand(int fd, std::string* in);
+
+    static bool WriteAll(int fd, const std::string& out);
+
+ private:
+    int listenFd_;
+    uint16_t port_;
+    std::atomic<bool> running_;
+    std::thread acceptThread_;
+
+    std::mutex connMtx_;
+    std::unordered_set<int> connFds_;
+    std::vector<std::thread> connThreads_;
+
+    std::mutex dataMtx_;
+    std::unordered_map<std::string, std::string> data_;
+
+    std::atomic<uint64_t> getCount_;
+    std::atomic<uint64_t> getKeyCount_;
+    std::atomic<uint64_t> setCount_;
+};
+
+}  // namespace client
+}  // namespace curvefs
+
+#endif  // CURVEFS_TEST_CLIENT_FAKE_MEMCACHED_SERVER_H_
@@ -158,6 +158,59 @@ TEST_F(FsCacheManagerTest, test_lru_set_and_delete) {
     }
 }
 
+TEST_F(FsCacheManagerTest, test_lru_clock_second_chance) {
+    uint64_t dataCacheByte = 4ull * 1024 * 1024;  // 4MiB
+    std::vector<char> buf(dataCacheByte);
+    std::vector<DataCachePtr> dataCaches;
+    std::vector<std::list<DataCachePtr>::iterator> iters;
+
+    for (size_t i = 0; i < maxReadCacheByte_ / dataCacheByte; ++i) {
+        std::list<DataCachePtr>::iterator outIter;
+        dataCaches.push_back(std::make_shared<DataCache>(
+            s3ClientAdaptor_, mockChunkCacheManager_, 0, dataCacheByte,
+            buf.data(), nullptr));
+        ASSERT_TRUE(fsCacheManager_->Set(dataCaches.back(), &outIter));
+        iters.push_back(outIter);
+    }
+    ASSERT_EQ(maxReadCacheByte_, fsCacheManager_->GetLruByte());
+
+    // the oldest data cache is hit, so the next one is evicted instead
+    fsCacheManager_->Get(iters[0]);
+
+    curve::common::CountDownEvent counter(1);
+    EXPECT_CALL(*mockChunkCacheManager_, ReleaseReadDataCache(_))
+        .Times(1)
+        .WillOnce(Invoke([&counter](uint64_t) { counter.Signal(); }));
+    std::list<DataCachePtr>::iterator outIter;
+    ASSERT_TRUE(fsCacheManager_->Set(
+        std::make_shared<DataCache>(s3ClientAdaptor_, mockChunkCacheManager_,
+                                    0, dataCacheByte, buf.data(), nullptr),
+        &outIter));
+    counter.Wait();
+
+    ASSERT_TRUE(dataCaches[0]->InReadCache());
+    ASSERT_FALSE(dataCaches[1]->InReadCache());
+    ASSERT_TRUE(dataCaches[2]->InReadCache());
+    ASSERT_TRUE(dataCaches[3]->InReadCache());
+    ASSERT_EQ(maxReadCacheByte_, fsCacheManager_->GetLruByte());
+}
+
+TEST_F(FsCacheManagerTest, test_fsSync_all_shards) {
+    const uint64_t inodeNum = 256;
+    for (uint64_t inodeId = 0; inodeId < inodeNum; inodeId++) {
+        auto fileCache = std::make_shared<MockFileCacheManager>();
+        EXPECT_CALL(*fileCache, Flush(_, _))
+            .WillOnce(Return(CURVEFS_ERROR::OK));
+        fsCacheManager_->SetFileCacheManagerForTest(inodeId, fileCache);
+    }
+
+    ASSERT_EQ(CURVEFS_ERROR::OK, fsCacheManager_->FsSync(true));
+    // the empty file cache managers are released after sync
+    for (uint64_t inodeId = 0; inodeId < inodeNum; inodeId++) {
+        ASSERT_EQ(nullptr, fsCacheManager_->FindFileCacheManager(inodeId));
+    }
+}
+
 TEST_F(FsCacheManagerTest, test_fsSync_ok) {
     uint64_t inodeId = 1;
     auto fileCache = std::make_shared<MockFileCacheManager>();
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-21
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "curvefs/src/client/s3/page_arena.h"
+
+namespace curvefs {
+namespace client {
+
+const uint32_t kPageSize = 64 * 1024;
+const uint64_t kSlabSize = 2 * 1024 * 1024;
+
+TEST(PageArenaTest, AllocateAndFree) {
+    PageArena arena(kPageSize, kSlabSize);
+    ASSERT_EQ(32, arena.GetPagesPerSlab());
+
+    std::set<char *> pages;
+    for (int i = 0; i < 40; i++) {
+        char *page = arena.Allocate();
+        ASSERT_NE(nullptr, page);
+        memset(page, i, kPageSize);
+        ASSERT_TRUE(pages.emplace(page).second);
+    }
+    ASSERT_EQ(40, arena.GetUsedPages());
+    ASSERT_EQ(2, arena.GetSlabNum());
+    ASSERT_EQ(64, arena.GetTotalPages());
+
+    // pages never overlap
+    char *prev = nullptr;
+    for (char *page : pages) {
+        if (prev != nullptr) {
+            ASSERT_GE(page - prev, kPageSize);
+        }
+        prev = page;
+    }
+
+    for (char *page : pages) {
+        arena.Free(page);
+    }
+    ASSERT_EQ(0, arena.GetUsedPages());
+    // one empty slab is kept for reuse
+    ASSERT_EQ(1, arena.GetSlabNum());
+    ASSERT_EQ(32, arena.GetTotalPages());
+}
+
+TEST(PageArenaTest, ReuseLowestSlab) {
+    PageArena arena(kPageSize, kSlabSize);
+    std::vector<char *> pages;
+    for (int i = 0; i < 96; i++) {
+        pages.push_back(arena.Allocate());
+    }
+    ASSERT_EQ(3, arena.GetSlabNum());
+
+    // free one page from every slab, new pages come from the lowest slab
+    char *lowest = nullptr;
+    for (int i = 0; i < 96; i += 32) {
+        if (lowest == nullptr || pages[i] < lowest) {
+            lowest = pages[i];
+        }
+        arena.Free(pages[i]);
+    }
+    ASSERT_EQ(lowest, arena.Allocate());
+}
+
+TEST(PageArenaTest, ReleaseEmptySlab) {
+    PageArena arena(kPageSize, kSlabSize);
+    std::vector<char *> pages;
+    for (int i = 0; i < 96; i++) {
+        pages.push_back(arena.Allocate());
+    }
+    ASSERT_EQ(3, arena.GetSlabNum());
+
+    for (auto page : pages) {
+        arena.Free(page);
+    }
+    ASSERT_EQ(1, arena.GetSlabNum());
+
+    // allocate again from the cached slab without mapping new one
+    char *page = arena.Allocate();
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(1, arena.GetSlabNum());
+    arena.Free(page);
+}
+
+TEST(PageArenaTest, SlabSmallerThanPage) {
+    PageArena arena(kPageSize, 4096);
+    ASSERT_EQ(1, arena.GetPagesPerSlab());
+    char *page1 = arena.Allocate();
+    char *page2 = arena.Allocate();
+    ASSERT_NE(page1, page2);
+    ASSERT_EQ(2, arena.GetSlabNum());
+    arena.Free(page1);
+    arena.Free(page2);
+    ASSERT_EQ(1, arena.GetSlabNum());
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,253 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-26
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "curvefs/src/client/s3/read_single_flight.h"
+#include "curvefs/test/client/mock_client_s3.h"
+
+namespace curvefs {
+namespace client {
+
+using ::testing::_;
+using ::testing::Invoke;
+
+namespace {
+const uint64_t kMiB = 1024 * 1024;
+
+char DataAt(uint64_t pos) {
+    return static_cast<char>(pos % 251);
+}
+
+bool CheckData(const std::vector<char> &buf, uint64_t offset) {
+    for (uint64_t i = 0; i < buf.size(); i++) {
+        if (buf[i] != DataAt(offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+class S3ReadSingleFlightTest : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        client_ = std::make_shared<MockS3Client>();
+        singleFlight_ = std::make_shared<S3ReadSingleFlight>(client_);
+    }
+
+    // download blocks until gate is set
+    void BlockDownload(std::shared_future<void> gate, int ret = 0) {
+        EXPECT_CALL(*client_, Download(_, _, _, _))
+            .WillRepeatedly(Invoke([gate, ret](const std::string &name,
+                                               char *buf, uint64_t offset,
+                                               uint64_t length) {
+                gate.wait();
+                for (uint64_t i = 0; i < length; i++) {
+                    buf[i] = DataAt(offset + i);
+                }
+                return ret;
+            }));
+    }
+
+    // only the downloads at blockedOffsets block until gate is set, all
+    // downloads are recorded
+    void BlockDownloadAt(std::shared_future<void> gate,
+                         std::set<uint64_t> blockedOffsets) {
+        EXPECT_CALL(*client_, Download(_, _, _, _))
+            .WillRepeatedly(Invoke([this, gate, blockedOffsets](
+                                       const std::string &name, char *buf,
+                                       uint64_t offset, uint64_t length) {
+                {
+                    std::lock_guard<std::mutex> lk(mtx_);
+                    downloads_.emplace_back(offset, length);
+                }
+                if (blockedOffsets.count(offset) != 0) {
+                    gate.wait();
+                }
+                for (uint64_t i = 0; i < length; i++) {
+                    buf[i] = DataAt(offset + i);
+                }
+                return 0;
+            }));
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> GetDownloads() {
+        std::lock_guard<std::mutex> lk(mtx_);
+        auto downloads = downloads_;
+        std::sort(downloads.begin(), downloads.end());
+        return downloads;
+    }
+
+    std::thread AsyncRead(const std::string &name, uint64_t offset,
+                          uint64_t length, int expectRet = 0) {
+        return std::thread([=]() {
+            std::vector<char> buf(length);
+            ASSERT_EQ(expectRet, singleFlight_->Read(name, buf.data(), offset,
+                                                     length));
+            if (expectRet >= 0) {
+                ASSERT_TRUE(CheckData(buf, offset));
+            }
+        });
+    }
+
+    void WaitMerged(uint64_t count) {
+        while (singleFlight_->GetMergedCount() < count) {
+            usleep(1000);
+        }
+    }
+
+    std::shared_ptr<MockS3Client> client_;
+    std::shared_ptr<S3ReadSingleFlight> singleFlight_;
+    std::mutex mtx_;
+    std::vector<std::pair<uint64_t, uint64_t>> downloads_;
+};
+
+TEST_F(S3ReadSingleFlightTest, SingleRead) {
+    std::promise<void> gate;
+    gate.set_value();
+    BlockDownload(gate.get_future().share());
+
+    std::vector<char> buf(4096);
+    bool merged = true;
+    ASSERT_EQ(0, singleFlight_->Read("obj", buf.data(), 100, 4096, &merged));
+    ASSERT_FALSE(merged);
+    ASSERT_TRUE(CheckData(buf, 100));
+    ASSERT_EQ(1, singleFlight_->GetIssuedCount());
+    ASSERT_EQ(0, singleFlight_->GetMergedCount());
+}
+
+TEST_F(S3ReadSingleFlightTest, CoveredReadsShareGet) {
+    std::promise<void> gate;
+    BlockDownload(gate.get_future().share());
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(AsyncRead("obj", 0, 4 * kMiB));
+    while (singleFlight_->GetIssuedCount() < 1) {
+        usleep(1000);
+    }
+    threads.emplace_back(AsyncRead("obj", 0, 4 * kMiB));
+    threads.emplace_back(AsyncRead("obj", kMiB, 128 * 1024));
+    threads.emplace_back(AsyncRead("obj", 3 * kMiB, kMiB));
+    WaitMerged(3);
+    gate.set_value();
+    for (auto &t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(1, singleFlight_->GetIssuedCount());
+
+    // different objects are not merged
+    threads.clear();
+    threads.emplace_back(AsyncRead("obj1", 0, kMiB));
+    threads.emplace_back(AsyncRead("obj2", 0, kMiB));
+    for (auto &t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(3, singleFlight_->GetIssuedCount());
+    ASSERT_EQ(3, singleFlight_->GetMergedCount());
+}
+
+TEST_F(S3ReadSingleFlightTest, AdjacentReadsNotBlocked) {
+    std::promise<void> gate;
+    BlockDownloadAt(gate.get_future().share(), {0});
+
+    auto blocked = AsyncRead("obj", 0, kMiB);
+    while (singleFlight_->GetIssuedCount() < 1) {
+        usleep(1000);
+    }
+    // adjacent reads don't wait for the GET of [0, 1M)
+    bool merged = true;
+    std::vector<char> buf(kMiB);
+    ASSERT_EQ(0, singleFlight_->Read("obj", buf.data(), kMiB, kMiB, &merged));
+    ASSERT_FALSE(merged);
+    ASSERT_TRUE(CheckData(buf, kMiB));
+
+    gate.set_value();
+    blocked.join();
+    ASSERT_EQ(2, singleFlight_->GetIssuedCount());
+    ASSERT_EQ(0, singleFlight_->GetMergedCount());
+}
+
+TEST_F(S3ReadSingleFlightTest, OverlappedReadsFetchOnlyMissingPart) {
+    std::promise<void> gate;
+    BlockDownloadAt(gate.get_future().share(), {kMiB, 3 * kMiB});
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(AsyncRead("obj", kMiB, 2 * kMiB));
+    while (singleFlight_->GetIssuedCount() < 1) {
+        usleep(1000);
+    }
+    // joins [1M, 3M) and fetches [3M, 4M)
+    threads.emplace_back(AsyncRead("obj", 2 * kMiB, 2 * kMiB));
+    while (singleFlight_->GetIssuedCount() < 2) {
+        usleep(1000);
+    }
+    // joins [1M, 3M) and [3M, 4M), fetches [0, 1M) and [4M, 5M) without
+    // waiting for the joined GETs
+    threads.emplace_back(AsyncRead("obj", 0, 5 * kMiB));
+    while (singleFlight_->GetIssuedCount() < 4) {
+        usleep(1000);
+    }
+    ASSERT_EQ(2, singleFlight_->GetMergedCount());
+
+    gate.set_value();
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> expected{
+        {0, kMiB}, {kMiB, 2 * kMiB}, {3 * kMiB, kMiB}, {4 * kMiB, kMiB}};
+    ASSERT_EQ(expected, GetDownloads());
+    ASSERT_EQ(4, singleFlight_->GetIssuedCount());
+}
+
+TEST_F(S3ReadSingleFlightTest, ErrorPropagatedToAllReaders) {
+    std::promise<void> gate;
+    BlockDownload(gate.get_future().share(), -2);
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(AsyncRead("obj", 0, kMiB, -2));
+    while (singleFlight_->GetIssuedCount() < 1) {
+        usleep(1000);
+    }
+    threads.emplace_back(AsyncRead("obj", 4096, 4096, -2));
+    WaitMerged(1);
+    gate.set_value();
+    for (auto &t : threads) {
+        t.join();
+    }
+    ASSERT_EQ(1, singleFlight_->GetIssuedCount());
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-25
+ */
+
+#include <gtest/gtest.h>
+
+#include "curvefs/src/client/s3/readahead.h"
+
+namespace curvefs {
+namespace client {
+
+const uint64_t kReadSize = 128 * 1024;
+const uint64_t kMiB = 1024 * 1024;
+
+TEST(ReadaheadDetectorTest, Sequential) {
+    ReadaheadDetector detector;
+    ASSERT_EQ(AccessPattern::kUnknown, detector.GetPattern());
+    // first miss uses the min window
+    detector.OnRead(0, kReadSize);
+    ASSERT_EQ(1, detector.NextWindow(1, 8));
+
+    for (uint64_t off = kReadSize; off < 64 * kReadSize; off += kReadSize) {
+        detector.OnRead(off, kReadSize);
+    }
+    ASSERT_EQ(AccessPattern::kSequential, detector.GetPattern());
+    ASSERT_EQ(2, detector.NextWindow(1, 8));
+    ASSERT_EQ(4, detector.NextWindow(1, 8));
+    ASSERT_EQ(8, detector.NextWindow(1, 8));
+    ASSERT_EQ(8, detector.NextWindow(1, 8));
+
+    // reads reordered by concurrent fuse requests are still sequential
+    detector.OnRead(66 * kReadSize, kReadSize);
+    detector.OnRead(64 * kReadSize, kReadSize);
+    detector.OnRead(65 * kReadSize, kReadSize);
+    ASSERT_EQ(AccessPattern::kSequential, detector.GetPattern());
+
+    // a single far away read does not break the stream
+    detector.OnRead(1024 * kMiB, kReadSize);
+    ASSERT_EQ(AccessPattern::kSequential, detector.GetPattern());
+    detector.OnRead(67 * kReadSize, kReadSize);
+    ASSERT_EQ(AccessPattern::kSequential, detector.GetPattern());
+    ASSERT_EQ(8, detector.NextWindow(1, 8));
+}
+
+TEST(ReadaheadDetectorTest, Strided) {
+    ReadaheadDetector detector;
+    for (int i = 0; i < 8; i++) {
+        detector.OnRead(i * 16 * kMiB, kReadSize);
+    }
+    ASSERT_EQ(AccessPattern::kStrided, detector.GetPattern());
+    ASSERT_EQ(16 * kMiB, detector.GetStride());
+    ASSERT_EQ(2, detector.NextWindow(2, 4));
+    ASSERT_EQ(4, detector.NextWindow(2, 4));
+
+    // backward strides
+    ReadaheadDetector backward;
+    for (int i = 8; i > 0; i--) {
+        backward.OnRead(i * 16 * kMiB, kReadSize);
+    }
+    ASSERT_EQ(AccessPattern::kStrided, backward.GetPattern());
+    ASSERT_EQ(-16 * static_cast<int64_t>(kMiB), backward.GetStride());
+}
+
+TEST(ReadaheadDetectorTest, RandomShrinksWindow) {
+    ReadaheadDetector detector;
+    detector.OnRead(0, kReadSize);
+    detector.OnRead(kReadSize, kReadSize);
+    ASSERT_EQ(1, detector.NextWindow(1, 8));
+    ASSERT_EQ(2, detector.NextWindow(1, 8));
+    ASSERT_EQ(4, detector.NextWindow(1, 8));
+
+    const uint64_t offsets[] = {900, 30, 512, 7, 260, 77};
+    for (auto off : offsets) {
+        detector.OnRead(off * kMiB, kReadSize);
+    }
+    ASSERT_EQ(AccessPattern::kRandom, detector.GetPattern());
+    ASSERT_EQ(2, detector.NextWindow(1, 8));
+    ASSERT_EQ(1, detector.NextWindow(1, 8));
+    ASSERT_EQ(0, detector.NextWindow(1, 8));
+    ASSERT_EQ(0, detector.NextWindow(1, 8));
+
+    // sequential again, the window restarts from the min window
+    detector.OnRead(78 * kMiB, kReadSize);
+    detector.OnRead(78 * kMiB + kReadSize, kReadSize);
+    ASSERT_EQ(AccessPattern::kSequential, detector.GetPattern());
+    ASSERT_EQ(1, detector.NextWindow(1, 8));
+    ASSERT_EQ(2, detector.NextWindow(1, 8));
+}
+
+}  // namespace client
+}  // namespace curvefs
@@ -80,37 +80,94 @@ TEST_F(TestDiskCacheRead, ReadDiskFile) {
     ASSERT_EQ(-1, ret);
 
     EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, lseek(_, _, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*wrapper_, pread(_, _, length, length)).WillOnce(Return(-1));
     EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
     ret = diskCacheRead_->ReadDiskFile(
         fileName, const_cast<char *>(fileName.c_str()), length, length);
     ASSERT_EQ(-1, ret);
 
     EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, lseek(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, read(_, _, _)).WillOnce(Return(-1));
-    EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
-    ret = diskCacheRead_->ReadDiskFile(
-        fileName, const_cast<char *>(fileName.c_str()), length, length);
-    ASSERT_EQ(-1, ret);
-
-    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, lseek(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, read(_, _, _)).WillOnce(Return(length - 1));
+    EXPECT_CALL(*wrapper_, pread(_, _, _, _)).WillOnce(Return(length - 1));
     EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
     ret = diskCacheRead_->ReadDiskFile(
         fileName, const_cast<char *>(fileName.c_str()), length, length);
     ASSERT_EQ(length - 1, ret);
 
     EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, lseek(_, _, _)).WillOnce(Return(0));
-    EXPECT_CALL(*wrapper_, read(_, _, _)).WillOnce(Return(length));
+    EXPECT_CALL(*wrapper_, pread(_, _, _, _)).WillOnce(Return(length));
     EXPECT_CALL(*wrapper_, close(_)).WillOnce(Return(0));
     ret = diskCacheRead_->ReadDiskFile(
         fileName, const_cast<char *>(fileName.c_str()), length, length);
     ASSERT_EQ(length, ret);
 }
 
+TEST_F(TestDiskCacheRead, ReadDiskFileWithFdCache) {
+    diskCacheRead_->InitFdCache(1);
+    std::string fileName = "test";
+    uint64_t length = 10;
+    char buf[10];
+
+    struct stat fileStat;
+    memset(&fileStat, 0, sizeof(fileStat));
+    fileStat.st_ino = 100;
+    EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(fileStat), Return(0)));
+    EXPECT_CALL(*wrapper_, fstat(_, NotNull()))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(fileStat), Return(0)));
+
+    // open once, the fd is reused by later reads
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(3));
+    EXPECT_CALL(*wrapper_, pread(3, _, length, _))
+        .Times(2)
+        .WillRepeatedly(Return(length));
+    ASSERT_EQ(length, diskCacheRead_->ReadDiskFile(fileName, buf, 0, length));
+    ASSERT_EQ(length, diskCacheRead_->ReadDiskFile(fileName, buf, 0, length));
+    Mock::VerifyAndClearExpectations(wrapper_.get());
+
+    // the least recently used fd is closed when the cache is full
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(4));
+    EXPECT_CALL(*wrapper_, pread(4, _, length, _)).WillOnce(Return(length));
+    EXPECT_CALL(*wrapper_, close(3)).WillOnce(Return(0));
+    ASSERT_EQ(length, diskCacheRead_->ReadDiskFile("test2", buf, 0, length));
+    Mock::VerifyAndClearExpectations(wrapper_.get());
+
+    // released after the file is removed
+    EXPECT_CALL(*wrapper_, close(4)).WillOnce(Return(0));
+    diskCacheRead_->ReleaseFd("test2");
+    Mock::VerifyAndClearExpectations(wrapper_.get());
+
+    // fd is closed if read fails
+    EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(fileStat), Return(0)));
+    EXPECT_CALL(*wrapper_, fstat(_, NotNull()))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(fileStat), Return(0)));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(5));
+    EXPECT_CALL(*wrapper_, pread(5, _, length, _)).WillOnce(Return(-1));
+    EXPECT_CALL(*wrapper_, close(5)).WillOnce(Return(0));
+    ASSERT_EQ(-1, diskCacheRead_->ReadDiskFile(fileName, buf, 0, length));
+    Mock::VerifyAndClearExpectations(wrapper_.get());
+
+    // the file is removed after it is opened, the fd is not cached
+    EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull())).WillOnce(Return(-1));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(6));
+    EXPECT_CALL(*wrapper_, pread(6, _, length, _)).WillOnce(Return(length));
+    EXPECT_CALL(*wrapper_, close(6)).WillOnce(Return(0));
+    ASSERT_EQ(length, diskCacheRead_->ReadDiskFile(fileName, buf, 0, length));
+    Mock::VerifyAndClearExpectations(wrapper_.get());
+
+    // the file is removed and created again after it is opened
+    struct stat newFileStat = fileStat;
+    newFileStat.st_ino = 101;
+    EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
+        .WillOnce(DoAll(SetArgPointee<1>(newFileStat), Return(0)));
+    EXPECT_CALL(*wrapper_, fstat(7, NotNull()))
+        .WillOnce(DoAll(SetArgPointee<1>(fileStat), Return(0)));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillOnce(Return(7));
+    EXPECT_CALL(*wrapper_, pread(7, _, length, _)).WillOnce(Return(length));
+    EXPECT_CALL(*wrapper_, close(7)).WillOnce(Return(0));
+    ASSERT_EQ(length, diskCacheRead_->ReadDiskFile(fileName, buf, 0, length));
+}
+
 TEST_F(TestDiskCacheRead, LinkWriteToRead) {
     EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull())).WillOnce(Return(-1));
     std::string fileName = "test";
@@ -0,0 +1,319 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-22
+ */
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "curvefs/src/client/s3/disk_cache_segment_store.h"
+
+namespace curvefs {
+namespace client {
+
+namespace {
+const uint64_t kSegmentSize = 64 * 1024;
+const uint32_t kSegmentNum = 4;
+const uint64_t kObjectSize = 12 * 1024;
+}  // namespace
+
+class TestDiskCacheSegmentStore : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/segment_store_test_XXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(tmpl));
+        dir_ = tmpl;
+        wrapper_ = std::make_shared<PosixWrapper>();
+        option_.enable = true;
+        option_.segmentSize = kSegmentSize;
+        option_.segmentNum = kSegmentNum;
+        option_.checkpointIntervalSec = 3600;
+        option_.directIo = false;
+        option_.compactRatio = 50;
+    }
+
+    void TearDown() override {
+        std::string cmd = "rm -rf " + dir_;
+        ASSERT_EQ(0, system(cmd.c_str()));
+    }
+
+    std::shared_ptr<DiskCacheSegmentStore> NewStore() {
+        auto store = std::make_shared<DiskCacheSegmentStore>(wrapper_, option_);
+        EXPECT_EQ(0, store->Init(dir_ + "/cachesegment"));
+        store->SetEvictCallback(
+            [this](const std::string &name, uint64_t length) {
+                evicted_[name] = length;
+            });
+        return store;
+    }
+
+    static std::string MakeData(char c) {
+        return std::string(kObjectSize, c);
+    }
+
+    static void CheckRead(DiskCacheSegmentStore *store,
+                          const std::string &name, const std::string &data) {
+        std::string buf(data.size(), '\0');
+        ASSERT_EQ(data.size(), store->Read(name, &buf[0], 0, data.size()));
+        ASSERT_EQ(data, buf);
+    }
+
+    std::string dir_;
+    std::shared_ptr<PosixWrapper> wrapper_;
+    DiskCacheSegmentOption option_;
+    std::map<std::string, uint64_t> evicted_;
+};
+
+TEST_F(TestDiskCacheSegmentStore, WriteAndRead) {
+    auto store = NewStore();
+    std::string data = MakeData('a');
+    data[100] = 'b';
+    ASSERT_EQ(kObjectSize, store->Write("obj_1", data.data(), data.size()));
+    ASSERT_TRUE(store->IsCached("obj_1"));
+    ASSERT_FALSE(store->IsCached("obj_2"));
+    CheckRead(store.get(), "obj_1", data);
+
+    // unaligned partial read
+    char buf[10];
+    ASSERT_EQ(10, store->Read("obj_1", buf, 95, 10));
+    ASSERT_EQ(data.substr(95, 10), std::string(buf, 10));
+
+    // read beyond object or missing object
+    ASSERT_GT(0, store->Read("obj_1", buf, kObjectSize - 5, 10));
+    ASSERT_GT(0, store->Read("obj_2", buf, 0, 10));
+
+    // overwrite replaces the old version
+    std::string data2 = MakeData('c');
+    ASSERT_EQ(kObjectSize, store->Write("obj_1", data2.data(), data2.size()));
+    CheckRead(store.get(), "obj_1", data2);
+    ASSERT_EQ(kObjectSize, store->GetLiveBytes());
+
+    ASSERT_EQ(kObjectSize, store->Remove("obj_1"));
+    ASSERT_EQ(-1, store->Remove("obj_1"));
+    ASSERT_FALSE(store->IsCached("obj_1"));
+    ASSERT_EQ(0, store->GetLiveBytes());
+}
+
+TEST_F(TestDiskCacheSegmentStore, EvictLeastRecentlyUsedSegment) {
+    auto store = NewStore();
+    // every segment holds 4 objects
+    for (int i = 0; i < 16; i++) {
+        std::string data = MakeData('a' + i);
+        ASSERT_EQ(kObjectSize, store->Write("obj_" + std::to_string(i),
+                                            data.data(), data.size()));
+    }
+    ASSERT_EQ(0, store->GetFreeSegmentNum());
+    ASSERT_TRUE(evicted_.empty());
+
+    // the first segment becomes hot, the second one is evicted
+    char buf[1];
+    ASSERT_EQ(1, store->Read("obj_0", buf, 0, 1));
+    std::string data = MakeData('z');
+    ASSERT_EQ(kObjectSize, store->Write("obj_16", data.data(), data.size()));
+    ASSERT_EQ(4, evicted_.size());
+    for (int i = 4; i < 8; i++) {
+        std::string name = "obj_" + std::to_string(i);
+        ASSERT_EQ(kObjectSize, evicted_[name]);
+        ASSERT_FALSE(store->IsCached(name));
+    }
+    ASSERT_TRUE(store->IsCached("obj_0"));
+    CheckRead(store.get(), "obj_16", data);
+
+    // object larger than segment can not be cached
+    std::string big(kSegmentSize, 'x');
+    ASSERT_GT(0, store->Write("big", big.data(), big.size()));
+}
+
+TEST_F(TestDiskCacheSegmentStore, ReloadFromCheckpointAndTail) {
+    {
+        auto store = NewStore();
+        for (int i = 0; i < 6; i++) {
+            std::string data = MakeData('a' + i);
+            ASSERT_EQ(kObjectSize, store->Write("obj_" + std::to_string(i),
+                                                data.data(), data.size()));
+        }
+        ASSERT_EQ(0, store->Checkpoint());
+        // appended after checkpoint, recovered by replaying segment tail
+        std::string data = MakeData('x');
+        ASSERT_EQ(kObjectSize, store->Write("obj_6", data.data(),
+                                            data.size()));
+        ASSERT_EQ(kObjectSize, store->Remove("obj_0"));
+        ASSERT_EQ(0, store->Checkpoint());
+        data = MakeData('y');
+        ASSERT_EQ(kObjectSize, store->Write("obj_7", data.data(),
+                                            data.size()));
+        // simulate crash, the index is not updated
+        std::string index = dir_ + "/cachesegment/index";
+        std::string backup = index + ".bak";
+        ASSERT_EQ(0, rename(index.c_str(), backup.c_str()));
+        store->Close();
+        ASSERT_EQ(0, rename(backup.c_str(), index.c_str()));
+    }
+
+    auto store = NewStore();
+    ASSERT_FALSE(store->IsCached("obj_0"));
+    for (int i = 1; i < 6; i++) {
+        CheckRead(store.get(), "obj_" + std::to_string(i), MakeData('a' + i));
+    }
+    CheckRead(store.get(), "obj_6", MakeData('x'));
+    CheckRead(store.get(), "obj_7", MakeData('y'));
+    ASSERT_EQ(7 * kObjectSize, store->GetLiveBytes());
+
+    std::list<std::string> objs;
+    store->ListObjects(&objs);
+    ASSERT_EQ(7, objs.size());
+
+    // new writes go on after the recovered records
+    std::string data = MakeData('z');
+    ASSERT_EQ(kObjectSize, store->Write("obj_8", data.data(), data.size()));
+    CheckRead(store.get(), "obj_7", MakeData('y'));
+    CheckRead(store.get(), "obj_8", data);
+}
+
+TEST_F(TestDiskCacheSegmentStore, DropIndexIfLayoutChanged) {
+    {
+        auto store = NewStore();
+        std::string data = MakeData('a');
+        ASSERT_EQ(kObjectSize, store->Write("obj", data.data(), data.size()));
+        store->Close();
+    }
+
+    option_.segmentNum = kSegmentNum * 2;
+    auto store = NewStore();
+    // records are still recovered by replaying the segments
+    CheckRead(store.get(), "obj", MakeData('a'));
+    ASSERT_EQ(kSegmentNum * 2 - 1, store->GetFreeSegmentNum());
+}
+
+TEST_F(TestDiskCacheSegmentStore, Compact) {
+    auto store = NewStore();
+    // all segments are used, the active one is half full
+    for (int i = 0; i < 14; i++) {
+        std::string data = MakeData('a' + i);
+        ASSERT_EQ(kObjectSize, store->Write("obj_" + std::to_string(i),
+                                            data.data(), data.size()));
+    }
+    ASSERT_EQ(0, store->GetFreeSegmentNum());
+
+    // live ratio of the first segment is higher than compactRatio
+    ASSERT_EQ(kObjectSize, store->Remove("obj_0"));
+    store->Compact();
+    ASSERT_EQ(0, store->GetFreeSegmentNum());
+
+    ASSERT_EQ(kObjectSize, store->Remove("obj_1"));
+    ASSERT_EQ(kObjectSize, store->Remove("obj_2"));
+    store->Compact();
+
+    // obj_3 is moved out, the segment becomes free without eviction
+    ASSERT_TRUE(evicted_.empty());
+    ASSERT_EQ(1, store->GetFreeSegmentNum());
+    for (int i = 3; i < 14; i++) {
+        CheckRead(store.get(), "obj_" + std::to_string(i), MakeData('a' + i));
+    }
+    ASSERT_EQ(11 * kObjectSize, store->GetLiveBytes());
+}
+
+TEST_F(TestDiskCacheSegmentStore, NotReplayFreeSegmentOfCheckpoint) {
+    {
+        auto store = NewStore();
+        for (int i = 0; i < 14; i++) {
+            std::string data = MakeData('a' + i);
+            ASSERT_EQ(kObjectSize, store->Write("obj_" + std::to_string(i),
+                                                data.data(), data.size()));
+        }
+        ASSERT_EQ(kObjectSize, store->Remove("obj_0"));
+        ASSERT_EQ(kObjectSize, store->Remove("obj_1"));
+        ASSERT_EQ(kObjectSize, store->Remove("obj_2"));
+        store->Compact();
+        ASSERT_EQ(1, store->GetFreeSegmentNum());
+        store->Close();
+    }
+
+    // the free segment still keeps the old records
+    auto store = NewStore();
+    ASSERT_EQ(1, store->GetFreeSegmentNum());
+    for (int i = 0; i < 3; i++) {
+        ASSERT_FALSE(store->IsCached("obj_" + std::to_string(i)));
+    }
+    for (int i = 3; i < 14; i++) {
+        CheckRead(store.get(), "obj_" + std::to_string(i), MakeData('a' + i));
+    }
+    ASSERT_EQ(11 * kObjectSize, store->GetLiveBytes());
+}
+
+TEST_F(TestDiskCacheSegmentStore, DropOverwrittenRecords) {
+    {
+        auto store = NewStore();
+        for (int i = 0; i < 3; i++) {
+            std::string data = MakeData('a' + i);
+            ASSERT_EQ(kObjectSize, store->Write("obj_" + std::to_string(i),
+                                                data.data(), data.size()));
+        }
+        ASSERT_EQ(0, store->Checkpoint());
+        std::string index = dir_ + "/cachesegment/index";
+        std::string backup = index + ".bak";
+        ASSERT_EQ(0, rename(index.c_str(), backup.c_str()));
+        store->Close();
+        ASSERT_EQ(0, rename(backup.c_str(), index.c_str()));
+    }
+
+    // overwrite the name of obj_1 and the data of obj_2 after checkpoint
+    std::string segment = dir_ + "/cachesegment/segment_0";
+    int fd = open(segment.c_str(), O_RDWR);
+    ASSERT_LE(0, fd);
+    uint64_t recordLen = 4 * 4096;
+    ASSERT_EQ(1, pwrite(fd, "x", 1, recordLen + 32));
+    ASSERT_EQ(1, pwrite(fd, "x", 1, 2 * recordLen + 4096));
+    close(fd);
+
+    // overwritten records are dropped on the first read
+    auto store = NewStore();
+    ASSERT_EQ(3 * kObjectSize, store->GetLiveBytes());
+    CheckRead(store.get(), "obj_0", MakeData('a'));
+    char buf[1];
+    for (int i = 1; i < 3; i++) {
+        std::string name = "obj_" + std::to_string(i);
+        ASSERT_TRUE(store->IsCached(name));
+        ASSERT_GT(0, store->Read(name, buf, 0, 1));
+        ASSERT_FALSE(store->IsCached(name));
+    }
+    ASSERT_EQ(kObjectSize, store->GetLiveBytes());
+    // verified once, later reads only read the range
+    CheckRead(store.get(), "obj_0", MakeData('a'));
+}
+
+TEST_F(TestDiskCacheSegmentStore, DirectIo) {
+    option_.directIo = true;
+    auto store = NewStore();
+    std::string data = MakeData('d');
+    ASSERT_EQ(kObjectSize, store->Write("obj", data.data(), data.size()));
+    char buf[3];
+    ASSERT_EQ(3, store->Read("obj", buf, 4095, 3));
+    ASSERT_EQ(std::string(3, 'd'), std::string(buf, 3));
+}
+
+}  // namespace client
+}  // namespace curvefs
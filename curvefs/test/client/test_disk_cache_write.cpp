@@ -474,6 +474,65 @@ TEST_F(TestDiskCacheWrite, AsyncUploadRun) {
     }
 }
 
+TEST_F(TestDiskCacheWrite, AsyncUploadInflightBudget) {
+    const uint64_t fileSize = 100;
+    struct stat st;
+    memset(&st, 0, sizeof(st));
+    st.st_size = fileSize;
+    std::string path = "test";
+    EXPECT_CALL(*wrapper_, stat(NotNull(), NotNull()))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(st), Return(0)));
+    EXPECT_CALL(*wrapper_, open(_, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*wrapper_, close(_)).WillRepeatedly(Return(0));
+    EXPECT_CALL(*wrapper_, malloc(_)).WillRepeatedly(Return(&path));
+    EXPECT_CALL(*wrapper_, memset(_, _, _)).WillRepeatedly(Return(&path));
+    EXPECT_CALL(*wrapper_, free(_)).WillRepeatedly(Return());
+    EXPECT_CALL(*wrapper_, read(_, _, _)).WillRepeatedly(Return(fileSize));
+    EXPECT_CALL(*wrapper_, remove(_)).WillRepeatedly(Return(0));
+
+    std::mutex mtx;
+    std::vector<std::shared_ptr<PutObjectAsyncContext>> contexts;
+    EXPECT_CALL(*client_, UploadAsync(_))
+        .WillRepeatedly(
+            Invoke([&](const std::shared_ptr<PutObjectAsyncContext> &context) {
+                std::lock_guard<std::mutex> lock(mtx);
+                contexts.push_back(context);
+            }));
+    auto uploaded = [&]() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return contexts.size();
+    };
+    auto finish = [&](size_t index) {
+        std::shared_ptr<PutObjectAsyncContext> context;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            context = contexts[index];
+        }
+        context->retCode = 0;
+        context->cb(context);
+    };
+
+    // two files can be uploaded at the same time
+    diskCacheWrite_->SetUploadOption(3, 2 * fileSize, 0);
+    for (int i = 0; i < 3; i++) {
+        diskCacheWrite_->AsyncUploadEnqueue("obj_" + std::to_string(i));
+    }
+    ASSERT_EQ(0, diskCacheWrite_->AsyncUploadRun());
+    while (uploaded() < 2) {
+        usleep(1000);
+    }
+    usleep(100 * 1000);
+    ASSERT_EQ(2, uploaded());
+
+    finish(0);
+    while (uploaded() < 3) {
+        usleep(1000);
+    }
+    finish(1);
+    finish(2);
+    diskCacheWrite_->AsyncUploadStop();
+}
+
 TEST_F(TestDiskCacheWrite, UploadFileByInode) {
     std::string inode("100"), obj1("1_16777216_2_0_0");
 
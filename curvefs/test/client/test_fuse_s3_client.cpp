@@ -980,6 +980,76 @@ TEST_F(TestFuseS3Client, warmUp_FetchChildDentry_suc_ListDentry) {
     ASSERT_FALSE(ret);
 }
 
+// files of a listed directory are stat'ed in one batch, without getting
+// their dentries again, and the empty ones are skipped
+TEST_F(TestFuseS3Client, warmUp_FetchChildDentry_batchGetInodeAttr) {
+    sleep(1);
+    fuse_ino_t parent = 1;
+    fuse_ino_t inodeid = 2;
+    fuse_ino_t emptyInodeid = 6;
+
+    Inode inode;
+    inode.set_fsid(fsId);
+    inode.set_inodeid(inodeid);
+    inode.set_length(4096);
+    inode.set_type(FsFileType::TYPE_S3);
+    auto inodeWrapper = std::make_shared<InodeWrapper>(inode, metaClient_);
+
+    std::list<Dentry> dlist;
+    std::map<uint64_t, InodeAttr> attrs;
+    for (auto ino : {inodeid, emptyInodeid}) {
+        Dentry dentry;
+        dentry.set_fsid(fsId);
+        dentry.set_inodeid(ino);
+        dentry.set_parentinodeid(parent);
+        dentry.set_name(std::to_string(ino));
+        dentry.set_type(FsFileType::TYPE_S3);
+        dlist.emplace_back(dentry);
+
+        InodeAttr attr;
+        attr.set_inodeid(ino);
+        attr.set_length(ino == inodeid ? 4096 : 0);
+        attrs.emplace(ino, attr);
+    }
+
+    EXPECT_CALL(*dentryManager_, ListDentry(parent, _, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<1>(dlist), Return(CURVEFS_ERROR::OK)));
+    EXPECT_CALL(*dentryManager_, GetDentry(_, _, _)).Times(0);
+    EXPECT_CALL(*inodeManager_, BatchGetInodeAttrAsync(parent, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(attrs), Return(CURVEFS_ERROR::OK)));
+    // add the filelist task, read the filelist and fetch the data of the
+    // non-empty file
+    EXPECT_CALL(*inodeManager_, GetInode(_, _))
+        .Times(3)
+        .WillRepeatedly(
+            DoAll(SetArgReferee<1>(inodeWrapper), Return(CURVEFS_ERROR::OK)));
+
+    size_t len = 20;
+    char* tmpbuf = new char[len];
+    memset(tmpbuf, '\n', len);
+    tmpbuf[0] = '/';
+    tmpbuf[1] = '\n';
+    EXPECT_CALL(*s3ClientAdaptor_, Read(_, _, _, _))
+        .WillOnce(
+            DoAll(SetArrayArgument<3>(tmpbuf, tmpbuf + len), Return(len)));
+    auto old = client_->GetFsInfo()->fstype();
+    client_->GetFsInfo()->set_fstype(FSType::TYPE_S3);
+    client_->PutWarmFilelistTask(
+        inodeid,
+        curvefs::client::common::WarmupStorageType::kWarmupStorageTypeDisk, "",
+        "", "");
+
+    warmup::WarmupProgress progress;
+    bool ret = client_->GetWarmupProgress(inodeid, &progress);
+    ASSERT_TRUE(ret);
+    client_->GetFsInfo()->set_fstype(old);
+    sleep(5);
+    ret = client_->GetWarmupProgress(inodeid, &progress);
+    LOG(INFO) << "ret:" << ret << " Warmup progress: " << progress.ToString();
+    ASSERT_FALSE(ret);
+    delete[] tmpbuf;
+}
+
 TEST_F(TestFuseS3Client, warmUp_GetInodeSubPathParent_empty) {
     /*
 .(1) parent
@@ -781,6 +781,12 @@ void ChunkServer::InitHeartbeatOptions(
         &heartbeatOptions->intervalSec));
     LOG_IF(FATAL, !conf->GetUInt32Value("mds.heartbeat_timeout",
         &heartbeatOptions->timeout));
+    if (!conf->GetUInt32Value("mds.heartbeat_full_interval",
+        &heartbeatOptions->fullHeartbeatInterval)) {
+        heartbeatOptions->fullHeartbeatInterval = 1;
+        LOG(WARNING) << "config no mds.heartbeat_full_interval info, "
+                     << "always send full heartbeat";
+    }
 }
 
 void ChunkServer::InitRegisterOptions(
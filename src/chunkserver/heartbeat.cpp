@@ -35,6 +35,7 @@
 #include "src/chunkserver/heartbeat.h"
 #include "src/common/uri_parser.h"
 #include "src/chunkserver/heartbeat_helper.h"
+#include "src/chunkserver/raftsnapshot/curve_snapshot_file_reader.h"
 #include "src/common/curve_version.h"
 
 using curve::fs::FileSystemInfo;
@@ -87,6 +88,7 @@ int Heartbeat::Init(const HeartbeatOptions &options) {
     LOG(INFO) << "MDS address: " << options_.mdsListenAddr;
 
     copysetMan_ = options.copysetNodeManager;
+    copysetTracker_.SetFullInterval(options_.fullHeartbeatInterval);
 
     // 初始化timer
     waitInterval_.Init(options_.intervalSec * 1000);
@@ -188,6 +190,9 @@ int Heartbeat::BuildCopysetInfo(curve::mds::heartbeat::CopySetInfo* info,
             stats->set_writerate(writeMetric->bps_.get_value(1));
             stats->set_readiops(readMetric->iops_.get_value(1));
             stats->set_writeiops(writeMetric->iops_.get_value(1));
+            stats->set_readlatency(readMetric->latencyRecorder_.latency(1));
+            stats->set_writelatency(
+                writeMetric->latencyRecorder_.latency(1));
             info->set_allocated_stats(stats);
         } else {
             LOG(ERROR) << "Failed to get copyset io metric."
@@ -252,7 +257,10 @@ int Heartbeat::BuildRequest(HeartbeatRequest* req) {
         stats->set_writerate(writeMetric->bps_.get_value(1));
         stats->set_readiops(readMetric->iops_.get_value(1));
         stats->set_writeiops(writeMetric->iops_.get_value(1));
+        stats->set_readlatency(readMetric->latencyRecorder_.latency(1));
+        stats->set_writelatency(writeMetric->latencyRecorder_.latency(1));
     }
+    stats->set_installsnapshotrate(GetInstallSnapshotReadBps());
     CopysetNodeOptions opt = copysetMan_->GetCopysetNodeOptions();
     uint64_t chunkFileSize = opt.maxChunkSize;
     uint64_t walSegmentFileSize = opt.maxWalSegmentSize;
@@ -326,7 +334,9 @@ void Heartbeat::DumpHeartbeatRequest(const HeartbeatRequest& request) {
              << request.chunkserverid()
              << ", IP: " << request.ip() << ", port: " << request.port()
              << ", copyset count: " << request.copysetcount()
-             << ", leader count: " << request.leadercount();
+             << ", leader count: " << request.leadercount()
+             << ", incremental: " << request.incremental()
+             << ", reported copysets: " << request.copysetinfos_size();
     for (int i = 0; i < request.copysetinfos_size(); i ++) {
         const curve::mds::heartbeat::CopySetInfo& info =
             request.copysetinfos(i);
@@ -599,6 +609,8 @@ void Heartbeat::HeartbeatWorker() {
             ::sleep(errorIntervalSec);
             continue;
         }
+        // 只保留发生变化的copyset
+        copysetTracker_.Encode(&req);
 
         LOG(INFO) << "sending heartbeat info";
         ret = SendHeartbeat(req, &resp);
@@ -607,6 +619,12 @@ void Heartbeat::HeartbeatWorker() {
             ::sleep(errorIntervalSec);
             continue;
         }
+        // 心跳被mds成功处理后才更新已确认的copyset信息,
+        // 否则下次心跳重新上报
+        if (!resp.has_statuscode() ||
+            resp.statuscode() == curve::mds::heartbeat::hbOK) {
+            copysetTracker_.Ack(resp.needfullheartbeat());
+        }
 
         LOG(INFO) << "executing heartbeat info";
         ret = ExecTask(resp);
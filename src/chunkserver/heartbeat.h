@@ -39,6 +39,7 @@
 #include "src/common/wait_interval.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/chunkserver/scan_manager.h"
+#include "src/chunkserver/heartbeat_helper.h"
 #include "proto/heartbeat.pb.h"
 #include "proto/scan.pb.h"
 
@@ -67,6 +68,8 @@ struct HeartbeatOptions {
     uint32_t                port;
     uint32_t                intervalSec;
     uint32_t                timeout;
+    // 每隔多少次心跳发送一次全量心跳, 0或1表示总是发送全量心跳
+    uint32_t                fullHeartbeatInterval;
     CopysetNodeManager*     copysetNodeManager;
     ScanManager*            scanManager;
 
@@ -187,6 +190,9 @@ class Heartbeat {
     uint64_t startUpTime_;
 
     ScanManager *scanMan_;
+
+    // 记录已被mds确认的copyset信息, 用于生成增量心跳
+    CopysetHeartbeatTracker copysetTracker_;
 };
 
 }  // namespace chunkserver
@@ -140,6 +140,53 @@ bool HeartbeatHelper::ChunkServerLoadCopySetFin(const std::string peerId) {
     return rep.copysetloadfin();
 }
 
+void CopysetHeartbeatTracker::Encode(ChunkServerHeartbeatRequest *request) {
+    pending_.clear();
+    for (const auto &info : request->copysetinfos()) {
+        pending_[CopysetKey(info.logicalpoolid(), info.copysetid())] =
+            info.SerializeAsString();
+    }
+
+    bool full = fullInterval_ <= 1 || forceFull_ ||
+                sinceFull_ + 1 >= fullInterval_;
+    // copyset被删除时无法用增量表达, 发送全量心跳
+    for (auto iter = acked_.begin(); !full && iter != acked_.end(); ++iter) {
+        full = pending_.count(iter->first) == 0;
+    }
+
+    pendingFull_ = full;
+    if (full) {
+        request->set_incremental(false);
+        return;
+    }
+
+    auto *infos = request->mutable_copysetinfos();
+    int kept = 0;
+    for (int i = 0; i < infos->size(); i++) {
+        const auto &info = infos->Get(i);
+        auto iter = acked_.find(
+            CopysetKey(info.logicalpoolid(), info.copysetid()));
+        bool changed = info.has_configchangeinfo() || iter == acked_.end() ||
+            iter->second != pending_[iter->first];
+        if (changed) {
+            if (kept != i) {
+                infos->SwapElements(kept, i);
+            }
+            kept++;
+        }
+    }
+    infos->DeleteSubrange(kept, infos->size() - kept);
+    request->set_incremental(true);
+}
+
+void CopysetHeartbeatTracker::Ack(bool needFull) {
+    // 未上报的copyset与上次确认的一致, 所以pending_就是mds当前看到的状态
+    acked_.swap(pending_);
+    pending_.clear();
+    sinceFull_ = pendingFull_ ? 0 : sinceFull_ + 1;
+    forceFull_ = needFull;
+}
+
 }  // namespace chunkserver
 }  // namespace curve
 
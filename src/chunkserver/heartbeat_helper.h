@@ -24,15 +24,18 @@
 #define SRC_CHUNKSERVER_HEARTBEAT_HELPER_H_
 
 #include <braft/node_manager.h>
+#include <map>
 #include <vector>
 #include <memory>
 #include <string>
+#include <utility>
 #include "proto/heartbeat.pb.h"
 #include "src/chunkserver/copyset_node.h"
 
 namespace curve {
 namespace chunkserver {
 using ::curve::mds::heartbeat::CopySetConf;
+using ::curve::mds::heartbeat::ChunkServerHeartbeatRequest;
 using ::curve::common::Peer;
 using CopysetNodePtr = std::shared_ptr<CopysetNode>;
 
@@ -91,6 +94,53 @@ class HeartbeatHelper {
      */
     static bool ChunkServerLoadCopySetFin(const std::string ipPort);
 };
+
+/**
+ * 记录上一次被mds确认的心跳中各copyset的信息, 用于增量心跳:
+ * 只上报epoch、leader、成员、统计信息等发生变化或者正在配置变更的copyset,
+ * 以下情况发送全量心跳:
+ * 1. 未开启增量心跳(fullInterval为0或1)
+ * 2. 距离上次全量心跳已经达到fullInterval次
+ * 3. 没有被确认的心跳、mds要求全量心跳或者有copyset被删除
+ */
+class CopysetHeartbeatTracker {
+ public:
+    explicit CopysetHeartbeatTracker(uint32_t fullInterval = 0)
+        : fullInterval_(fullInterval), sinceFull_(0),
+          forceFull_(true), pendingFull_(true) {}
+
+    void SetFullInterval(uint32_t fullInterval) {
+        fullInterval_ = fullInterval;
+    }
+
+    /**
+     * 从全量心跳请求中去掉上次确认之后没有变化的copyset
+     *
+     * @param[in|out] request 包含所有copyset的心跳请求
+     */
+    void Encode(ChunkServerHeartbeatRequest *request);
+
+    /**
+     * 心跳被mds处理成功之后调用, 记录本次上报的copyset信息
+     *
+     * @param[in] needFull mds是否要求下次发送全量心跳
+     */
+    void Ack(bool needFull);
+
+ private:
+    using CopysetKey = std::pair<LogicPoolID, CopysetID>;
+
+    uint32_t fullInterval_;
+    // 上次全量心跳之后被确认的增量心跳次数
+    uint32_t sinceFull_;
+    bool forceFull_;
+    // 最近一次Encode的请求是否为全量心跳
+    bool pendingFull_;
+    // 上次被确认的心跳中所有copyset序列化之后的信息
+    std::map<CopysetKey, std::string> acked_;
+    // 最近一次Encode时所有copyset序列化之后的信息
+    std::map<CopysetKey, std::string> pending_;
+};
 }  // namespace chunkserver
 }  // namespace curve
 #endif  // SRC_CHUNKSERVER_HEARTBEAT_HELPER_H_
@@ -44,6 +44,17 @@
 namespace curve {
 namespace chunkserver {
 
+namespace {
+bvar::Adder<uint64_t> g_install_snapshot_read_bytes(
+    "chunkserver_install_snapshot_read_bytes");
+bvar::PerSecond<bvar::Adder<uint64_t>> g_install_snapshot_read_bps(
+    "chunkserver_install_snapshot_read_bps", &g_install_snapshot_read_bytes);
+}  // namespace
+
+uint64_t GetInstallSnapshotReadBps() {
+    return g_install_snapshot_read_bps.get_value();
+}
+
 CurveSnapshotAttachMetaTable::CurveSnapshotAttachMetaTable() {}
 
 CurveSnapshotAttachMetaTable::~CurveSnapshotAttachMetaTable() {}
@@ -161,6 +172,9 @@ int CurveSnapshotFileReader::read_file(butil::IOBuf* out,
             ret = LocalDirReader::read_file_with_meta(out, filename, &file_meta,
                                     offset, new_max_count, read_count, is_eof);
             used_count = out->size();
+            if (ret == 0) {
+                g_install_snapshot_read_bytes << *read_count;
+            }
         }
         if ((ret == 0 || ret == EAGAIN) &&
                                 used_count < (int64_t)new_max_count) {
@@ -169,8 +183,12 @@ int CurveSnapshotFileReader::read_file(butil::IOBuf* out,
         }
         return ret;
     }
-    return LocalDirReader::read_file_with_meta(out, filename, &file_meta,
+    int ret = LocalDirReader::read_file_with_meta(out, filename, &file_meta,
                                     offset, new_max_count, read_count, is_eof);
+    if (ret == 0) {
+        g_install_snapshot_read_bytes << *read_count;
+    }
+    return ret;
 }
 
 }  // namespace chunkserver
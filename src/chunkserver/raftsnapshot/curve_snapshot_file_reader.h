@@ -44,6 +44,7 @@
 
 #include <braft/file_reader.h>
 #include <braft/snapshot.h>
+#include <bvar/bvar.h>
 #include <utility>
 #include <vector>
 #include <string>
@@ -54,6 +55,12 @@
 namespace curve {
 namespace chunkserver {
 
+/**
+ * 获取最近一段时间作为leader给follower安装快照读取数据的带宽(bytes/s)，
+ * 通过心跳上报给mds，用于估计数据恢复的速度
+ */
+uint64_t GetInstallSnapshotReadBps();
+
 /**
  * snapshot attachment文件元数据表，同上面的
  * CurveSnapshotAttachMetaTable接口，主要提供attach文件元数据信息
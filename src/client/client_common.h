@@ -124,6 +124,8 @@ typedef struct SegmentInfo {
     uint64_t startoffset;
     std::vector<ChunkIDInfo> chunkvec;
     LogicalPoolCopysetIDInfo lpcpIDInfo;
+    // seqnum of the latest write recorded by mds, 0 if unknown
+    uint64_t dirtySeqNum = 0;
 } SegmentInfo_t;
 
 struct CloneSourceInfo {
@@ -161,12 +163,15 @@ typedef struct FInfo {
     uint64_t stripeUnit;
     uint64_t stripeCount;
     std::string poolset;
+    // segments are marked dirty before writing if not 0
+    uint64_t dirtyTrackingSeqNum{0};
 
     OpenFlags       openflags;
     common::ReadWriteThrottleParams throttleParams;
 
     FInfo() {
         id = 0;
+        parentid = 0;
         ctime = 0;
         seqnum = 0;
         length = 0;
@@ -148,6 +148,23 @@ int ClientConfig::Init(const std::string& configpath) {
     LOG_IF(ERROR, ret == false) << "config no metacache.getLeaderTimeOutMS info";   // NOLINT
     RETURN_IF_FALSE(ret);
 
+    ret = conf_.GetUInt32Value("metacache.segmentPrefetchNum",
+        &fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.segmentPrefetchNum info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.segmentPrefetchNum;
+
+    ret = conf_.GetStringValue("metacache.persistDir",
+        &fileServiceOption_.ioOpt.metaCacheOpt.persistDir);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.persistDir info, metacache persist disabled";
+
+    ret = conf_.GetUInt32Value("metacache.persistIntervalS",
+        &fileServiceOption_.ioOpt.metaCacheOpt.persistIntervalS);
+    LOG_IF(WARNING, ret == false)
+        << "config no metacache.persistIntervalS info, using default value "
+        << fileServiceOption_.ioOpt.metaCacheOpt.persistIntervalS;
+
     ret = conf_.GetUInt32Value("schedule.queueCapacity",
         &fileServiceOption_.ioOpt.reqSchdulerOpt.scheduleQueueCapacity);
     LOG_IF(ERROR, ret == false) << "config no schedule.queueCapacity info";
@@ -268,6 +285,13 @@ int ClientConfig::Init(const std::string& configpath) {
         << "config no throttle.enable info, using default value "
         << fileServiceOption_.ioOpt.throttleOption.enable;
 
+    ret = conf_.GetUInt32Value(
+        "throttle.maxPendingAioNum",
+        &fileServiceOption_.ioOpt.throttleOption.maxPendingAioNum);
+    LOG_IF(WARNING, ret == false)
+        << "config no throttle.maxPendingAioNum info, using default value "
+        << fileServiceOption_.ioOpt.throttleOption.maxPendingAioNum;
+
     ret = conf_.GetBoolValue("discard.enable",
                              &fileServiceOption_.ioOpt.discardOption.enable);
     LOG_IF(ERROR, ret == false) << "config no discard.enable info";
@@ -175,8 +175,12 @@ struct MDSClientMetric {
     InterfaceMetric getServerList;
     // GetOrAllocateSegment接口统计信息
     InterfaceMetric getOrAllocateSegment;
+    // GetOrAllocateSegments接口统计信息
+    InterfaceMetric getOrAllocateSegments;
     // DeAllocateSegment接口统计信息
     InterfaceMetric deAllocateSegment;
+    // MarkSegmentsDirty接口统计信息
+    InterfaceMetric markSegmentsDirty;
     // RenameFile接口统计信息
     InterfaceMetric renameFile;
     // Extend接口统计信息
@@ -214,7 +218,9 @@ struct MDSClientMetric {
           refreshSession(prefix, "refreshSession"),
           getServerList(prefix, "getServerList"),
           getOrAllocateSegment(prefix, "getOrAllocateSegment"),
+          getOrAllocateSegments(prefix, "getOrAllocateSegments"),
           deAllocateSegment(prefix, "deAllocateSegment"),
+          markSegmentsDirty(prefix, "markSegmentsDirty"),
           renameFile(prefix, "renameFile"),
           extendFile(prefix, "extendFile"),
           deleteFile(prefix, "deleteFile"),
@@ -203,6 +203,14 @@ struct MetaCacheOption {
     uint32_t metacacheGetLeaderRPCTimeOutMS = 1000;
     uint32_t metacacheGetLeaderBackupRequestMS = 100;
     uint32_t discardGranularity = 4096;
+    // number of following segments allocated together with the current one
+    // when segments are allocated sequentially, 0 means disabled
+    uint32_t segmentPrefetchNum = 0;
+    // directory to persist copyset and segment info of opened files, which
+    // is loaded when the file is opened again, empty means disabled
+    std::string persistDir;
+    // interval of persisting while the file is opened, 0 means only on close
+    uint32_t persistIntervalS = 300;
     std::string metacacheGetLeaderBackupRequestLbName = "rr";
     ChunkServerUnstableOption chunkserverUnstableOption;
 };
@@ -247,6 +255,9 @@ struct CloseFdThreadOption {
 
 struct ThrottleOption {
     bool enable = false;
+    // max number of aio requests waiting on throttle asynchronously,
+    // requests beyond it are throttled in the threads of task pool
+    uint32_t maxPendingAioNum = 1024;
 };
 
 /**
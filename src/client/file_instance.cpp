@@ -214,6 +214,7 @@ int FileInstance::Open(std::string* sessionId) {
         }
         iomanager4file_.UpdateFileEpoch(fEpoch);
         blocksize_ = finfo_.blocksize;
+        iomanager4file_.GetMetaCache()->LoadPersisted();
     }
     return -ret;
 }
@@ -232,6 +233,7 @@ int FileInstance::Close() {
     }
 
     StopLease();
+    iomanager4file_.GetMetaCache()->Persist();
 
     LIBCURVE_ERROR ret =
         mdsclient_->CloseFile(finfo_.fullPathName, finfo_.userinfo, "");
@@ -23,6 +23,9 @@
 #include <glog/logging.h>
 
 #include <chrono>   // NOLINT
+#include <functional>
+#include <memory>
+#include <utility>
 
 #include "src/client/metacache.h"
 #include "src/client/iomanager4file.h"
@@ -32,8 +35,29 @@
 
 namespace curve {
 namespace client {
+
+namespace {
+
+// dispatch throttled aio request to task pool when throttle is satisfied
+class ThrottleDoneClosure : public google::protobuf::Closure {
+ public:
+    explicit ThrottleDoneClosure(std::function<void()> dispatch)
+        : dispatch_(std::move(dispatch)) {}
+
+    void Run() override {
+        std::unique_ptr<ThrottleDoneClosure> selfGuard(this);
+        dispatch_();
+    }
+
+ private:
+    std::function<void()> dispatch_;
+};
+
+}  // namespace
+
 Atomic<uint64_t> IOManager::idRecorder_(1);
-IOManager4File::IOManager4File() : scheduler_(nullptr), exit_(false) {}
+IOManager4File::IOManager4File()
+    : scheduler_(nullptr), throttlePending_(0), exit_(false) {}
 
 bool IOManager4File::Initialize(const std::string& filename,
                                 const IOOption& ioOpt,
@@ -197,12 +221,11 @@ int IOManager4File::AioRead(CurveAioContext* ctx, MDSClient* mdsclient,
 
     temp->SetUserDataType(dataType);
     inflightCntl_.IncremInflightNum();
-    auto task = [this, ctx, mdsclient, temp]() {
-        temp->StartAioRead(ctx, mdsclient, this->GetFileInfo(),
-                           throttle_.get());
+    auto task = [this, ctx, mdsclient, temp](common::Throttle* throttle) {
+        temp->StartAioRead(ctx, mdsclient, this->GetFileInfo(), throttle);
     };
 
-    taskPool_.Enqueue(task);
+    EnqueueAfterThrottle(true, ctx->length, std::move(task));
     return LIBCURVE_ERROR::OK;
 }
 
@@ -221,16 +244,41 @@ int IOManager4File::AioWrite(CurveAioContext* ctx, MDSClient* mdsclient,
 
     temp->SetUserDataType(dataType);
     inflightCntl_.IncremInflightNum();
-    auto task = [this, ctx, mdsclient, temp]() {
+    auto task = [this, ctx, mdsclient, temp](common::Throttle* throttle) {
         temp->StartAioWrite(ctx, mdsclient, this->GetFileInfo(),
-                            this->GetFileEpoch(),
-                            throttle_.get());
+                            this->GetFileEpoch(), throttle);
     };
 
-    taskPool_.Enqueue(task);
+    EnqueueAfterThrottle(false, ctx->length, std::move(task));
     return LIBCURVE_ERROR::OK;
 }
 
+void IOManager4File::EnqueueAfterThrottle(
+    bool isRead, uint64_t length,
+    std::function<void(common::Throttle*)> task) {
+    if (!throttle_) {
+        taskPool_.Enqueue([task]() { task(nullptr); });
+        return;
+    }
+
+    // too many requests are waiting on throttle, throttle them in the threads
+    // of task pool instead, so the bounded task queue blocks the caller
+    if (throttlePending_.fetch_add(1, std::memory_order_relaxed) >=
+        ioopt_.throttleOption.maxPendingAioNum) {
+        throttlePending_.fetch_sub(1, std::memory_order_relaxed);
+        taskPool_.Enqueue([this, task]() { task(throttle_.get()); });
+        return;
+    }
+
+    // throttle asynchronously, so throttled requests wait on throttle's timer
+    // instead of occupying threads of task pool
+    auto dispatch = [this, task]() {
+        throttlePending_.fetch_sub(1, std::memory_order_relaxed);
+        taskPool_.Enqueue([task]() { task(nullptr); });
+    };
+    throttle_->Add(isRead, length, new ThrottleDoneClosure(dispatch));
+}
+
 int IOManager4File::Discard(off_t offset, size_t length, MDSClient* mdsclient) {
     MetricHelper::IncremUserRPSCount(fileMetric_, OpType::DISCARD);
 
@@ -27,6 +27,7 @@
 #include <bthread/mutex.h>
 
 #include <atomic>
+#include <functional>
 #include <condition_variable>  // NOLINT
 #include <mutex>               // NOLINT
 #include <string>
@@ -260,6 +261,18 @@ class IOManager4File : public IOManager {
 
     bool IsNeedDiscard(size_t len) const;
 
+    /**
+     * @brief Enqueue aio task into task pool after it passes the throttle,
+     *        throttled task waits on throttle's timer without occupying
+     *        the caller thread or threads of task pool. If there are more
+     *        than maxPendingAioNum requests waiting, the task is enqueued
+     *        directly and throttled in the thread of task pool
+     * @param task the throttle passed to task is nullptr if the request has
+     *        already passed the throttle
+     */
+    void EnqueueAfterThrottle(bool isRead, uint64_t length,
+                              std::function<void(common::Throttle*)> task);
+
  private:
     // 每个IOManager都有其IO配置，保存在iooption里
     IOOption ioopt_;
@@ -285,6 +298,9 @@ class IOManager4File : public IOManager {
 
     std::unique_ptr<common::Throttle> throttle_;
 
+    // number of aio requests waiting on throttle asynchronously
+    std::atomic<uint32_t> throttlePending_;
+
     // 是否退出
     bool exit_;
 
@@ -122,6 +122,7 @@ bool LeaseExecutor::RefreshLease() {
         failedrefreshcount_.store(0);
         isleaseAvaliable_.store(true);
         iomanager_->ResumeIO();
+        iomanager_->GetMetaCache()->PersistIfExpired();
         return true;
     } else if (response.status == LeaseRefreshResult::Status::NOT_EXIST) {
         iomanager_->LeaseTimeoutBlockIO();
@@ -676,6 +676,7 @@ LIBCURVE_ERROR MDSClient::GetSnapshotSegmentInfo(const std::string &filename,
         segInfo->segmentsize = pfs.segmentsize();
         segInfo->chunksize = pfs.chunksize();
         segInfo->startoffset = pfs.startoffset();
+        segInfo->dirtySeqNum = pfs.dirtyseqnum();
         segInfo->lpcpIDInfo.lpid = logicpoolid;
 
         int chunksNum = pfs.chunks_size();
@@ -1080,6 +1081,7 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
         segInfo->chunksize = pfs.chunksize();
         segInfo->segmentsize = pfs.segmentsize();
         segInfo->startoffset = pfs.startoffset();
+        segInfo->dirtySeqNum = pfs.dirtyseqnum();
         LogicPoolID logicpoolid = pfs.logicalpoolid();
         segInfo->lpcpIDInfo.lpid = pfs.logicalpoolid();
 
@@ -1101,6 +1103,91 @@ LIBCURVE_ERROR MDSClient::GetOrAllocateSegment(bool allocate, uint64_t offset,
     return ReturnError(rpcExcutor_.DoRPCTask(task, 0));
 }
 
+LIBCURVE_ERROR MDSClient::GetOrAllocateSegments(
+    bool allocate, const std::vector<uint64_t> &offsets, const FInfo_t *fi,
+    const FileEpoch_t *fEpoch, std::vector<SegmentInfo> *segInfos) {
+    if (offsets.empty()) {
+        return LIBCURVE_ERROR::OK;
+    }
+
+    // mds doesn't have the batch rpc, caller allocates segment one by one
+    if (batchSegmentsUnsupported_.load(std::memory_order_relaxed)) {
+        return LIBCURVE_ERROR::NOT_SUPPORT;
+    }
+
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        GetOrAllocateSegmentsResponse response;
+        mdsClientMetric_.getOrAllocateSegments.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.getOrAllocateSegments.latency);
+        MDSClientBase::GetOrAllocateSegments(allocate, offsets, fi, fEpoch,
+                                             &response, cntl, channel);
+        if (cntl->Failed()) {
+            mdsClientMetric_.getOrAllocateSegments.eps.count << 1;
+            LOG(WARNING) << "allocate segments failed, error code = "
+                         << cntl->ErrorCode()
+                         << ", error content:" << cntl->ErrorText()
+                         << ", first offset:" << offsets.front()
+                         << ", count:" << offsets.size();
+            // older mds without the batch rpc, retrying is useless
+            if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                LOG(INFO) << "mds doesn't support GetOrAllocateSegments, "
+                             "allocate segment one by one from now on";
+                batchSegmentsUnsupported_.store(true,
+                                                std::memory_order_relaxed);
+                return LIBCURVE_ERROR::NOT_SUPPORT;
+            }
+            return -cntl->ErrorCode();
+        }
+
+        auto statuscode = response.statuscode();
+        switch (statuscode) {
+        case StatusCode::kOK:
+            break;
+        case StatusCode::kOwnerAuthFail:
+            LOG(WARNING) << "GetOrAllocateSegments: auth failed!";
+            return LIBCURVE_ERROR::AUTHFAIL;
+        case StatusCode::kEpochTooOld:
+            LOG(WARNING) << "GetOrAllocateSegments return epoch too old!";
+            return LIBCURVE_ERROR::EPOCH_TOO_OLD;
+        default:
+            LOG(WARNING) << "GetOrAllocateSegments failed, statuscode = "
+                         << StatusCode_Name(statuscode);
+            return LIBCURVE_ERROR::FAILED;
+        }
+
+        std::vector<SegmentInfo> infos;
+        infos.reserve(response.pagefilesegments_size());
+        for (const auto &pfs : response.pagefilesegments()) {
+            int chunksNum = pfs.chunks_size();
+            if (allocate && chunksNum <= 0) {
+                LOG(WARNING) << "MDS allocate segments, but no chunkinfo!";
+                return LIBCURVE_ERROR::FAILED;
+            }
+
+            SegmentInfo segInfo;
+            segInfo.chunksize = pfs.chunksize();
+            segInfo.segmentsize = pfs.segmentsize();
+            segInfo.startoffset = pfs.startoffset();
+            segInfo.dirtySeqNum = pfs.dirtyseqnum();
+            LogicPoolID logicpoolid = pfs.logicalpoolid();
+            segInfo.lpcpIDInfo.lpid = logicpoolid;
+            for (int i = 0; i < chunksNum; i++) {
+                ChunkID chunkid = pfs.chunks(i).chunkid();
+                CopysetID copysetid = pfs.chunks(i).copysetid();
+                segInfo.lpcpIDInfo.cpidVec.push_back(copysetid);
+                segInfo.chunkvec.emplace_back(chunkid, logicpoolid, copysetid);
+            }
+            infos.emplace_back(std::move(segInfo));
+        }
+        segInfos->swap(infos);
+        return LIBCURVE_ERROR::OK;
+    };
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
 LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo *fileInfo,
                                             uint64_t offset) {
     auto task = RPCTaskDefine {
@@ -1140,6 +1227,48 @@ LIBCURVE_ERROR MDSClient::DeAllocateSegment(const FInfo *fileInfo,
         rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
 }
 
+LIBCURVE_ERROR MDSClient::MarkSegmentsDirty(
+    const FInfo *fileInfo, const std::vector<uint64_t> &offsets,
+    uint64_t seq) {
+    auto task = RPCTaskDefine {
+        (void)addrindex;
+        (void)rpctimeoutMS;
+        MarkSegmentsDirtyResponse response;
+        mdsClientMetric_.markSegmentsDirty.qps.count << 1;
+        LatencyGuard lg(&mdsClientMetric_.markSegmentsDirty.latency);
+        MDSClientBase::MarkSegmentsDirty(fileInfo, offsets, seq, &response,
+                                         cntl, channel);
+
+        if (cntl->Failed()) {
+            mdsClientMetric_.markSegmentsDirty.eps.count << 1;
+            LOG(WARNING) << "MarkSegmentsDirty failed, error = "
+                         << cntl->ErrorText()
+                         << ", filename = " << fileInfo->fullPathName
+                         << ", first offset = " << offsets.front()
+                         << ", count = " << offsets.size();
+            if (cntl->ErrorCode() == brpc::ENOMETHOD) {
+                return LIBCURVE_ERROR::NOT_SUPPORT;
+            }
+            return -cntl->ErrorCode();
+        }
+
+        auto statusCode = response.statuscode();
+        if (statusCode != StatusCode::kOK) {
+            LOG(WARNING) << "MarkSegmentsDirty mds return failed, error = "
+                         << mds::StatusCode_Name(statusCode)
+                         << ", filename = " << fileInfo->fullPathName
+                         << ", first offset = " << offsets.front()
+                         << ", count = " << offsets.size();
+        }
+        LIBCURVE_ERROR errCode;
+        MDSStatusCode2LibcurveError(statusCode, &errCode);
+        return errCode;
+    };
+
+    return ReturnError(
+        rpcExcutor_.DoRPCTask(task, metaServerOpt_.mdsMaxRetryMS));
+}
+
 LIBCURVE_ERROR MDSClient::RenameFile(const UserInfo_t &userinfo,
                                      const std::string &origin,
                                      const std::string &destination,
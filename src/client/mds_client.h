@@ -26,6 +26,7 @@
 #include <brpc/channel.h>
 #include <brpc/controller.h>
 
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
@@ -209,7 +210,7 @@ class MDSClient : public MDSClientBase,
      * @param: cpinfoVec保存获取到的server信息
      * @return: 成功返回LIBCURVE_ERROR::OK,否则返回LIBCURVE_ERROR::FAILED
      */
-    LIBCURVE_ERROR
+    virtual LIBCURVE_ERROR
     GetServerList(const LogicPoolID &logicPoolId,
                   const std::vector<CopysetID> &csid,
                   std::vector<CopysetInfo<ChunkServerID>> *cpinfoVec);
@@ -240,6 +241,25 @@ class MDSClient : public MDSClientBase,
                                         const FileEpoch_t *fEpoch,
                                         SegmentInfo *segInfo);
 
+    /**
+     * Get or Alloc several segments of one file in one rpc
+     * @param: allocate  ture for allocate, false for get only
+     * @param: offsets  segment start offsets
+     * @param: fi file info
+     * @param: fEpoch  file epoch info
+     * @param[out]: segInfos segments info returned, segments not allocated
+     *              are absent when allocate is false
+     * @return:
+     * return LIBCURVE_ERROR::OK for success,
+     * return LIBCURVE_ERROR::AUTHFAIL for auth fail,
+     * return LIBCURVE_ERROR::NOT_SUPPORT if mds doesn't have this rpc,
+     * otherwise return LIBCURVE_ERROR::FAILED
+     */
+    virtual LIBCURVE_ERROR GetOrAllocateSegments(
+        bool allocate, const std::vector<uint64_t> &offsets,
+        const FInfo_t *fi, const FileEpoch_t *fEpoch,
+        std::vector<SegmentInfo> *segInfos);
+
     /**
      * @brief Send DeAllocateSegment request to current working MDS
      * @param fileInfo current file info
@@ -249,6 +269,19 @@ class MDSClient : public MDSClientBase,
     virtual LIBCURVE_ERROR DeAllocateSegment(const FInfo *fileInfo,
                                              uint64_t offset);
 
+    /**
+     * @brief Send MarkSegmentsDirty request to current working MDS
+     * @param fileInfo current file info
+     * @param offsets segment start offsets
+     * @param seq seqnum of the following writes
+     * @return LIBCURVE_ERROR::OK means success,
+     *         LIBCURVE_ERROR::NOT_SUPPORT if mds doesn't have this rpc,
+     *         other value means fail
+     */
+    virtual LIBCURVE_ERROR MarkSegmentsDirty(
+        const FInfo *fileInfo, const std::vector<uint64_t> &offsets,
+        uint64_t seq);
+
     /**
      * Get File Info
      * @param: filename  file name
@@ -557,6 +590,9 @@ class MDSClient : public MDSClientBase,
     MDSClientMetric mdsClientMetric_;
 
     RPCExcutorRetryPolicy rpcExcutor_;
+
+    // set once mds replied that GetOrAllocateSegments is not implemented
+    std::atomic<bool> batchSegmentsUnsupported_{false};
 };
 
 }  // namespace client
@@ -52,6 +52,7 @@ void MDSClientBase::OpenFile(const std::string& filename,
     OpenFileRequest request;
     request.set_filename(filename);
     request.set_clientversion(curve::common::CurveVersion());
+    request.set_marksegmentsdirty(true);
     FillUserInfo(&request, userinfo);
 
     LOG(INFO) << "OpenFile: filename = " << filename
@@ -408,6 +409,37 @@ void MDSClientBase::GetOrAllocateSegment(bool allocate,
     stub.GetOrAllocateSegment(cntl, &request, response, NULL);
 }
 
+void MDSClientBase::GetOrAllocateSegments(
+    bool allocate,
+    const std::vector<uint64_t>& offsets,
+    const FInfo_t* fi,
+    const FileEpoch_t *fEpoch,
+    GetOrAllocateSegmentsResponse* response,
+    brpc::Controller* cntl,
+    brpc::Channel* channel) {
+    GetOrAllocateSegmentsRequest request;
+
+    uint64_t segmentsize = fi->segmentsize;
+    request.set_filename(fi->fullPathName);
+    for (const auto& offset : offsets) {
+        request.add_offsets((offset / segmentsize) * segmentsize);
+    }
+    request.set_allocateifnotexist(allocate);
+    if (allocate && fEpoch != nullptr && fEpoch->epoch != 0) {
+        request.set_epoch(fEpoch->epoch);
+    }
+    FillUserInfo(&request, fi->userinfo);
+
+    LOG(INFO) << "GetOrAllocateSegments: filename = " << fi->fullPathName
+              << ", allocate = " << allocate << ", owner = " << fi->owner
+              << ", first offset = " << request.offsets(0)
+              << ", segment count = " << request.offsets_size()
+              << ", log id = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.GetOrAllocateSegments(cntl, &request, response, NULL);
+}
+
 void MDSClientBase::DeAllocateSegment(const FInfo* fileInfo,
                                       uint64_t segmentOffset,
                                       DeAllocateSegmentResponse* response,
@@ -427,6 +459,30 @@ void MDSClientBase::DeAllocateSegment(const FInfo* fileInfo,
     stub.DeAllocateSegment(cntl, &request, response, nullptr);
 }
 
+void MDSClientBase::MarkSegmentsDirty(const FInfo* fileInfo,
+                                      const std::vector<uint64_t>& offsets,
+                                      uint64_t seq,
+                                      MarkSegmentsDirtyResponse* response,
+                                      brpc::Controller* cntl,
+                                      brpc::Channel* channel) {
+    MarkSegmentsDirtyRequest request;
+    request.set_filename(fileInfo->fullPathName);
+    for (auto offset : offsets) {
+        request.add_offsets(offset);
+    }
+    request.set_seqnum(seq);
+
+    FillUserInfo(&request, fileInfo->userinfo);
+
+    DVLOG(9) << "MarkSegmentsDirty: filename = " << fileInfo->fullPathName
+             << ", first offset = " << offsets.front()
+             << ", count = " << offsets.size() << ", seq = " << seq
+             << ", logid = " << cntl->log_id();
+
+    curve::mds::CurveFSService_Stub stub(channel);
+    stub.MarkSegmentsDirty(cntl, &request, response, nullptr);
+}
+
 void MDSClientBase::RenameFile(const UserInfo_t& userinfo,
                                const std::string& origin,
                                const std::string& destination,
@@ -71,8 +71,12 @@ using curve::mds::SetCloneFileStatusRequest;
 using curve::mds::SetCloneFileStatusResponse;
 using curve::mds::GetOrAllocateSegmentRequest;
 using curve::mds::GetOrAllocateSegmentResponse;
+using curve::mds::GetOrAllocateSegmentsRequest;
+using curve::mds::GetOrAllocateSegmentsResponse;
 using curve::mds::DeAllocateSegmentRequest;
 using curve::mds::DeAllocateSegmentResponse;
+using curve::mds::MarkSegmentsDirtyRequest;
+using curve::mds::MarkSegmentsDirtyResponse;
 using curve::mds::CheckSnapShotStatusRequest;
 using curve::mds::CheckSnapShotStatusResponse;
 using curve::mds::ListSnapShotFileInfoRequest;
@@ -352,10 +356,34 @@ class MDSClientBase {
                               brpc::Controller* cntl,
                               brpc::Channel* channel);
 
+    /**
+     * Get or Alloc several segments of one file in one rpc
+     * @param: allocate  ture for allocate, false for get only
+     * @param: offsets  segment start offsets
+     * @param: fi file info
+     * @param: fEpoch  file epoch info
+     * @param[out]: reponse  rpc response
+     * @param[in|out]: cntl  rpc controller
+     * @param[in]:channel  rpc channel
+     */
+    void GetOrAllocateSegments(bool allocate,
+                               const std::vector<uint64_t>& offsets,
+                               const FInfo_t* fi,
+                               const FileEpoch_t *fEpoch,
+                               GetOrAllocateSegmentsResponse* response,
+                               brpc::Controller* cntl,
+                               brpc::Channel* channel);
+
     void DeAllocateSegment(const FInfo* fileInfo, uint64_t segmentOffset,
                            DeAllocateSegmentResponse* response,
                            brpc::Controller* cntl, brpc::Channel* channel);
 
+    void MarkSegmentsDirty(const FInfo* fileInfo,
+                           const std::vector<uint64_t>& offsets,
+                           uint64_t seq,
+                           MarkSegmentsDirtyResponse* response,
+                           brpc::Controller* cntl, brpc::Channel* channel);
+
     /**
      * @brief 重名文件
      * @param:userinfo 用户信息
@@ -22,7 +22,17 @@
 #include <glog/logging.h>
 
 #include <bthread/bthread.h>
-
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <future>  // NOLINT
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
 #include <utility>
 #include <vector>
 #include <algorithm>
@@ -33,6 +43,8 @@
 #include "src/client/mds_client.h"
 #include "src/client/client_common.h"
 #include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace client {
@@ -40,6 +52,87 @@ namespace client {
 using curve::common::WriteLockGuard;
 using curve::common::ReadLockGuard;
 using curve::client::ClientConfig;
+using curve::common::TimeUtility;
+
+namespace {
+
+// persisted file layout:
+//   magic inodeid ctime
+//   S logicpoolid copysetid leaderindex peernum
+//     [peerid internaladdr externaladdr]...
+//   G segmentindex logicpoolid [chunkid copysetid]...
+//
+// segments may be deallocated by other clients after close and their
+// chunks reallocated to other files, and there is no generation of
+// segments on mds, so persisted segments are only used after they are
+// compared with the segments returned by mds at open
+const char kPersistMagic[] = "curve_metacache_v3";
+
+// mds accepts at most this many offsets in one GetOrAllocateSegments
+const size_t kMaxSegmentsPerRequest = 128;
+
+// persisted files are written by one background thread, so that the
+// lease refresh bthread is not blocked by file io, and the writes of one
+// file are kept in order
+curve::common::TaskThreadPool<>* GetPersistThread() {
+    static curve::common::TaskThreadPool<>* persistThread = []() {
+        auto* pool = new curve::common::TaskThreadPool<>();
+        pool->Start(1);
+        return pool;
+    }();
+    return persistThread;
+}
+
+int WritePersistFile(const std::string& path, const std::string& content,
+                     const std::string& filename) {
+    // write to a temporary file first, avoid leaving a partial file
+    const std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        LOG(WARNING) << "Persist metacache failed, open " << tmpPath
+                     << " failed, filename = " << filename
+                     << ", errno = " << errno;
+        return -1;
+    }
+
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = ::write(fd, content.data() + written,
+                            content.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        written += n;
+    }
+
+    // the file must be on disk before it's renamed over the old one,
+    // otherwise a crash may leave an empty or partial file behind
+    bool ok = written == content.size() && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok) {
+        LOG(WARNING) << "Persist metacache failed, write " << tmpPath
+                     << " failed, filename = " << filename
+                     << ", errno = " << errno;
+        std::remove(tmpPath.c_str());
+        return -1;
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG(WARNING) << "Persist metacache failed, rename " << tmpPath
+                     << " failed, filename = " << filename;
+        std::remove(tmpPath.c_str());
+        return -1;
+    }
+
+    VLOG(3) << "Persist metacache success, filename = " << filename
+            << ", path = " << path;
+    return 0;
+}
+
+}  // namespace
 
 void MetaCache::Init(const MetaCacheOption& metaCacheOpt,
                      MDSClient* mdsclient) {
@@ -287,6 +380,19 @@ void MetaCache::AddCopysetsInfo(
     }
 }
 
+std::vector<CopysetID> MetaCache::GetUncachedCopysets(
+    LogicPoolID poolId, const std::vector<CopysetID>& copysetIds) {
+    std::vector<CopysetID> uncached;
+    ReadLockGuard guard(rwlock4CopysetInfo_);
+    for (const auto& id : copysetIds) {
+        const auto key = CalcLogicPoolCopysetID(poolId, id);
+        if (lpcsid2CopsetInfoMap_.count(key) == 0) {
+            uncached.push_back(id);
+        }
+    }
+    return uncached;
+}
+
 void MetaCache::UpdateChunkInfoByID(ChunkID cid, const ChunkIDInfo& cidinfo) {
     WriteLockGuard wrlk(rwlock4chunkInfoMap_);
     chunkid2chunkInfoMap_[cid] = cidinfo;
@@ -435,5 +541,340 @@ void MetaCache::CleanChunksInSegment(SegmentIndex segmentIndex) {
     }
 }
 
+uint32_t MetaCache::GetSegmentPrefetchNum(SegmentIndex segmentIndex) const {
+    int64_t last = lastAllocatedSegment_.load(std::memory_order_relaxed);
+    if (last >= 0 && static_cast<int64_t>(segmentIndex) == last + 1) {
+        return metacacheopt_.segmentPrefetchNum;
+    }
+    return 0;
+}
+
+void MetaCache::UpdateLastAllocatedSegment(SegmentIndex segmentIndex) {
+    lastAllocatedSegment_.store(segmentIndex, std::memory_order_relaxed);
+}
+
+std::string MetaCache::GetPersistPath() const {
+    return metacacheopt_.persistDir + "/" + std::to_string(fileInfo_.id);
+}
+
+std::string MetaCache::BuildPersistContent() {
+    std::ostringstream oss;
+    oss << kPersistMagic << " " << fileInfo_.id << " " << fileInfo_.ctime
+        << "\n";
+
+    {
+        ReadLockGuard rdlk(rwlock4CopysetInfo_);
+        for (const auto& item : lpcsid2CopsetInfoMap_) {
+            const auto& copyset = item.second;
+            if (!copyset.IsValid()) {
+                continue;
+            }
+            oss << "S " << copyset.lpid_ << " " << copyset.cpid_ << " "
+                << copyset.leaderindex_ << " " << copyset.csinfos_.size();
+            for (const auto& peer : copyset.csinfos_) {
+                oss << " " << peer.peerID << " "
+                    << peer.internalAddr.ToString() << " "
+                    << peer.externalAddr.ToString();
+            }
+            oss << "\n";
+        }
+    }
+
+    if (fileInfo_.chunksize == 0 ||
+        fileInfo_.segmentsize < fileInfo_.chunksize) {
+        return oss.str();
+    }
+
+    // only segments with all chunks allocated and cached are persisted
+    const uint64_t chunksPerSegment =
+        fileInfo_.segmentsize / fileInfo_.chunksize;
+    std::map<SegmentIndex, std::vector<ChunkIDInfo>> segments;
+    {
+        ReadLockGuard rdlk(rwlock4ChunkInfo_);
+        for (const auto& item : chunkindex2idMap_) {
+            if (!item.second.chunkExist) {
+                continue;
+            }
+            auto& chunks = segments[item.first / chunksPerSegment];
+            chunks.resize(chunksPerSegment);
+            chunks[item.first % chunksPerSegment] = item.second;
+        }
+    }
+
+    for (const auto& item : segments) {
+        const auto& chunks = item.second;
+        const LogicPoolID lpid = chunks.front().lpid_;
+        bool complete = std::all_of(chunks.begin(), chunks.end(),
+                                    [lpid](const ChunkIDInfo& chunk) {
+                                        return chunk.Valid() &&
+                                               chunk.lpid_ == lpid;
+                                    });
+        if (!complete) {
+            continue;
+        }
+        oss << "G " << item.first << " " << lpid;
+        for (const auto& chunk : chunks) {
+            oss << " " << chunk.cid_ << " " << chunk.cpid_;
+        }
+        oss << "\n";
+    }
+    return oss.str();
+}
+
+int MetaCache::Persist() {
+    if (metacacheopt_.persistDir.empty() || fileInfo_.id == 0) {
+        return 0;
+    }
+
+    // go through the persist thread and wait, so that it's not
+    // overwritten by a periodic persist still in queue
+    auto done = std::make_shared<std::promise<int>>();
+    std::future<int> future = done->get_future();
+    std::string path = GetPersistPath();
+    std::string content = BuildPersistContent();
+    std::string filename = fileInfo_.fullPathName;
+    GetPersistThread()->Enqueue([=]() {
+        done->set_value(WritePersistFile(path, content, filename));
+    });
+
+    int ret = future.get();
+    if (ret == 0) {
+        lastPersistTime_.store(TimeUtility::GetTimeofDaySec(),
+                               std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+void MetaCache::PersistIfExpired() {
+    if (metacacheopt_.persistDir.empty() ||
+        metacacheopt_.persistIntervalS == 0) {
+        return;
+    }
+
+    if (fileInfo_.id == 0) {
+        return;
+    }
+
+    uint64_t now = TimeUtility::GetTimeofDaySec();
+    if (now < lastPersistTime_.load(std::memory_order_relaxed) +
+                  metacacheopt_.persistIntervalS) {
+        return;
+    }
+    lastPersistTime_.store(now, std::memory_order_relaxed);
+
+    // called from the lease refresh bthread, don't wait for the file io
+    std::string path = GetPersistPath();
+    std::string content = BuildPersistContent();
+    std::string filename = fileInfo_.fullPathName;
+    GetPersistThread()->Enqueue([path, content, filename]() {
+        WritePersistFile(path, content, filename);
+    });
+}
+
+bool MetaCache::LoadPersisted() {
+    if (metacacheopt_.persistDir.empty() || fileInfo_.id == 0) {
+        return false;
+    }
+
+    const std::string path = GetPersistPath();
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+
+    // count persist interval from open
+    lastPersistTime_.store(TimeUtility::GetTimeofDaySec(),
+                           std::memory_order_relaxed);
+
+    std::string line;
+    std::string magic;
+    uint64_t inodeId = 0;
+    uint64_t ctime = 0;
+    if (!std::getline(in, line) ||
+        !(std::istringstream(line) >> magic >> inodeId >> ctime) ||
+        magic != kPersistMagic || inodeId != fileInfo_.id ||
+        ctime != fileInfo_.ctime) {
+        LOG(WARNING) << "Persisted metacache mismatch, drop it, filename = "
+                     << fileInfo_.fullPathName << ", path = " << path;
+        in.close();
+        std::remove(path.c_str());
+        return false;
+    }
+
+    uint64_t loadedCopysets = 0;
+    std::map<SegmentIndex, std::vector<ChunkIDInfo>> segments;
+
+    while (std::getline(in, line)) {
+        std::istringstream iss(line);
+        std::string type;
+        iss >> type;
+        if (type == "G") {
+            SegmentIndex index = 0;
+            LogicPoolID lpid = 0;
+            if (!(iss >> index >> lpid)) {
+                continue;
+            }
+            std::vector<ChunkIDInfo> chunks;
+            ChunkID cid = 0;
+            CopysetID cpid = 0;
+            while (iss >> cid >> cpid) {
+                chunks.emplace_back(cid, lpid, cpid);
+            }
+            segments[index].swap(chunks);
+        } else if (type == "S") {
+            CopysetInfo<ChunkServerID> copyset;
+            uint32_t peerNum = 0;
+            if (!(iss >> copyset.lpid_ >> copyset.cpid_ >>
+                  copyset.leaderindex_ >> peerNum)) {
+                continue;
+            }
+
+            bool valid = true;
+            for (uint32_t i = 0; i < peerNum && valid; ++i) {
+                CopysetPeerInfo<ChunkServerID> peer;
+                std::string internal;
+                std::string external;
+                valid = static_cast<bool>(iss >> peer.peerID >> internal >>
+                                          external) &&
+                        peer.internalAddr.Parse(internal) == 0 &&
+                        peer.externalAddr.Parse(external) == 0;
+                copyset.csinfos_.push_back(peer);
+            }
+            if (!valid || !copyset.IsValid()) {
+                continue;
+            }
+            if (copyset.leaderindex_ >=
+                static_cast<int>(copyset.csinfos_.size())) {
+                copyset.leaderindex_ = -1;
+            }
+
+            for (const auto& peer : copyset.csinfos_) {
+                AddCopysetIDInfo(peer.peerID,
+                                 CopysetIDInfo(copyset.lpid_, copyset.cpid_));
+            }
+            const auto key = CalcLogicPoolCopysetID(copyset.lpid_,
+                                                    copyset.cpid_);
+            WriteLockGuard wrlk(rwlock4CopysetInfo_);
+            lpcsid2CopsetInfoMap_.emplace(key, std::move(copyset));
+            ++loadedCopysets;
+        }
+    }
+
+    in.close();
+    // persisted info may become stale once this open modified the file,
+    // it will be persisted again by this open
+    std::remove(path.c_str());
+
+    uint64_t loadedSegments = LoadPersistedSegments(segments);
+
+    LOG(INFO) << "Load persisted metacache success, filename = "
+              << fileInfo_.fullPathName << ", copysets = " << loadedCopysets
+              << ", segments = " << loadedSegments << "/"
+              << segments.size();
+    return true;
+}
+
+uint64_t MetaCache::LoadPersistedSegments(
+    const std::map<SegmentIndex, std::vector<ChunkIDInfo>>& segments) {
+    if (segments.empty() || mdsclient_ == nullptr) {
+        return 0;
+    }
+
+    const uint64_t segmentSize = fileInfo_.segmentsize;
+    const uint64_t chunksPerSegment = segmentSize / fileInfo_.chunksize;
+    std::vector<uint64_t> offsets;
+    for (const auto& item : segments) {
+        uint64_t offset = static_cast<uint64_t>(item.first) * segmentSize;
+        if (item.second.size() == chunksPerSegment &&
+            offset + segmentSize <= fileInfo_.length) {
+            offsets.push_back(offset);
+        }
+    }
+
+    // get the segments from mds in batches, and only keep the persisted
+    // ones which are still the same as on mds
+    std::vector<SegmentInfo> matched;
+    for (size_t begin = 0; begin < offsets.size();
+         begin += kMaxSegmentsPerRequest) {
+        size_t end = std::min(offsets.size(), begin + kMaxSegmentsPerRequest);
+        std::vector<uint64_t> batch(offsets.begin() + begin,
+                                    offsets.begin() + end);
+        std::vector<SegmentInfo> infos;
+        LIBCURVE_ERROR ret = mdsclient_->GetOrAllocateSegments(
+            false, batch, &fileInfo_, &fEpoch_, &infos);
+        if (ret != LIBCURVE_ERROR::OK) {
+            LOG(INFO) << "Get persisted segments from mds failed, ret = "
+                      << ret << ", filename = " << fileInfo_.fullPathName;
+            break;
+        }
+
+        for (auto& info : infos) {
+            auto it = segments.find(info.startoffset / segmentSize);
+            if (it == segments.end() ||
+                it->second.size() != info.chunkvec.size() ||
+                !std::equal(it->second.begin(), it->second.end(),
+                            info.chunkvec.begin(),
+                            [](const ChunkIDInfo& a, const ChunkIDInfo& b) {
+                                return a.cid_ == b.cid_ &&
+                                       a.lpid_ == b.lpid_ &&
+                                       a.cpid_ == b.cpid_;
+                            })) {
+                continue;
+            }
+            matched.emplace_back(std::move(info));
+        }
+    }
+
+    // chunks can't be used without the server list of their copysets
+    std::map<LogicPoolID, std::set<CopysetID>> copysets;
+    for (const auto& info : matched) {
+        auto& ids = copysets[info.lpcpIDInfo.lpid];
+        for (const auto& chunk : info.chunkvec) {
+            ids.insert(chunk.cpid_);
+        }
+    }
+    for (const auto& item : copysets) {
+        std::vector<CopysetID> uncached = GetUncachedCopysets(
+            item.first,
+            std::vector<CopysetID>(item.second.begin(), item.second.end()));
+        if (uncached.empty()) {
+            continue;
+        }
+        std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
+        if (mdsclient_->GetServerList(item.first, uncached, &copysetInfos) !=
+            LIBCURVE_ERROR::OK) {
+            continue;
+        }
+        for (const auto& copysetInfo : copysetInfos) {
+            for (const auto& peerInfo : copysetInfo.csinfos_) {
+                AddCopysetIDInfo(peerInfo.peerID,
+                                 CopysetIDInfo(item.first, copysetInfo.cpid_));
+            }
+        }
+        AddCopysetsInfo(item.first, std::move(copysetInfos));
+    }
+
+    uint64_t loaded = 0;
+    for (const auto& info : matched) {
+        std::vector<CopysetID> cpids;
+        for (const auto& chunk : info.chunkvec) {
+            cpids.push_back(chunk.cpid_);
+        }
+        if (!GetUncachedCopysets(info.lpcpIDInfo.lpid, cpids).empty()) {
+            continue;
+        }
+        ChunkIndex index = info.startoffset / fileInfo_.chunksize;
+        for (const auto& chunk : info.chunkvec) {
+            UpdateChunkInfoByIndex(index++, chunk);
+        }
+        if (info.dirtySeqNum != 0) {
+            GetFileSegment(info.startoffset / segmentSize)
+                ->UpdateDirtySeqNum(info.dirtySeqNum);
+        }
+        ++loaded;
+    }
+    return loaded;
+}
+
 }   // namespace client
 }   // namespace curve
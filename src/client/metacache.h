@@ -22,6 +22,8 @@
 #ifndef SRC_CLIENT_METACACHE_H_
 #define SRC_CLIENT_METACACHE_H_
 
+#include <atomic>
+#include <map>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -130,6 +132,10 @@ class MetaCache {
         LogicPoolID poolId,
         std::vector<CopysetInfo<ChunkServerID>>&& copysetsInfo);
 
+    // Get copysets in copysetIds whose info is not cached yet
+    std::vector<CopysetID> GetUncachedCopysets(
+        LogicPoolID poolId, const std::vector<CopysetID>& copysetIds);
+
     /**
      * 通过chunk id更新chunkid信息
      * @param: cid为chunkid
@@ -238,7 +244,57 @@ class MetaCache {
      */
     virtual void CleanChunksInSegment(SegmentIndex segmentIndex);
 
+    /**
+     * @brief Get the number of following segments which should be allocated
+     *        together with segmentIndex
+     * @return segmentPrefetchNum if segmentIndex directly follows the last
+     *         allocated segment, otherwise 0
+     */
+    uint32_t GetSegmentPrefetchNum(SegmentIndex segmentIndex) const;
+
+    /**
+     * @brief Record the last segment allocated from mds, used to detect
+     *        sequential allocation
+     */
+    void UpdateLastAllocatedSegment(SegmentIndex segmentIndex);
+
+    /**
+     * @brief Persist copyset info and chunk ids of fully cached segments
+     *        of current file into metacache.persistDir, so that next open
+     *        can skip querying mds for them one by one
+     * @return 0 if succeeded or persist is disabled, otherwise -1
+     */
+    int Persist();
+
+    /**
+     * @brief Persist in background if persistIntervalS has elapsed since
+     *        last persist, it doesn't wait for the file io
+     */
+    void PersistIfExpired();
+
+    /**
+     * @brief Load info persisted by last open of current file, and remove
+     *        the persisted file so that it will be used only once.
+     *        Copyset info is validated lazily by redirect response or
+     *        leader refresh like other cached copysets, persisted segments
+     *        are got from mds in batches and dropped if they changed
+     * @return true if persisted info is loaded
+     */
+    bool LoadPersisted();
+
  private:
+    /**
+     * @brief Cache the persisted segments which are still the same as on
+     *        mds, together with the server lists of their copysets
+     * @return the number of segments cached
+     */
+    uint64_t LoadPersistedSegments(
+        const std::map<SegmentIndex, std::vector<ChunkIDInfo>>& segments);
+
+    std::string GetPersistPath() const;
+
+    std::string BuildPersistContent();
+
     /**
      * @brief 从mds更新copyset复制组信息
      * @param logicPoolId 逻辑池id
@@ -308,6 +364,12 @@ class MetaCache {
     FileEpoch fEpoch_;
 
     UnstableHelper unstableHelper_;
+
+    // index of the last segment allocated from mds, -1 means none
+    std::atomic<int64_t> lastAllocatedSegment_{-1};
+
+    // time of last persist in seconds
+    std::atomic<uint64_t> lastPersistTime_{0};
 };
 
 }  // namespace client
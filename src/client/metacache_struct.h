@@ -23,6 +23,7 @@
 #ifndef SRC_CLIENT_METACACHE_STRUCT_H_
 #define SRC_CLIENT_METACACHE_STRUCT_H_
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -319,6 +320,22 @@ class FileSegment {
 
     void ClearBitmap() { discardBitmap_.Clear(); }
 
+    /**
+     * @brief Get the seqnum of the latest write recorded by mds
+     * @return 0 if unknown
+     */
+    uint64_t GetDirtySeqNum() const {
+        return dirtySeqNum_.load(std::memory_order_acquire);
+    }
+
+    void UpdateDirtySeqNum(uint64_t seq) {
+        uint64_t cur = dirtySeqNum_.load(std::memory_order_relaxed);
+        while (cur < seq && !dirtySeqNum_.compare_exchange_weak(
+                                cur, seq, std::memory_order_release,
+                                std::memory_order_relaxed)) {
+        }
+    }
+
  private:
     const SegmentIndex segmentIndex_;
     const uint32_t segmentSize_;
@@ -326,6 +343,7 @@ class FileSegment {
     BthreadRWLock rwlock_;
     Bitmap discardBitmap_;
     std::unordered_map<ChunkIndex, ChunkIDInfo> chunks_;
+    std::atomic<uint64_t> dirtySeqNum_{0};
 };
 
 inline void FileSegment::SetBitmap(const uint64_t offset,
@@ -137,6 +137,9 @@ void ServiceHelper::ProtoFileInfo2Local(const curve::mds::FileInfo& finfo,
     if (finfo.has_poolset()) {
         fi->poolset = finfo.poolset();
     }
+    if (finfo.has_dirtytrackingseqnum()) {
+        fi->dirtyTrackingSeqNum = finfo.dirtytrackingseqnum();
+    }
 
     fEpoch->fileId = finfo.id();
     if (finfo.has_epoch()) {
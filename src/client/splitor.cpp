@@ -25,6 +25,8 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -176,10 +178,18 @@ bool Splitor::AssignInternal(IOTracker* iotracker, MetaCache* metaCache,
     if (errCode == MetaCacheErrorType::OK) {
         int ret = 0;
 
+        // the seqnum may be refreshed meanwhile, write with the marked one
+        uint64_t seq = fileInfo->seqnum;
+        if (iotracker->Optype() == OpType::WRITE &&
+            !MarkSegmentDirty(fileSegment, segmentIndex, seq, mdsclient,
+                              fileInfo)) {
+            return false;
+        }
+
         std::vector<RequestContext*> templist;
         ret = SingleChunkIO2ChunkRequests(iotracker, metaCache, &templist,
                                           chunkIdInfo, data, off, len,
-                                          fileInfo->seqnum);
+                                          seq);
 
         for (auto& ctx : templist) {
             ctx->fileId_ = fileInfo->id;
@@ -217,6 +227,16 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
                                    const FInfo* fileInfo,
                                    const FileEpoch_t *fEpoch,
                                    ChunkIndex chunkidx) {
+    const SegmentIndex segmentIndex = offset / fileInfo->segmentsize;
+    if (allocateIfNotExist) {
+        uint32_t prefetchNum = metaCache->GetSegmentPrefetchNum(segmentIndex);
+        if (prefetchNum > 0 &&
+            GetOrAllocateSegments(offset, prefetchNum, mdsClient, metaCache,
+                                  fileInfo, fEpoch)) {
+            return true;
+        }
+    }
+
     SegmentInfo segmentInfo;
     LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegment(
         allocateIfNotExist, offset, fileInfo, fEpoch, &segmentInfo);
@@ -241,6 +261,101 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
         }
     }
 
+    UpdateChunkInfos(segmentInfo, metaCache, fileInfo);
+    if (!UpdateServerList(segmentInfo.lpcpIDInfo.lpid,
+                          segmentInfo.lpcpIDInfo.cpidVec, mdsClient,
+                          metaCache)) {
+        return false;
+    }
+
+    if (allocateIfNotExist) {
+        metaCache->UpdateLastAllocatedSegment(segmentIndex);
+    }
+
+    return true;
+}
+
+bool Splitor::GetOrAllocateSegments(uint64_t offset,
+                                    uint32_t prefetchNum,
+                                    MDSClient* mdsClient,
+                                    MetaCache* metaCache,
+                                    const FInfo* fileInfo,
+                                    const FileEpoch_t* fEpoch) {
+    const uint64_t segmentSize = fileInfo->segmentsize;
+    const SegmentIndex segmentIndex = offset / segmentSize;
+
+    // the current segment and the following segments which are neither
+    // beyond the file length nor cached yet
+    std::vector<uint64_t> offsets;
+    offsets.push_back(static_cast<uint64_t>(segmentIndex) * segmentSize);
+    for (uint32_t i = 1; i <= prefetchNum; ++i) {
+        uint64_t segOffset =
+            static_cast<uint64_t>(segmentIndex + i) * segmentSize;
+        if (segOffset >= fileInfo->length) {
+            break;
+        }
+
+        ChunkIDInfo chunkIdInfo;
+        if (metaCache->GetChunkInfoByIndex(segOffset / fileInfo->chunksize,
+                                           &chunkIdInfo) ==
+                MetaCacheErrorType::OK &&
+            chunkIdInfo.chunkExist) {
+            break;
+        }
+        offsets.push_back(segOffset);
+    }
+
+    if (offsets.size() == 1) {
+        return false;
+    }
+
+    std::vector<SegmentInfo> segmentInfos;
+    LIBCURVE_ERROR errCode = mdsClient->GetOrAllocateSegments(
+        true, offsets, fileInfo, fEpoch, &segmentInfos);
+    if (errCode == LIBCURVE_ERROR::NOT_SUPPORT) {
+        return false;
+    }
+    if (errCode != LIBCURVE_ERROR::OK ||
+        segmentInfos.size() != offsets.size()) {
+        LOG(WARNING) << "GetOrAllocateSegments failed, fallback to allocate "
+                     << "single segment, filename: " << fileInfo->filename
+                     << ", offset: " << offset
+                     << ", count: " << offsets.size();
+        return false;
+    }
+
+    // copysets of all segments are fetched from mds once per logical pool
+    std::map<LogicPoolID, std::set<CopysetID>> copysets;
+    for (const auto& segmentInfo : segmentInfos) {
+        SegmentIndex index = segmentInfo.startoffset / segmentSize;
+        if (index == segmentIndex) {
+            // caller already holds the read lock of current segment
+            UpdateChunkInfos(segmentInfo, metaCache, fileInfo);
+        } else {
+            FileSegment* fileSegment = metaCache->GetFileSegment(index);
+            FileSegmentReadLockGuard lk(fileSegment);
+            UpdateChunkInfos(segmentInfo, metaCache, fileInfo);
+        }
+
+        auto& ids = copysets[segmentInfo.lpcpIDInfo.lpid];
+        ids.insert(segmentInfo.lpcpIDInfo.cpidVec.begin(),
+                   segmentInfo.lpcpIDInfo.cpidVec.end());
+    }
+
+    for (const auto& item : copysets) {
+        std::vector<CopysetID> cpidVec(item.second.begin(), item.second.end());
+        if (!UpdateServerList(item.first, cpidVec, mdsClient, metaCache)) {
+            return false;
+        }
+    }
+
+    metaCache->UpdateLastAllocatedSegment(offsets.back() / segmentSize);
+    return true;
+}
+
+void Splitor::UpdateChunkInfos(const SegmentInfo& segmentInfo,
+                               MetaCache* metaCache,
+                               const FInfo* fileInfo) {
     const auto chunksize = fileInfo->chunksize;
     uint32_t count = 0;
     for (const auto& chunkIdInfo : segmentInfo.chunkvec) {
@@ -250,19 +365,65 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
         ++count;
     }
 
+    if (segmentInfo.dirtySeqNum != 0) {
+        metaCache->GetFileSegment(segmentInfo.startoffset /
+                                  fileInfo->segmentsize)
+            ->UpdateDirtySeqNum(segmentInfo.dirtySeqNum);
+    }
+}
+
+bool Splitor::MarkSegmentDirty(FileSegment* fileSegment,
+                               SegmentIndex segmentIndex, uint64_t seq,
+                               MDSClient* mdsClient,
+                               const FInfo_t* fileInfo) {
+    if (fileInfo->dirtyTrackingSeqNum == 0 ||
+        fileSegment->GetDirtySeqNum() >= seq) {
+        return true;
+    }
+
+    std::vector<uint64_t> offsets{static_cast<uint64_t>(segmentIndex) *
+                                  fileInfo->segmentsize};
+    LIBCURVE_ERROR errCode =
+        mdsClient->MarkSegmentsDirty(fileInfo, offsets, seq);
+    if (errCode == LIBCURVE_ERROR::NOT_SUPPORT) {
+        // mds without the rpc doesn't track the file either
+        fileSegment->UpdateDirtySeqNum(seq);
+        return true;
+    }
+    if (errCode != LIBCURVE_ERROR::OK) {
+        LOG(ERROR) << "MarkSegmentsDirty failed, filename: "
+                   << fileInfo->filename << ", offset: " << offsets[0]
+                   << ", seq: " << seq;
+        return false;
+    }
+
+    fileSegment->UpdateDirtySeqNum(seq);
+    return true;
+}
+
+bool Splitor::UpdateServerList(LogicPoolID lpid,
+                               const std::vector<CopysetID>& cpidVec,
+                               MDSClient* mdsClient,
+                               MetaCache* metaCache) {
+    // copysets are shared by many segments, and may be loaded from the
+    // persisted metacache, only get the ones not cached yet
+    std::vector<CopysetID> uncached =
+        metaCache->GetUncachedCopysets(lpid, cpidVec);
+    if (uncached.empty()) {
+        return true;
+    }
+
     std::vector<CopysetInfo<ChunkServerID>> copysetInfos;
-    errCode = mdsClient->GetServerList(segmentInfo.lpcpIDInfo.lpid,
-                                       segmentInfo.lpcpIDInfo.cpidVec,
-                                       &copysetInfos);
+    LIBCURVE_ERROR errCode =
+        mdsClient->GetServerList(lpid, uncached, &copysetInfos);
 
     if (errCode == LIBCURVE_ERROR::FAILED) {
         std::string failedCopysets;
-        for (const auto& id : segmentInfo.lpcpIDInfo.cpidVec) {
+        for (const auto& id : uncached) {
             failedCopysets.append(std::to_string(id)).append(",");
         }
 
-        LOG(ERROR) << "GetServerList failed, logicpool id: "
-                   << segmentInfo.lpcpIDInfo.lpid
+        LOG(ERROR) << "GetServerList failed, logicpool id: " << lpid
                    << ", copysets: " << failedCopysets;
 
         return false;
@@ -271,13 +432,11 @@ bool Splitor::GetOrAllocateSegment(bool allocateIfNotExist,
     for (const auto& copysetInfo : copysetInfos) {
         for (const auto& peerInfo : copysetInfo.csinfos_) {
             metaCache->AddCopysetIDInfo(
-                peerInfo.peerID,
-                CopysetIDInfo(segmentInfo.lpcpIDInfo.lpid, copysetInfo.cpid_));
+                peerInfo.peerID, CopysetIDInfo(lpid, copysetInfo.cpid_));
         }
     }
 
-    metaCache->AddCopysetsInfo(segmentInfo.lpcpIDInfo.lpid,
-                               std::move(copysetInfos));
+    metaCache->AddCopysetsInfo(lpid, std::move(copysetInfos));
 
     return true;
 }
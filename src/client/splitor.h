@@ -135,6 +135,40 @@ class Splitor {
                                      const FileEpoch_t *fEpoch,
                                      ChunkIndex chunkidx);
 
+    /**
+     * @brief Get or allocate the segment at offset together with at most
+     *        prefetchNum following segments in one rpc
+     * @return true if all segments are allocated and cached, otherwise
+     *         false and caller should fallback to allocate single segment
+     */
+    static bool GetOrAllocateSegments(uint64_t offset,
+                                      uint32_t prefetchNum,
+                                      MDSClient* mdsClient,
+                                      MetaCache* metaCache,
+                                      const FInfo* fileInfo,
+                                      const FileEpoch_t* fEpoch);
+
+    static void UpdateChunkInfos(const SegmentInfo& segmentInfo,
+                                 MetaCache* metaCache,
+                                 const FInfo* fileInfo);
+
+    static bool UpdateServerList(LogicPoolID lpid,
+                                 const std::vector<CopysetID>& cpidVec,
+                                 MDSClient* mdsClient,
+                                 MetaCache* metaCache);
+
+    /**
+     * @brief Tell mds that the segment is going to be written with seq if
+     *        the file is tracked and the segment is not marked with it yet,
+     *        so that snapshots can skip the segments not written since
+     * @return false if marking failed and the write should fail
+     */
+    static bool MarkSegmentDirty(FileSegment* fileSegment,
+                                 SegmentIndex segmentIndex,
+                                 uint64_t seq,
+                                 MDSClient* mdsClient,
+                                 const FInfo_t* fileInfo);
+
     static int SplitForNormal(IOTracker* iotracker, MetaCache* metaCache,
                               std::vector<RequestContext*>* targetlist,
                               butil::IOBuf* data, off_t offset, size_t length,
@@ -320,6 +320,31 @@ class ARCCache : public LRUCacheInterface<K, V> {
 
     bool Replace(const K& k, V* eliminated);
 
+    // Write lock guard which only pays for timing when the lock is
+    // contended, the wait time is reported to cacheMetrics_
+    class MeteredWriteLockGuard {
+     public:
+        MeteredWriteLockGuard(::curve::common::RWLock* lock,
+                              CacheMetrics* metrics)
+            : lock_(lock) {
+            if (metrics == nullptr) {
+                lock_->WRLock();
+                return;
+            }
+            if (lock_->TryWRLock() == 0) {
+                return;
+            }
+            uint64_t start = ::curve::common::TimeUtility::GetTimeofDayUs();
+            lock_->WRLock();
+            metrics->OnLockWait(
+                ::curve::common::TimeUtility::GetTimeofDayUs() - start);
+        }
+        ~MeteredWriteLockGuard() { lock_->Unlock(); }
+
+     private:
+        ::curve::common::RWLock* lock_;
+    };
+
     mutable ::curve::common::RWLock lock_;
     uint64_t c_;
     uint64_t p_;
@@ -330,7 +355,7 @@ class ARCCache : public LRUCacheInterface<K, V> {
 
 template <typename K, typename V, typename KeyTraits, typename ValueTraits>
 bool ARCCache<K, V, KeyTraits, ValueTraits>::Get(const K& key, V* value) {
-    ::curve::common::WriteLockGuard guard(lock_);
+    MeteredWriteLockGuard guard(&lock_, cacheMetrics_.get());
     tmap_iter it;
 
     if (t1_.Find(key, &it)) {
@@ -363,7 +388,7 @@ void ARCCache<K, V, KeyTraits, ValueTraits>::Put(const K& key, const V& value) {
 template <typename K, typename V, typename KeyTraits, typename ValueTraits>
 bool ARCCache<K, V, KeyTraits, ValueTraits>::Put(const K& key, const V& value,
                                                  V* eliminated) {
-    ::curve::common::WriteLockGuard guard(lock_);
+    MeteredWriteLockGuard guard(&lock_, cacheMetrics_.get());
     tmap_iter it;
     bool ret = false;
 
@@ -461,7 +486,7 @@ ARCCache<K, V, KeyTraits, ValueTraits>::ArcSize() const {
 // This operation detach the key from cache
 template <typename K, typename V, typename KeyTraits, typename ValueTraits>
 void ARCCache<K, V, KeyTraits, ValueTraits>::Remove(const K& key) {
-    ::curve::common::WriteLockGuard guard(lock_);
+    MeteredWriteLockGuard guard(&lock_, cacheMetrics_.get());
     T* ts[]{&t1_, &t2_};
     for (auto t : ts) {
         tmap_iter it;
@@ -43,7 +43,9 @@ class CacheMetrics {
       : cacheCount(metricPrefix, "cache_count"),
         cacheBytes(metricPrefix, "cache_bytes"),
         cacheHit(metricPrefix, "cache_hit"),
-        cacheMiss(metricPrefix, "cache_miss") {}
+        cacheMiss(metricPrefix, "cache_miss"),
+        lockWaitCount(metricPrefix, "cache_lock_wait_count"),
+        lockWaitUs(metricPrefix, "cache_lock_wait_us") {}
 
     void UpdateAddToCacheCount() {
         cacheCount << 1;
@@ -74,11 +76,19 @@ class CacheMetrics {
         cacheMiss << 1;
     }
 
+    // called when an operation found the cache lock held by others
+    void OnLockWait(uint64_t waitUs) {
+        lockWaitCount << 1;
+        lockWaitUs << waitUs;
+    }
+
  public:
     bvar::Adder<uint32_t> cacheCount;
     bvar::Adder<uint64_t> cacheBytes;
     bvar::Adder<uint64_t> cacheHit;
     bvar::Adder<uint64_t> cacheMiss;
+    bvar::Adder<uint64_t> lockWaitCount;
+    bvar::Adder<uint64_t> lockWaitUs;
 };
 
 template<class T>
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-11
+ */
+
+#ifndef SRC_COMMON_SHARDED_CACHE_H_
+#define SRC_COMMON_SHARDED_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "src/common/lru_cache.h"
+
+namespace curve {
+namespace common {
+
+// ShardedARCCache splits keys into several independent ARCCache by key hash,
+// so that concurrent accesses to different keys seldom contend on the same
+// lock. All shards share one CacheMetrics, the capacity is divided evenly.
+template <typename K, typename V,
+          typename KeyTraits = CacheTraits<K>,
+          typename ValueTraits = CacheTraits<V>,
+          typename Hash = std::hash<K>>
+class ShardedARCCache : public LRUCacheInterface<K, V> {
+ public:
+    using Shard = ARCCache<K, V, KeyTraits, ValueTraits>;
+
+    /**
+     * @param[in] shardNum number of shards, 0 is treated as 1
+     * @param[in] maxCount total capacity of all shards
+     * @param[in] cacheMetrics metrics shared by all shards
+     */
+    ShardedARCCache(uint32_t shardNum, uint64_t maxCount,
+                    std::shared_ptr<CacheMetrics> cacheMetrics = nullptr)
+        : cacheMetrics_(cacheMetrics) {
+        if (shardNum == 0) {
+            shardNum = 1;
+        }
+        uint64_t shardCapacity = (maxCount + shardNum - 1) / shardNum;
+        if (shardCapacity == 0) {
+            shardCapacity = 1;
+        }
+        shards_.reserve(shardNum);
+        for (uint32_t i = 0; i < shardNum; i++) {
+            shards_.emplace_back(new Shard(shardCapacity, cacheMetrics));
+        }
+    }
+
+    void Put(const K &key, const V &value) override {
+        GetShard(key)->Put(key, value);
+    }
+
+    bool Put(const K &key, const V &value, V *eliminated) override {
+        return GetShard(key)->Put(key, value, eliminated);
+    }
+
+    bool Get(const K &key, V *value) override {
+        return GetShard(key)->Get(key, value);
+    }
+
+    void Remove(const K &key) override {
+        GetShard(key)->Remove(key);
+    }
+
+    uint64_t Size() override {
+        uint64_t size = 0;
+        for (auto &shard : shards_) {
+            size += shard->Size();
+        }
+        return size;
+    }
+
+    uint64_t Capacity() const {
+        uint64_t capacity = 0;
+        for (const auto &shard : shards_) {
+            capacity += shard->Capacity();
+        }
+        return capacity;
+    }
+
+    uint32_t ShardNum() const {
+        return shards_.size();
+    }
+
+    std::shared_ptr<CacheMetrics> GetCacheMetrics() const {
+        return cacheMetrics_;
+    }
+
+ private:
+    Shard *GetShard(const K &key) {
+        return shards_[Hash()(key) % shards_.size()].get();
+    }
+
+ private:
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::shared_ptr<CacheMetrics> cacheMetrics_;
+};
+
+}  // namespace common
+}  // namespace curve
+
+#endif  // SRC_COMMON_SHARDED_CACHE_H_
@@ -22,8 +22,11 @@
 
 #include "src/common/throttle.h"
 
+#include <bthread/condition_variable.h>
+#include <bthread/mutex.h>
 #include <glog/logging.h>
 
+#include <mutex>  // NOLINT
 #include <ostream>
 #include <string>
 #include <utility>
@@ -55,7 +58,52 @@ const std::vector<Throttle::Type> kDefaultEnabledThrottleTypes = {
     Throttle::Type::IOPS_WRITE, Throttle::Type::BPS_TOTAL,
     Throttle::Type::BPS_READ,   Throttle::Type::BPS_WRITE};
 
-Throttle::Throttle() : throttleParams_(), throttles_() {
+class Throttle::AddClosure : public google::protobuf::Closure {
+ public:
+    AddClosure(Throttle* throttle, bool isRead, uint64_t length,
+               google::protobuf::Closure* done)
+        : throttle(throttle), isRead(isRead), length(length), next(0),
+          done(done) {}
+
+    void Run() override { throttle->ContinueAdd(this); }
+
+    Throttle* throttle;
+    bool isRead;
+    uint64_t length;
+    // index of next throttle to add tokens
+    size_t next;
+    google::protobuf::Closure* done;
+};
+
+namespace {
+
+// wake up the blocking Add when all throttles are satisfied
+class WaitClosure : public google::protobuf::Closure {
+ public:
+    WaitClosure() : mtx_(), cond_(), pass_(false) {}
+
+    void Run() override {
+        std::lock_guard<bthread::Mutex> lock(mtx_);
+        pass_ = true;
+        cond_.notify_one();
+    }
+
+    void Wait() {
+        std::unique_lock<bthread::Mutex> lock(mtx_);
+        while (!pass_) {
+            cond_.wait(lock);
+        }
+    }
+
+ private:
+    bthread::Mutex mtx_;
+    bthread::ConditionVariable cond_;
+    bool pass_;
+};
+
+}  // namespace
+
+Throttle::Throttle() : throttleParams_(), throttles_(), stopped_(false) {
     for (auto type : kDefaultEnabledThrottleTypes) {
         throttles_.emplace_back(
             type, false,
@@ -63,23 +111,59 @@ Throttle::Throttle() : throttleParams_(), throttles_() {
     }
 }
 
-void Throttle::Stop() { throttles_.clear(); }
+void Throttle::Stop() {
+    stopped_.store(true, std::memory_order_release);
+
+    std::vector<InternalThrottle> throttles;
+    {
+        WriteLockGuard lk(rwlock_);
+        throttles.swap(throttles_);
+    }
+
+    // destroying leaky bucket waits its timer task and runs its pending
+    // requests, which continue with ContinueAdd, so it can't hold the lock
+    throttles.clear();
+}
 
 void Throttle::Add(bool isReadOp, uint64_t length) {
-    for (auto& throttle : throttles_) {
-        if (!throttle.enabled) {
-            continue;
-        }
+    // share the path of async add, so blocked requests also go after stop
+    WaitClosure done;
+    Add(isReadOp, length, &done);
+    done.Wait();
+}
+
+void Throttle::Add(bool isReadOp, uint64_t length,
+                   google::protobuf::Closure* done) {
+    ContinueAdd(new AddClosure(this, isReadOp, length, done));
+}
 
-        auto tokens = CalcTokens(isReadOp, length, throttle.type);
-        if (tokens > 0) {
-            throttle.leakyBucket->Add(tokens);
+void Throttle::ContinueAdd(AddClosure* closure) {
+    {
+        ReadLockGuard lk(rwlock_);
+        while (!stopped_.load(std::memory_order_acquire) &&
+               closure->next < throttles_.size()) {
+            auto& throttle = throttles_[closure->next++];
+            if (!throttle.enabled) {
+                continue;
+            }
+
+            auto tokens = CalcTokens(closure->isRead, closure->length,
+                                     throttle.type);
+            if (tokens > 0 && throttle.leakyBucket->Add(tokens, closure)) {
+                // closure->Run() will continue from next throttle
+                return;
+            }
         }
     }
+
+    google::protobuf::Closure* done = closure->done;
+    delete closure;
+    done->Run();
 }
 
 void Throttle::ResetThrottleParams(Type type, uint64_t limit, uint64_t burst,
                                    uint64_t burstLength) {
+    WriteLockGuard lk(rwlock_);
     for (auto& throttle : throttles_) {
         if (throttle.type != type) {
             continue;
@@ -107,6 +191,7 @@ void Throttle::UpdateThrottleParams(const ReadWriteThrottleParams& params) {
 }
 
 bool Throttle::IsThrottleEnabled(Type type) const {
+    ReadLockGuard lk(rwlock_);
     for (auto& throttle : throttles_) {
         if (type != throttle.type) {
             continue;
@@ -23,11 +23,13 @@
 #ifndef SRC_COMMON_THROTTLE_H_
 #define SRC_COMMON_THROTTLE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "src/common/concurrent/rw_lock.h"
 #include "src/common/leaky_bucket.h"
 
 namespace curve {
@@ -69,7 +71,8 @@ class Throttle {
     ~Throttle() = default;
 
     /**
-     * @brief Stop all throttles, and let all blocked requests go
+     * @brief Stop all throttles, and let all blocked requests go.
+     *        Requests added after stop are not throttled
      */
     void Stop();
 
@@ -83,6 +86,18 @@ class Throttle {
      */
     void Add(bool isRead, uint64_t length);
 
+    /**
+     * @brief Async version of Add, it never blocks the caller.
+     *        done->Run() is called when all throttles are satisfied,
+     *        it may be called in current thread if no throttle needs to wait,
+     *        otherwise in the throttle's timer thread, so done should be
+     *        lightweight, e.g. dispatch the request to other threads
+     * @param isRead is read operations
+     * @param length io request's length
+     * @param done callback when all throttles are satisfied
+     */
+    void Add(bool isRead, uint64_t length, google::protobuf::Closure* done);
+
     /**
      * @brief Update throttle params
      * @param params throttle params
@@ -119,6 +134,15 @@ class Throttle {
      */
     uint64_t CalcTokens(bool isRead, uint64_t length, Type type) const;
 
+    class AddClosure;
+
+    /**
+     * @brief Add tokens to throttles starting from closure's next throttle,
+     *        stop at the first throttle that needs to wait, and it will be
+     *        continued by closure when the throttle is satisfied
+     */
+    void ContinueAdd(AddClosure* closure);
+
     bool IsWriteThrottle(Type type) const;
     bool IsReadThrottle(Type type) const;
     bool IsIOPSThrottle(Type type) const;
@@ -130,6 +154,14 @@ class Throttle {
     // iops-total/iops-read/iops-write/bps-total/bps-read/bps-write throttle
     // std::vector<std::pair<Type, common::LeakyBucketThrottle*>> throttles_;
     std::vector<InternalThrottle> throttles_;
+
+    // protect throttles_, pending requests are resumed from the timer thread
+    // of leaky bucket and may walk throttles_ while it is cleared by Stop()
+    mutable RWLock rwlock_;
+
+    // whether throttle is stopped, async requests resumed after stop will
+    // pass all remaining throttles directly
+    std::atomic<bool> stopped_;
 };
 
 }  // namespace common
@@ -199,14 +199,36 @@ int EtcdClientImp::TxnN(const std::vector<Operation> &ops) {
         } else if (ops.size() == 3) {
             errCode = EtcdClientTxn3(timeout_, ops[0], ops[1], ops[2]);
         } else {
-            LOG(ERROR) << "do not support Txn " << ops.size();
-            return EtcdErrCode::EtcdInvalidArgument;
+            int64_t revision;
+            return TxnNWithRevision(ops, &revision);
         }
         needRetry = NeedRetry(errCode);
     } while (needRetry && ++retry <= retryTimes_);
     return errCode;
 }
 
+int EtcdClientImp::TxnNWithRevision(const std::vector<Operation> &ops,
+    int64_t *revision) {
+    if (ops.empty() || ops.size() > kMaxTxnOps) {
+        LOG(ERROR) << "do not support Txn " << ops.size();
+        return EtcdErrCode::EtcdInvalidArgument;
+    }
+
+    bool needRetry = false;
+    int retry = 0;
+    int errCode;
+    do {
+        EtcdClientTxnN_return res = EtcdClientTxnN(timeout_,
+            const_cast<Operation*>(ops.data()), ops.size());
+        if (res.r0 == EtcdErrCode::EtcdOK) {
+            *revision = res.r1;
+        }
+        errCode = res.r0;
+        needRetry = NeedRetry(errCode);
+    } while (needRetry && ++retry <= retryTimes_);
+    return errCode;
+}
+
 int EtcdClientImp::GetCurrentRevision(int64_t *revision) {
     bool needRetry = false;
     int retry = 0;
@@ -30,6 +30,11 @@
 
 namespace curve {
 namespace kvstorage {
+
+// max number of operations in one transaction, the same as the default
+// value of etcd server option --max-txn-ops
+const size_t kMaxTxnOps = 128;
+
 class KVStorageClient {
  public:
     KVStorageClient() {}
@@ -112,7 +117,7 @@ class KVStorageClient {
         const std::string &key, int64_t *revision) = 0;
 
     /*
-    * @brief TxnN Operate transactions in the order of ops[0] ops[1] ..., currently 2 and 3 operations are supported //NOLINT
+    * @brief TxnN Operate transactions in the order of ops[0] ops[1] ..., up to kMaxTxnOps operations are supported //NOLINT
     *
     * @param[in] ops Operation set
     *
@@ -120,6 +125,17 @@ class KVStorageClient {
     */
     virtual int TxnN(const std::vector<Operation> &ops) = 0;
 
+    /*
+    * @brief TxnNWithRevision Same as TxnN, but also return the revision //NOLINT
+    *
+    * @param[in] ops Operation set
+    * @param[out] revision Version number of the transaction
+    *
+    * @return error code
+    */
+    virtual int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) = 0;
+
     /**
      * @brief CompareAndSwap Transaction, to achieve CAS
      *
@@ -174,6 +190,9 @@ class EtcdClientImp : public KVStorageClient {
 
     int TxnN(const std::vector<Operation> &ops) override;
 
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
     int CompareAndSwap(const std::string &key, const std::string &preV,
         const std::string &target) override;
 
@@ -0,0 +1,236 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-15
+ */
+
+#include "src/kvstorageclient/txn_batch_client.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::common::LockGuard;
+using ::curve::common::TimeUtility;
+using ::curve::common::UniqueLock;
+
+TxnBatchClient::TxnBatchClient(std::shared_ptr<KVStorageClient> client,
+                               const TxnBatchOption &option)
+    : client_(client), option_(option), running_(false) {
+    option_.maxBatchOps = std::min<uint32_t>(
+        std::max<uint32_t>(option_.maxBatchOps, 1), kMaxTxnOps);
+    txnCount_.expose_as("txn_batch_client", "txn_count");
+    mutationCount_.expose_as("txn_batch_client", "mutation_count");
+}
+
+TxnBatchClient::~TxnBatchClient() {
+    Stop();
+}
+
+void TxnBatchClient::Start() {
+    if (running_.exchange(true)) {
+        return;
+    }
+    commitThread_ = Thread(&TxnBatchClient::CommitLoop, this);
+    LOG(INFO) << "txn batch client started, maxBatchOps: "
+              << option_.maxBatchOps << ", maxDelayUs: " << option_.maxDelayUs;
+}
+
+void TxnBatchClient::Stop() {
+    {
+        LockGuard lk(mutex_);
+        if (!running_.exchange(false)) {
+            return;
+        }
+    }
+    cond_.notify_one();
+    commitThread_.join();
+    LOG(INFO) << "txn batch client stopped";
+}
+
+int TxnBatchClient::Put(const std::string &key, const std::string &value) {
+    return Submit(OpType::OpPut, key, value, nullptr);
+}
+
+int TxnBatchClient::PutRewithRevision(const std::string &key,
+    const std::string &value, int64_t *revision) {
+    return Submit(OpType::OpPut, key, value, revision);
+}
+
+int TxnBatchClient::Get(const std::string &key, std::string *out) {
+    return client_->Get(key, out);
+}
+
+int TxnBatchClient::List(const std::string &startKey,
+    const std::string &endKey, std::vector<std::string> *values) {
+    return client_->List(startKey, endKey, values);
+}
+
+int TxnBatchClient::List(const std::string &startKey,
+    const std::string &endKey,
+    std::vector<std::pair<std::string, std::string>> *out) {
+    return client_->List(startKey, endKey, out);
+}
+
+int TxnBatchClient::Delete(const std::string &key) {
+    return Submit(OpType::OpDelete, key, "", nullptr);
+}
+
+int TxnBatchClient::DeleteRewithRevision(const std::string &key,
+                                         int64_t *revision) {
+    return Submit(OpType::OpDelete, key, "", revision);
+}
+
+int TxnBatchClient::TxnN(const std::vector<Operation> &ops) {
+    return client_->TxnN(ops);
+}
+
+int TxnBatchClient::TxnNWithRevision(const std::vector<Operation> &ops,
+                                     int64_t *revision) {
+    return client_->TxnNWithRevision(ops, revision);
+}
+
+int TxnBatchClient::CompareAndSwap(const std::string &key,
+    const std::string &preV, const std::string &target) {
+    return client_->CompareAndSwap(key, preV, target);
+}
+
+uint64_t TxnBatchClient::GetPendingMutationNum() {
+    LockGuard lk(mutex_);
+    uint64_t num = openBatch_ == nullptr ? 0 : openBatch_->mutations.size();
+    for (const auto &batch : sealedBatches_) {
+        num += batch->mutations.size();
+    }
+    return num;
+}
+
+int TxnBatchClient::Submit(OpType type, const std::string &key,
+                           const std::string &value, int64_t *revision) {
+    std::unique_ptr<Mutation> mutation(new Mutation());
+    mutation->type = type;
+    mutation->key = key;
+    mutation->value = value;
+    std::future<MutationResult> future = mutation->done.get_future();
+
+    bool batched = false;
+    {
+        LockGuard lk(mutex_);
+        if (running_.load()) {
+            // mutations of one key in a transaction are rejected by etcd,
+            // and the later one must be committed after the former
+            if (openBatch_ != nullptr && openBatch_->keys.count(key) != 0) {
+                SealOpenBatch();
+            }
+            if (openBatch_ == nullptr) {
+                openBatch_.reset(new Batch());
+                openBatch_->startUs = TimeUtility::GetTimeofDayUs();
+            }
+            openBatch_->keys.emplace(key);
+            openBatch_->mutations.emplace_back(std::move(mutation));
+            if (openBatch_->mutations.size() >= option_.maxBatchOps) {
+                SealOpenBatch();
+            }
+            batched = true;
+        }
+    }
+
+    if (!batched) {
+        if (type == OpType::OpPut) {
+            return revision == nullptr ? client_->Put(key, value)
+                : client_->PutRewithRevision(key, value, revision);
+        }
+        return revision == nullptr ? client_->Delete(key)
+            : client_->DeleteRewithRevision(key, revision);
+    }
+
+    cond_.notify_one();
+    MutationResult result = future.get();
+    if (revision != nullptr && result.first == EtcdErrCode::EtcdOK) {
+        *revision = result.second;
+    }
+    return result.first;
+}
+
+void TxnBatchClient::SealOpenBatch() {
+    if (openBatch_ != nullptr) {
+        sealedBatches_.emplace_back(std::move(openBatch_));
+    }
+}
+
+void TxnBatchClient::CommitLoop() {
+    UniqueLock lk(mutex_);
+    while (true) {
+        if (sealedBatches_.empty() && openBatch_ != nullptr) {
+            uint64_t now = TimeUtility::GetTimeofDayUs();
+            uint64_t deadline = openBatch_->startUs + option_.maxDelayUs;
+            if (running_.load() && now < deadline) {
+                cond_.wait_for(lk, std::chrono::microseconds(deadline - now));
+                continue;
+            }
+            SealOpenBatch();
+        }
+
+        if (sealedBatches_.empty()) {
+            if (!running_.load()) {
+                break;
+            }
+            cond_.wait(lk);
+            continue;
+        }
+
+        std::unique_ptr<Batch> batch = std::move(sealedBatches_.front());
+        sealedBatches_.pop_front();
+        lk.unlock();
+        Commit(batch.get());
+        lk.lock();
+    }
+}
+
+void TxnBatchClient::Commit(Batch *batch) {
+    std::vector<Operation> ops;
+    ops.reserve(batch->mutations.size());
+    for (const auto &mutation : batch->mutations) {
+        ops.emplace_back(Operation{mutation->type,
+            const_cast<char *>(mutation->key.c_str()),
+            const_cast<char *>(mutation->value.c_str()),
+            static_cast<int>(mutation->key.size()),
+            static_cast<int>(mutation->value.size())});
+    }
+
+    int64_t revision = 0;
+    int errCode = client_->TxnNWithRevision(ops, &revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(WARNING) << "commit " << ops.size()
+                     << " mutations in one txn err: " << errCode;
+    }
+    txnCount_ << 1;
+    mutationCount_ << ops.size();
+
+    for (auto &mutation : batch->mutations) {
+        mutation->done.set_value(MutationResult(errCode, revision));
+    }
+}
+
+}  // namespace kvstorage
+}  // namespace curve
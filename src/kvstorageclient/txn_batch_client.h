@@ -0,0 +1,172 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-15
+ */
+
+#ifndef SRC_KVSTORAGECLIENT_TXN_BATCH_CLIENT_H_
+#define SRC_KVSTORAGECLIENT_TXN_BATCH_CLIENT_H_
+
+#include <bvar/bvar.h>
+
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/kvstorageclient/etcd_client.h"
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::common::Atomic;
+using ::curve::common::ConditionVariable;
+using ::curve::common::Mutex;
+using ::curve::common::Thread;
+
+struct TxnBatchOption {
+    // max number of mutations committed in one transaction,
+    // no more than kMaxTxnOps
+    uint32_t maxBatchOps = kMaxTxnOps;
+    // max time a mutation waits for others to join its transaction,
+    // 0 means committing as soon as the previous transaction finished
+    uint32_t maxDelayUs = 100;
+};
+
+/**
+ * @brief TxnBatchClient is a group commit layer over a KVStorageClient.
+ *        Independent Put and Delete issued concurrently are accumulated and
+ *        committed by a background thread in one TxnNWithRevision, and every
+ *        caller still gets its own error code and revision. Mutations of the
+ *        same key are never put in the same transaction, and the order of
+ *        them is kept by committing transactions one by one. Other
+ *        interfaces are forwarded to the underlying client directly.
+ */
+class TxnBatchClient : public KVStorageClient {
+ public:
+    TxnBatchClient(std::shared_ptr<KVStorageClient> client,
+                   const TxnBatchOption &option);
+    ~TxnBatchClient();
+
+    /**
+     * @brief start the background commit thread, mutations are forwarded
+     *        to the underlying client directly before started
+     */
+    void Start();
+
+    /**
+     * @brief commit the pending mutations and stop the background thread
+     */
+    void Stop();
+
+    int Put(const std::string &key, const std::string &value) override;
+
+    int PutRewithRevision(const std::string &key, const std::string &value,
+        int64_t *revision) override;
+
+    int Get(const std::string &key, std::string *out) override;
+
+    int List(const std::string &startKey, const std::string &endKey,
+        std::vector<std::string> *values) override;
+
+    int List(const std::string &startKey, const std::string &endKey,
+        std::vector<std::pair<std::string, std::string>> *out) override;
+
+    int Delete(const std::string &key) override;
+
+    int DeleteRewithRevision(
+        const std::string &key, int64_t *revision) override;
+
+    int TxnN(const std::vector<Operation> &ops) override;
+
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+        int64_t *revision) override;
+
+    int CompareAndSwap(const std::string &key, const std::string &preV,
+        const std::string &target) override;
+
+    /**
+     * @brief number of mutations waiting to be committed,
+     *        not including the transaction being committed
+     */
+    uint64_t GetPendingMutationNum();
+
+ private:
+    // the result of a mutation: error code and revision
+    using MutationResult = std::pair<int, int64_t>;
+
+    struct Mutation {
+        OpType type;
+        std::string key;
+        std::string value;
+        std::promise<MutationResult> done;
+    };
+
+    struct Batch {
+        std::vector<std::unique_ptr<Mutation>> mutations;
+        std::unordered_set<std::string> keys;
+        // time when the first mutation joined, in us
+        uint64_t startUs = 0;
+    };
+
+    /**
+     * @brief add a mutation to the open batch and wait for its commit
+     *
+     * @param type OpPut or OpDelete
+     * @param key
+     * @param value empty for OpDelete
+     * @param[out] revision revision of the transaction, can be nullptr
+     *
+     * @return error code EtcdErrCode
+     */
+    int Submit(OpType type, const std::string &key, const std::string &value,
+               int64_t *revision);
+
+    // seal the open batch so that no more mutation joins it
+    void SealOpenBatch();
+
+    void CommitLoop();
+
+    void Commit(Batch *batch);
+
+ private:
+    std::shared_ptr<KVStorageClient> client_;
+    TxnBatchOption option_;
+
+    Mutex mutex_;
+    ConditionVariable cond_;
+    // batch accepting new mutations
+    std::unique_ptr<Batch> openBatch_;
+    // batches waiting to be committed, in order
+    std::deque<std::unique_ptr<Batch>> sealedBatches_;
+
+    Thread commitThread_;
+    Atomic<bool> running_;
+
+    bvar::Adder<uint64_t> txnCount_;
+    bvar::Adder<uint64_t> mutationCount_;
+};
+
+}  // namespace kvstorage
+}  // namespace curve
+
+#endif  // SRC_KVSTORAGECLIENT_TXN_BATCH_CLIENT_H_
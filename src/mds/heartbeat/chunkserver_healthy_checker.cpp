@@ -128,6 +128,10 @@ void ChunkserverHealthyChecker::UpdateChunkServerOnlineState(
     if (kTopoErrCodeSuccess != errCode) {
         LOG(WARNING) << "heartbeatManager update chunkserver get error code: "
             << errCode;
+        return;
+    }
+    if (onStateChanged_ != nullptr) {
+        onStateChanged_(id);
     }
 }
 
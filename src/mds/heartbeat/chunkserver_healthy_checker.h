@@ -24,6 +24,7 @@
 #define SRC_MDS_HEARTBEAT_CHUNKSERVER_HEALTHY_CHECKER_H_
 
 #include <chrono> //NOLINT
+#include <functional>
 #include <memory>
 #include <map>
 #include "src/mds/common/mds_define.h"
@@ -69,6 +70,10 @@ struct HeartbeatOption {
 
     // the time when the mds start (fetch from system)
     steady_clock::time_point mdsStartTime;
+
+    // number of workers updating copysets reported by heartbeat into
+    // topology, 0 means updating in the heartbeat rpc thread
+    uint32_t topoUpdaterWorkerNum = 0;
 };
 
 struct HeartbeatInfo {
@@ -87,11 +92,15 @@ struct HeartbeatInfo {
     OnlineState state;
 };
 
+// called after the online state of chunkserver is updated into topology
+using OnlineStateChangedCallback = std::function<void(ChunkServerIdType)>;
+
 class ChunkserverHealthyChecker {
  public:
     explicit ChunkserverHealthyChecker(
-        HeartbeatOption option, std::shared_ptr<Topology> topo) :
-        option_(option), topo_(topo) {}
+        HeartbeatOption option, std::shared_ptr<Topology> topo,
+        OnlineStateChangedCallback onStateChanged = nullptr) :
+        option_(option), topo_(topo), onStateChanged_(onStateChanged) {}
     ~ChunkserverHealthyChecker() {}
 
     /**
@@ -139,6 +148,7 @@ class ChunkserverHealthyChecker {
  private:
     HeartbeatOption option_;
     std::shared_ptr<Topology> topo_;
+    OnlineStateChangedCallback onStateChanged_;
 
     mutable RWLock hbinfoLock_;
     std::map<ChunkServerIdType, HeartbeatInfo> heartbeatInfos_;
@@ -37,6 +37,7 @@ using ::curve::mds::topology::ChunkServerStatus;
 using ::curve::mds::topology::ChunkServerStat;
 using ::curve::mds::topology::CopysetStat;
 using ::curve::mds::topology::SplitPeerId;
+using ::curve::common::LockGuard;
 
 namespace curve {
 namespace mds {
@@ -46,11 +47,24 @@ HeartbeatManager::HeartbeatManager(HeartbeatOption option,
     std::shared_ptr<TopologyStat> topologyStat,
     std::shared_ptr<Coordinator> coordinator)
     : topology_(topology),
-      topologyStat_(topologyStat) {
-    healthyChecker_ =
-        std::make_shared<ChunkserverHealthyChecker>(option, topology);
+      topologyStat_(topologyStat),
+      coordinator_(coordinator) {
+    // changes of chunkservers and copysets are pushed to the coordinator
+    // for incremental scheduling
+    OnlineStateChangedCallback onStateChanged = nullptr;
+    CopySetChangedCallback onCopySetChanged = nullptr;
+    if (coordinator != nullptr) {
+        onStateChanged = [coordinator](ChunkServerIdType id) {
+            coordinator->ChunkServerChanged(id);
+        };
+        onCopySetChanged = [coordinator](const CopySetKey &key) {
+            coordinator->CopySetChanged(key);
+        };
+    }
+    healthyChecker_ = std::make_shared<ChunkserverHealthyChecker>(
+        option, topology, onStateChanged);
 
-    topoUpdater_ = std::make_shared<TopoUpdater>(topology);
+    topoUpdater_ = std::make_shared<TopoUpdater>(topology, onCopySetChanged);
 
     copysetConfGenerator_ =
         std::make_shared<CopysetConfGenerator>(topology, coordinator,
@@ -58,6 +72,7 @@ HeartbeatManager::HeartbeatManager(HeartbeatOption option,
 
     isStop_ = true;
     chunkserverHealthyCheckerRunInter_ = option.heartbeatMissTimeOutMs;
+    topoUpdaterWorkerNum_ = option.topoUpdaterWorkerNum;
 }
 
 void HeartbeatManager::Init() {
@@ -73,6 +88,7 @@ void HeartbeatManager::Init() {
 
 void HeartbeatManager::Run() {
     if (isStop_.exchange(false)) {
+        topoUpdater_->Start(topoUpdaterWorkerNum_);
         backEndThread_ =
             Thread(&HeartbeatManager::ChunkServerHealthyChecker, this);
     }
@@ -83,6 +99,7 @@ void HeartbeatManager::Stop() {
         LOG(INFO) << "stop heartbeatManager...";
         sleeper_.interrupt();
         backEndThread_.join();
+        topoUpdater_->Stop();
         LOG(INFO) << "stop heartbeatManager ok.";
     } else {
         LOG(INFO) << "heartbeatManager not running.";
@@ -130,6 +147,8 @@ void HeartbeatManager::UpdateChunkServerStatistics(
         stat.writeRate = request.stats().writerate();
         stat.readIOPS = request.stats().readiops();
         stat.writeIOPS = request.stats().writeiops();
+        stat.readLatency = request.stats().readlatency();
+        stat.writeLatency = request.stats().writelatency();
         stat.chunkSizeUsedBytes = request.stats().chunksizeusedbytes();
         stat.chunkSizeLeftBytes = request.stats().chunksizeleftbytes();
         stat.chunkSizeTrashedBytes = request.stats().chunksizetrashedbytes();
@@ -142,6 +161,10 @@ void HeartbeatManager::UpdateChunkServerStatistics(
                 request.stats().chunkfilepoolformatpercent();  // NOLINT
         }
 
+        if (request.stats().has_installsnapshotrate()) {
+            stat.installSnapshotRate = request.stats().installsnapshotrate();
+        }
+
         for (int i = 0; i < request.copysetinfos_size(); i++) {
             CopysetStat cstat;
             cstat.logicalPoolId = request.copysetinfos(i).logicalpoolid();
@@ -172,6 +195,10 @@ void HeartbeatManager::UpdateChunkServerStatistics(
                 cstat.writeRate = request.copysetinfos(i).stats().writerate();
                 cstat.readIOPS = request.copysetinfos(i).stats().readiops();
                 cstat.writeIOPS = request.copysetinfos(i).stats().writeiops();
+                cstat.readLatency =
+                    request.copysetinfos(i).stats().readlatency();
+                cstat.writeLatency =
+                    request.copysetinfos(i).stats().writelatency();
             } else {
                 LOG(WARNING) << "hearbeat manager receive request "
                              << "copyset {" << cstat.logicalPoolId
@@ -181,6 +208,22 @@ void HeartbeatManager::UpdateChunkServerStatistics(
             stat.copysetStats.push_back(cstat);
         }
 
+        // incremental heartbeat only carries changed copysets, keep the
+        // statistics of the others from last heartbeat
+        ChunkServerStat lastStat;
+        if (request.incremental() && topologyStat_->GetChunkServerStat(
+                request.chunkserverid(), &lastStat)) {
+            std::set<CopySetKey> reported;
+            for (const auto &cstat : stat.copysetStats) {
+                reported.emplace(cstat.logicalPoolId, cstat.copysetId);
+            }
+            for (const auto &cstat : lastStat.copysetStats) {
+                if (reported.count(CopySetKey(cstat.logicalPoolId,
+                                              cstat.copysetId)) == 0) {
+                    stat.copysetStats.push_back(cstat);
+                }
+            }
+        }
     } else {
         LOG(WARNING) << "hearbeat manager receive request "
                      << "do not have ChunkServerStatisticInfo";
@@ -216,12 +259,20 @@ void HeartbeatManager::ChunkServerHeartbeat(
 
     UpdateChunkServerVersion(request);
 
-    // no copyset info in the request
-    if (request.copysetinfos_size() == 0) {
+    if (!CheckFullHeartbeat(request)) {
+        response->set_needfullheartbeat(true);
+    }
+
+    // no copyset info in the request, which is normal for incremental
+    // heartbeat when nothing changed
+    if (request.copysetinfos_size() == 0 && !request.incremental()) {
         response->set_statuscode(HeartbeatStatusCode::hbRequestNoCopyset);
     }
     // dealing with copysets included in the heartbeat request
+    std::set<CopySetKey> reported;
+    std::vector<::curve::mds::topology::CopySetInfo> leaderCopySets;
     for (auto &value : request.copysetinfos()) {
+        reported.emplace(value.logicalpoolid(), value.copysetid());
         // discard copysets of invalid logical pool
         ::curve::mds::topology::LogicalPool lPool;
         if (topology_->GetLogicalPool(value.logicalpoolid(), &lPool)) {
@@ -255,7 +306,52 @@ void HeartbeatManager::ChunkServerHeartbeat(
         // if a copyset is the leader, update (e.g. epoch) topology according
         // to its info
         if (request.chunkserverid() == reportCopySetInfo.GetLeader()) {
-            topoUpdater_->UpdateTopo(reportCopySetInfo);
+            leaderCopySets.emplace_back(std::move(reportCopySetInfo));
+        }
+    }
+    topoUpdater_->UpdateTopos(leaderCopySets);
+
+    if (request.incremental()) {
+        DispatchPendingOperators(request.chunkserverid(), reported, response);
+    }
+}
+
+bool HeartbeatManager::CheckFullHeartbeat(
+    const ChunkServerHeartbeatRequest &request) {
+    LockGuard guard(fullHeartbeatMutex_);
+    if (!request.incremental()) {
+        fullHeartbeatChunkServers_.emplace(request.chunkserverid());
+        return true;
+    }
+    return fullHeartbeatChunkServers_.count(request.chunkserverid()) != 0;
+}
+
+void HeartbeatManager::DispatchPendingOperators(ChunkServerIdType csId,
+    const std::set<CopySetKey> &reported,
+    ChunkServerHeartbeatResponse *response) {
+    if (coordinator_ == nullptr || coordinator_->GetOpController() == nullptr) {
+        return;
+    }
+
+    for (const auto &op : coordinator_->GetOpController()->GetOperators()) {
+        if (reported.count(op.copysetID) != 0) {
+            continue;
+        }
+
+        // the copyset is unchanged since last report, so the record in
+        // topology is the same as what the leader would report. Copysets
+        // with candidate are always reported by chunkserver
+        ::curve::mds::topology::CopySetInfo recordCopySetInfo;
+        if (!topology_->GetCopySet(op.copysetID, &recordCopySetInfo) ||
+            recordCopySetInfo.GetLeader() != csId ||
+            recordCopySetInfo.HasCandidate()) {
+            continue;
+        }
+
+        CopySetConf conf;
+        if (copysetConfGenerator_->GenCopysetConf(
+                csId, recordCopySetInfo, ConfigChangeInfo(), &conf)) {
+            *response->add_needupdatecopysets() = conf;
         }
     }
 }
@@ -25,6 +25,8 @@
 
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_set>
 #include <atomic>
 #include <string>
 #include <memory>
@@ -43,6 +45,7 @@
 using ::curve::mds::topology::CopySetInfo;
 using ::curve::mds::topology::PoolIdType;
 using ::curve::mds::topology::CopySetIdType;
+using ::curve::mds::topology::CopySetKey;
 using ::curve::mds::topology::Topology;
 using ::curve::mds::topology::TopologyStat;
 using ::curve::mds::schedule::Coordinator;
@@ -50,6 +53,7 @@ using ::curve::mds::schedule::Coordinator;
 using ::curve::common::Thread;
 using ::curve::common::Atomic;
 using ::curve::common::RWLock;
+using ::curve::common::Mutex;
 using ::curve::common::InterruptibleSleeper;
 
 namespace curve {
@@ -134,6 +138,30 @@ class HeartbeatManager {
      */
     void UpdateChunkServerVersion(const ChunkServerHeartbeatRequest &request);
 
+    /**
+     * @brief Record chunkservers which have sent full heartbeat since mds
+     *        started
+     *
+     * @param request Heartbeat request
+     *
+     * @return false if the request is incremental and mds has not received
+     *         a full heartbeat from the chunkserver, otherwise true
+     */
+    bool CheckFullHeartbeat(const ChunkServerHeartbeatRequest &request);
+
+    /**
+     * @brief Incremental heartbeat does not carry unchanged copysets, so
+     *        pending operators on the copysets which the chunkserver leads
+     *        are dispatched according to the topology record
+     *
+     * @param csId chunkserver which sent the heartbeat
+     * @param reported copysets carried by the heartbeat
+     * @param[out] response Response of heartbeat request
+     */
+    void DispatchPendingOperators(ChunkServerIdType csId,
+                                  const std::set<CopySetKey> &reported,
+                                  ChunkServerHeartbeatResponse *response);
+
     /**
      * @brief Background thread for heartbeat timeout inspection
      */
@@ -195,6 +223,11 @@ class HeartbeatManager {
     Atomic<bool> isStop_;
     InterruptibleSleeper sleeper_;
     int chunkserverHealthyCheckerRunInter_;
+    uint32_t topoUpdaterWorkerNum_;
+
+    // chunkservers which have sent full heartbeat since mds started
+    Mutex fullHeartbeatMutex_;
+    std::unordered_set<ChunkServerIdType> fullHeartbeatChunkServers_;
 };
 
 }  // namespace heartbeat
@@ -22,10 +22,60 @@
 
 #include <glog/logging.h>
 #include "src/mds/heartbeat/topo_updater.h"
+#include "src/common/concurrent/count_down_event.h"
+
+using ::curve::common::CountDownEvent;
+using ::curve::common::ReadLockGuard;
+using ::curve::common::WriteLockGuard;
 
 namespace curve {
 namespace mds {
 namespace heartbeat {
+void TopoUpdater::Start(uint32_t workerNum) {
+    WriteLockGuard guard(workersLock_);
+    if (!workers_.empty()) {
+        return;
+    }
+    for (uint32_t i = 0; i < workerNum; i++) {
+        std::unique_ptr<TaskThreadPool<>> worker(new TaskThreadPool<>());
+        worker->Start(1);
+        workers_.emplace_back(std::move(worker));
+    }
+    LOG(INFO) << "topoUpdater start " << workerNum << " workers";
+}
+
+void TopoUpdater::Stop() {
+    WriteLockGuard guard(workersLock_);
+    for (auto &worker : workers_) {
+        worker->Stop();
+    }
+    workers_.clear();
+}
+
+void TopoUpdater::UpdateTopos(
+    const std::vector<CopySetInfo> &reportCopySetInfos) {
+    ReadLockGuard guard(workersLock_);
+    if (workers_.empty() || reportCopySetInfos.size() <= 1) {
+        for (const auto &info : reportCopySetInfos) {
+            UpdateTopo(info);
+        }
+        return;
+    }
+
+    CountDownEvent done(reportCopySetInfos.size());
+    for (const auto &info : reportCopySetInfos) {
+        // copysets of one logical pool are spread by copyset id, and the
+        // same copyset always goes to the same worker to keep the order
+        uint64_t key = (static_cast<uint64_t>(info.GetLogicalPoolId()) << 32) |
+                       info.GetId();
+        workers_[key % workers_.size()]->Enqueue([this, &info, &done]() {
+            UpdateTopo(info);
+            done.Signal();
+        });
+    }
+    done.Wait();
+}
+
 void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
     CopySetInfo recordCopySetInfo;
 
@@ -181,6 +231,9 @@ void TopoUpdater::UpdateTopo(const CopySetInfo &reportCopySetInfo) {
                        << ") got error code: " << updateCode;
             return;
         }
+        if (onCopySetChanged_ != nullptr) {
+            onCopySetChanged_(reportCopySetInfo.GetCopySetKey());
+        }
     }
 }
 }  // namespace heartbeat
@@ -23,20 +23,45 @@
 #ifndef SRC_MDS_HEARTBEAT_TOPO_UPDATER_H_
 #define SRC_MDS_HEARTBEAT_TOPO_UPDATER_H_
 
+#include <functional>
 #include <memory>
+#include <vector>
 #include "src/mds/topology/topology_item.h"
 #include "src/mds/topology/topology.h"
+#include "src/common/concurrent/rw_lock.h"
+#include "src/common/concurrent/task_thread_pool.h"
 
 using ::curve::mds::topology::CopySetInfo;
 using ::curve::mds::topology::Topology;
+using ::curve::common::RWLock;
+using ::curve::common::TaskThreadPool;
 
 namespace curve {
 namespace mds {
 namespace heartbeat {
+// called after the copyset reported is updated into topology
+using CopySetChangedCallback =
+    std::function<void(const ::curve::mds::topology::CopySetKey &)>;
+
 class TopoUpdater {
  public:
-    explicit TopoUpdater(std::shared_ptr<Topology> topo) : topo_(topo) {}
-    ~TopoUpdater() {}
+    explicit TopoUpdater(std::shared_ptr<Topology> topo,
+                         CopySetChangedCallback onCopySetChanged = nullptr)
+        : topo_(topo), onCopySetChanged_(onCopySetChanged) {}
+    ~TopoUpdater() { Stop(); }
+
+   /*
+    * @brief Start start workers for UpdateTopos, each copyset is always
+    *              handled by the same worker which is chosen by copyset id
+    * @param[in] workerNum number of workers, 0 means UpdateTopos updates
+    *                      copysets one by one in the caller thread
+    */
+    void Start(uint32_t workerNum);
+
+   /*
+    * @brief Stop stop all workers, later UpdateTopos runs in caller thread
+    */
+    void Stop();
 
    /*
     * @brief UpdateTopo this function will be called by leader copyset
@@ -46,8 +71,20 @@ class TopoUpdater {
     */
     void UpdateTopo(const CopySetInfo &reportCopySetInfo);
 
+   /*
+    * @brief UpdateTopos update copysets reported in one heartbeat in parallel
+    *                    by workers and wait until all of them are done
+    * @param[in] reportCopySetInfos copysets reported by chunkserver
+    */
+    void UpdateTopos(const std::vector<CopySetInfo> &reportCopySetInfos);
+
  private:
     std::shared_ptr<Topology> topo_;
+    CopySetChangedCallback onCopySetChanged_;
+
+    // protect workers_ from being stopped while tasks are dispatched
+    RWLock workersLock_;
+    std::vector<std::unique_ptr<TaskThreadPool<>>> workers_;
 };
 }  // namespace heartbeat
 }  // namespace mds
@@ -107,10 +107,11 @@ void AllocStatistic::AllocSpace(
         WriteLockGuard guard(segmentAllocLock_);
         segmentAlloc_[lid] += changeSize;
     // if the Etcd data has not been counted, update changeSize
-    // to segmentChange_
+    // to segmentChange_, several segments may be changed in one
+    // transaction with the same revision, so accumulate them
     } else {
         WriteLockGuard guard(segmentChangeLock_);
-        segmentChange_[lid][revision] = changeSize;
+        segmentChange_[lid][revision] += changeSize;
     }
 }
 
@@ -126,7 +127,7 @@ void AllocStatistic::DeAllocSpace(
         segmentAlloc_[lid] -= changeSize;
     } else {
         WriteLockGuard guard(segmentChangeLock_);
-        segmentChange_[lid][revision] = 0L - changeSize;
+        segmentChange_[lid][revision] -= changeSize;
     }
 }
 
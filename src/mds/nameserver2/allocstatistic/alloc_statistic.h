@@ -207,7 +207,7 @@ class AllocStatistic {
     // Segment changes after mds started
     // PoolIdType: poolId
     // std::map<int64_t, int64_t> first value is the version, and the second is
-    //                            the value change
+    //                            the sum of value changes of the version
     std::map<PoolIdType, std::map<int64_t, int64_t>> segmentChange_;
     RWLock segmentChangeLock_;
 
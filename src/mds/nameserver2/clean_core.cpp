@@ -22,8 +22,51 @@
 
 #include "src/mds/nameserver2/clean_core.h"
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <utility>
+
+#include "src/common/concurrent/count_down_event.h"
+
+using ::curve::common::CountDownEvent;
+using ::curve::common::ReadWriteThrottleParams;
+using ::curve::kvstorage::kMaxTxnOps;
+
 namespace curve {
 namespace mds {
+
+CleanCore::CleanCore(std::shared_ptr<NameServerStorage> storage,
+                     std::shared_ptr<CopysetClient> copysetClient,
+                     std::shared_ptr<AllocStatistic> allocStatistic,
+                     const CleanCoreOption &option)
+    : storage_(storage),
+      copysetClient_(copysetClient),
+      allocStatistic_(allocStatistic),
+      option_(option) {
+    option_.chunkDeleteWindow =
+        std::max<uint32_t>(option_.chunkDeleteWindow, 1);
+    option_.segmentDeleteBatchSize = std::min<uint32_t>(
+        std::max<uint32_t>(option_.segmentDeleteBatchSize, 1), kMaxTxnOps);
+
+    if (option_.chunkDeleteThreadNum > 0) {
+        chunkDeleteWorkers_.reset(new TaskThreadPool<>());
+        chunkDeleteWorkers_->Start(option_.chunkDeleteThreadNum);
+    }
+
+    ReadWriteThrottleParams params;
+    params.iopsTotal =
+        ::curve::common::ThrottleParams(option_.chunkDeleteIops, 0, 0);
+    chunkDeleteThrottle_.UpdateThrottleParams(params);
+}
+
+CleanCore::~CleanCore() {
+    if (chunkDeleteWorkers_ != nullptr) {
+        chunkDeleteWorkers_->Stop();
+    }
+    chunkDeleteThrottle_.Stop();
+}
+
 StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
                                         TaskProgress* progress) {
     if (fileInfo.segmentsize() == 0) {
@@ -32,49 +75,44 @@ StatusCode CleanCore::CleanSnapShotFile(const FileInfo & fileInfo,
     }
     uint32_t  segmentNum = fileInfo.length() / fileInfo.segmentsize();
     uint64_t segmentSize = fileInfo.segmentsize();
-    for (uint32_t i = 0; i < segmentNum; i++) {
+    uint32_t batchSize = option_.segmentDeleteBatchSize;
+    for (uint32_t i = 0; i < segmentNum; i += batchSize) {
+        uint32_t num = std::min(batchSize, segmentNum - i);
         // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(fileInfo.parentid(),
-                                                    i * segmentSize,
-                                                    &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
+        std::vector<PageFileSegment> segments;
+        std::vector<uint64_t> offsets;
+        if (!LoadSegments(fileInfo.parentid(), segmentSize, i, num,
+                          &segments, &offsets)) {
             LOG(ERROR) << "cleanSnapShot File Error: "
             << "GetSegment Error, inodeid = " << fileInfo.id()
             << ", filename = " << fileInfo.filename()
-            << ", offset = " << i * segmentSize
             << ", sequenceNum = " << fileInfo.seqnum();
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kSnapshotFileDeleteError;
         }
 
         // delete chunks in chunkserver
-        LogicalPoolID logicalPoolID = segment.logicalpoolid();
-        uint32_t chunkNum = segment.chunks_size();
-        for (uint32_t j = 0; j != chunkNum; j++) {
-            // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
-            // 防止删除快照后，后续的写触发chunk的快照
-            // correctSn为创建快照后文件的版本号，也就是快照版本号+1
-            SeqNum correctSn = fileInfo.seqnum() + 1;
-            int ret = copysetClient_->DeleteChunkSnapshotOrCorrectSn(
-                logicalPoolID,
-                segment.chunks()[j].copysetid(),
-                segment.chunks()[j].chunkid(),
-                correctSn);
-            if (ret != 0) {
-                LOG(ERROR) << "CleanSnapShotFile Error: "
-                    << "DeleteChunkSnapshotOrCorrectSn Error"
-                    << ", ret = " << ret
-                    << ", inodeid = " << fileInfo.id()
-                    << ", filename = " << fileInfo.filename()
-                    << ", correctSn = " << correctSn;
-                progress->SetStatus(TaskStatus::FAILED);
-                return StatusCode::kSnapshotFileDeleteError;
-            }
+        // 删除快照时如果chunk不存在快照，则需要修改chunk的correctedSn
+        // 防止删除快照后，后续的写触发chunk的快照
+        // correctSn为创建快照后文件的版本号，也就是快照版本号+1
+        SeqNum correctSn = fileInfo.seqnum() + 1;
+        int ret = CleanChunks(segments,
+            [&](LogicalPoolID logicalPoolId, CopysetID copysetId,
+                ChunkID chunkId) {
+                return copysetClient_->DeleteChunkSnapshotOrCorrectSn(
+                    logicalPoolId, copysetId, chunkId, correctSn);
+            });
+        if (ret != 0) {
+            LOG(ERROR) << "CleanSnapShotFile Error: "
+                << "DeleteChunkSnapshotOrCorrectSn Error"
+                << ", ret = " << ret
+                << ", inodeid = " << fileInfo.id()
+                << ", filename = " << fileInfo.filename()
+                << ", correctSn = " << correctSn;
+            progress->SetStatus(TaskStatus::FAILED);
+            return StatusCode::kSnapshotFileDeleteError;
         }
-        progress->SetProgress(100 * (i+1) / segmentNum);
+        progress->SetProgress(100 * (i + num) / segmentNum);
     }
 
     // delete the storage
@@ -102,25 +140,28 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
         return StatusCode::KInternalError;
     }
 
-    int  segmentNum = commonFile.length() / commonFile.segmentsize();
+    uint32_t segmentNum = commonFile.length() / commonFile.segmentsize();
     uint64_t segmentSize = commonFile.segmentsize();
-    for (int i = 0; i != segmentNum; i++) {
+    uint32_t batchSize = option_.segmentDeleteBatchSize;
+    for (uint32_t i = 0; i < segmentNum; i += batchSize) {
+        uint32_t num = std::min(batchSize, segmentNum - i);
         // load  segment
-        PageFileSegment segment;
-        StoreStatus storeRet = storage_->GetSegment(commonFile.id(),
-                                    i * segmentSize, &segment);
-        if (storeRet == StoreStatus::KeyNotExist) {
-            continue;
-        } else if (storeRet !=  StoreStatus::OK) {
+        std::vector<PageFileSegment> segments;
+        std::vector<uint64_t> offsets;
+        if (!LoadSegments(commonFile.id(), segmentSize, i, num,
+                          &segments, &offsets)) {
             LOG(ERROR) << "Clean common File Error: "
                 << "GetSegment Error, inodeid = " << commonFile.id()
-                << ", filename = " << commonFile.filename()
-                << ", offset = " << i * segmentSize;
+                << ", filename = " << commonFile.filename();
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kCommonFileDeleteError;
         }
+        if (segments.empty()) {
+            progress->SetProgress(100 * (i + num) / segmentNum);
+            continue;
+        }
 
-        int ret = DeleteChunksInSegment(segment, commonFile.seqnum());
+        int ret = DeleteChunksInSegments(segments, commonFile.seqnum());
         if (ret != 0) {
             LOG(ERROR) << "Clean common File Error: "
                        << ", ret = " << ret
@@ -131,22 +172,36 @@ StatusCode CleanCore::CleanFile(const FileInfo & commonFile,
             return StatusCode::kCommonFileDeleteError;
         }
 
-        // delete segment
+        // delete segments, several segments are deleted in one transaction
         int64_t revision;
-        storeRet = storage_->DeleteSegment(
-            commonFile.id(), i * segmentSize, &revision);
+        StoreStatus storeRet;
+        if (offsets.size() == 1) {
+            storeRet = storage_->DeleteSegment(
+                commonFile.id(), offsets[0], &revision);
+        } else {
+            storeRet = storage_->DeleteSegments(
+                commonFile.id(), offsets, &revision);
+        }
         if (storeRet != StoreStatus::OK) {
             LOG(ERROR) << "Clean common File Error: "
             << "DeleteSegment Error, inodeid = " << commonFile.id()
             << ", filename = " << commonFile.filename()
-            << ", offset = " << i * segmentSize
+            << ", offset = " << offsets[0]
+            << ", segment num = " << offsets.size()
             << ", sequenceNum = " << commonFile.seqnum();
             progress->SetStatus(TaskStatus::FAILED);
             return StatusCode::kCommonFileDeleteError;
         }
-        allocStatistic_->DeAllocSpace(segment.logicalpoolid(),
-            segment.segmentsize(), revision);
-        progress->SetProgress(100 * (i + 1) / segmentNum);
+        // the segments share the revision of the transaction, report the
+        // released size of each logical pool once
+        std::map<PoolIdType, int64_t> deallocSizes;
+        for (const auto &segment : segments) {
+            deallocSizes[segment.logicalpoolid()] += segment.segmentsize();
+        }
+        for (const auto &item : deallocSizes) {
+            allocStatistic_->DeAllocSpace(item.first, item.second, revision);
+        }
+        progress->SetProgress(100 * (i + num) / segmentNum);
     }
 
     // delete the storage
@@ -182,7 +237,7 @@ StatusCode CleanCore::CleanDiscardSegment(
     timer.start();
 
     // delete chunks
-    int ret = DeleteChunksInSegment(segment, seq);
+    int ret = DeleteChunksInSegments({segment}, seq);
     if (ret != 0) {
         LOG(ERROR) << "CleanDiscardSegment failed, DeleteChunk Error, ret = "
                    << ret << ", filename = " << fileInfo.filename()
@@ -218,27 +273,121 @@ StatusCode CleanCore::CleanDiscardSegment(
     return StatusCode::kOK;
 }
 
-int CleanCore::DeleteChunksInSegment(const PageFileSegment& segment,
-                                     const SeqNum& seq) {
-    const LogicalPoolID logicalPoolId = segment.logicalpoolid();
-    for (int i = 0; i < segment.chunks_size(); ++i) {
-        int ret = copysetClient_->DeleteChunk(
-            logicalPoolId,
-            segment.chunks()[i].copysetid(),
-            segment.chunks()[i].chunkid(),
-            seq);
+bool CleanCore::LoadSegments(InodeID id, uint64_t segmentSize,
+                             uint32_t start, uint32_t num,
+                             std::vector<PageFileSegment> *segments,
+                             std::vector<uint64_t> *offsets) {
+    for (uint32_t i = start; i < start + num; i++) {
+        PageFileSegment segment;
+        uint64_t offset = i * segmentSize;
+        StoreStatus storeRet = storage_->GetSegment(id, offset, &segment);
+        if (storeRet == StoreStatus::KeyNotExist) {
+            continue;
+        } else if (storeRet != StoreStatus::OK) {
+            LOG(ERROR) << "GetSegment failed, inodeid = " << id
+                       << ", offset = " << offset
+                       << ", retCode = " << storeRet;
+            return false;
+        }
+        segments->emplace_back(std::move(segment));
+        offsets->emplace_back(offset);
+    }
+    return true;
+}
 
-        if (ret != 0) {
-            LOG(ERROR) << "DeleteChunk failed, ret = " << ret
-                       << ", logicalpoolid = " << logicalPoolId
-                       << ", copysetid = " << segment.chunks()[i].copysetid()
-                       << ", chunkid = " << segment.chunks()[i].chunkid()
-                       << ", seq = " << seq;
-            return ret;
+int CleanCore::CleanChunks(const std::vector<PageFileSegment> &segments,
+                           const ChunkCleaner &cleaner) {
+    if (chunkDeleteWorkers_ == nullptr) {
+        for (const auto &segment : segments) {
+            for (const auto &chunk : segment.chunks()) {
+                int ret = CleanChunk(cleaner, segment.logicalpoolid(),
+                                     chunk.copysetid(), chunk.chunkid());
+                if (ret != 0) {
+                    return ret;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // group chunks by copyset, chunks of one copyset are deleted one by one
+    // so that no copyset is flooded by a clean task
+    struct CopysetChunks {
+        LogicalPoolID logicalPoolId;
+        CopysetID copysetId;
+        std::vector<ChunkID> chunks;
+    };
+    std::vector<CopysetChunks> copysets;
+    std::map<std::pair<LogicalPoolID, CopysetID>, size_t> index;
+    for (const auto &segment : segments) {
+        for (const auto &chunk : segment.chunks()) {
+            auto key = std::make_pair(
+                static_cast<LogicalPoolID>(segment.logicalpoolid()),
+                static_cast<CopysetID>(chunk.copysetid()));
+            auto it = index.emplace(key, copysets.size()).first;
+            if (it->second == copysets.size()) {
+                copysets.push_back(CopysetChunks{key.first, key.second, {}});
+            }
+            copysets[it->second].chunks.push_back(chunk.chunkid());
         }
     }
+    if (copysets.empty()) {
+        return 0;
+    }
+
+    // at most chunkDeleteWindow copysets are being cleaned at the same time,
+    // the rest copysets are taken by the workers after they finish one
+    std::atomic<size_t> next(0);
+    std::atomic<int> result(0);
+    uint32_t workerNum = std::min<size_t>(option_.chunkDeleteWindow,
+                                          copysets.size());
+    CountDownEvent done(workerNum);
+    for (uint32_t i = 0; i < workerNum; i++) {
+        chunkDeleteWorkers_->Enqueue([&]() {
+            size_t cur;
+            while (result.load() == 0 &&
+                   (cur = next.fetch_add(1)) < copysets.size()) {
+                const CopysetChunks &copyset = copysets[cur];
+                for (ChunkID chunkId : copyset.chunks) {
+                    int ret = CleanChunk(cleaner, copyset.logicalPoolId,
+                                         copyset.copysetId, chunkId);
+                    if (ret != 0) {
+                        int expected = 0;
+                        result.compare_exchange_strong(expected, ret);
+                        break;
+                    }
+                }
+            }
+            done.Signal();
+        });
+    }
+    done.Wait();
+    return result.load();
+}
+
+int CleanCore::CleanChunk(const ChunkCleaner &cleaner,
+                          LogicalPoolID logicalPoolId, CopysetID copysetId,
+                          ChunkID chunkId) {
+    // blocked here if chunk deletions of all tasks exceed the limit
+    chunkDeleteThrottle_.Add(false, 1);
+    int ret = cleaner(logicalPoolId, copysetId, chunkId);
+    if (ret != 0) {
+        LOG(ERROR) << "clean chunk failed, ret = " << ret
+                   << ", logicalpoolid = " << logicalPoolId
+                   << ", copysetid = " << copysetId
+                   << ", chunkid = " << chunkId;
+    }
+    return ret;
+}
 
-    return 0;
+int CleanCore::DeleteChunksInSegments(
+    const std::vector<PageFileSegment> &segments, const SeqNum& seq) {
+    return CleanChunks(segments,
+        [&](LogicalPoolID logicalPoolId, CopysetID copysetId,
+            ChunkID chunkId) {
+            return copysetClient_->DeleteChunk(
+                logicalPoolId, copysetId, chunkId, seq);
+        });
 }
 
 }  // namespace mds
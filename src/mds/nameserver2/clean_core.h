@@ -23,8 +23,12 @@
 #ifndef SRC_MDS_NAMESERVER2_CLEAN_CORE_H_
 #define SRC_MDS_NAMESERVER2_CLEAN_CORE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/throttle.h"
 #include "src/mds/nameserver2/namespace_storage.h"
 #include "src/mds/common/mds_define.h"
 #include "src/mds/nameserver2/task_progress.h"
@@ -34,18 +38,31 @@
 
 using ::curve::mds::chunkserverclient::CopysetClient;
 using ::curve::mds::topology::Topology;
+using ::curve::common::TaskThreadPool;
+using ::curve::common::Throttle;
 
 namespace curve {
 namespace mds {
 
+struct CleanCoreOption {
+    // 所有清理任务共享的删除chunk的线程数, 为0则在清理任务的线程中串行删除
+    uint32_t chunkDeleteThreadNum = 0;
+    // 单个清理任务同时删除chunk的copyset数量上限
+    uint32_t chunkDeleteWindow = 1;
+    // 一个etcd事务中删除的segment数量上限
+    uint32_t segmentDeleteBatchSize = 1;
+    // 所有清理任务每秒发送的删除chunk请求数上限, 为0则不限制
+    uint64_t chunkDeleteIops = 0;
+};
+
 class CleanCore {
  public:
     CleanCore(std::shared_ptr<NameServerStorage> storage,
         std::shared_ptr<CopysetClient> copysetClient,
-        std::shared_ptr<AllocStatistic> allocStatistic)
-        : storage_(storage),
-          copysetClient_(copysetClient),
-          allocStatistic_(allocStatistic) {}
+        std::shared_ptr<AllocStatistic> allocStatistic,
+        const CleanCoreOption &option = CleanCoreOption());
+
+    ~CleanCore();
 
     /**
      * @brief 删除快照文件，更新task状态
@@ -74,12 +91,46 @@ class CleanCore {
                                    TaskProgress* progress);
 
  private:
-    int DeleteChunksInSegment(const PageFileSegment& segment,
-                              const SeqNum& seq);
+    // 删除一个chunk或chunk快照, 成功返回0
+    using ChunkCleaner =
+        std::function<int(LogicalPoolID, CopysetID, ChunkID)>;
+
+    /**
+     * @brief 加载文件第[start, start + num)个segment
+     * @param id: segment所属文件的inodeid
+     * @param segmentSize: segment大小
+     * @param[out] segments: 存在的segment
+     * @param[out] offsets: 存在的segment的偏移
+     * @return 是否加载成功, segment不存在不算失败
+     */
+    bool LoadSegments(InodeID id, uint64_t segmentSize, uint32_t start,
+                      uint32_t num, std::vector<PageFileSegment> *segments,
+                      std::vector<uint64_t> *offsets);
+
+    /**
+     * @brief 删除segments中所有的chunk. 配置了删除线程时, chunk按copyset分组,
+     *        同一copyset的chunk串行删除, 最多chunkDeleteWindow个copyset
+     *        在共享线程池中并发删除; 否则按顺序串行删除
+     * @return 全部删除成功返回0, 否则返回第一个失败的错误码
+     */
+    int CleanChunks(const std::vector<PageFileSegment> &segments,
+                    const ChunkCleaner &cleaner);
+
+    int CleanChunk(const ChunkCleaner &cleaner, LogicalPoolID logicalPoolId,
+                   CopysetID copysetId, ChunkID chunkId);
+
+    int DeleteChunksInSegments(const std::vector<PageFileSegment> &segments,
+                               const SeqNum& seq);
 
     std::shared_ptr<NameServerStorage> storage_;
     std::shared_ptr<CopysetClient> copysetClient_;
     std::shared_ptr<AllocStatistic> allocStatistic_;
+    CleanCoreOption option_;
+
+    // 所有清理任务共享的删除chunk的线程池
+    std::unique_ptr<TaskThreadPool<>> chunkDeleteWorkers_;
+    // 所有清理任务共享的删除chunk限流
+    Throttle chunkDeleteThrottle_;
 };
 
 }  // namespace mds
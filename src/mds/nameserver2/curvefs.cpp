@@ -40,6 +40,7 @@
 
 using curve::common::TimeUtility;
 using curve::common::kDefaultPoolsetName;
+using curve::kvstorage::kMaxTxnOps;
 using curve::mds::topology::LogicalPool;
 using curve::mds::topology::LogicalPoolIdType;
 using curve::mds::topology::PhysicalPool;
@@ -1302,6 +1303,9 @@ StatusCode CurveFS::GetOrAllocateSegment(const std::string & filename,
                 LOG(ERROR) << "AllocateChunkSegment error";
                 return StatusCode::kSegmentAllocateError;
             }
+            if (fileInfo.has_dirtytrackingseqnum()) {
+                segment->set_dirtyseqnum(fileInfo.seqnum());
+            }
             int64_t revision;
             if (storage_->PutSegment(fileInfo.id(), offset, segment, &revision)
                 != StoreStatus::OK) {
@@ -1325,6 +1329,101 @@ StatusCode CurveFS::GetOrAllocateSegment(const std::string & filename,
     }
 }
 
+StatusCode CurveFS::GetOrAllocateSegments(const std::string & filename,
+        const std::vector<offset_t> &offsets, bool allocateIfNoExist,
+        std::vector<PageFileSegment> *segments) {
+    assert(segments != nullptr);
+
+    if (offsets.empty() || offsets.size() > kMaxTxnOps) {
+        LOG(INFO) << "invalid segment number: " << offsets.size();
+        return StatusCode::kParaError;
+    }
+
+    FileInfo  fileInfo;
+    auto ret = GetFileInfo(filename, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        LOG(INFO) << "get source file error, errCode = " << ret;
+        return  ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE) {
+        LOG(INFO) << "not pageFile, can't do this";
+        return StatusCode::kParaError;
+    }
+
+    std::set<offset_t> uniqueOffsets;
+    for (auto offset : offsets) {
+        if (offset % fileInfo.segmentsize() != 0) {
+            LOG(INFO) << "offset not align with segment";
+            return StatusCode::kParaError;
+        }
+        if (offset + fileInfo.segmentsize() > fileInfo.length()) {
+            LOG(INFO) << "bigger than file length, first extentFile";
+            return StatusCode::kParaError;
+        }
+        uniqueOffsets.insert(offset);
+    }
+
+    std::vector<PageFileSegment> newSegments;
+    for (auto offset : uniqueOffsets) {
+        PageFileSegment segment;
+        auto storeRet = storage_->GetSegment(fileInfo.id(), offset, &segment);
+        if (storeRet == StoreStatus::OK) {
+            segments->emplace_back(std::move(segment));
+            continue;
+        } else if (storeRet != StoreStatus::KeyNotExist) {
+            return StatusCode::KInternalError;
+        }
+
+        if (!allocateIfNoExist) {
+            continue;
+        }
+
+        auto ifok = chunkSegAllocator_->AllocateChunkSegment(
+                fileInfo.filetype(), fileInfo.segmentsize(),
+                fileInfo.chunksize(),
+                fileInfo.has_poolset() ? fileInfo.poolset()
+                                       : kDefaultPoolsetName,
+                offset, &segment);
+        if (ifok == false) {
+            LOG(ERROR) << "AllocateChunkSegment error";
+            return StatusCode::kSegmentAllocateError;
+        }
+        if (fileInfo.has_dirtytrackingseqnum()) {
+            segment.set_dirtyseqnum(fileInfo.seqnum());
+        }
+        newSegments.emplace_back(std::move(segment));
+    }
+
+    if (newSegments.empty()) {
+        return StatusCode::kOK;
+    }
+
+    int64_t revision;
+    if (storage_->PutSegments(fileInfo.id(), newSegments, &revision)
+        != StoreStatus::OK) {
+        LOG(ERROR) << "PutSegments fail, fileInfo.id() = " << fileInfo.id()
+                   << ", segment number = " << newSegments.size();
+        segments->clear();
+        return StatusCode::kStorageError;
+    }
+
+    // the segments share the revision of the transaction, report the
+    // allocated size of each logical pool once
+    std::map<PoolIdType, int64_t> allocSizes;
+    for (auto &segment : newSegments) {
+        allocSizes[segment.logicalpoolid()] += segment.segmentsize();
+        segments->emplace_back(std::move(segment));
+    }
+    for (const auto &item : allocSizes) {
+        allocStatistic_->AllocSpace(item.first, item.second, revision);
+    }
+
+    LOG(INFO) << "alloc " << newSegments.size()
+              << " segments success, fileInfo.id() = " << fileInfo.id();
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::DeAllocateSegment(const std::string& fileName,
                                       uint64_t offset) {
     FileInfo fileInfo;
@@ -1393,6 +1492,67 @@ StatusCode CurveFS::DeAllocateSegment(const std::string& fileName,
     return StatusCode::kOK;
 }
 
+StatusCode CurveFS::MarkSegmentsDirty(const std::string &filename,
+                                      const std::vector<offset_t> &offsets,
+                                      FileSeqType seq) {
+    if (offsets.empty() || offsets.size() > kMaxTxnOps) {
+        LOG(INFO) << "invalid segment number: " << offsets.size();
+        return StatusCode::kParaError;
+    }
+
+    FileInfo fileInfo;
+    auto ret = GetFileInfo(filename, &fileInfo);
+    if (ret != StatusCode::kOK) {
+        LOG(INFO) << "get source file error, errCode = " << ret;
+        return ret;
+    }
+
+    if (fileInfo.filetype() != FileType::INODE_PAGEFILE) {
+        LOG(INFO) << "not pageFile, can't do this";
+        return StatusCode::kParaError;
+    }
+
+    // the client may write with the seqNum before the latest snapshot
+    // until it refreshes the session, record the higher one
+    FileSeqType dirtySeq = std::max(seq, fileInfo.seqnum());
+    std::set<offset_t> uniqueOffsets(offsets.begin(), offsets.end());
+    std::vector<PageFileSegment> dirtySegments;
+    for (auto offset : uniqueOffsets) {
+        if (CheckSegmentOffset(fileInfo, offset) == false) {
+            LOG(INFO) << "MarkSegmentsDirty check offset failed, filename = "
+                      << filename << ", offset = " << offset;
+            return StatusCode::kParaError;
+        }
+
+        PageFileSegment segment;
+        auto storeRet = storage_->GetSegment(fileInfo.id(), offset, &segment);
+        if (storeRet == StoreStatus::KeyNotExist) {
+            continue;
+        } else if (storeRet != StoreStatus::OK) {
+            return StatusCode::KInternalError;
+        }
+        if (segment.dirtyseqnum() >= dirtySeq) {
+            continue;
+        }
+        segment.set_dirtyseqnum(dirtySeq);
+        dirtySegments.emplace_back(std::move(segment));
+    }
+
+    if (dirtySegments.empty()) {
+        return StatusCode::kOK;
+    }
+
+    int64_t revision;
+    if (storage_->PutSegments(fileInfo.id(), dirtySegments, &revision)
+        != StoreStatus::OK) {
+        LOG(ERROR) << "MarkSegmentsDirty PutSegments fail, fileInfo.id() = "
+                   << fileInfo.id()
+                   << ", segment number = " << dirtySegments.size();
+        return StatusCode::kStorageError;
+    }
+    return StatusCode::kOK;
+}
+
 StatusCode CurveFS::CreateSnapShotFile(const std::string &fileName,
                                     FileInfo *snapshotFileInfo) {
     FileInfo  parentFileInfo;
@@ -1714,7 +1874,8 @@ StatusCode CurveFS::OpenFile(const std::string &fileName,
                              const std::string &clientIP,
                              ProtoSession *protoSession,
                              FileInfo  *fileInfo,
-                             CloneSourceSegment* cloneSourceSegment) {
+                             CloneSourceSegment* cloneSourceSegment,
+                             bool markSegmentsDirty) {
     // check the existence of the file
     StatusCode ret;
     ret = GetFileInfo(fileName, fileInfo);
@@ -1746,6 +1907,27 @@ StatusCode CurveFS::OpenFile(const std::string &fileName,
         return ListCloneSourceFileSegments(fileInfo, cloneSourceSegment);
     }
 
+    // a client that does not mark segments may write any segment, stop
+    // tracking until all clients mark again
+    bool tracked = fileInfo->has_dirtytrackingseqnum();
+    bool trackable = fileInfo->filestatus() == FileStatus::kFileCreated ||
+                     fileInfo->filestatus() == FileStatus::kFileCloned;
+    if (tracked != (markSegmentsDirty && trackable)) {
+        if (tracked) {
+            fileInfo->clear_dirtytrackingseqnum();
+        } else {
+            fileInfo->set_dirtytrackingseqnum(fileInfo->seqnum());
+        }
+        ret = PutFile(*fileInfo);
+        if (ret != StatusCode::kOK) {
+            LOG(ERROR) << "OpenFile update dirty tracking error, fileName = "
+                       << fileName << ", clientIP = " << clientIP
+                       << ", errCode = " << ret
+                       << ", errName = " << StatusCode_Name(ret);
+            return ret;
+        }
+    }
+
     if (!fileInfo->blocksize()) {
         fileInfo->set_blocksize(g_block_size);
     }
@@ -300,6 +300,25 @@ class CurveFS {
         offset_t offset,
         bool allocateIfNoExist, PageFileSegment *segment);
 
+    /**
+     *  @brief query several segments of one file, segments not exist are
+     *         allocated if allocateIfNoExist is true, and all new segments
+     *         are persisted in one transaction
+     *
+     *  @param filename
+     *  @param offsets: start offsets of the segments, at most
+     *                  kMaxTxnOps offsets are allowed
+     *  @param allocateIfNoExist: If the segment does not exist,
+     *                            whether or not creating a new one
+     *  @param segments: Return the allocated segments, segments not
+     *                   allocated are skipped if allocateIfNoExist is false
+     *  @return StatusCode::kOK if succeeded
+     */
+    StatusCode GetOrAllocateSegments(
+        const std::string & filename,
+        const std::vector<offset_t> &offsets,
+        bool allocateIfNoExist, std::vector<PageFileSegment> *segments);
+
     /**
      * @brief deallocate file segment start at offset
      * @param filename
@@ -308,6 +327,18 @@ class CurveFS {
      */
     StatusCode DeAllocateSegment(const std::string& filename, uint64_t offset);
 
+    /**
+     * @brief mark the allocated segments as written at seq, dirtySeqNum of
+     *        the segment only grows, unallocated segments are ignored
+     * @param filename
+     * @param offsets: start offsets of the segments
+     * @param seq: seqNum the client writes with
+     * @return On success, return StatusCode::kOK
+     */
+    StatusCode MarkSegmentsDirty(const std::string &filename,
+                                 const std::vector<offset_t> &offsets,
+                                 FileSeqType seq);
+
     /**
      *  @brief get the root file info
      *  @param
@@ -390,13 +421,17 @@ class CurveFS {
      *  @param clientIP
      *  @param[out] session: session information created
      *  @param[out] fileInfo: opened file information
+     *  @param markSegmentsDirty: whether the client marks segments dirty
+     *         before writing them, dirty tracking of the file is started if
+     *         true and stopped otherwise
      *  @return StatusCode::kOK if succeeded
      */
     StatusCode OpenFile(const std::string &fileName,
                         const std::string &clientIP,
                         ProtoSession *protoSession,
                         FileInfo  *fileInfo,
-                        CloneSourceSegment* cloneSourceSegment = nullptr);
+                        CloneSourceSegment* cloneSourceSegment = nullptr,
+                        bool markSegmentsDirty = false);
 
     /**
      *  @brief close file
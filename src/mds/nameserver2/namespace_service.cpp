@@ -505,6 +505,119 @@ void NameSpaceService::GetOrAllocateSegment(
     return;
 }
 
+void NameSpaceService::GetOrAllocateSegments(
+                    ::google::protobuf::RpcController* controller,
+                    const ::curve::mds::GetOrAllocateSegmentsRequest* request,
+                    ::curve::mds::GetOrAllocateSegmentsResponse* response,
+                    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    ExpiredTime expiredTime;
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(WARNING)
+            << "logid = " << cntl->log_id()
+            << ", GetOrAllocateSegments request path is invalid, filename = "
+            << request->filename() << ", segment number = "
+            << request->offsets_size()
+            << ", allocateTag = " << request->allocateifnotexist();
+        return;
+    }
+
+    LOG(INFO) << "logid = " << cntl->log_id()
+        << ", GetOrAllocateSegments request, filename = "
+        << request->filename()
+        << ", segment number = " << request->offsets_size()
+        << ", allocateTag = " << request->allocateifnotexist();
+
+    FileWriteLockGuard guard(fileLockManager_, request->filename());
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode;
+    retCode = kCurveFS.CheckFileOwner(request->filename(), request->owner(),
+                                      signature, request->date());
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                << ", CheckFileOwner fail, filename = " <<  request->filename()
+                << ", owner = " << request->owner()
+                << ", statusCode = " << retCode;
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                << ", CheckFileOwner fail, filename = " <<  request->filename()
+                << ", owner = " << request->owner()
+                << ", statusCode = " << retCode;
+        }
+        return;
+    }
+
+    if (request->allocateifnotexist() && request->has_epoch()) {
+        retCode = kCurveFS.CheckEpoch(request->filename(), request->epoch());
+        if (retCode != StatusCode::kOK) {
+            response->set_statuscode(retCode);
+            if (google::ERROR != GetMdsLogLevel(retCode)) {
+                LOG(WARNING) << "logid = " << cntl->log_id()
+                    << ", CheckEpoch fail, filename = " <<  request->filename()
+                    << ", epoch = " << request->epoch()
+                    << ", statusCode = " << retCode;
+            } else {
+                LOG(ERROR) << "logid = " << cntl->log_id()
+                    << ", CheckEpoch fail, filename = " <<  request->filename()
+                    << ", epoch = " << request->epoch()
+                    << ", statusCode = " << retCode;
+            }
+            return;
+        }
+    }
+
+    std::vector<offset_t> offsets(request->offsets().begin(),
+                                  request->offsets().end());
+    std::vector<PageFileSegment> segments;
+    retCode = kCurveFS.GetOrAllocateSegments(request->filename(), offsets,
+                request->allocateifnotexist(), &segments);
+
+    if (retCode != StatusCode::kOK)  {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                << ", GetOrAllocateSegments fail, filename = "
+                <<  request->filename()
+                << ", segment number = " << request->offsets_size()
+                << ", allocateTag = " << request->allocateifnotexist()
+                << ", statusCode = " << retCode
+                << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                << ", cost " << expiredTime.ExpiredMs() << " ms";
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                << ", GetOrAllocateSegments fail, filename = "
+                <<  request->filename()
+                << ", segment number = " << request->offsets_size()
+                << ", allocateTag = " << request->allocateifnotexist()
+                << ", statusCode = " << retCode
+                << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                << ", cost " << expiredTime.ExpiredMs() << " ms";
+        }
+    } else {
+        response->set_statuscode(StatusCode::kOK);
+        for (auto& segment : segments) {
+            response->add_pagefilesegments()->Swap(&segment);
+        }
+        LOG(INFO) << "logid = " << cntl->log_id()
+                  << ", GetOrAllocateSegments ok, filename = "
+                  << request->filename()
+                  << ", segment number = " << request->offsets_size()
+                  << ", allocateTag = " << request->allocateifnotexist()
+                  << ", cost " << expiredTime.ExpiredMs() << " ms";
+    }
+    return;
+}
+
 void NameSpaceService::DeAllocateSegment(
     ::google::protobuf::RpcController* controller,
     const ::curve::mds::DeAllocateSegmentRequest* request,
@@ -584,6 +697,80 @@ void NameSpaceService::DeAllocateSegment(
     return;
 }
 
+void NameSpaceService::MarkSegmentsDirty(
+    ::google::protobuf::RpcController* controller,
+    const ::curve::mds::MarkSegmentsDirtyRequest* request,
+    ::curve::mds::MarkSegmentsDirtyResponse* response,
+    ::google::protobuf::Closure* done) {
+    brpc::ClosureGuard doneGuard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+    butil::Timer timer;
+    timer.start();
+
+    if (!isPathValid(request->filename())) {
+        response->set_statuscode(StatusCode::kParaError);
+        LOG(ERROR) << "logid = " << cntl->log_id()
+                   << ", MarkSegmentsDirty request path is invalid, "
+                   << request->ShortDebugString();
+        return;
+    }
+
+    FileWriteLockGuard guard(fileLockManager_, request->filename());
+
+    std::string signature;
+    if (request->has_signature()) {
+        signature = request->signature();
+    }
+
+    StatusCode retCode;
+    retCode = kCurveFS.CheckFileOwner(request->filename(), request->owner(),
+                                      signature, request->date());
+    if (retCode != StatusCode::kOK) {
+        response->set_statuscode(retCode);
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", MarkSegmentsDirty CheckFileOwner fail, "
+                         << request->ShortDebugString()
+                         << ", retCode = " << retCode;
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                       << ", MarkSegmentsDirty CheckFileOwner fail, "
+                       << request->ShortDebugString()
+                       << ", retCode = " << retCode;
+        }
+        return;
+    }
+
+    std::vector<offset_t> offsets(request->offsets().begin(),
+                                  request->offsets().end());
+    retCode = kCurveFS.MarkSegmentsDirty(request->filename(), offsets,
+                                         request->seqnum());
+
+    timer.stop();
+    response->set_statuscode(retCode);
+    if (retCode != StatusCode::kOK) {
+        if (google::ERROR != GetMdsLogLevel(retCode)) {
+            LOG(WARNING) << "logid = " << cntl->log_id()
+                         << ", MarkSegmentsDirty fail, "
+                         << request->ShortDebugString()
+                         << ", statusCode = " << retCode
+                         << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                         << ", cost " << timer.m_elapsed(0.0) << " ms";
+        } else {
+            LOG(ERROR) << "logid = " << cntl->log_id()
+                       << ", MarkSegmentsDirty fail, "
+                       << request->ShortDebugString()
+                       << ", statusCode = " << retCode
+                       << ", StatusCode_Name = " << StatusCode_Name(retCode)
+                       << ", cost " << timer.m_elapsed(0.0) << " ms";
+        }
+    } else {
+        DVLOG(6) << "logid = " << cntl->log_id() << ", MarkSegmentsDirty ok, "
+                 << request->ShortDebugString() << ", cost "
+                 << timer.m_elapsed(0.0) << " ms";
+    }
+}
+
 void NameSpaceService::RenameFile(::google::protobuf::RpcController* controller,
                          const ::curve::mds::RenameFileRequest* request,
                          ::curve::mds::RenameFileResponse* response,
@@ -1490,7 +1677,8 @@ void NameSpaceService::OpenFile(::google::protobuf::RpcController* controller,
                                 clientIP,
                                 protoSession,
                                 fileInfo,
-                                cloneSourceSegment);
+                                cloneSourceSegment,
+                                request->marksegmentsdirty());
     if (retCode != StatusCode::kOK)  {
         response->set_statuscode(retCode);
         if (google::ERROR != GetMdsLogLevel(retCode)) {
@@ -96,12 +96,23 @@ class NameSpaceService: public CurveFSService {
                        ::curve::mds::GetOrAllocateSegmentResponse* response,
                        ::google::protobuf::Closure* done) override;
 
+    void GetOrAllocateSegments(::google::protobuf::RpcController* controller,
+                    const ::curve::mds::GetOrAllocateSegmentsRequest* request,
+                    ::curve::mds::GetOrAllocateSegmentsResponse* response,
+                    ::google::protobuf::Closure* done) override;
+
     void DeAllocateSegment(
         ::google::protobuf::RpcController* controller,
         const ::curve::mds::DeAllocateSegmentRequest* request,
         ::curve::mds::DeAllocateSegmentResponse* response,
         ::google::protobuf::Closure* done) override;
 
+    void MarkSegmentsDirty(
+        ::google::protobuf::RpcController* controller,
+        const ::curve::mds::MarkSegmentsDirtyRequest* request,
+        ::curve::mds::MarkSegmentsDirtyResponse* response,
+        ::google::protobuf::Closure* done) override;
+
     void RenameFile(::google::protobuf::RpcController* controller,
                        const ::curve::mds::RenameFileRequest* request,
                        ::curve::mds::RenameFileResponse* response,
@@ -30,10 +30,31 @@ using ::curve::common::DISCARDSEGMENTKEYEND;
 using ::curve::common::DISCARDSEGMENTKEYPREFIX;
 using ::curve::common::SNAPSHOTFILEINFOKEYEND;
 using ::curve::common::SNAPSHOTFILEINFOKEYPREFIX;
+using ::curve::kvstorage::kMaxTxnOps;
 
 namespace curve {
 namespace mds {
 
+namespace {
+
+// Get decoded metadata of type T from cache, return false if not cached
+template <typename T>
+bool GetFromCache(const std::shared_ptr<Cache> &cache, const std::string &key,
+                  T *out) {
+    NameSpaceCacheValue value;
+    if (!cache->Get(key, &value)) {
+        return false;
+    }
+    auto cached = std::dynamic_pointer_cast<const T>(value);
+    if (cached == nullptr) {
+        return false;
+    }
+    *out = *cached;
+    return true;
+}
+
+}  // namespace
+
 std::ostream &operator<<(std::ostream &os, StoreStatus &s) {
     os << static_cast<std::underlying_type<StoreStatus>::type>(s);
     return os;
@@ -62,7 +83,7 @@ StoreStatus NameServerStorageImp::PutFile(const FileInfo &fileInfo) {
                    << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(storeKey, encodeFileInfo);
+        cache_->Put(storeKey, std::make_shared<FileInfo>(fileInfo));
     }
 
     return getErrorCode(errCode);
@@ -78,19 +99,19 @@ StoreStatus NameServerStorageImp::GetFile(InodeID parentid,
         return StoreStatus::InternalError;
     }
 
-    int errCode = EtcdErrCode::EtcdOK;
-    std::string out;
-    if (!cache_->Get(storeKey, &out)) {
-        errCode = client_->Get(storeKey, &out);
-
-        if (errCode == EtcdErrCode::EtcdOK) {
-            cache_->Put(storeKey, out);
-        }
+    if (GetFromCache(cache_, storeKey, fileInfo)) {
+        return StoreStatus::OK;
     }
 
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
     if (errCode == EtcdErrCode::EtcdOK) {
-        bool decodeOK = NameSpaceStorageCodec::DecodeFileInfo(out, fileInfo);
+        auto decoded = std::make_shared<FileInfo>();
+        bool decodeOK =
+            NameSpaceStorageCodec::DecodeFileInfo(out, decoded.get());
         if (decodeOK) {
+            *fileInfo = *decoded;
+            cache_->Put(storeKey, std::move(decoded));
             return StoreStatus::OK;
         } else {
             LOG(ERROR) << "decode info error. parentid: " << parentid
@@ -198,7 +219,7 @@ StoreStatus NameServerStorageImp::RenameFile(const FileInfo &oldFInfo,
                    << newFInfo.filename() << "] err: " << errCode;
     } else {
         // update to cache at last
-        cache_->Put(newStoreKey, encodeNewFileInfo);
+        cache_->Put(newStoreKey, std::make_shared<FileInfo>(newFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -281,8 +302,8 @@ StoreStatus NameServerStorageImp::ReplaceFileAndRecycleOldFile(
                    << newFInfo.filename() << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleStoreKey, encodeRecycleFInfo);
-        cache_->Put(newStoreKey, encodeNewFInfo);
+        cache_->Put(recycleStoreKey, std::make_shared<FileInfo>(recycleFInfo));
+        cache_->Put(newStoreKey, std::make_shared<FileInfo>(newFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -336,7 +357,8 @@ NameServerStorageImp::MoveFileToRecycle(const FileInfo &originFileInfo,
                    << "] err: " << errCode;
     } else {
         // update to cache
-        cache_->Put(recycleFileInfoKey, encodeRecycleFInfo);
+        cache_->Put(recycleFileInfoKey,
+                    std::make_shared<FileInfo>(recycleFileInfo));
     }
     return getErrorCode(errCode);
 }
@@ -453,7 +475,48 @@ StoreStatus NameServerStorageImp::PutSegment(InodeID id, uint64_t off,
         LOG(ERROR) << "put segment of logicalPoolId:"
                    << segment->logicalpoolid() << "err:" << errCode;
     } else {
-        cache_->Put(storeKey, encodeSegment);
+        cache_->Put(storeKey, std::make_shared<PageFileSegment>(*segment));
+    }
+    return getErrorCode(errCode);
+}
+
+StoreStatus NameServerStorageImp::PutSegments(
+    InodeID id, const std::vector<PageFileSegment> &segments,
+    int64_t *revision) {
+    if (segments.empty() || segments.size() > kMaxTxnOps) {
+        LOG(ERROR) << "put segments of inodeid: " << id
+                   << " with invalid number: " << segments.size();
+        return StoreStatus::InternalError;
+    }
+
+    // keys and values must outlive the operations that reference them
+    std::vector<std::string> storeKeys(segments.size());
+    std::vector<std::string> encodeSegments(segments.size());
+    std::vector<Operation> ops;
+    ops.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        storeKeys[i] = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+            id, segments[i].startoffset());
+        if (!NameSpaceStorageCodec::EncodeSegment(segments[i],
+                                                  &encodeSegments[i])) {
+            return StoreStatus::InternalError;
+        }
+        ops.emplace_back(Operation{OpType::OpPut,
+            const_cast<char *>(storeKeys[i].c_str()),
+            const_cast<char *>(encodeSegments[i].c_str()),
+            static_cast<int>(storeKeys[i].size()),
+            static_cast<int>(encodeSegments[i].size())});
+    }
+
+    int errCode = client_->TxnNWithRevision(ops, revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "put " << segments.size() << " segments of inodeid: "
+                   << id << " err: " << errCode;
+    } else {
+        for (size_t i = 0; i < segments.size(); i++) {
+            cache_->Put(storeKeys[i],
+                        std::make_shared<PageFileSegment>(segments[i]));
+        }
     }
     return getErrorCode(errCode);
 }
@@ -462,12 +525,12 @@ StoreStatus NameServerStorageImp::GetSegment(InodeID id, uint64_t off,
                                              PageFileSegment *segment) {
     std::string storeKey =
         NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off);
-    int errCode = EtcdErrCode::EtcdOK;
-    std::string out;
-    if (!cache_->Get(storeKey, &out)) {
-        errCode = client_->Get(storeKey, &out);
+    if (GetFromCache(cache_, storeKey, segment)) {
+        return StoreStatus::OK;
     }
 
+    std::string out;
+    int errCode = client_->Get(storeKey, &out);
     if (errCode == EtcdErrCode::EtcdOK) {
         bool decodeOK = NameSpaceStorageCodec::DecodeSegment(out, segment);
         if (decodeOK) {
@@ -501,6 +564,38 @@ StoreStatus NameServerStorageImp::DeleteSegment(InodeID id, uint64_t off,
     return getErrorCode(errCode);
 }
 
+StoreStatus NameServerStorageImp::DeleteSegments(
+    InodeID id, const std::vector<uint64_t> &offs, int64_t *revision) {
+    if (offs.empty() || offs.size() > kMaxTxnOps) {
+        LOG(ERROR) << "delete segments of inodeid: " << id
+                   << " with invalid number: " << offs.size();
+        return StoreStatus::InternalError;
+    }
+
+    // keys must outlive the operations that reference them
+    std::vector<std::string> storeKeys(offs.size());
+    std::vector<Operation> ops;
+    ops.reserve(offs.size());
+    for (size_t i = 0; i < offs.size(); i++) {
+        storeKeys[i] = NameSpaceStorageCodec::EncodeSegmentStoreKey(id,
+                                                                    offs[i]);
+        ops.emplace_back(Operation{OpType::OpDelete,
+            const_cast<char *>(storeKeys[i].c_str()), nullptr,
+            static_cast<int>(storeKeys[i].size()), 0});
+    }
+
+    // update the cache first, then update Etcd
+    for (const auto &storeKey : storeKeys) {
+        cache_->Remove(storeKey);
+    }
+    int errCode = client_->TxnNWithRevision(ops, revision);
+    if (errCode != EtcdErrCode::EtcdOK) {
+        LOG(ERROR) << "delete " << offs.size() << " segments of inodeid: "
+                   << id << " err: " << errCode;
+    }
+    return getErrorCode(errCode);
+}
+
 StoreStatus NameServerStorageImp::ListDiscardSegment(
     std::map<std::string, DiscardSegmentInfo> *discardSegments) {
     assert(discardSegments != nullptr);
@@ -641,8 +736,9 @@ StoreStatus NameServerStorageImp::SnapShotFile(const FileInfo *originFInfo,
                    << ", fileinfo: " << originFInfo->filename() << "err";
     } else {
         // update cache at last
-        cache_->Put(originFileKey, encodeFileInfo);
-        cache_->Put(snapshotFileKey, encodeSnapshot);
+        cache_->Put(originFileKey, std::make_shared<FileInfo>(*originFInfo));
+        cache_->Put(snapshotFileKey,
+                    std::make_shared<FileInfo>(*snapshotFInfo));
     }
     return getErrorCode(errCode);
 }
@@ -41,8 +41,19 @@ namespace mds {
 
 using ::curve::kvstorage::EtcdClientImp;
 using ::curve::kvstorage::KVStorageClient;
+
+// FileInfo or PageFileSegment decoded from etcd. Cached values are shared
+// with readers, so they must never be modified once put into the cache
+using NameSpaceCacheValue = std::shared_ptr<const google::protobuf::Message>;
+
+struct NameSpaceCacheValueTraits {
+    static uint64_t CountBytes(const NameSpaceCacheValue &value) {
+        return value == nullptr ? 0 : value->ByteSizeLong();
+    }
+};
+
 using Cache =
-    ::curve::common::LRUCacheInterface<std::string, std::string>;
+    ::curve::common::LRUCacheInterface<std::string, NameSpaceCacheValue>;
 
 enum class StoreStatus {
     OK = 0,
@@ -211,6 +222,20 @@ class NameServerStorage {
                                     const PageFileSegment * segment,
                                     int64_t *revision) = 0;
 
+    /**
+     * @brief PutSegments: Store several segments of one file in one
+     *                     transaction
+     *
+     * @param[in] id: Inode ID of the target file
+     * @param[in] segments: Segments info, keyed by their startoffset
+     * @param[out] revision: The version number of this operation
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) = 0;
+
     /**
      * @brief DeleteSegment: Delete the specified segment metadata
      *
@@ -223,6 +248,20 @@ class NameServerStorage {
     virtual StoreStatus DeleteSegment(
         InodeID id, uint64_t off, int64_t *revision) = 0;
 
+    /**
+     * @brief DeleteSegments: Delete several segments of one file in one
+     *                        transaction
+     *
+     * @param[in] id: Inode ID of the target file
+     * @param[in] offs: Offsets of the target segments
+     * @param[out] revision: The version number of this operation
+     *
+     * @return StoreStatus: error code
+     */
+    virtual StoreStatus DeleteSegments(InodeID id,
+                            const std::vector<uint64_t> &offs,
+                            int64_t *revision) = 0;
+
     /**
      * @brief Move segment metadata from SegmentTable to DiscardSegmentTable,
      *        another background task will delete all chunks and delete segment
@@ -326,9 +365,17 @@ class NameServerStorageImp : public NameServerStorage {
                             const PageFileSegment * segment,
                             int64_t *revision) override;
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override;
+
     StoreStatus DeleteSegment(
         InodeID id, uint64_t off, int64_t *revision) override;
 
+    StoreStatus DeleteSegments(InodeID id,
+                            const std::vector<uint64_t> &offs,
+                            int64_t *revision) override;
+
     StoreStatus DiscardSegment(const FileInfo& fileInfo,
                              const PageFileSegment& segment) override;
 
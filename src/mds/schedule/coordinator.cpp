@@ -29,6 +29,7 @@
 #include "src/mds/topology/topology_item.h"
 #include "src/mds/schedule/operatorFactory.h"
 #include "src/mds/schedule/operatorStep.h"
+#include "src/common/timeutility.h"
 
 namespace curve {
 namespace mds {
@@ -140,7 +141,13 @@ ChunkServerIdType Coordinator::CopySetHeartbeat(
     // reported by the leader, return true if there's any new configuration
     CopySetConf res;
     bool hasOrder = opController_->ApplyOperator(info, &res);
-    if (hasOrder) {
+    if (!hasOrder) {
+        // the operator is removed if it finished, failed or timeout
+        Operator cur;
+        if (!opController_->GetOperatorById(info.id, &cur)) {
+            OperatorRemoved(op);
+        }
+    } else {
         LOG(INFO) << "going to order operator " << op.OpToString();
         // determine whether the epoch and startEpoch are the same,
         // if not, the operator will not be dispatched
@@ -154,6 +161,7 @@ ChunkServerIdType Coordinator::CopySetHeartbeat(
                          << "on " << info.CopySetInfoStr()
                          << " is stale, remove operator";
             opController_->RemoveOperator(info.id);
+            OperatorRemoved(op);
             return ::curve::mds::topology::UNINTIALIZE_ID;
         }
 
@@ -165,6 +173,7 @@ ChunkServerIdType Coordinator::CopySetHeartbeat(
             LOG(ERROR) << "coordinator can not get chunkServer "
                     << res.configChangeItem << " from topology";
             opController_->RemoveOperator(info.id);
+            OperatorRemoved(op);
             return ::curve::mds::topology::UNINTIALIZE_ID;
         }
         bool needCheckType = (res.type == ConfigChangeType::ADD_PEER ||
@@ -176,6 +185,7 @@ ChunkServerIdType Coordinator::CopySetHeartbeat(
             LOG(WARNING) << "candidate chunkserver " << chunkServer.info.id
                        << " is offline, abort config change";
             opController_->RemoveOperator(info.id);
+            OperatorRemoved(op);
             return ::curve::mds::topology::UNINTIALIZE_ID;
         }
 
@@ -185,6 +195,7 @@ ChunkServerIdType Coordinator::CopySetHeartbeat(
             LOG(ERROR) << "build copyset conf for " << info.CopySetInfoStr()
                        << ") fail, remove operator";
             opController_->RemoveOperator(info.id);
+            OperatorRemoved(op);
             return ::curve::mds::topology::UNINTIALIZE_ID;
         }
 
@@ -237,6 +248,11 @@ int Coordinator::QueryChunkServerRecoverStatus(
 
 void Coordinator::RunScheduler(
     const std::shared_ptr<Scheduler> &s, SchedulerType type) {
+    if (conf_.enableIncrementalSchedule && s->SupportIncrementalSchedule()) {
+        RunIncrementalScheduler(s, type);
+        return;
+    }
+
     while (sleeper_.wait_for(std::chrono::seconds(s->GetRunningInterval()))) {
         if (ScheduleNeedRun(type)) {
             s->Schedule();
@@ -245,6 +261,62 @@ void Coordinator::RunScheduler(
     LOG(INFO) << ScheduleName(type) << " exit.";
 }
 
+void Coordinator::RunIncrementalScheduler(
+    const std::shared_ptr<Scheduler> &s, SchedulerType type) {
+    using ::curve::common::TimeUtility;
+    LOG(INFO) << ScheduleName(type) << " run in incremental mode.";
+    // the first full round is run after the running interval of the
+    // scheduler as before
+    uint64_t nextFullMs =
+        TimeUtility::GetTimeofDayMs() + s->GetRunningInterval() * 1000;
+    while (sleeper_.wait_for(
+        std::chrono::milliseconds(conf_.incrementalScheduleIntervalMs))) {
+        if (!ScheduleNeedRun(type)) {
+            continue;
+        }
+        uint64_t now = TimeUtility::GetTimeofDayMs();
+        if (now >= nextFullMs) {
+            s->Schedule();
+            nextFullMs = TimeUtility::GetTimeofDayMs() +
+                static_cast<uint64_t>(conf_.fullScheduleIntervalSec) * 1000;
+        } else if (s->HasDirty()) {
+            s->IncrementalSchedule();
+        }
+    }
+    LOG(INFO) << ScheduleName(type) << " exit.";
+}
+
+void Coordinator::ChunkServerChanged(ChunkServerIdType csId) {
+    if (!conf_.enableIncrementalSchedule) {
+        return;
+    }
+    for (auto &v : schedulerController_) {
+        if (v.second->SupportIncrementalSchedule()) {
+            v.second->MarkChunkServerDirty(csId);
+        }
+    }
+}
+
+void Coordinator::CopySetChanged(const CopySetKey &key) {
+    if (!conf_.enableIncrementalSchedule) {
+        return;
+    }
+    for (auto &v : schedulerController_) {
+        if (v.second->SupportIncrementalSchedule()) {
+            v.second->MarkCopySetDirty(key);
+        }
+    }
+}
+
+void Coordinator::OperatorRemoved(const Operator &op) {
+    // other copysets waiting for the operator concurrency of the chunkservers
+    // can be scheduled now
+    for (auto csId : op.AffectedChunkServers()) {
+        ChunkServerChanged(csId);
+    }
+    CopySetChanged(op.copysetID);
+}
+
 bool Coordinator::BuildCopySetConf(
     const CopySetConf &res, ::curve::mds::heartbeat::CopySetConf *out) {
     // build the copysetConf need to be returned in heartbeat
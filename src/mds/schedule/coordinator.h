@@ -84,6 +84,23 @@ class Coordinator {
      */
     virtual bool ChunkserverGoingToAdd(ChunkServerIdType csId, CopySetKey key);
 
+    /**
+     * @brief the online state of the chunkserver changed, the copysets on it
+     *        will be checked in next incremental round of the schedulers
+     *
+     * @param[in] csId Chunkserver changed
+     */
+    virtual void ChunkServerChanged(ChunkServerIdType csId);
+
+    /**
+     * @brief the members or epoch of the copyset reported by heartbeat
+     *        changed, it will be checked in next incremental round of the
+     *        schedulers
+     *
+     * @param[in] key Copyset changed
+     */
+    virtual void CopySetChanged(const CopySetKey &key);
+
     /**
      * @brief Initialize the scheduler according to the configuration
      *
@@ -140,6 +157,25 @@ class Coordinator {
      */
     void RunScheduler(const std::shared_ptr<Scheduler> &s, SchedulerType type);
 
+    /**
+     * @brief task for running scheduler in incremental mode, only the changed
+     *        copysets are checked every incrementalScheduleIntervalMs and all
+     *        the copysets are checked every fullScheduleIntervalSec
+     *
+     * @param[in] s Schedulers for running
+     * @param[in] type Scheduler type
+     */
+    void RunIncrementalScheduler(
+        const std::shared_ptr<Scheduler> &s, SchedulerType type);
+
+    /**
+     * @brief the operator is removed, its copyset and chunkservers need to be
+     *        checked again by the incremental schedulers
+     *
+     * @param[in] op Operator removed
+     */
+    void OperatorRemoved(const Operator &op);
+
     /**
      * @brief BuildCopySetConf Build copyset configuration for chunkserver
      *
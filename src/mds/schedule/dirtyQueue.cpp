@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-16
+ */
+
+#include "src/mds/schedule/dirtyQueue.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+using ::curve::common::LockGuard;
+
+void DirtyQueue::PushCopySet(const CopySetKey &key) {
+    LockGuard lk(mutex_);
+    if (copysets_.emplace(key).second) {
+        size_++;
+    }
+}
+
+void DirtyQueue::PushChunkServer(ChunkServerIdType id) {
+    LockGuard lk(mutex_);
+    if (chunkservers_.emplace(id).second) {
+        size_++;
+    }
+}
+
+void DirtyQueue::Take(std::set<CopySetKey> *copysets,
+                      std::set<ChunkServerIdType> *chunkservers) {
+    LockGuard lk(mutex_);
+    copysets->swap(copysets_);
+    chunkservers->swap(chunkservers_);
+    copysets_.clear();
+    chunkservers_.clear();
+    size_.store(0);
+}
+
+void DirtyQueue::Clear() {
+    LockGuard lk(mutex_);
+    copysets_.clear();
+    chunkservers_.clear();
+    size_.store(0);
+}
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-16
+ */
+
+#ifndef SRC_MDS_SCHEDULE_DIRTYQUEUE_H_
+#define SRC_MDS_SCHEDULE_DIRTYQUEUE_H_
+
+#include <set>
+#include "src/common/concurrent/concurrent.h"
+#include "src/mds/topology/topology_item.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+using ::curve::mds::topology::ChunkServerIdType;
+using ::curve::mds::topology::CopySetKey;
+
+/**
+ * @brief DirtyQueue collects the copysets and chunkservers changed since they
+ *        were taken last time, a scheduler in incremental mode only checks the
+ *        copysets taken from its queue. Ids pushed repeatedly are merged.
+ */
+class DirtyQueue {
+ public:
+    DirtyQueue() : size_(0) {}
+
+    void PushCopySet(const CopySetKey &key);
+
+    void PushChunkServer(ChunkServerIdType id);
+
+    bool Empty() const {
+        return size_.load() == 0;
+    }
+
+    /**
+     * @brief take all the ids out of the queue
+     *
+     * @param[out] copysets copysets changed
+     * @param[out] chunkservers chunkservers changed
+     */
+    void Take(std::set<CopySetKey> *copysets,
+              std::set<ChunkServerIdType> *chunkservers);
+
+    void Clear();
+
+ private:
+    ::curve::common::Mutex mutex_;
+    std::set<CopySetKey> copysets_;
+    std::set<ChunkServerIdType> chunkservers_;
+    // number of ids in queue, for checking emptiness without the lock
+    ::curve::common::Atomic<uint64_t> size_;
+};
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_SCHEDULE_DIRTYQUEUE_H_
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-17
+ */
+
+#include "src/mds/schedule/recoverPlanner.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <utility>
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+RecoverPlanner::RecoverPlanner(const ScheduleOption &opt,
+    const std::shared_ptr<TopoAdapter> &topo,
+    const std::shared_ptr<OperatorController> &opController)
+    : topo_(topo), opController_(opController),
+      clusterBandwidth_(opt.recoverClusterBandwidth),
+      chunkServerBandwidth_(opt.recoverChunkServerBandwidth),
+      opBandwidth_(std::max<uint64_t>(opt.recoverOpDefaultBandwidth, 1)),
+      clusterOps_(std::numeric_limits<int>::max()),
+      chunkServerOps_(std::numeric_limits<int>::max()),
+      running_(0) {}
+
+void RecoverPlanner::Refresh() {
+    running_ = 0;
+    load_.clear();
+
+    // only adding peer and changing peer transfer data, the leader sends
+    // snapshot to the target
+    std::map<ChunkServerIdType, int> sources;
+    for (const auto &op : opController_->GetOperators()) {
+        std::vector<ChunkServerIdType> targets = op.AffectedChunkServers();
+        if (targets.empty()) {
+            continue;
+        }
+        running_++;
+        for (auto target : targets) {
+            load_[target]++;
+        }
+        CopySetInfo info;
+        if (topo_->GetCopySetInfo(op.copysetID, &info) &&
+            info.leader != UNINTIALIZE_ID) {
+            load_[info.leader]++;
+            sources[info.leader]++;
+        }
+    }
+
+    // the install snapshot throughput of a source is shared by the
+    // recoveries on it, sources not sending yet are not counted
+    uint64_t observed = 0;
+    int samples = 0;
+    for (const auto &item : sources) {
+        ChunkServerInfo csInfo;
+        if (!topo_->GetChunkServerInfo(item.first, &csInfo) ||
+            csInfo.installSnapshotRate == 0) {
+            continue;
+        }
+        observed += csInfo.installSnapshotRate / item.second;
+        samples++;
+    }
+    if (samples > 0) {
+        // the rate reported is a recent average, smooth it again to avoid
+        // admitting too many recoveries by a transient low
+        opBandwidth_ = std::max<uint64_t>(
+            (opBandwidth_ + observed / samples) / 2, 1);
+    }
+
+    clusterOps_ = static_cast<int>(std::min<uint64_t>(
+        std::max<uint64_t>(clusterBandwidth_ / opBandwidth_, 1),
+        std::numeric_limits<int>::max()));
+    if (chunkServerBandwidth_ == 0) {
+        chunkServerOps_ = std::numeric_limits<int>::max();
+    } else {
+        chunkServerOps_ = static_cast<int>(std::min<uint64_t>(
+            std::max<uint64_t>(chunkServerBandwidth_ / opBandwidth_, 1),
+            std::numeric_limits<int>::max()));
+    }
+}
+
+void RecoverPlanner::Plan(std::vector<RecoverTask> *tasks) const {
+    std::map<ChunkServerIdType, std::deque<RecoverTask>> bySource;
+    for (auto &task : *tasks) {
+        bySource[task.info.leader].emplace_back(std::move(task));
+    }
+    tasks->clear();
+
+    std::vector<ChunkServerIdType> sources;
+    for (const auto &item : bySource) {
+        sources.emplace_back(item.first);
+    }
+    std::stable_sort(sources.begin(), sources.end(),
+        [this](ChunkServerIdType a, ChunkServerIdType b) {
+            return GetLoad(a) < GetLoad(b);
+        });
+
+    bool left = true;
+    while (left) {
+        left = false;
+        for (auto source : sources) {
+            auto &queue = bySource[source];
+            if (queue.empty()) {
+                continue;
+            }
+            tasks->emplace_back(std::move(queue.front()));
+            queue.pop_front();
+            left = true;
+        }
+    }
+}
+
+std::set<ChunkServerIdType> RecoverPlanner::SaturatedChunkServers() const {
+    std::set<ChunkServerIdType> res;
+    for (const auto &item : load_) {
+        if (item.second >= chunkServerOps_) {
+            res.emplace(item.first);
+        }
+    }
+    return res;
+}
+
+void RecoverPlanner::Admit(ChunkServerIdType source,
+                           ChunkServerIdType target) {
+    running_++;
+    if (source != UNINTIALIZE_ID) {
+        load_[source]++;
+    }
+    load_[target]++;
+}
+
+int RecoverPlanner::GetLoad(ChunkServerIdType id) const {
+    auto it = load_.find(id);
+    return it == load_.end() ? 0 : it->second;
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
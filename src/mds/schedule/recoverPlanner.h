@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-17
+ */
+
+#ifndef SRC_MDS_SCHEDULE_RECOVERPLANNER_H_
+#define SRC_MDS_SCHEDULE_RECOVERPLANNER_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include "src/mds/schedule/schedule_define.h"
+#include "src/mds/schedule/topoAdapter.h"
+#include "src/mds/schedule/operatorController.h"
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+struct RecoverTask {
+    CopySetInfo info;
+    // the offline replica to be replaced
+    ChunkServerIdType offlinePeer;
+};
+
+/**
+ * @brief RecoverPlanner decides which recoveries transferring data can be
+ *        started. The leader of the copyset installs snapshot to the new
+ *        replica, so a recovery takes bandwidth on both the leader(source)
+ *        and the new replica(target). The bandwidth of one recovery is
+ *        estimated by the install snapshot throughput reported by heartbeat,
+ *        then recoveries are admitted until the cluster-wide bandwidth target
+ *        is reached, and no chunkserver takes more than its bandwidth cap.
+ *        Pending recoveries are ordered by turns of sources so that as many
+ *        chunkservers as possible work in parallel.
+ */
+class RecoverPlanner {
+ public:
+    RecoverPlanner(const ScheduleOption &opt,
+                   const std::shared_ptr<TopoAdapter> &topo,
+                   const std::shared_ptr<OperatorController> &opController);
+
+    /**
+     * @brief whether recovery is limited by bandwidth, otherwise it's only
+     *        limited by operator concurrency
+     */
+    bool Enabled() const {
+        return clusterBandwidth_ > 0;
+    }
+
+    /**
+     * @brief update the estimated bandwidth of one recovery, and the load
+     *        of chunkservers by the running operators transferring data.
+     *        called at the beginning of every round
+     */
+    void Refresh();
+
+    /**
+     * @brief order the tasks: take one task of every source by turns, and
+     *        the sources with less load go first
+     *
+     * @param[in/out] tasks Tasks to order
+     */
+    void Plan(std::vector<RecoverTask> *tasks) const;
+
+    /**
+     * @brief whether the cluster can take one more recovery
+     */
+    bool HasQuota() const {
+        return running_ < clusterOps_;
+    }
+
+    /**
+     * @brief whether the chunkserver can take one more recovery as source
+     *        or target
+     */
+    bool Available(ChunkServerIdType id) const {
+        return GetLoad(id) < chunkServerOps_;
+    }
+
+    /**
+     * @brief chunkservers can not take any more recovery
+     */
+    std::set<ChunkServerIdType> SaturatedChunkServers() const;
+
+    /**
+     * @brief record the recovery admitted in this round
+     *
+     * @param[in] source Leader of the copyset
+     * @param[in] target Replica added
+     */
+    void Admit(ChunkServerIdType source, ChunkServerIdType target);
+
+    uint64_t GetOpBandwidth() const {
+        return opBandwidth_;
+    }
+
+    int GetRunningNum() const {
+        return running_;
+    }
+
+    int GetClusterOps() const {
+        return clusterOps_;
+    }
+
+    int GetChunkServerOps() const {
+        return chunkServerOps_;
+    }
+
+ private:
+    int GetLoad(ChunkServerIdType id) const;
+
+ private:
+    std::shared_ptr<TopoAdapter> topo_;
+    std::shared_ptr<OperatorController> opController_;
+
+    // target bandwidth of recovery in the cluster and on one chunkserver
+    uint64_t clusterBandwidth_;
+    uint64_t chunkServerBandwidth_;
+    // estimated bandwidth of one recovery
+    uint64_t opBandwidth_;
+
+    // max number of recoveries in the cluster and on one chunkserver
+    int clusterOps_;
+    int chunkServerOps_;
+    // number of running operators transferring data
+    int running_;
+    // number of running operators on every chunkserver as source or target
+    std::map<ChunkServerIdType, int> load_;
+};
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_SCHEDULE_RECOVERPLANNER_H_
@@ -32,6 +32,12 @@ namespace mds {
 namespace schedule {
 int RecoverScheduler::Schedule() {
     LOG(INFO) << "recoverScheduler begin.";
+    // all the copysets are checked in this round
+    dirtyQueue_.Clear();
+    deferred_.clear();
+    if (planner_.Enabled()) {
+        planner_.Refresh();
+    }
     int oneRoundGenOp = 0;
 
     // if over certain amount of chunkserver are downed on a server, these
@@ -39,115 +45,228 @@ int RecoverScheduler::Schedule() {
     std::set<ChunkServerIdType> excludes;
     CalculateExcludesChunkServer(&excludes);
 
+    std::vector<RecoverTask> tasks;
     for (auto copysetInfo : topo_->GetCopySetInfos()) {
-        // skip the copyset under configuration change
-        Operator op;
-        if (opController_->GetOperatorById(copysetInfo.id, &op)) {
-            continue;
+        if (RecoverCopySet(copysetInfo, excludes, &tasks)) {
+            oneRoundGenOp++;
         }
+    }
+    oneRoundGenOp += RecoverTasks(&tasks);
+    LOG(INFO) << "recoverScheduler generate " << oneRoundGenOp
+              << " operators at this round";
+    LogPlannerStatus();
+    return 1;
+}
 
-        if (copysetInfo.HasCandidate()) {
-            LOG(WARNING) << copysetInfo.CopySetInfoStr()
-                         << " already has candidate: "
-                         << copysetInfo.candidatePeerInfo.id;
-            continue;
+int RecoverScheduler::IncrementalSchedule() {
+    std::vector<CopySetInfo> copysets = TakeDirtyCopySets();
+    if (planner_.Enabled()) {
+        planner_.Refresh();
+        TakeDeferredCopySets(&copysets);
+    }
+    if (copysets.empty()) {
+        return 1;
+    }
+
+    int oneRoundGenOp = 0;
+    std::set<ChunkServerIdType> excludes;
+    CalculateExcludesChunkServer(&excludes);
+    std::vector<RecoverTask> tasks;
+    for (const auto &copysetInfo : copysets) {
+        if (RecoverCopySet(copysetInfo, excludes, &tasks)) {
+            oneRoundGenOp++;
         }
+    }
+    oneRoundGenOp += RecoverTasks(&tasks);
+    LOG(INFO) << "recoverScheduler check " << copysets.size()
+              << " changed copysets and generate " << oneRoundGenOp
+              << " operators at this incremental round";
+    LogPlannerStatus();
+    return 1;
+}
 
-        std::set<ChunkServerIdType> offlinelists;
-        // check if there's any offline replica
-        for (auto peer : copysetInfo.peers) {
-            ChunkServerInfo csInfo;
-            if (!topo_->GetChunkServerInfo(peer.id, &csInfo)) {
-                LOG(WARNING) << "recover scheduler: can not get " << peer.id
-                             << " from topology" << std::endl;
-                continue;
-            }
+bool RecoverScheduler::RecoverCopySet(const CopySetInfo &copysetInfo,
+    const std::set<ChunkServerIdType> &excludes,
+    std::vector<RecoverTask> *tasks) {
+    // skip the copyset under configuration change
+    Operator op;
+    if (opController_->GetOperatorById(copysetInfo.id, &op)) {
+        return false;
+    }
 
-            if (!csInfo.IsOffline()) {
-                continue;
-            } else {
-                offlinelists.emplace(peer.id);
-            }
-        }
+    if (copysetInfo.HasCandidate()) {
+        LOG(WARNING) << copysetInfo.CopySetInfoStr()
+                     << " already has candidate: "
+                     << copysetInfo.candidatePeerInfo.id;
+        return false;
+    }
 
-        // do nothing if all replicas are online
-        if (offlinelists.size() == 0) {
+    std::set<ChunkServerIdType> offlinelists;
+    // check if there's any offline replica
+    for (auto peer : copysetInfo.peers) {
+        ChunkServerInfo csInfo;
+        if (!topo_->GetChunkServerInfo(peer.id, &csInfo)) {
+            LOG(WARNING) << "recover scheduler: can not get " << peer.id
+                         << " from topology" << std::endl;
             continue;
         }
 
-        // alarm if over half of the replicas are offline
-        int deadBound =
-            copysetInfo.peers.size() - (copysetInfo.peers.size() / 2 + 1);
-        if (static_cast<int>(offlinelists.size()) > deadBound) {
-            LOG(ERROR) << "recoverSchdeuler find "
-                       << copysetInfo.CopySetInfoStr() << " has "
-                       << offlinelists.size()
-                       << " replica offline, cannot repair, please check";
+        if (!csInfo.IsOffline()) {
             continue;
+        } else {
+            offlinelists.emplace(peer.id);
         }
+    }
+
+    // do nothing if all replicas are online
+    if (offlinelists.size() == 0) {
+        return false;
+    }
 
-        // offline replicas in excludes will not be recovered
-        for (auto it = offlinelists.begin(); it != offlinelists.end();) {
-            if (excludes.count(*it) > 0) {
-                LOG(ERROR) << "can not recover offline chunkserver " << *it
-                           << " on " << copysetInfo.CopySetInfoStr()
-                           << ", because it's server has more than "
-                           << chunkserverFailureTolerance_
-                           << " offline chunkservers";
-                it = offlinelists.erase(it);
-            } else {
-                ++it;
-            }
+    // alarm if over half of the replicas are offline
+    int deadBound =
+        copysetInfo.peers.size() - (copysetInfo.peers.size() / 2 + 1);
+    if (static_cast<int>(offlinelists.size()) > deadBound) {
+        LOG(ERROR) << "recoverSchdeuler find "
+                   << copysetInfo.CopySetInfoStr() << " has "
+                   << offlinelists.size()
+                   << " replica offline, cannot repair, please check";
+        return false;
+    }
+
+    // offline replicas in excludes will not be recovered
+    for (auto it = offlinelists.begin(); it != offlinelists.end();) {
+        if (excludes.count(*it) > 0) {
+            LOG(ERROR) << "can not recover offline chunkserver " << *it
+                       << " on " << copysetInfo.CopySetInfoStr()
+                       << ", because it's server has more than "
+                       << chunkserverFailureTolerance_
+                       << " offline chunkservers";
+            it = offlinelists.erase(it);
+        } else {
+            ++it;
         }
+    }
 
-        if (offlinelists.size() == 0) {
+    if (offlinelists.size() == 0) {
+        return false;
+    }
+
+    // recoveries transferring data wait for admission by bandwidth,
+    // removing the offline replica directly is done at once
+    if (planner_.Enabled() && NeedTransferData(copysetInfo)) {
+        tasks->emplace_back(RecoverTask{copysetInfo, *offlinelists.begin()});
+        return false;
+    }
+
+    ChunkServerIdType target;
+    return RecoverOfflinePeer(copysetInfo, *offlinelists.begin(), &target);
+}
+
+int RecoverScheduler::RecoverTasks(std::vector<RecoverTask> *tasks) {
+    if (tasks->empty()) {
+        return 0;
+    }
+
+    int genOp = 0;
+    planner_.Plan(tasks);
+    for (const auto &task : *tasks) {
+        if (!planner_.HasQuota() || !planner_.Available(task.info.leader)) {
+            deferred_.emplace(task.info.id);
             continue;
         }
 
-        // recover one of the offline replica
-        Operator fixRes;
         ChunkServerIdType target;
-        // failed to recover the replica
-        if (!FixOfflinePeer(copysetInfo, *offlinelists.begin(), &fixRes,
-                            &target)) {
+        if (!RecoverOfflinePeer(task.info, task.offlinePeer, &target)) {
             continue;
-            // succeeded but failed to add the operator to the controller
-        } else if (!opController_->AddOperator(fixRes)) {
-            LOG(WARNING) << "recover scheduler add operator "
-                         << fixRes.OpToString() << " on "
-                         << copysetInfo.CopySetInfoStr() << " fail";
+        }
+        genOp++;
+        if (target != UNINTIALIZE_ID) {
+            planner_.Admit(task.info.leader, target);
+        }
+    }
+    return genOp;
+}
+
+bool RecoverScheduler::RecoverOfflinePeer(const CopySetInfo &copysetInfo,
+    ChunkServerIdType peerId, ChunkServerIdType *target) {
+    // recover one of the offline replica
+    Operator fixRes;
+    // failed to recover the replica
+    if (!FixOfflinePeer(copysetInfo, peerId, &fixRes, target)) {
+        return false;
+        // succeeded but failed to add the operator to the controller
+    } else if (!opController_->AddOperator(fixRes)) {
+        LOG(WARNING) << "recover scheduler add operator "
+                     << fixRes.OpToString() << " on "
+                     << copysetInfo.CopySetInfoStr() << " fail";
+        return false;
+        // succeeded in recovering replica and adding it to the controller
+    } else {
+        LOG(INFO) << "recoverScheduler generate operator:"
+                  << fixRes.OpToString() << " for "
+                  << copysetInfo.CopySetInfoStr()
+                  << ", remove offlinePeer: " << peerId;
+        // if the target returned has the initial value, that means offline
+        // replicas are removed directly.
+        if (*target == UNINTIALIZE_ID) {
+            return true;
+        }
+
+        // if the target didn't return the initial value, that means copyset
+        // should be generated on target. If failed to generate, delete the
+        // operator.
+        if (!topo_->CreateCopySetAtChunkServer(copysetInfo.id, *target)) {
+            LOG(WARNING)
+                << "recoverScheduler create "
+                << copysetInfo.CopySetInfoStr()
+                << " on chunkServer: " << *target
+                << " error, delete operator" << fixRes.OpToString();
+            opController_->RemoveOperator(copysetInfo.id);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool RecoverScheduler::NeedTransferData(const CopySetInfo &info) {
+    auto standardReplicaNum =
+        topo_->GetStandardReplicaNumInLogicalPool(info.id.first);
+    return static_cast<int>(info.peers.size()) <= standardReplicaNum;
+}
+
+void RecoverScheduler::TakeDeferredCopySets(
+    std::vector<CopySetInfo> *copysets) {
+    if (deferred_.empty() || !planner_.HasQuota()) {
+        return;
+    }
+
+    std::set<CopySetKey> taken;
+    for (const auto &info : *copysets) {
+        taken.emplace(info.id);
+    }
+    for (const auto &key : deferred_) {
+        if (taken.count(key) > 0) {
             continue;
-            // succeeded in recovering replica and adding it to the controller
-        } else {
-            LOG(INFO) << "recoverScheduler generate operator:"
-                      << fixRes.OpToString() << " for "
-                      << copysetInfo.CopySetInfoStr()
-                      << ", remove offlinePeer: " << *offlinelists.begin();
-            // if the target returned has the initial value, that means offline
-            // replicas are removed directly.
-            if (target == UNINTIALIZE_ID) {
-                oneRoundGenOp++;
-                continue;
-            }
-
-            // if the target didn't return the initial value, that means copyset
-            // should be generated on target. If failed to generate, delete the
-            // operator.
-            if (!topo_->CreateCopySetAtChunkServer(copysetInfo.id, target)) {
-                LOG(WARNING)
-                    << "recoverScheduler create "
-                    << copysetInfo.CopySetInfoStr()
-                    << " on chunkServer: " << target
-                    << " error, delete operator" << fixRes.OpToString();
-                opController_->RemoveOperator(copysetInfo.id);
-                continue;
-            }
-            oneRoundGenOp++;
+        }
+        CopySetInfo info;
+        if (topo_->GetCopySetInfo(key, &info)) {
+            copysets->emplace_back(info);
         }
     }
-    LOG(INFO) << "recoverScheduler generate " << oneRoundGenOp
-              << " operators at this round";
-    return 1;
+    deferred_.clear();
+}
+
+void RecoverScheduler::LogPlannerStatus() {
+    if (!planner_.Enabled()) {
+        return;
+    }
+    LOG(INFO) << "recoverScheduler estimate bandwidth of one recovery "
+              << planner_.GetOpBandwidth() << " bytes/s, running "
+              << planner_.GetRunningNum() << " recoveries, limit "
+              << planner_.GetClusterOps() << " in cluster and "
+              << planner_.GetChunkServerOps() << " on one chunkserver, "
+              << deferred_.size() << " copysets wait for bandwidth";
 }
 
 int64_t RecoverScheduler::GetRunningInterval() { return runInterval_; }
@@ -174,7 +293,10 @@ bool RecoverScheduler::FixOfflinePeer(const CopySetInfo &info,
     }
 
     // select peers to add
-    auto csId = SelectBestPlacementChunkServer(info, peerId);
+    auto csId = planner_.Enabled() ?
+        SelectBestPlacementChunkServer(info, peerId,
+                                       planner_.SaturatedChunkServers()) :
+        SelectBestPlacementChunkServer(info, peerId);
     if (csId == UNINTIALIZE_ID) {
         LOG(WARNING) << "recoverScheduler can not select chunkServer to "
                         "repair "
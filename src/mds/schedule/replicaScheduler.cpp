@@ -31,110 +31,137 @@ namespace mds {
 namespace schedule {
 int ReplicaScheduler::Schedule() {
     LOG(INFO) << "replicaScheduelr begin.";
+    // all the copysets are checked in this round
+    dirtyQueue_.Clear();
     int oneRoundGenOp = 0;
     for (auto info : topo_->GetCopySetInfos()) {
-        // skip if there's any operator on a copyset
-        Operator op;
-        if (opController_->GetOperatorById(info.id, &op)) {
-            continue;
+        if (FixReplicaNum(info)) {
+            oneRoundGenOp += 1;
         }
+    }
+    LOG(INFO) << "replicaScheduelr generate "
+              << oneRoundGenOp << " at this round";
+    return 1;
+}
 
-        // it will be skipped if there's any configuration change on a copyset.
-        // this case would happen when the MDS is restarted, and the operator
-        // without persistence will lost.
-        // configuration change is actually happening.
-        if (info.HasCandidate()) {
-            LOG(WARNING) << info.CopySetInfoStr()
-                         << " has candidate " << info.candidatePeerInfo.id
-                         << " but operator lost";
-            continue;
+int ReplicaScheduler::IncrementalSchedule() {
+    std::vector<CopySetInfo> copysets = TakeDirtyCopySets();
+    if (copysets.empty()) {
+        return 1;
+    }
+
+    int oneRoundGenOp = 0;
+    for (const auto &info : copysets) {
+        if (FixReplicaNum(info)) {
+            oneRoundGenOp += 1;
         }
+    }
+    LOG(INFO) << "replicaScheduelr check " << copysets.size()
+              << " changed copysets and generate " << oneRoundGenOp
+              << " at this incremental round";
+    return 1;
+}
 
-        int standardReplicaNum =
-            topo_->GetStandardReplicaNumInLogicalPool(info.id.first);
-        int copysetReplicaNum = info.peers.size();
+bool ReplicaScheduler::FixReplicaNum(const CopySetInfo &info) {
+    // skip if there's any operator on a copyset
+    Operator op;
+    if (opController_->GetOperatorById(info.id, &op)) {
+        return false;
+    }
 
-        if (copysetReplicaNum == standardReplicaNum) {
-            // replica number is equal to the standard
-            continue;
-        } else if (copysetReplicaNum < standardReplicaNum) {
-            // add one replica a time when the replica number is smaller than
-            // the standard.
-            LOG(ERROR) << "replicaScheduler find "
-                       << info.CopySetInfoStr()
-                       << " replicaNum:" << copysetReplicaNum
-                       << " smaller than standardReplicaNum:"
-                       << standardReplicaNum;
+    // it will be skipped if there's any configuration change on a copyset.
+    // this case would happen when the MDS is restarted, and the operator
+    // without persistence will lost.
+    // configuration change is actually happening.
+    if (info.HasCandidate()) {
+        LOG(WARNING) << info.CopySetInfoStr()
+                     << " has candidate " << info.candidatePeerInfo.id
+                     << " but operator lost";
+        return false;
+    }
 
-            ChunkServerIdType csId =
-                SelectBestPlacementChunkServer(info, UNINTIALIZE_ID);
-            // can't find a suitable chunkserver for the new replica
-            if (csId == UNINTIALIZE_ID) {
-                LOG(WARNING) << "replicaScheduler can not select chunkServer"
-                             "to repair "
-                           << info.CopySetInfoStr() << ", witch only has "
-                           << copysetReplicaNum << " but statandard is "
-                           << standardReplicaNum;
-                continue;
-            }
+    int standardReplicaNum =
+        topo_->GetStandardReplicaNumInLogicalPool(info.id.first);
+    int copysetReplicaNum = info.peers.size();
 
-            Operator op = operatorFactory.CreateAddPeerOperator(
-                    info, csId, OperatorPriority::HighPriority);
-            op.timeLimit = std::chrono::seconds(addTimeSec_);
-            if (!opController_->AddOperator(op)) {
-                LOG(WARNING) << "replicaScheduler find "
-                             << info.CopySetInfoStr()
-                             << ") replicaNum:" << copysetReplicaNum
-                             << " smaller than standardReplicaNum:"
-                             << standardReplicaNum << " but cannot apply"
-                             "operator right now";
-                continue;
-            // create copyset on target chunkserver
-            } else if (!topo_->CreateCopySetAtChunkServer(info.id, csId)) {
-                LOG(WARNING) << "replicaScheduler create "
-                               << info.CopySetInfoStr()
-                               << ") on chunkServer: " << csId << " error";
-                opController_->RemoveOperator(info.id);
-                continue;
-            }
-            LOG(INFO) << "replicaScheduler create "
-                      << info.CopySetInfoStr()
-                      << ") on chunkServer: " << csId
-                      << " success and generate operator: "
-                      << op.OpToString();
-            oneRoundGenOp += 1;
-        } else {
-            // remove one replica a time when the replica number is larger than
-            // the standard.
-            LOG(WARNING) << "replicaScheduler find " << info.CopySetInfoStr()
-                       << " replicaNum:" << copysetReplicaNum
-                       << " larger than standardReplicaNum:"
+    if (copysetReplicaNum == standardReplicaNum) {
+        // replica number is equal to the standard
+        return false;
+    } else if (copysetReplicaNum < standardReplicaNum) {
+        // add one replica a time when the replica number is smaller than
+        // the standard.
+        LOG(ERROR) << "replicaScheduler find "
+                   << info.CopySetInfoStr()
+                   << " replicaNum:" << copysetReplicaNum
+                   << " smaller than standardReplicaNum:"
+                   << standardReplicaNum;
+
+        ChunkServerIdType csId =
+            SelectBestPlacementChunkServer(info, UNINTIALIZE_ID);
+        // can't find a suitable chunkserver for the new replica
+        if (csId == UNINTIALIZE_ID) {
+            LOG(WARNING) << "replicaScheduler can not select chunkServer"
+                         "to repair "
+                       << info.CopySetInfoStr() << ", witch only has "
+                       << copysetReplicaNum << " but statandard is "
                        << standardReplicaNum;
+            return false;
+        }
 
-            ChunkServerIdType csId =
-                SelectRedundantReplicaToRemove(info);
-            if (csId == UNINTIALIZE_ID) {
-                LOG(WARNING) << "replicaScheduler can not select redundent "
-                             "replica to remove on "
-                             << info.CopySetInfoStr() << "), witch has "
-                             << copysetReplicaNum << " but standard is "
-                             << standardReplicaNum;
-                continue;
-            }
+        Operator op = operatorFactory.CreateAddPeerOperator(
+                info, csId, OperatorPriority::HighPriority);
+        op.timeLimit = std::chrono::seconds(addTimeSec_);
+        if (!opController_->AddOperator(op)) {
+            LOG(WARNING) << "replicaScheduler find "
+                         << info.CopySetInfoStr()
+                         << ") replicaNum:" << copysetReplicaNum
+                         << " smaller than standardReplicaNum:"
+                         << standardReplicaNum << " but cannot apply"
+                         "operator right now";
+            return false;
+        // create copyset on target chunkserver
+        } else if (!topo_->CreateCopySetAtChunkServer(info.id, csId)) {
+            LOG(WARNING) << "replicaScheduler create "
+                           << info.CopySetInfoStr()
+                           << ") on chunkServer: " << csId << " error";
+            opController_->RemoveOperator(info.id);
+            return false;
+        }
+        LOG(INFO) << "replicaScheduler create "
+                  << info.CopySetInfoStr()
+                  << ") on chunkServer: " << csId
+                  << " success and generate operator: "
+                  << op.OpToString();
+        return true;
+    } else {
+        // remove one replica a time when the replica number is larger than
+        // the standard.
+        LOG(WARNING) << "replicaScheduler find " << info.CopySetInfoStr()
+                   << " replicaNum:" << copysetReplicaNum
+                   << " larger than standardReplicaNum:"
+                   << standardReplicaNum;
+
+        ChunkServerIdType csId =
+            SelectRedundantReplicaToRemove(info);
+        if (csId == UNINTIALIZE_ID) {
+            LOG(WARNING) << "replicaScheduler can not select redundent "
+                         "replica to remove on "
+                         << info.CopySetInfoStr() << "), witch has "
+                         << copysetReplicaNum << " but standard is "
+                         << standardReplicaNum;
+            return false;
+        }
 
-            Operator op = operatorFactory.CreateRemovePeerOperator(
-                    info, csId, OperatorPriority::HighPriority);
-            op.timeLimit = std::chrono::seconds(removeTimeSec_);
-            if (opController_->AddOperator(op)) {
-                LOG(INFO) << "replicaScheduler generate operator "
-                          << op.OpToString() << " on " << info.CopySetInfoStr();
-                oneRoundGenOp += 1;
-            }
+        Operator op = operatorFactory.CreateRemovePeerOperator(
+                info, csId, OperatorPriority::HighPriority);
+        op.timeLimit = std::chrono::seconds(removeTimeSec_);
+        if (opController_->AddOperator(op)) {
+            LOG(INFO) << "replicaScheduler generate operator "
+                      << op.OpToString() << " on " << info.CopySetInfoStr();
+            return true;
         }
+        return false;
     }
-    LOG(INFO) << "replicaScheduelr generate "
-              << oneRoundGenOp << " at this round";
-    return 1;
 }
 
 int64_t ReplicaScheduler::GetRunningInterval() {
@@ -101,6 +101,28 @@ struct ScheduleOption {
     // ScanScheduler: maximum number of scan copysets at the same time
     // for every chunkserver
     uint32_t scanConcurrentPerChunkserver;
+
+    // incremental scheduling: recover and replica scheduler only check the
+    // copysets changed since last round every incrementalScheduleIntervalMs,
+    // and check all the copysets every fullScheduleIntervalSec. changes are
+    // pushed by heartbeat, chunkserver online state updating and operator
+    // finishing
+    bool enableIncrementalSchedule = false;
+    uint32_t incrementalScheduleIntervalMs = 100;
+    uint32_t fullScheduleIntervalSec = 300;
+
+    // recovery bandwidth control: recover operators transferring data are
+    // admitted until their estimated bandwidth reaches recoverClusterBandwidth
+    // in the cluster, or recoverChunkServerBandwidth on a chunkserver as
+    // source or target. the bandwidth of one operator is estimated by the
+    // install snapshot throughput reported by heartbeat, and is
+    // recoverOpDefaultBandwidth before anything reported. all in bytes/s,
+    // recoverClusterBandwidth = 0 means recovery is only limited by
+    // operatorConcurrent, recoverChunkServerBandwidth = 0 means no limit on
+    // one chunkserver
+    uint64_t recoverClusterBandwidth = 0;
+    uint64_t recoverChunkServerBandwidth = 0;
+    uint64_t recoverOpDefaultBandwidth = 20 * 1024 * 1024;
 };
 
 }  // namespace schedule
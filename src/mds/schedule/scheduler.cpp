@@ -40,6 +40,39 @@ int64_t Scheduler::GetRunningInterval() {
     return 0;
 }
 
+std::vector<CopySetInfo> Scheduler::TakeDirtyCopySets() {
+    std::set<CopySetKey> keys;
+    std::set<ChunkServerIdType> chunkservers;
+    dirtyQueue_.Take(&keys, &chunkservers);
+
+    std::vector<CopySetInfo> out;
+    std::set<CopySetKey> taken;
+    for (auto csId : chunkservers) {
+        for (auto &info : topo_->GetCopySetInfosInChunkServer(csId)) {
+            if (taken.emplace(info.id).second) {
+                out.emplace_back(info);
+            }
+        }
+    }
+
+    for (const auto &key : keys) {
+        if (taken.count(key) > 0) {
+            continue;
+        }
+        CopySetInfo info;
+        if (!topo_->GetCopySetInfo(key, &info)) {
+            LOG(WARNING) << "scheduler can not get dirty copyset("
+                         << key.first << "," << key.second
+                         << ") from topology";
+            continue;
+        }
+        if (info.logicalPoolWork) {
+            out.emplace_back(info);
+        }
+    }
+    return out;
+}
+
 /**
  * process for SelectBestPlacementChunkServer process description:
  * Purpose: For copyset-m(1, 2, 3), select a chunkserver-n in chunkserverList{1,
@@ -75,7 +108,8 @@ int64_t Scheduler::GetRunningInterval() {
  * chunkserver that makes the scatter-width decrease the least.
  */
 ChunkServerIdType Scheduler::SelectBestPlacementChunkServer(
-    const CopySetInfo &copySetInfo, ChunkServerIdType oldPeer) {
+    const CopySetInfo &copySetInfo, ChunkServerIdType oldPeer,
+    const std::set<ChunkServerIdType> &unavailable) {
     // all the chunkservers in the same pysical pool
     ChunkServerInfo oldPeerInfo;
     if (oldPeer != UNINTIALIZE_ID) {
@@ -141,7 +175,8 @@ ChunkServerIdType Scheduler::SelectBestPlacementChunkServer(
         }
 
         // exclude the chunkserver exceeding the concurrent limit
-        if (opController_->Exceed(cs.info.id)) {
+        if (opController_->Exceed(cs.info.id) ||
+            unavailable.count(cs.info.id) > 0) {
             continue;
         }
 
@@ -35,6 +35,8 @@
 #include "src/mds/schedule/operatorController.h"
 #include "src/mds/topology/topology.h"
 #include "src/mds/schedule/operator.h"
+#include "src/mds/schedule/dirtyQueue.h"
+#include "src/mds/schedule/recoverPlanner.h"
 
 namespace curve {
 namespace mds {
@@ -90,7 +92,50 @@ class Scheduler {
      */
     virtual int64_t GetRunningInterval();
 
+    /**
+     * @brief producing operator only for the copysets changed since last
+     *        round, run a full round by default
+     */
+    virtual int IncrementalSchedule() {
+        return Schedule();
+    }
+
+    /**
+     * @brief whether the scheduler can check only the copysets changed
+     */
+    virtual bool SupportIncrementalSchedule() {
+        return false;
+    }
+
+    /**
+     * @brief mark copyset changed, it will be checked in next incremental
+     *        round
+     */
+    void MarkCopySetDirty(const CopySetKey &key) {
+        dirtyQueue_.PushCopySet(key);
+    }
+
+    /**
+     * @brief mark chunkserver changed, the copysets on it will be checked in
+     *        next incremental round
+     */
+    void MarkChunkServerDirty(ChunkServerIdType id) {
+        dirtyQueue_.PushChunkServer(id);
+    }
+
+    bool HasDirty() const {
+        return !dirtyQueue_.Empty();
+    }
+
  protected:
+    /**
+     * @brief take the copysets marked dirty and the copysets on the
+     *        chunkservers marked dirty out of the dirty queue
+     *
+     * @return copysets to check in incremental round
+     */
+    std::vector<CopySetInfo> TakeDirtyCopySets();
+
     /**
      * @brief SelectBestPlacementChunkServer Select a healthy chunkserver in
      *                                       the cluster to replace the oldPeer
@@ -98,12 +143,14 @@ class Scheduler {
      *
      * @param[in] copySetInfo
      * @param[in] copySet Replica to replace
+     * @param[in] unavailable Chunkservers can not be selected
      *
      * @return target chunkserver, return UNINITIALIZED if no
      *         chunkserver selected
      */
     ChunkServerIdType SelectBestPlacementChunkServer(
-        const CopySetInfo &copySetInfo, ChunkServerIdType oldPeer);
+        const CopySetInfo &copySetInfo, ChunkServerIdType oldPeer,
+        const std::set<ChunkServerIdType> &unavailable = {});
 
     /**
      * @brief SelectRedundantReplicaToRemove select a replica from
@@ -156,6 +203,9 @@ class Scheduler {
     int changeTimeSec_;
     // maximum estimated time for start/cancel scan peer, alarm if exceeded
     int scanTimeSec_;
+
+    // copysets and chunkservers changed since last round
+    DirtyQueue dirtyQueue_;
 };
 
 // scheduler for balancing copyset number and chunkserver scatter width
@@ -397,7 +447,8 @@ class RecoverScheduler : public Scheduler {
         const ScheduleOption &opt,
         const std::shared_ptr<TopoAdapter> &topo,
         const std::shared_ptr<OperatorController> &opController)
-        : Scheduler(opt, topo, opController) {
+        : Scheduler(opt, topo, opController),
+          planner_(opt, topo, opController) {
         runInterval_ = opt.recoverSchedulerIntervalSec;
         chunkserverFailureTolerance_ = opt.chunkserverFailureTolerance;
     }
@@ -409,6 +460,17 @@ class RecoverScheduler : public Scheduler {
      */
     int Schedule() override;
 
+    /**
+     * @brief recovering the offline replica of the copysets changed
+     *
+     * @return the number of operators generated
+     */
+    int IncrementalSchedule() override;
+
+    bool SupportIncrementalSchedule() override {
+        return true;
+    }
+
     /**
      * @brief running time interval of the scheduler
      *
@@ -417,6 +479,57 @@ class RecoverScheduler : public Scheduler {
     int64_t GetRunningInterval() override;
 
  private:
+    /**
+     * @brief recover one of the offline replicas of the copyset. if the
+     *        recovery transfers data and is limited by bandwidth, it's
+     *        added to tasks and left to RecoverTasks
+     *
+     * @param[in] info The copyset to check
+     * @param[in] excludes Chunkservers not to be recovered
+     * @param[out] tasks Recoveries waiting for admission
+     *
+     * @return whether any operator has been generated
+     */
+    bool RecoverCopySet(const CopySetInfo &info,
+                        const std::set<ChunkServerIdType> &excludes,
+                        std::vector<RecoverTask> *tasks);
+
+    /**
+     * @brief admit the recoveries in the order planned until the bandwidth
+     *        limit is reached, the rest are deferred
+     *
+     * @param[in] tasks Recoveries waiting for admission
+     *
+     * @return the number of operators generated
+     */
+    int RecoverTasks(std::vector<RecoverTask> *tasks);
+
+    /**
+     * @brief generate operator to replace the offline replica
+     *
+     * @param[in] info The copyset to be fixed
+     * @param[in] peerId The offline replica
+     * @param[out] target The replica added, UNINTIALIZE_ID if the offline
+     *                    replica is removed directly
+     *
+     * @return whether any operator has been generated
+     */
+    bool RecoverOfflinePeer(const CopySetInfo &info, ChunkServerIdType peerId,
+                            ChunkServerIdType *target);
+
+    /**
+     * @brief whether replacing a replica of the copyset transfers data
+     */
+    bool NeedTransferData(const CopySetInfo &info);
+
+    /**
+     * @brief put the deferred copysets into the copysets to check if the
+     *        cluster has bandwidth left
+     */
+    void TakeDeferredCopySets(std::vector<CopySetInfo> *copysets);
+
+    void LogPlannerStatus();
+
     /**
      * @brief fix the specified replica
      *
@@ -445,6 +558,10 @@ class RecoverScheduler : public Scheduler {
     int64_t runInterval_;
     // the threshold of the failing chunkserver that the server will not be recovered //NOLINT
     int32_t chunkserverFailureTolerance_;
+    // admit recoveries by bandwidth
+    RecoverPlanner planner_;
+    // copysets whose recovery waits for bandwidth
+    std::set<CopySetKey> deferred_;
 };
 
 // Check replica numbers of the copyset according to the configuration, and
@@ -467,6 +584,17 @@ class ReplicaScheduler : public Scheduler {
      */
     int Schedule() override;
 
+    /**
+     * @brief check the replica number of the copysets changed only
+     *
+     * @return the number of operators generated
+     */
+    int IncrementalSchedule() override;
+
+    bool SupportIncrementalSchedule() override {
+        return true;
+    }
+
     /**
      * @brief get running time interval of the scheduler
      *
@@ -475,6 +603,16 @@ class ReplicaScheduler : public Scheduler {
     int64_t GetRunningInterval() override;
 
  private:
+    /**
+     * @brief add or remove one replica if the replica number of the copyset
+     *        is not equal to the standard
+     *
+     * @param[in] info The copyset to check
+     *
+     * @return whether any operator has been generated
+     */
+    bool FixReplicaNum(const CopySetInfo &info);
+
     // time interval of replicaScheduler
     int64_t runInterval_;
 };
@@ -113,6 +113,7 @@ ChunkServerInfo::ChunkServerInfo(const PeerInfo &info,
     this->diskUsed = used;
     this->statisticInfo = statisticInfo;
     this->startUpTime = 0;
+    this->installSnapshotRate = 0;
 }
 
 bool ChunkServerInfo::IsOnline() const {
@@ -178,6 +179,27 @@ bool TopoAdapterImpl::GetCopySetInfo(const CopySetKey &id, CopySetInfo *info) {
 
 std::vector<CopySetInfo> TopoAdapterImpl::GetCopySetInfos() {
     std::vector<CopySetInfo> infos;
+    // read all copysets from the snapshot if it is supported, which avoids
+    // taking the topology locks for every copyset and peer
+    auto snapshot = topo_->GetSnapshot();
+    if (snapshot != nullptr) {
+        infos.reserve(snapshot->GetCopySetNum());
+        for (const auto &copySetKey : snapshot->GetCopySetsInCluster()) {
+            auto lpool = snapshot->FindLogicalPool(copySetKey.first);
+            if (lpool == nullptr || !lpool->GetLogicalPoolAvaliableFlag()) {
+                continue;
+            }
+            auto origin = snapshot->FindCopySet(copySetKey);
+            CopySetInfo copySetInfo;
+            if (origin != nullptr && ConvertCopySet(
+                    *origin, snapshot.get(), &copySetInfo)) {
+                copySetInfo.logicalPoolWork = true;
+                infos.push_back(copySetInfo);
+            }
+        }
+        return infos;
+    }
+
     for (auto copySetKey : topo_->GetCopySetsInCluster()) {
         CopySetInfo copySetInfo;
         if (GetCopySetInfo(copySetKey, &copySetInfo)) {
@@ -304,14 +326,23 @@ int TopoAdapterImpl::GetAvgScatterWidthInLogicalPool(PoolIdType id) {
     return 0;
 }
 
-bool TopoAdapterImpl::GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo) {
+bool TopoAdapterImpl::GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo,
+    const ::curve::mds::topology::TopologySnapshot *snapshot) {
     ::curve::mds::topology::ChunkServer cs;
     ::curve::mds::topology::Server server;
 
     bool canGetChunkServer = false;
     bool canGetServer = false;
-    if ((canGetChunkServer = topo_->GetChunkServer(id, &cs)) &&
-        (canGetServer = topo_->GetServer(cs.GetServerId(), &server))) {
+    if (snapshot != nullptr) {
+        canGetChunkServer = snapshot->GetChunkServer(id, &cs);
+        canGetServer = canGetChunkServer &&
+            snapshot->GetServer(cs.GetServerId(), &server);
+    } else {
+        canGetChunkServer = topo_->GetChunkServer(id, &cs);
+        canGetServer = canGetChunkServer &&
+            topo_->GetServer(cs.GetServerId(), &server);
+    }
+    if (canGetChunkServer && canGetServer) {
         *peerInfo = PeerInfo(
             cs.GetId(), server.GetZoneId(), server.GetId(),
             cs.GetHostIp(), cs.GetPort());
@@ -327,6 +358,13 @@ bool TopoAdapterImpl::GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo) {
 bool TopoAdapterImpl::CopySetFromTopoToSchedule(
     const ::curve::mds::topology::CopySetInfo &origin,
     ::curve::mds::schedule::CopySetInfo *out) {
+    return ConvertCopySet(origin, nullptr, out);
+}
+
+bool TopoAdapterImpl::ConvertCopySet(
+    const ::curve::mds::topology::CopySetInfo &origin,
+    const ::curve::mds::topology::TopologySnapshot *snapshot,
+    ::curve::mds::schedule::CopySetInfo *out) {
     assert(out != nullptr);
 
     out->id.first = origin.GetLogicalPoolId();
@@ -338,7 +376,7 @@ bool TopoAdapterImpl::CopySetFromTopoToSchedule(
 
     for (auto id : origin.GetCopySetMembers()) {
         PeerInfo peerInfo;
-        if (GetPeerInfo(id, &peerInfo)) {
+        if (GetPeerInfo(id, &peerInfo, snapshot)) {
             out->peers.emplace_back(peerInfo);
         } else {
             return false;
@@ -347,7 +385,7 @@ bool TopoAdapterImpl::CopySetFromTopoToSchedule(
 
     if (origin.HasCandidate()) {
         PeerInfo peerInfo;
-        if (GetPeerInfo(origin.GetCandidate(), &peerInfo)) {
+        if (GetPeerInfo(origin.GetCandidate(), &peerInfo, snapshot)) {
             out->candidatePeerInfo = peerInfo;
         } else {
             return false;
@@ -383,6 +421,7 @@ bool TopoAdapterImpl::ChunkServerFromTopoToSchedule(
     ChunkServerStat stat;
     if (topoStat_->GetChunkServerStat(origin.GetId(), &stat)) {
         out->leaderCount = stat.leaderCount;
+        out->installSnapshotRate = stat.installSnapshotRate;
     }
 
     return true;
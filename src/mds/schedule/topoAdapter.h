@@ -148,7 +148,8 @@ struct CopySetInfo {
 struct ChunkServerInfo {
  public:
     ChunkServerInfo() :
-        startUpTime(0), leaderCount(0), diskCapacity(0), diskUsed(0) {}
+        startUpTime(0), leaderCount(0), diskCapacity(0), diskUsed(0),
+        installSnapshotRate(0) {}
     ChunkServerInfo(const PeerInfo &info, OnlineState state,
                     DiskState diskState, ChunkServerStatus status,
                     uint32_t leaderCount, uint64_t capacity, uint64_t used,
@@ -169,6 +170,8 @@ struct ChunkServerInfo {
     uint32_t leaderCount;
     uint64_t diskCapacity;
     uint64_t diskUsed;
+    // bandwidth of sending snapshot to the followers installing snapshot
+    uint32_t installSnapshotRate;
     ChunkServerStatisticInfo statisticInfo;
 };
 
@@ -394,7 +397,14 @@ class TopoAdapterImpl : public TopoAdapter {
         std::map<ChunkServerIdType, int> *out) override;
 
  private:
-    bool GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo);
+    // read from the snapshot if it is not nullptr, otherwise from topology
+    bool GetPeerInfo(ChunkServerIdType id, PeerInfo *peerInfo,
+        const ::curve::mds::topology::TopologySnapshot *snapshot = nullptr);
+
+    bool ConvertCopySet(
+        const ::curve::mds::topology::CopySetInfo &origin,
+        const ::curve::mds::topology::TopologySnapshot *snapshot,
+        ::curve::mds::schedule::CopySetInfo *out);
 
  private:
     std::shared_ptr<Topology> topo_;
@@ -26,6 +26,7 @@
 #include "src/mds/nameserver2/helper/namespace_helper.h"
 #include "src/mds/topology/topology_storge_etcd.h"
 #include "src/common/lru_cache.h"
+#include "src/common/sharded_cache.h"
 #include "src/common/namespace_define.h"
 #include "src/common/string_util.h"
 #include "src/common/fast_align.h"
@@ -39,10 +40,15 @@ using ::curve::mds::topology::ChunkServerRegistInfoBuilder;
 namespace curve {
 namespace mds {
 
-using LRUCache = ::curve::common::LRUCache<std::string, std::string>;
+using LRUCache = ::curve::common::LRUCache<std::string, NameSpaceCacheValue,
+    ::curve::common::CacheTraits<std::string>, NameSpaceCacheValueTraits>;
+using ShardedARCCache = ::curve::common::ShardedARCCache<std::string,
+    NameSpaceCacheValue, ::curve::common::CacheTraits<std::string>,
+    NameSpaceCacheValueTraits>;
 using CacheMetrics = ::curve::common::CacheMetrics;
 using ::curve::common::BLOCKSIZEKEY;
 using ::curve::common::CHUNKSIZEKEY;
+using ::curve::kvstorage::kMaxTxnOps;
 
 MDS::~MDS() {
     if (fileLockManager_) {
@@ -70,6 +76,14 @@ void MDS::InitMdsOptions(std::shared_ptr<Configuration> conf) {
 
     // cache size of namestorage
     conf_->GetValueFatalIfFail("mds.cache.count", &options_.mdsCacheCount);
+    if (!conf_->GetValue("mds.cache.shardNum", &options_.mdsCacheShardNum)) {
+        options_.mdsCacheShardNum = 32;
+    }
+    if (!conf_->GetValue("mds.etcd.txnBatch.enable",
+                         &options_.enableTxnBatch)) {
+        options_.enableTxnBatch = false;
+    }
+    InitTxnBatchOption(&options_.txnBatchOption);
 
     conf_->GetValueFatalIfFail("mds.listen.addr", &options_.mdsListenAddr);
 
@@ -131,7 +145,7 @@ void MDS::Init() {
 
     InitSegmentAllocStatistic(options_.retryInterTimes,
                               options_.periodicPersistInterMs);
-    InitNameServerStorage(options_.mdsCacheCount);
+    InitNameServerStorage(options_.mdsCacheCount, options_.mdsCacheShardNum);
     InitTopology(options_.topologyOption);
     InitTopologyStat();
     InitTopologyChunkAllocator(options_.topologyOption);
@@ -195,6 +209,10 @@ void MDS::Stop() {
 
     segmentAllocStatistic_->Stop();
 
+    if (txnBatchClient_ != nullptr) {
+        txnBatchClient_->Stop();
+    }
+
     etcdClient_->CloseClient();
 }
 
@@ -333,6 +351,18 @@ void MDS::InitTopologyOption(TopologyOption *topologyOption) {
     conf_->GetValueFatalIfFail(
         "mds.topology.enableLogicalPoolStatus",
         &topologyOption->enableLogicalPoolStatus);
+    if (!conf_->GetValue("mds.topology.chooseCopySetPolicy",
+                         &topologyOption->chooseCopySetPolicy)) {
+        topologyOption->chooseCopySetPolicy = 0;
+    }
+    if (!conf_->GetValue("mds.topology.copySetLoadRefreshIntervalMs",
+                         &topologyOption->copySetLoadRefreshIntervalMs)) {
+        topologyOption->copySetLoadRefreshIntervalMs = 5000;
+    }
+    if (!conf_->GetValue("mds.topology.snapshotRefreshIntervalMs",
+                         &topologyOption->snapshotRefreshIntervalMs)) {
+        topologyOption->snapshotRefreshIntervalMs = 100;
+    }
 }
 
 void MDS::InitTopology(const TopologyOption& option) {
@@ -422,19 +452,48 @@ void MDS::InitTopologyChunkAllocator(const TopologyOption& option) {
     LOG(INFO) << "init topologyChunkAllocator success.";
 }
 
-void MDS::InitNameServerStorage(int mdsCacheCount) {
-    // init LRUCache
+void MDS::InitNameServerStorage(int mdsCacheCount,
+                                uint32_t mdsCacheShardNum) {
+    auto cacheMetrics =
+        std::make_shared<CacheMetrics>("mds_nameserver_cache_metric");
+    std::shared_ptr<Cache> cache;
+    if (mdsCacheCount == 0) {
+        // ARC needs a bounded capacity, keep the unlimited LRUCache
+        cache = std::make_shared<LRUCache>(cacheMetrics);
+        LOG(INFO) << "init LRUCache success.";
+    } else {
+        cache = std::make_shared<ShardedARCCache>(mdsCacheShardNum,
+            mdsCacheCount, cacheMetrics);
+        LOG(INFO) << "init ShardedARCCache success, shard num: "
+                  << mdsCacheShardNum << ", capacity: " << mdsCacheCount;
+    }
 
-    auto cache = std::make_shared<LRUCache>(mdsCacheCount,
-        std::make_shared<CacheMetrics>("mds_nameserver_cache_metric"));
-    LOG(INFO) << "init LRUCache success.";
+    // mutations of NameServerStorage are committed to etcd in batches,
+    // other modules still use etcdClient_ directly
+    std::shared_ptr<KVStorageClient> storageClient = etcdClient_;
+    if (options_.enableTxnBatch) {
+        txnBatchClient_ = std::make_shared<TxnBatchClient>(etcdClient_,
+            options_.txnBatchOption);
+        txnBatchClient_->Start();
+        storageClient = txnBatchClient_;
+    }
 
     // init NameServerStorage
-    nameServerStorage_ = std::make_shared<NameServerStorageImp>(etcdClient_,
+    nameServerStorage_ = std::make_shared<NameServerStorageImp>(storageClient,
                                                                 cache);
     LOG(INFO) << "init NameServerStorage success.";
 }
 
+void MDS::InitTxnBatchOption(TxnBatchOption *option) {
+    if (!conf_->GetValue("mds.etcd.txnBatch.maxOps", &option->maxBatchOps)) {
+        option->maxBatchOps = kMaxTxnOps;
+    }
+    if (!conf_->GetValue("mds.etcd.txnBatch.maxDelayUs",
+                         &option->maxDelayUs)) {
+        option->maxDelayUs = 100;
+    }
+}
+
 void MDS::InitSnapshotCloneClientOption(SnapshotCloneClientOption *option) {
     if (!conf_->GetValue("mds.snapshotcloneclient.addr",
         &option->snapshotCloneAddr)) {
@@ -570,9 +629,12 @@ void MDS::InitCleanManager() {
         std::make_shared<CopysetClient>(topology_, chunkServerClientOption,
                                                         channelPool);
 
+    CleanCoreOption cleanCoreOption;
+    InitCleanCoreOption(&cleanCoreOption);
     auto cleanCore = std::make_shared<CleanCore>(nameServerStorage_,
                                                  copysetClient,
-                                                 segmentAllocStatistic_);
+                                                 segmentAllocStatistic_,
+                                                 cleanCoreOption);
 
     // init dlock options
     auto dlockOpts = std::make_shared<DLockOpts>();
@@ -584,6 +646,25 @@ void MDS::InitCleanManager() {
     LOG(INFO) << "init CleanManager success.";
 }
 
+void MDS::InitCleanCoreOption(CleanCoreOption *option) {
+    if (!conf_->GetValue("mds.clean.chunkDeleteThreadNum",
+                         &option->chunkDeleteThreadNum)) {
+        option->chunkDeleteThreadNum = 16;
+    }
+    if (!conf_->GetValue("mds.clean.chunkDeleteWindow",
+                         &option->chunkDeleteWindow)) {
+        option->chunkDeleteWindow = 8;
+    }
+    if (!conf_->GetValue("mds.clean.segmentDeleteBatchSize",
+                         &option->segmentDeleteBatchSize)) {
+        option->segmentDeleteBatchSize = 16;
+    }
+    if (!conf_->GetValue("mds.clean.chunkDeleteIops",
+                         &option->chunkDeleteIops)) {
+        option->chunkDeleteIops = 2000;
+    }
+}
+
 void MDS::InitChunkServerClientOption(ChunkServerClientOption *option) {
     conf_->GetValueFatalIfFail("mds.chunkserverclient.rpcTimeoutMs",
         &option->rpcTimeoutMs);
@@ -664,6 +745,36 @@ void MDS::InitScheduleOption(ScheduleOption *scheduleOption) {
         &scheduleOption->scanConcurrentPerPool);
     conf_->GetValueFatalIfFail("mds.scheduler.scan.concurrent.per.chunkserver",
         &scheduleOption->scanConcurrentPerChunkserver);
+
+    if (!conf_->GetValue("mds.scheduler.incremental.enable",
+                         &scheduleOption->enableIncrementalSchedule)) {
+        scheduleOption->enableIncrementalSchedule = false;
+    }
+    if (!conf_->GetValue("mds.scheduler.incremental.intervalMs",
+                         &scheduleOption->incrementalScheduleIntervalMs)) {
+        scheduleOption->incrementalScheduleIntervalMs = 100;
+    }
+    if (!conf_->GetValue("mds.scheduler.incremental.fullIntervalSec",
+                         &scheduleOption->fullScheduleIntervalSec)) {
+        scheduleOption->fullScheduleIntervalSec = 300;
+    }
+
+    uint64_t bandwidthMB = 0;
+    if (!conf_->GetValue("mds.scheduler.recover.clusterBandwidthMB",
+                         &bandwidthMB)) {
+        bandwidthMB = 0;
+    }
+    scheduleOption->recoverClusterBandwidth = bandwidthMB * 1024 * 1024;
+    if (!conf_->GetValue("mds.scheduler.recover.chunkserverBandwidthMB",
+                         &bandwidthMB)) {
+        bandwidthMB = 0;
+    }
+    scheduleOption->recoverChunkServerBandwidth = bandwidthMB * 1024 * 1024;
+    if (!conf_->GetValue("mds.scheduler.recover.opDefaultBandwidthMB",
+                         &bandwidthMB)) {
+        bandwidthMB = 20;
+    }
+    scheduleOption->recoverOpDefaultBandwidth = bandwidthMB * 1024 * 1024;
 }
 
 void MDS::InitHeartbeatManager() {
@@ -687,6 +798,10 @@ void MDS::InitHeartbeatOption(HeartbeatOption* heartbeatOption) {
                         &heartbeatOption->offLineTimeOutMs);
     conf_->GetValueFatalIfFail("mds.heartbeat.clean_follower_afterMs",
                         &heartbeatOption->cleanFollowerAfterMs);
+    if (!conf_->GetValue("mds.heartbeat.topoUpdaterWorkerNum",
+                         &heartbeatOption->topoUpdaterWorkerNum)) {
+        heartbeatOption->topoUpdaterWorkerNum = 8;
+    }
 }
 
 bool ParsePoolsetRules(const std::string& str,
@@ -58,6 +58,7 @@
 #include "src/common/channel_pool.h"
 #include "src/mds/schedule/scheduleService/scheduleService.h"
 #include "src/common/concurrent/dlock.h"
+#include "src/kvstorageclient/txn_batch_client.h"
 
 using ::curve::mds::topology::TopologyChunkAllocatorImpl;
 using ::curve::mds::topology::TopologyServiceImpl;
@@ -84,6 +85,8 @@ using ::curve::election::LeaderElectionOptions;
 using ::curve::election::LeaderElection;
 using ::curve::common::Configuration;
 using ::curve::common::DLockOpts;
+using ::curve::kvstorage::TxnBatchClient;
+using ::curve::kvstorage::TxnBatchOption;
 
 namespace curve {
 namespace mds {
@@ -98,6 +101,11 @@ struct MDSOptions {
     uint64_t periodicPersistInterMs;
     // cache size of namestorage
     int mdsCacheCount;
+    // shard number of namestorage cache
+    uint32_t mdsCacheShardNum;
+    // whether to commit namestorage mutations to etcd in batches
+    bool enableTxnBatch;
+    TxnBatchOption txnBatchOption;
     int mdsFilelockBucketNum;
 
     FileRecordOptions fileRecordOptions;
@@ -181,7 +189,9 @@ class MDS {
     void InitSegmentAllocStatistic(uint64_t retryInterTimes,
                                    uint64_t periodicPersistInterMs);
 
-    void InitNameServerStorage(int mdsCacheCount);
+    void InitNameServerStorage(int mdsCacheCount, uint32_t mdsCacheShardNum);
+
+    void InitTxnBatchOption(TxnBatchOption *option);
 
     void StartServer();
 
@@ -201,6 +211,8 @@ class MDS {
 
     void InitCleanManager();
 
+    void InitCleanCoreOption(CleanCoreOption *option);
+
     void InitCoordinator();
 
     void InitHeartbeatManager();
@@ -223,6 +235,8 @@ class MDS {
     MDSOptions options_;
 
     std::shared_ptr<EtcdClientImp> etcdClient_;
+    // commit mutations of NameServerStorage in batches, nullptr if disabled
+    std::shared_ptr<TxnBatchClient> txnBatchClient_;
     std::shared_ptr<LeaderElection> leaderElection_;
     std::shared_ptr<AllocStatistic> segmentAllocStatistic_;
     std::shared_ptr<NameServerStorage> nameServerStorage_;
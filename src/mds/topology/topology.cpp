@@ -33,11 +33,25 @@
 using ::curve::common::UUIDGenerator;
 using ::curve::common::kDefaultPoolsetId;
 using ::curve::common::kDefaultPoolsetName;
+using ::curve::common::LockGuard;
+using ::curve::common::Mutex;
+using ::curve::common::TimeUtility;
 
 namespace curve {
 namespace mds {
 namespace topology {
 
+namespace {
+
+// types of items which are copied as a whole when building snapshot
+const uint32_t kSnapshotPoolset = 1 << 0;
+const uint32_t kSnapshotLogicalPool = 1 << 1;
+const uint32_t kSnapshotPhysicalPool = 1 << 2;
+const uint32_t kSnapshotZone = 1 << 3;
+const uint32_t kSnapshotServer = 1 << 4;
+
+}  // namespace
+
 PoolsetIdType TopologyImpl::AllocatePoolsetId() {
     return idGenerator_->GenPoolsetId();
 }
@@ -73,6 +87,7 @@ int TopologyImpl::AddPoolset(const Poolset &data) {
             return kTopoErrCodeStorgeFail;
         }
         poolsetMap_.emplace(data.GetId(), data);
+        MarkStructureChanged(kSnapshotPoolset);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeIdDuplicated;
@@ -89,6 +104,7 @@ int TopologyImpl::AddLogicalPool(const LogicalPool &data) {
                 return kTopoErrCodeStorgeFail;
             }
             logicalPoolMap_[data.GetId()] = data;
+            MarkStructureChanged(kSnapshotLogicalPool);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -109,6 +125,7 @@ int TopologyImpl::AddPhysicalPool(const PhysicalPool &data) {
             }
             it->second.AddPhysicalPool(data.GetId());
             physicalPoolMap_.emplace(data.GetId(), data);
+            MarkStructureChanged(kSnapshotPoolset | kSnapshotPhysicalPool);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -129,6 +146,7 @@ int TopologyImpl::AddZone(const Zone &data) {
             }
             it->second.AddZone(data.GetId());
             zoneMap_[data.GetId()] = data;
+            MarkStructureChanged(kSnapshotPhysicalPool | kSnapshotZone);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -149,6 +167,7 @@ int TopologyImpl::AddServer(const Server &data) {
             }
             it->second.AddServer(data.GetId());
             serverMap_[data.GetId()] = data;
+            MarkStructureChanged(kSnapshotZone | kSnapshotServer);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -181,6 +200,8 @@ int TopologyImpl::AddChunkServer(const ChunkServer &data) {
                 it->second.AddChunkServer(data.GetId());
                 chunkServerMap_[data.GetId()] = data;
                 csCapacity = data.GetChunkServerState().GetDiskCapacity();
+                MarkStructureChanged(kSnapshotServer);
+                MarkChunkServerChanged(data.GetId());
             } else {
                 return kTopoErrCodeIdDuplicated;
             }
@@ -194,6 +215,7 @@ int TopologyImpl::AddChunkServer(const ChunkServer &data) {
         uint64_t totalCapacity = it->second.GetDiskCapacity();
         totalCapacity += csCapacity;
         it->second.SetDiskCapacity(totalCapacity);
+        MarkStructureChanged(kSnapshotPhysicalPool);
     } else {
         return kTopoErrCodePhysicalPoolNotFound;
     }
@@ -208,6 +230,7 @@ int TopologyImpl::RemoveLogicalPool(PoolIdType id) {
             return kTopoErrCodeStorgeFail;
         }
         logicalPoolMap_.erase(it);
+        MarkStructureChanged(kSnapshotLogicalPool);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeLogicalPoolNotFound;
@@ -230,6 +253,7 @@ int TopologyImpl::RemovePoolset(PoolsetIdType id) {
             return kTopoErrCodeStorgeFail;
         }
         poolsetMap_.erase(it);
+        MarkStructureChanged(kSnapshotPoolset);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodePoolsetNotFound;
@@ -253,6 +277,7 @@ int TopologyImpl::RemovePhysicalPool(PoolIdType id) {
         }
 
         physicalPoolMap_.erase(it);
+        MarkStructureChanged(kSnapshotPoolset | kSnapshotPhysicalPool);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodePhysicalPoolNotFound;
@@ -275,6 +300,7 @@ int TopologyImpl::RemoveZone(ZoneIdType id) {
             ix->second.RemoveZone(id);
         }
         zoneMap_.erase(it);
+        MarkStructureChanged(kSnapshotPhysicalPool | kSnapshotZone);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeZoneNotFound;
@@ -297,6 +323,7 @@ int TopologyImpl::RemoveServer(ServerIdType id) {
             ix->second.RemoveServer(id);
         }
         serverMap_.erase(it);
+        MarkStructureChanged(kSnapshotZone | kSnapshotServer);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeServerNotFound;
@@ -319,6 +346,8 @@ int TopologyImpl::RemoveChunkServer(ChunkServerIdType id) {
             ix->second.RemoveChunkServer(id);
         }
         chunkServerMap_.erase(it);
+        MarkStructureChanged(kSnapshotServer);
+        MarkChunkServerChanged(id);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeChunkServerNotFound;
@@ -333,6 +362,7 @@ int TopologyImpl::UpdateLogicalPool(const LogicalPool &data) {
             return kTopoErrCodeStorgeFail;
         }
         it->second = data;
+        MarkStructureChanged(kSnapshotLogicalPool);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeLogicalPoolNotFound;
@@ -350,6 +380,7 @@ int TopologyImpl::UpdateLogicalPoolAllocateStatus(const AllocateStatus &status,
             return kTopoErrCodeStorgeFail;
         }
         it->second.SetStatus(status);
+        MarkStructureChanged(kSnapshotLogicalPool);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeLogicalPoolNotFound;
@@ -371,6 +402,7 @@ int TopologyImpl::UpdateLogicalPoolScanState(PoolIdType lpid, bool scanEnable) {
     }
 
     iter->second.SetScanEnable(scanEnable);
+    MarkStructureChanged(kSnapshotLogicalPool);
     return kTopoErrCodeSuccess;
 }
 
@@ -382,6 +414,7 @@ int TopologyImpl::UpdatePhysicalPool(const PhysicalPool &data) {
             return kTopoErrCodeStorgeFail;
         }
         it->second = data;
+        MarkStructureChanged(kSnapshotPhysicalPool);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodePhysicalPoolNotFound;
@@ -396,6 +429,7 @@ int TopologyImpl::UpdateZone(const Zone &data) {
             return kTopoErrCodeStorgeFail;
         }
         it->second = data;
+        MarkStructureChanged(kSnapshotZone);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeZoneNotFound;
@@ -410,6 +444,7 @@ int TopologyImpl::UpdateServer(const Server &data) {
             return kTopoErrCodeStorgeFail;
         }
         it->second = data;
+        MarkStructureChanged(kSnapshotServer);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeServerNotFound;
@@ -431,6 +466,7 @@ int TopologyImpl::UpdateChunkServerTopo(const ChunkServer &data) {
         }
         it->second = temp;
         it->second.SetDirtyFlag(false);
+        MarkChunkServerChanged(data.GetId());
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeChunkServerNotFound;
@@ -461,6 +497,7 @@ int TopologyImpl::UpdateChunkServerRwState(const ChunkServerStatus &rwState,
             csCapacity = it->second.GetChunkServerState().GetDiskCapacity();
             it->second.SetStatus(rwState);
             it->second.SetDirtyFlag(true);
+            MarkChunkServerChanged(id);
         }
     }
     // update physical pool
@@ -476,6 +513,7 @@ int TopologyImpl::UpdateChunkServerRwState(const ChunkServerStatus &rwState,
                     totalCapacity = (totalCapacity > csCapacity) ?
                         (totalCapacity - csCapacity) : 0;
                     it->second.SetDiskCapacity(totalCapacity);
+                    MarkStructureChanged(kSnapshotPhysicalPool);
                 } else {
                     return kTopoErrCodePhysicalPoolNotFound;
                 }
@@ -490,6 +528,7 @@ int TopologyImpl::UpdateChunkServerRwState(const ChunkServerStatus &rwState,
                     uint64_t totalCapacity = it->second.GetDiskCapacity();
                     totalCapacity += csCapacity;
                     it->second.SetDiskCapacity(totalCapacity);
+                    MarkStructureChanged(kSnapshotPhysicalPool);
                 } else {
                     return kTopoErrCodePhysicalPoolNotFound;
                 }
@@ -542,6 +581,9 @@ int TopologyImpl::UpdateChunkServerOnlineState(const OnlineState &onlineState,
     auto it = chunkServerMap_.find(id);
     if (it != chunkServerMap_.end()) {
         WriteLockGuard wlockChunkServer(it->second.GetRWLockRef());
+        if (it->second.GetOnlineState() != onlineState) {
+            MarkChunkServerChanged(id);
+        }
         it->second.SetOnlineState(onlineState);
         it->second.SetDirtyFlag(true);
         return kTopoErrCodeSuccess;
@@ -573,6 +615,7 @@ int TopologyImpl::UpdateChunkServerDiskStatus(const ChunkServerState &state,
             // database by background process regularly
             it->second.SetChunkServerState(state);
             it->second.SetDirtyFlag(true);
+            MarkChunkServerChanged(id);
         } else {
             return kTopoErrCodeChunkServerNotFound;
         }
@@ -583,6 +626,9 @@ int TopologyImpl::UpdateChunkServerDiskStatus(const ChunkServerState &state,
         uint64_t totalCapacity = it->second.GetDiskCapacity();
         totalCapacity += diff;
         it->second.SetDiskCapacity(totalCapacity);
+        if (diff != 0) {
+            MarkStructureChanged(kSnapshotPhysicalPool);
+        }
     } else {
         return kTopoErrCodePhysicalPoolNotFound;
     }
@@ -595,7 +641,10 @@ int TopologyImpl::UpdateChunkServerStartUpTime(uint64_t time,
     auto it = chunkServerMap_.find(id);
     if (it != chunkServerMap_.end()) {
         WriteLockGuard wlockChunkServer(it->second.GetRWLockRef());
-        it->second.SetStartUpTime(time);
+        if (it->second.GetStartUpTime() != time) {
+            it->second.SetStartUpTime(time);
+            MarkChunkServerChanged(id);
+        }
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeChunkServerNotFound;
@@ -1181,6 +1230,20 @@ int TopologyImpl::Init(const TopologyOption &option) {
     }
     LOG(INFO) << "Clean Invalid LogicalPool and copyset success.";
 
+    // all maps are locked, build the first snapshot directly
+    {
+        LockGuard guard(snapshotDeltaMutex_);
+        changedCopySets_.clear();
+        changedChunkServers_.clear();
+        changedStructure_ = 0;
+        snapshotStale_.store(false, std::memory_order_release);
+    }
+    TopologySnapshotBuilder builder(nullptr);
+    BuildSnapshotFull(&builder);
+    std::atomic_store(&snapshot_,
+        builder.Build(TimeUtility::GetTimeofDayMs()));
+    LOG(INFO) << "Build topology snapshot success.";
+
     return kTopoErrCodeSuccess;
 }
 
@@ -1231,6 +1294,7 @@ int TopologyImpl::AddCopySet(const CopySetInfo &data) {
                 return kTopoErrCodeStorgeFail;
             }
             copySetMap_[key] = data;
+            MarkCopySetChanged(key);
             return kTopoErrCodeSuccess;
         } else {
             return kTopoErrCodeIdDuplicated;
@@ -1248,6 +1312,7 @@ int TopologyImpl::RemoveCopySet(CopySetKey key) {
             return kTopoErrCodeStorgeFail;
         }
         copySetMap_.erase(key);
+        MarkCopySetChanged(key);
         return kTopoErrCodeSuccess;
     } else {
         return kTopoErrCodeCopySetNotFound;
@@ -1260,6 +1325,14 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
     auto it = copySetMap_.find(key);
     if (it != copySetMap_.end()) {
         WriteLockGuard wlockCopySet(it->second.GetRWLockRef());
+        // heartbeat reports the same info most of the time, only changed
+        // copysets need to be applied to the next snapshot
+        bool changed = it->second.GetLeader() != data.GetLeader() ||
+            it->second.GetEpoch() != data.GetEpoch() ||
+            it->second.GetCopySetMembers() != data.GetCopySetMembers() ||
+            it->second.HasCandidate() != data.HasCandidate() ||
+            (data.HasCandidate() &&
+                it->second.GetCandidate() != data.GetCandidate());
         it->second.SetLeader(data.GetLeader());
         it->second.SetEpoch(data.GetEpoch());
         it->second.SetCopySetMembers(data.GetCopySetMembers());
@@ -1270,15 +1343,20 @@ int TopologyImpl::UpdateCopySetTopo(const CopySetInfo &data) {
         }
 
         if (data.IsLatestScaning(it->second.GetScaning())) {
+            changed = true;
             it->second.SetScaning(data.GetScaning());
         }
 
         if (data.IsLatestLastScanSec(it->second.GetLastScanSec())) {
+            changed = true;
             it->second.SetLastScanSec(data.GetLastScanSec());
             it->second.SetLastScanConsistent(data.GetLastScanConsistent());
         }
 
         it->second.SetDirtyFlag(true);
+        if (changed) {
+            MarkCopySetChanged(key);
+        }
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "UpdateCopySetTopo can not find copyset, "
@@ -1301,6 +1379,7 @@ int TopologyImpl::SetCopySetAvalFlag(const CopySetKey &key, bool aval) {
             return kTopoErrCodeStorgeFail;
         }
         it->second.SetAvailableFlag(aval);
+        MarkCopySetChanged(key);
         return kTopoErrCodeSuccess;
     } else {
         LOG(WARNING) << "SetCopySetAvalFlag can not find copyset, "
@@ -1327,7 +1406,7 @@ std::vector<CopySetIdType> TopologyImpl::GetCopySetsInLogicalPool(
     CopySetFilter filter) const {
     std::vector<CopySetIdType> ret;
     ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
+    for (const auto &it : copySetMap_) {
         if (filter(it.second) && it.first.first == logicalPoolId) {
             ret.push_back(it.first.second);
         }
@@ -1340,7 +1419,7 @@ std::vector<CopySetInfo> TopologyImpl::GetCopySetInfosInLogicalPool(
     CopySetFilter filter) const {
     std::vector<CopySetInfo> ret;
     ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
+    for (const auto &it : copySetMap_) {
         if (filter(it.second) && it.first.first == logicalPoolId) {
             ret.push_back(it.second);
         }
@@ -1352,7 +1431,7 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInCluster(
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
     ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
+    for (const auto &it : copySetMap_) {
         if (filter(it.second)) {
             ret.push_back(it.first);
         }
@@ -1365,7 +1444,7 @@ std::vector<CopySetKey> TopologyImpl::GetCopySetsInChunkServer(
     CopySetFilter filter) const {
     std::vector<CopySetKey> ret;
     ReadLockGuard rlockCopySet(copySetMutex_);
-    for (auto it : copySetMap_) {
+    for (const auto &it : copySetMap_) {
         if (filter(it.second) && it.second.GetCopySetMembers().count(id) > 0) {
             ret.push_back(it.first);
         }
@@ -1488,13 +1567,161 @@ int TopologyImpl::UpdateChunkServerVersion(const std::string &version,
     auto iter = chunkServerMap_.find(id);
     if (iter != chunkServerMap_.end()) {
         WriteLockGuard wlockChunkServer(iter->second.GetRWLockRef());
-        iter->second.SetVersion(version);
+        if (iter->second.GetVersion() != version) {
+            iter->second.SetVersion(version);
+            MarkChunkServerChanged(id);
+        }
     } else {
         ret = kTopoErrCodeChunkServerNotFound;
     }
     return ret;
 }
 
+std::shared_ptr<const TopologySnapshot> TopologyImpl::GetSnapshot() const {
+    auto snapshot = std::atomic_load(&snapshot_);
+    if (snapshot != nullptr &&
+        (!snapshotStale_.load(std::memory_order_acquire) ||
+         TimeUtility::GetTimeofDayMs() <
+            snapshot->GetCreateTimeMs() + option_.snapshotRefreshIntervalMs)) {
+        return snapshot;
+    }
+
+    if (option_.snapshotRefreshIntervalMs == 0) {
+        // the caller must see all changes it has made
+        RefreshSnapshot();
+    } else {
+        // only one reader refreshes, the others go on with the current
+        // snapshot instead of waiting for the building
+        std::unique_lock<Mutex> buildGuard(snapshotBuildMutex_,
+                                           std::try_to_lock);
+        if (buildGuard.owns_lock() &&
+            std::atomic_load(&snapshot_) == snapshot) {
+            RefreshSnapshotLocked();
+        }
+    }
+    return std::atomic_load(&snapshot_);
+}
+
+void TopologyImpl::RefreshSnapshot() const {
+    LockGuard buildGuard(snapshotBuildMutex_);
+    RefreshSnapshotLocked();
+}
+
+void TopologyImpl::RefreshSnapshotLocked() const {
+    auto base = std::atomic_load(&snapshot_);
+
+    std::set<CopySetKey> copySets;
+    std::set<ChunkServerIdType> chunkServers;
+    uint32_t structure = 0;
+    {
+        LockGuard guard(snapshotDeltaMutex_);
+        if (base != nullptr &&
+            !snapshotStale_.load(std::memory_order_relaxed)) {
+            // refreshed by others while waiting for the lock
+            return;
+        }
+        copySets.swap(changedCopySets_);
+        chunkServers.swap(changedChunkServers_);
+        structure = changedStructure_;
+        changedStructure_ = 0;
+        snapshotStale_.store(false, std::memory_order_release);
+    }
+
+    // changes happened after the swap above are recorded again and will be
+    // applied by the next refresh, so no change is lost
+    TopologySnapshotBuilder builder(base);
+    if (base == nullptr) {
+        ReadLockGuard rlockPoolset(poolsetMutex_);
+        ReadLockGuard rlockLogicalPool(logicalPoolMutex_);
+        ReadLockGuard rlockPhysicalPool(physicalPoolMutex_);
+        ReadLockGuard rlockZone(zoneMutex_);
+        ReadLockGuard rlockServer(serverMutex_);
+        ReadLockGuard rlockChunkServer(chunkServerMutex_);
+        ReadLockGuard rlockCopySet(copySetMutex_);
+        BuildSnapshotFull(&builder);
+    } else {
+        BuildSnapshotStructure(structure, &builder);
+        for (const auto id : chunkServers) {
+            ChunkServer cs;
+            if (GetChunkServer(id, &cs)) {
+                builder.PutChunkServer(cs);
+            } else {
+                builder.RemoveChunkServer(id);
+            }
+        }
+        for (const auto &key : copySets) {
+            CopySetInfo info;
+            if (GetCopySet(key, &info)) {
+                builder.PutCopySet(info);
+            } else {
+                builder.RemoveCopySet(key);
+            }
+        }
+    }
+    std::atomic_store(&snapshot_,
+        builder.Build(TimeUtility::GetTimeofDayMs()));
+}
+
+void TopologyImpl::MarkCopySetChanged(const CopySetKey &key) const {
+    LockGuard guard(snapshotDeltaMutex_);
+    changedCopySets_.emplace(key);
+    snapshotStale_.store(true, std::memory_order_release);
+}
+
+void TopologyImpl::MarkChunkServerChanged(ChunkServerIdType id) const {
+    LockGuard guard(snapshotDeltaMutex_);
+    changedChunkServers_.emplace(id);
+    snapshotStale_.store(true, std::memory_order_release);
+}
+
+void TopologyImpl::MarkStructureChanged(uint32_t types) const {
+    LockGuard guard(snapshotDeltaMutex_);
+    changedStructure_ |= types;
+    snapshotStale_.store(true, std::memory_order_release);
+}
+
+void TopologyImpl::BuildSnapshotStructure(uint32_t types,
+    TopologySnapshotBuilder *builder) const {
+    // maps are locked one by one instead of all together, which is the
+    // same consistency as the Get interfaces
+    if (types & kSnapshotPoolset) {
+        ReadLockGuard rlockPoolset(poolsetMutex_);
+        builder->SetPoolsets(poolsetMap_);
+    }
+    if (types & kSnapshotLogicalPool) {
+        ReadLockGuard rlockLogicalPool(logicalPoolMutex_);
+        builder->SetLogicalPools(logicalPoolMap_);
+    }
+    if (types & kSnapshotPhysicalPool) {
+        ReadLockGuard rlockPhysicalPool(physicalPoolMutex_);
+        builder->SetPhysicalPools(physicalPoolMap_);
+    }
+    if (types & kSnapshotZone) {
+        ReadLockGuard rlockZone(zoneMutex_);
+        builder->SetZones(zoneMap_);
+    }
+    if (types & kSnapshotServer) {
+        ReadLockGuard rlockServer(serverMutex_);
+        builder->SetServers(serverMap_);
+    }
+}
+
+void TopologyImpl::BuildSnapshotFull(TopologySnapshotBuilder *builder) const {
+    builder->SetPoolsets(poolsetMap_);
+    builder->SetLogicalPools(logicalPoolMap_);
+    builder->SetPhysicalPools(physicalPoolMap_);
+    builder->SetZones(zoneMap_);
+    builder->SetServers(serverMap_);
+    for (const auto &it : chunkServerMap_) {
+        ReadLockGuard rlockChunkServer(it.second.GetRWLockRef());
+        builder->PutChunkServer(it.second);
+    }
+    for (const auto &it : copySetMap_) {
+        ReadLockGuard rlockCopySet(it.second.GetRWLockRef());
+        builder->PutCopySet(it.second);
+    }
+}
+
 bool TopologyImpl::CreateDefaultPoolset() {
     assert(poolsetMap_.empty());
 
@@ -28,6 +28,8 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <set>
+#include <atomic>
 
 #include "proto/topology.pb.h"
 #include "src/mds/common/mds_define.h"
@@ -35,6 +37,7 @@
 #include "src/mds/topology/topology_id_generator.h"
 #include "src/mds/topology/topology_token_generator.h"
 #include "src/mds/topology/topology_storge.h"
+#include "src/mds/topology/topology_snapshot.h"
 #include "src/common/concurrent/rw_lock.h"
 #include "src/common/concurrent/concurrent.h"
 #include "src/common/interruptible_sleeper.h"
@@ -48,14 +51,6 @@ namespace curve {
 namespace mds {
 namespace topology {
 
-using ChunkServerFilter = std::function<bool(const ChunkServer&)>;
-using ServerFilter = std::function<bool (const Server&)>;
-using ZoneFilter = std::function<bool (const Zone&)>;
-using PhysicalPoolFilter = std::function<bool (const PhysicalPool&)>;
-using LogicalPoolFilter = std::function<bool(const LogicalPool&)>;
-using PoolsetFilter = std::function<bool (const Poolset&)>;
-using CopySetFilter = std::function<bool (const CopySetInfo&)>;
-
 class Topology {
  public:
     Topology() {}
@@ -383,6 +378,17 @@ class Topology {
             return true;}) const = 0;
 
     virtual std::string GetHostNameAndPortById(ChunkServerIdType csId) = 0;
+
+    /**
+     * @brief get a read-only snapshot of the topology which can be read
+     *        without lock, see TopologySnapshot
+     *
+     * @return the snapshot, nullptr if snapshot is not supported and the
+     *         interfaces above should be used instead
+     */
+    virtual std::shared_ptr<const TopologySnapshot> GetSnapshot() const {
+        return nullptr;
+    }
 };
 
 class TopologyImpl : public Topology {
@@ -393,6 +399,8 @@ class TopologyImpl : public Topology {
         : idGenerator_(idGenerator),
           tokenGenerator_(tokenGenerator),
           storage_(storage),
+          changedStructure_(0),
+          snapshotStale_(true),
           isStop_(true) {
     }
 
@@ -675,6 +683,21 @@ class TopologyImpl : public Topology {
 
     std::string GetHostNameAndPortById(ChunkServerIdType csId) override;
 
+    /**
+     * @brief get the latest snapshot. If the topology changed after the
+     *        snapshot was built more than snapshotRefreshIntervalMs ago,
+     *        a new snapshot is built from the changes before returning.
+     *        If snapshotRefreshIntervalMs is not 0 and another thread is
+     *        building, the current snapshot is returned without waiting.
+     */
+    std::shared_ptr<const TopologySnapshot> GetSnapshot() const override;
+
+    /**
+     * @brief build and publish a new snapshot with the changes happened
+     *        since the last one
+     */
+    void RefreshSnapshot() const;
+
  private:
     int LoadClusterInfo();
 
@@ -690,6 +713,22 @@ class TopologyImpl : public Topology {
 
     bool CreateDefaultPoolset();
 
+    // record changes for building the next snapshot, must be called after
+    // the item in RAM is changed
+    void MarkCopySetChanged(const CopySetKey &key) const;
+    void MarkChunkServerChanged(ChunkServerIdType id) const;
+    // types is bitwise OR of kSnapshotXXX defined in topology.cpp
+    void MarkStructureChanged(uint32_t types) const;
+
+    // build a new snapshot, snapshotBuildMutex_ must be held by caller
+    void RefreshSnapshotLocked() const;
+
+    // copy items of the given types for building a snapshot
+    void BuildSnapshotStructure(uint32_t types,
+                                TopologySnapshotBuilder *builder) const;
+    // copy all items for building a snapshot, maps must be locked by caller
+    void BuildSnapshotFull(TopologySnapshotBuilder *builder) const;
+
  private:
     std::unordered_map<PoolsetIdType, Poolset> poolsetMap_;
     std::unordered_map<PoolIdType, LogicalPool> logicalPoolMap_;
@@ -716,6 +755,17 @@ class TopologyImpl : public Topology {
     mutable curve::common::RWLock chunkServerMutex_;
     mutable curve::common::RWLock copySetMutex_;
 
+    // the published snapshot, accessed by std::atomic_load/atomic_store
+    mutable std::shared_ptr<const TopologySnapshot> snapshot_;
+    // serialize snapshot building
+    mutable curve::common::Mutex snapshotBuildMutex_;
+    // changes since the published snapshot, protected by snapshotDeltaMutex_
+    mutable curve::common::Mutex snapshotDeltaMutex_;
+    mutable std::set<CopySetKey> changedCopySets_;
+    mutable std::set<ChunkServerIdType> changedChunkServers_;
+    mutable uint32_t changedStructure_;
+    mutable std::atomic<bool> snapshotStale_;
+
     TopologyOption option_;
     curve::common::Thread backEndThread_;
     curve::common::Atomic<bool> isStop_;
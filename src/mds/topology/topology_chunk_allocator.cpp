@@ -24,17 +24,49 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
 #include <list>
+#include <set>
 #include <random>
+#include <unordered_map>
 
+#include "src/common/timeutility.h"
+
+using ::curve::common::TimeUtility;
 
 namespace curve {
 namespace mds {
 namespace topology {
 
+namespace {
+
+// load score added to a copyset by every chunk allocated to it since the
+// last load refresh, so that bursts of allocations between two refreshes
+// do not pile on the same copysets
+const double kAllocatedChunkLoadScore = 0.01;
+
+template <typename LoadMap>
+IOLoad AverageIOLoad(const LoadMap &loads) {
+    IOLoad avg;
+    if (loads.empty()) {
+        return avg;
+    }
+    for (const auto &it : loads) {
+        avg.bandwidth += it.second.bandwidth;
+        avg.iops += it.second.iops;
+        avg.latency += it.second.latency;
+    }
+    avg.bandwidth /= loads.size();
+    avg.iops /= loads.size();
+    avg.latency /= loads.size();
+    return avg;
+}
+
+}  // namespace
+
 // logical pool is not designated when calling this function. When executing,
 // a logical will be chosen following the policy (randomly or weighted)
 bool TopologyChunkAllocatorImpl::AllocateChunkRandomInSingleLogicalPool(
@@ -53,11 +85,8 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRandomInSingleLogicalPool(
         return false;
     }
 
-    CopySetFilter filter = [](const CopySetInfo &copyset) {
-        return copyset.IsAvailable();
-    };
-    std::vector<CopySetIdType> copySetIds =
-        topology_->GetCopySetsInLogicalPool(logicalPoolChosenId, filter);
+    auto copySets = GetAvailableCopySets(logicalPoolChosenId);
+    const std::vector<CopySetIdType> &copySetIds = *copySets;
 
     if (0 == copySetIds.size()) {
         LOG(ERROR) << "[AllocateChunkRandomInSingleLogicalPool]:"
@@ -86,11 +115,8 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
         return false;
     }
 
-    CopySetFilter filter = [](const CopySetInfo &copyset) {
-        return copyset.IsAvailable();
-    };
-    std::vector<CopySetIdType> copySetIds =
-        topology_->GetCopySetsInLogicalPool(logicalPoolChosenId, filter);
+    auto copySets = GetAvailableCopySets(logicalPoolChosenId);
+    const std::vector<CopySetIdType> &copySetIds = *copySets;
 
     if (0 == copySetIds.size()) {
         LOG(ERROR) << "[AllocateChunkRoundRobinInSingleLogicalPool]:"
@@ -99,6 +125,11 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
         return false;
     }
 
+    if (ChooseCopySetPolicy::kLoadAware == copySetPolicy_) {
+        return AllocateChunkByLoad(logicalPoolChosenId, copySetIds,
+                                   chunkNumber, infos);
+    }
+
     uint32_t nextIndex = 0;
 
     ::curve::common::LockGuard guard(nextIndexMapLock_);
@@ -122,6 +153,109 @@ bool TopologyChunkAllocatorImpl::AllocateChunkRoundRobinInSingleLogicalPool(
     return ret;
 }
 
+std::shared_ptr<const std::vector<CopySetIdType>>
+TopologyChunkAllocatorImpl::GetAvailableCopySets(PoolIdType logicalPoolId) {
+    // the snapshot keeps a sorted list of available copysets for every
+    // logical pool, no need to scan all copysets under the topology lock
+    auto snapshot = topology_->GetSnapshot();
+    if (snapshot != nullptr) {
+        return snapshot->GetAvailableCopySetsInLogicalPool(logicalPoolId);
+    }
+
+    CopySetFilter filter = [](const CopySetInfo &copyset) {
+        return copyset.IsAvailable();
+    };
+    return std::make_shared<const std::vector<CopySetIdType>>(
+        topology_->GetCopySetsInLogicalPool(logicalPoolId, filter));
+}
+
+bool TopologyChunkAllocatorImpl::AllocateChunkByLoad(
+    PoolIdType logicalPoolId, const std::vector<CopySetIdType> &copySetIds,
+    uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos) {
+    auto snapshot = topology_->GetSnapshot();
+
+    ::curve::common::LockGuard guard(loadLock_);
+    uint64_t now = TimeUtility::GetTimeofDayMs();
+    if (lastLoadRefreshMs_ == 0 ||
+        now >= lastLoadRefreshMs_ + loadRefreshIntervalMs_) {
+        RefreshLoadScores();
+        lastLoadRefreshMs_ = now;
+    }
+
+    auto loadFunc = [&](CopySetIdType copySetId) {
+        return GetCopySetLoadScore(snapshot.get(),
+                                   CopySetKey(logicalPoolId, copySetId));
+    };
+    bool ret = AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, logicalPoolId, chunkNumber, loadFunc,
+        kAllocatedChunkLoadScore, infos);
+    if (ret) {
+        for (const auto &info : *infos) {
+            allocatedChunks_[CopySetKey(logicalPoolId, info.copySetId)]++;
+        }
+    }
+    return ret;
+}
+
+void TopologyChunkAllocatorImpl::RefreshLoadScores() {
+    ChunkServerLoadMap chunkServerLoads;
+    CopySetLoadMap copySetLoads;
+    topoStat_->GetIOLoads(&chunkServerLoads, &copySetLoads);
+
+    chunkServerLoadScores_.clear();
+    IOLoad avg = AverageIOLoad(chunkServerLoads);
+    for (const auto &it : chunkServerLoads) {
+        chunkServerLoadScores_.emplace(it.first,
+            AllocateChunkPolicy::CalcLoadScore(it.second, avg));
+    }
+
+    copySetLoadScores_.clear();
+    avg = AverageIOLoad(copySetLoads);
+    for (const auto &it : copySetLoads) {
+        copySetLoadScores_.emplace(it.first,
+            AllocateChunkPolicy::CalcLoadScore(it.second, avg));
+    }
+
+    // allocated chunks are already reflected in the new statistics
+    allocatedChunks_.clear();
+}
+
+double TopologyChunkAllocatorImpl::GetCopySetLoadScore(
+    const TopologySnapshot *snapshot, const CopySetKey &key) {
+    std::set<ChunkServerIdType> members;
+    if (snapshot != nullptr) {
+        const CopySetInfo *info = snapshot->FindCopySet(key);
+        if (info != nullptr) {
+            members = info->GetCopySetMembers();
+        }
+    } else {
+        CopySetInfo info;
+        if (topology_->GetCopySet(key, &info)) {
+            members = info.GetCopySetMembers();
+        }
+    }
+
+    // a write is done by all members, so the most loaded member decides
+    double memberScore = 0;
+    for (const auto id : members) {
+        auto it = chunkServerLoadScores_.find(id);
+        if (it != chunkServerLoadScores_.end()) {
+            memberScore = std::max(memberScore, it->second);
+        }
+    }
+
+    double score = memberScore;
+    auto it = copySetLoadScores_.find(key);
+    if (it != copySetLoadScores_.end()) {
+        score += it->second;
+    }
+    auto allocated = allocatedChunks_.find(key);
+    if (allocated != allocatedChunks_.end()) {
+        score += allocated->second * kAllocatedChunkLoadScore;
+    }
+    return score;
+}
+
 bool TopologyChunkAllocatorImpl::ChooseSingleLogicalPool(
     curve::mds::FileType fileType, const std::string& pstName,
     PoolIdType *poolOut) {
@@ -236,7 +370,7 @@ void TopologyChunkAllocatorImpl::GetRemainingSpaceInLogicalPool(
     }
 }
 bool AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
-    std::vector<CopySetIdType> copySetIds, PoolIdType logicalPoolId,
+    const std::vector<CopySetIdType> &copySetIds, PoolIdType logicalPoolId,
     uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos) {
     infos->clear();
 
@@ -255,7 +389,7 @@ bool AllocateChunkPolicy::AllocateChunkRandomInSingleLogicalPool(
 }
 
 bool AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
-    std::vector<CopySetIdType> copySetIds, PoolIdType logicalPoolId,
+    const std::vector<CopySetIdType> &copySetIds, PoolIdType logicalPoolId,
     uint32_t *nextIndex, uint32_t chunkNumber,
     std::vector<CopysetIdInfo> *infos) {
     if (copySetIds.empty()) {
@@ -275,6 +409,60 @@ bool AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
     return true;
 }
 
+bool AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+    const std::vector<CopySetIdType> &copySetIds, PoolIdType logicalPoolId,
+    uint32_t chunkNumber,
+    const std::function<double(CopySetIdType)> &loadFunc,
+    double allocatedChunkLoad, std::vector<CopysetIdInfo> *infos) {
+    if (copySetIds.empty()) {
+        return false;
+    }
+    infos->clear();
+
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, copySetIds.size() - 1);
+
+    // chunks allocated in this round
+    std::unordered_map<CopySetIdType, uint32_t> allocated;
+    auto load = [&](CopySetIdType id) {
+        auto it = allocated.find(id);
+        double score = loadFunc(id);
+        if (it != allocated.end()) {
+            score += it->second * allocatedChunkLoad;
+        }
+        return score;
+    };
+
+    for (uint32_t i = 0; i < chunkNumber; i++) {
+        CopySetIdType first = copySetIds[dis(gen)];
+        CopySetIdType second = copySetIds[dis(gen)];
+        CopySetIdType chosen = load(second) < load(first) ? second : first;
+        allocated[chosen]++;
+
+        CopysetIdInfo idInfo;
+        idInfo.logicalPoolId = logicalPoolId;
+        idInfo.copySetId = chosen;
+        infos->push_back(idInfo);
+    }
+    return true;
+}
+
+double AllocateChunkPolicy::CalcLoadScore(const IOLoad &load,
+                                          const IOLoad &avg) {
+    double score = 0;
+    if (avg.iops > 0) {
+        score += static_cast<double>(load.iops) / avg.iops;
+    }
+    if (avg.bandwidth > 0) {
+        score += static_cast<double>(load.bandwidth) / avg.bandwidth;
+    }
+    if (avg.latency > 0) {
+        score += static_cast<double>(load.latency) / avg.latency;
+    }
+    return score;
+}
+
 bool AllocateChunkPolicy::ChooseSingleLogicalPoolByWeight(
     const std::map<PoolIdType, double> &poolWeightMap, PoolIdType *poolIdOut) {
     if (poolWeightMap.empty()) {
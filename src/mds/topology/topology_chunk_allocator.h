@@ -28,6 +28,7 @@
 #include <functional>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include "src/mds/topology/topology.h"
 #include "proto/nameserver2.pb.h"
@@ -47,6 +48,14 @@ enum class ChoosePoolPolicy {
     kWeight,
 };
 
+enum class ChooseCopySetPolicy {
+    // choose copysets by round robin
+    kRoundRobin = 0,
+    // choose the less loaded one of two random copysets, load is measured by
+    // iops, bandwidth and latency reported by heartbeat
+    kLoadAware,
+};
+
 class ChunkFilePoolAllocHelp {
  public:
     ChunkFilePoolAllocHelp()
@@ -123,6 +132,10 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
           topoStat_(topologyStat),
           chunkFilePoolAllocHelp_(ChunkFilePoolAllocHelp),
           policy_(static_cast<ChoosePoolPolicy>(option.choosePoolPolicy)),
+          copySetPolicy_(
+              static_cast<ChooseCopySetPolicy>(option.chooseCopySetPolicy)),
+          loadRefreshIntervalMs_(option.copySetLoadRefreshIntervalMs),
+          lastLoadRefreshMs_(0),
           enableLogicalPoolStatus_(option.enableLogicalPoolStatus) {
         std::srand(std::time(nullptr));
     }
@@ -148,7 +161,8 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         std::vector<CopysetIdInfo> *infos) override;
 
     /**
-     * @brief allocate chunks by round robin in a single logical pool
+     * @brief allocate chunks by round robin in a single logical pool, or by
+     *        load if ChooseCopySetPolicy::kLoadAware is configured
      *
      * @param fileType file type
      * @param chunkNumber number of chunks to allocate
@@ -191,6 +205,44 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
         const std::string& pstName,
         PoolIdType *poolOut);
 
+    /**
+     * @brief get available copysets in a logical pool, sorted by copyset id
+     *
+     * @param logicalPoolId logical pool id
+     *
+     * @return copyset id list
+     */
+    std::shared_ptr<const std::vector<CopySetIdType>> GetAvailableCopySets(
+        PoolIdType logicalPoolId);
+
+    /**
+     * @brief allocate chunks to less loaded copysets in a logical pool
+     *
+     * @param logicalPoolId logical pool id
+     * @param copySetIds available copysets in the logical pool
+     * @param chunkNumber number of chunks to allocate
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    bool AllocateChunkByLoad(PoolIdType logicalPoolId,
+        const std::vector<CopySetIdType> &copySetIds,
+        uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos);
+
+    /**
+     * @brief recalculate load scores of chunkservers and copysets from
+     *        topology stat, loadLock_ must be held
+     */
+    void RefreshLoadScores();
+
+    /**
+     * @brief load score of a copyset, which is the score of its most loaded
+     *        member plus its own score, loadLock_ must be held
+     */
+    double GetCopySetLoadScore(const TopologySnapshot *snapshot,
+        const CopySetKey &key);
+
  private:
     std::shared_ptr<Topology> topology_;
 
@@ -218,6 +270,20 @@ class TopologyChunkAllocatorImpl : public TopologyChunkAllocator {
     ::curve::common::Mutex nextIndexMapLock_;
     // policy for choosing pool
     ChoosePoolPolicy policy_;
+    // policy for choosing copyset
+    ChooseCopySetPolicy copySetPolicy_;
+    // time interval of refreshing load scores
+    uint32_t loadRefreshIntervalMs_;
+    /**
+     * @brief load scores calculated from the latest heartbeat statistics,
+     *        and the number of chunks allocated to copysets since then,
+     *        all protected by loadLock_
+     */
+    ::curve::common::Mutex loadLock_;
+    uint64_t lastLoadRefreshMs_;
+    std::unordered_map<ChunkServerIdType, double> chunkServerLoadScores_;
+    std::unordered_map<CopySetKey, double, CopySetKeyHash> copySetLoadScores_;
+    std::unordered_map<CopySetKey, uint32_t, CopySetKeyHash> allocatedChunks_;
     // enableLogicalPoolStatus
     bool enableLogicalPoolStatus_;
 };
@@ -240,7 +306,8 @@ class AllocateChunkPolicy {
      * @retval false if failed
      */
     static bool AllocateChunkRandomInSingleLogicalPool(
-        std::vector<CopySetIdType> copySetIds, PoolIdType logicalPoolId,
+        const std::vector<CopySetIdType> &copySetIds,
+        PoolIdType logicalPoolId,
         uint32_t chunkNumber, std::vector<CopysetIdInfo> *infos);
 
     /**
@@ -261,10 +328,47 @@ class AllocateChunkPolicy {
      * @retval false if failed
      */
     static bool AllocateChunkRoundRobinInSingleLogicalPool(
-        std::vector<CopySetIdType> copySetIds, PoolIdType logicalPoolId,
+        const std::vector<CopySetIdType> &copySetIds,
+        PoolIdType logicalPoolId,
         uint32_t *nextIndex, uint32_t chunkNumber,
         std::vector<CopysetIdInfo> *infos);
 
+    /**
+     * @brief allocate chunks in a single logical pool by power of two
+     *        choices: for every chunk, two copysets are chosen randomly and
+     *        the one with lower load is used. Chunks allocated in this call
+     *        are counted into the load by allocatedChunkLoad.
+     *
+     * @param copySetIds copyset id list in designated logical pool
+     * @param logicalPoolId logical pool id
+     * @param chunkNumber number of chunks to allocate
+     * @param loadFunc get load score of a copyset
+     * @param allocatedChunkLoad load score added by a chunk allocated
+     * @param infos copyset list that chunks allocated to
+     *
+     * @retval true if succeeded
+     * @retval false if failed
+     */
+    static bool AllocateChunkByLoadInSingleLogicalPool(
+        const std::vector<CopySetIdType> &copySetIds,
+        PoolIdType logicalPoolId,
+        uint32_t chunkNumber,
+        const std::function<double(CopySetIdType)> &loadFunc,
+        double allocatedChunkLoad,
+        std::vector<CopysetIdInfo> *infos);
+
+    /**
+     * @brief calculate the load score of an io load, every dimension
+     *        (iops, bandwidth and latency) is normalized by the average,
+     *        so a score around 3 means average load
+     *
+     * @param load io load
+     * @param avg average io load
+     *
+     * @return load score
+     */
+    static double CalcLoadScore(const IOLoad &load, const IOLoad &avg);
+
     /**
      * @brief choose a logical pool according to their weight
      *
@@ -44,8 +44,16 @@ struct TopologyOption {
     uint32_t PoolUsagePercentLimit;
     // policy of pool choosing
     int choosePoolPolicy;
+    // policy of copyset choosing when allocating chunks
+    int chooseCopySetPolicy;
+    // time interval of refreshing io load of copysets used by load aware
+    // copyset choosing (in ms)
+    uint32_t copySetLoadRefreshIntervalMs;
     // enable LogicalPool ALLOW/DENY status
     bool enableLogicalPoolStatus;
+    // max staleness of topology snapshot read by schedulers and chunk
+    // allocator (in ms), 0 means snapshot is refreshed on every change
+    uint32_t snapshotRefreshIntervalMs;
 
     TopologyOption()
         : TopologyUpdateToRepoSec(0),
@@ -54,7 +62,10 @@ struct TopologyOption {
           CreateCopysetRpcRetrySleepTimeMs(500),
           UpdateMetricIntervalSec(0),
           choosePoolPolicy(0),
-          enableLogicalPoolStatus(false) {}
+          chooseCopySetPolicy(0),
+          copySetLoadRefreshIntervalMs(5000),
+          enableLogicalPoolStatus(false),
+          snapshotRefreshIntervalMs(0) {}
 };
 
 }  // namespace topology
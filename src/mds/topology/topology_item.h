@@ -701,6 +701,7 @@ class ChunkServer {
     }
 
     void SetVersion(const std::string &version) { version_ = version; }
+    const std::string &GetVersion() const { return version_; }
 
     ::curve::common::RWLock& GetRWLockRef() const {
         return mutex_;
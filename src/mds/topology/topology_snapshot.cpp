@@ -0,0 +1,276 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-13
+ */
+
+#include "src/mds/topology/topology_snapshot.h"
+
+#include <algorithm>
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+namespace {
+
+template <typename K, typename V>
+bool GetFromMap(const std::shared_ptr<const std::unordered_map<K, V>> &map,
+                K id, V *out) {
+    auto it = map->find(id);
+    if (it == map->end()) {
+        return false;
+    }
+    *out = it->second;
+    return true;
+}
+
+}  // namespace
+
+TopologySnapshot::TopologySnapshot()
+    : epoch_(0),
+      createTimeMs_(0),
+      poolsets_(
+          std::make_shared<std::unordered_map<PoolsetIdType, Poolset>>()),
+      logicalPools_(
+          std::make_shared<std::unordered_map<PoolIdType, LogicalPool>>()),
+      physicalPools_(
+          std::make_shared<std::unordered_map<PoolIdType, PhysicalPool>>()),
+      zones_(std::make_shared<std::unordered_map<ZoneIdType, Zone>>()),
+      servers_(std::make_shared<std::unordered_map<ServerIdType, Server>>()),
+      chunkServers_(kSnapshotChunkServerShardNum),
+      copySets_(kSnapshotCopySetShardNum) {}
+
+bool TopologySnapshot::GetPoolset(PoolsetIdType id, Poolset *out) const {
+    return GetFromMap(poolsets_, id, out);
+}
+
+bool TopologySnapshot::GetLogicalPool(PoolIdType id, LogicalPool *out) const {
+    return GetFromMap(logicalPools_, id, out);
+}
+
+bool TopologySnapshot::GetPhysicalPool(PoolIdType id,
+                                       PhysicalPool *out) const {
+    return GetFromMap(physicalPools_, id, out);
+}
+
+bool TopologySnapshot::GetZone(ZoneIdType id, Zone *out) const {
+    return GetFromMap(zones_, id, out);
+}
+
+bool TopologySnapshot::GetServer(ServerIdType id, Server *out) const {
+    return GetFromMap(servers_, id, out);
+}
+
+bool TopologySnapshot::GetChunkServer(ChunkServerIdType id,
+                                      ChunkServer *out) const {
+    const ChunkServer *cs = chunkServers_.Find(id);
+    if (cs == nullptr) {
+        return false;
+    }
+    *out = *cs;
+    return true;
+}
+
+bool TopologySnapshot::GetCopySet(const CopySetKey &key,
+                                  CopySetInfo *out) const {
+    const CopySetInfo *info = copySets_.Find(key);
+    if (info == nullptr) {
+        return false;
+    }
+    *out = *info;
+    return true;
+}
+
+const LogicalPool *TopologySnapshot::FindLogicalPool(PoolIdType id) const {
+    auto it = logicalPools_->find(id);
+    return it == logicalPools_->end() ? nullptr : &it->second;
+}
+
+const ChunkServer *TopologySnapshot::FindChunkServer(
+    ChunkServerIdType id) const {
+    return chunkServers_.Find(id);
+}
+
+const CopySetInfo *TopologySnapshot::FindCopySet(const CopySetKey &key) const {
+    return copySets_.Find(key);
+}
+
+std::vector<PoolIdType> TopologySnapshot::GetLogicalPoolInCluster(
+    LogicalPoolFilter filter) const {
+    std::vector<PoolIdType> ret;
+    for (const auto &it : *logicalPools_) {
+        if (filter(it.second)) {
+            ret.push_back(it.first);
+        }
+    }
+    return ret;
+}
+
+std::vector<ChunkServerIdType> TopologySnapshot::GetChunkServerInCluster(
+    ChunkServerFilter filter) const {
+    std::vector<ChunkServerIdType> ret;
+    chunkServers_.ForEach([&](const ChunkServer &cs) {
+        if (filter(cs)) {
+            ret.push_back(cs.GetId());
+        }
+    });
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+std::vector<CopySetKey> TopologySnapshot::GetCopySetsInCluster(
+    CopySetFilter filter) const {
+    std::vector<CopySetKey> ret;
+    copySets_.ForEach([&](const CopySetInfo &info) {
+        if (filter(info)) {
+            ret.push_back(info.GetCopySetKey());
+        }
+    });
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+void TopologySnapshot::ForEachCopySet(
+    const std::function<void(const CopySetInfo&)> &func) const {
+    copySets_.ForEach(func);
+}
+
+std::shared_ptr<const std::vector<CopySetIdType>>
+TopologySnapshot::GetAvailableCopySetsInLogicalPool(
+    PoolIdType logicalPoolId) const {
+    auto it = availableCopySets_.find(logicalPoolId);
+    if (it == availableCopySets_.end()) {
+        return std::make_shared<const std::vector<CopySetIdType>>();
+    }
+    return it->second;
+}
+
+TopologySnapshotBuilder::TopologySnapshotBuilder(
+    const std::shared_ptr<const TopologySnapshot> &base) {
+    if (base != nullptr) {
+        snapshot_ = std::make_shared<TopologySnapshot>(*base);
+    } else {
+        snapshot_ = std::make_shared<TopologySnapshot>();
+    }
+}
+
+void TopologySnapshotBuilder::SetPoolsets(
+    std::unordered_map<PoolsetIdType, Poolset> poolsets) {
+    snapshot_->poolsets_ =
+        std::make_shared<const std::unordered_map<PoolsetIdType, Poolset>>(
+            std::move(poolsets));
+}
+
+void TopologySnapshotBuilder::SetLogicalPools(
+    std::unordered_map<PoolIdType, LogicalPool> logicalPools) {
+    snapshot_->logicalPools_ =
+        std::make_shared<const std::unordered_map<PoolIdType, LogicalPool>>(
+            std::move(logicalPools));
+}
+
+void TopologySnapshotBuilder::SetPhysicalPools(
+    std::unordered_map<PoolIdType, PhysicalPool> physicalPools) {
+    snapshot_->physicalPools_ =
+        std::make_shared<const std::unordered_map<PoolIdType, PhysicalPool>>(
+            std::move(physicalPools));
+}
+
+void TopologySnapshotBuilder::SetZones(
+    std::unordered_map<ZoneIdType, Zone> zones) {
+    snapshot_->zones_ =
+        std::make_shared<const std::unordered_map<ZoneIdType, Zone>>(
+            std::move(zones));
+}
+
+void TopologySnapshotBuilder::SetServers(
+    std::unordered_map<ServerIdType, Server> servers) {
+    snapshot_->servers_ =
+        std::make_shared<const std::unordered_map<ServerIdType, Server>>(
+            std::move(servers));
+}
+
+void TopologySnapshotBuilder::PutChunkServer(const ChunkServer &data) {
+    snapshot_->chunkServers_.Put(data.GetId(),
+        std::make_shared<const ChunkServer>(data));
+}
+
+void TopologySnapshotBuilder::RemoveChunkServer(ChunkServerIdType id) {
+    snapshot_->chunkServers_.Erase(id);
+}
+
+void TopologySnapshotBuilder::PutCopySet(const CopySetInfo &data) {
+    CopySetKey key = data.GetCopySetKey();
+    const CopySetInfo *old = snapshot_->copySets_.Find(key);
+    bool oldAvailable = (old != nullptr && old->IsAvailable());
+    if (oldAvailable != data.IsAvailable()) {
+        UpdateAvailableCopySet(key, data.IsAvailable());
+    }
+    snapshot_->copySets_.Put(key, std::make_shared<const CopySetInfo>(data));
+}
+
+void TopologySnapshotBuilder::RemoveCopySet(const CopySetKey &key) {
+    const CopySetInfo *old = snapshot_->copySets_.Find(key);
+    if (old == nullptr) {
+        return;
+    }
+    if (old->IsAvailable()) {
+        UpdateAvailableCopySet(key, false);
+    }
+    snapshot_->copySets_.Erase(key);
+}
+
+void TopologySnapshotBuilder::UpdateAvailableCopySet(const CopySetKey &key,
+                                                     bool available) {
+    std::shared_ptr<std::vector<CopySetIdType>> ids;
+    auto owned = ownedAvailable_.find(key.first);
+    if (owned != ownedAvailable_.end()) {
+        ids = owned->second;
+    } else {
+        auto &lists = snapshot_->availableCopySets_;
+        auto it = lists.find(key.first);
+        if (it != lists.end()) {
+            ids = std::make_shared<std::vector<CopySetIdType>>(*it->second);
+        } else {
+            ids = std::make_shared<std::vector<CopySetIdType>>();
+        }
+        ownedAvailable_.emplace(key.first, ids);
+        lists[key.first] = ids;
+    }
+
+    auto pos = std::lower_bound(ids->begin(), ids->end(), key.second);
+    bool exist = (pos != ids->end() && *pos == key.second);
+    if (available && !exist) {
+        ids->insert(pos, key.second);
+    } else if (!available && exist) {
+        ids->erase(pos);
+    }
+}
+
+std::shared_ptr<const TopologySnapshot> TopologySnapshotBuilder::Build(
+    uint64_t timeMs) {
+    snapshot_->epoch_++;
+    snapshot_->createTimeMs_ = timeMs;
+    ownedAvailable_.clear();
+    std::shared_ptr<const TopologySnapshot> ret = std::move(snapshot_);
+    return ret;
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-13
+ */
+
+#ifndef SRC_MDS_TOPOLOGY_TOPOLOGY_SNAPSHOT_H_
+#define SRC_MDS_TOPOLOGY_TOPOLOGY_SNAPSHOT_H_
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/mds/topology/topology_item.h"
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+using ChunkServerFilter = std::function<bool(const ChunkServer&)>;
+using ServerFilter = std::function<bool (const Server&)>;
+using ZoneFilter = std::function<bool (const Zone&)>;
+using PhysicalPoolFilter = std::function<bool (const PhysicalPool&)>;
+using LogicalPoolFilter = std::function<bool(const LogicalPool&)>;
+using PoolsetFilter = std::function<bool (const Poolset&)>;
+using CopySetFilter = std::function<bool (const CopySetInfo&)>;
+
+// shard number of copysets and chunkservers in a snapshot, a modified item
+// only causes its shard to be copied when building a new snapshot
+const uint32_t kSnapshotCopySetShardNum = 4096;
+const uint32_t kSnapshotChunkServerShardNum = 64;
+
+struct CopySetKeyHash {
+    size_t operator()(const CopySetKey &key) const {
+        return std::hash<uint64_t>()(
+            (static_cast<uint64_t>(key.first) << 32) | key.second);
+    }
+};
+
+/**
+ * @brief an immutable map split into shards. Copying a SnapshotMap only
+ *        copies the shard pointers, and a shard is copied on its first
+ *        modification, so versions share all untouched shards.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class SnapshotMap {
+ public:
+    using Shard = std::unordered_map<K, std::shared_ptr<const V>, Hash>;
+
+    explicit SnapshotMap(uint32_t shardNum = 1)
+        : shards_(shardNum == 0 ? 1 : shardNum),
+          owned_(shards_.size(), true),
+          size_(0) {
+        for (auto &shard : shards_) {
+            shard = std::make_shared<Shard>();
+        }
+    }
+
+    // the copy shares all shards with the origin and owns none of them
+    SnapshotMap(const SnapshotMap &other)
+        : shards_(other.shards_),
+          owned_(other.shards_.size(), false),
+          size_(other.size_) {}
+
+    SnapshotMap &operator=(const SnapshotMap &other) {
+        if (this != &other) {
+            shards_ = other.shards_;
+            owned_.assign(other.shards_.size(), false);
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    const V *Find(const K &key) const {
+        const Shard &shard = *shards_[ShardIndex(key)];
+        auto it = shard.find(key);
+        return it == shard.end() ? nullptr : it->second.get();
+    }
+
+    template <typename Func>
+    void ForEach(const Func &func) const {
+        for (const auto &shard : shards_) {
+            for (const auto &item : *shard) {
+                func(*item.second);
+            }
+        }
+    }
+
+    size_t Size() const {
+        return size_;
+    }
+
+    void Put(const K &key, std::shared_ptr<const V> value) {
+        Shard *shard = MutableShard(key);
+        auto ret = shard->emplace(key, value);
+        if (ret.second) {
+            size_++;
+        } else {
+            ret.first->second = std::move(value);
+        }
+    }
+
+    bool Erase(const K &key) {
+        if (Find(key) == nullptr) {
+            return false;
+        }
+        MutableShard(key)->erase(key);
+        size_--;
+        return true;
+    }
+
+ private:
+    uint32_t ShardIndex(const K &key) const {
+        return Hash()(key) % shards_.size();
+    }
+
+    Shard *MutableShard(const K &key) {
+        uint32_t index = ShardIndex(key);
+        if (!owned_[index]) {
+            shards_[index] = std::make_shared<Shard>(*shards_[index]);
+            owned_[index] = true;
+        }
+        return shards_[index].get();
+    }
+
+ private:
+    std::vector<std::shared_ptr<Shard>> shards_;
+    // shards that are only referenced by this map and can be modified
+    std::vector<bool> owned_;
+    size_t size_;
+};
+
+/**
+ * @brief an immutable and consistent view of the topology at some epoch.
+ *        It is built by TopologySnapshotBuilder and never changed after
+ *        that, so it can be read by schedulers and chunk allocator without
+ *        any lock. Items got from a snapshot may be stale, and the
+ *        interfaces of Topology must be used when the latest data is needed.
+ */
+class TopologySnapshot {
+ public:
+    TopologySnapshot();
+
+    uint64_t GetEpoch() const {
+        return epoch_;
+    }
+
+    uint64_t GetCreateTimeMs() const {
+        return createTimeMs_;
+    }
+
+    bool GetPoolset(PoolsetIdType id, Poolset *out) const;
+    bool GetLogicalPool(PoolIdType id, LogicalPool *out) const;
+    bool GetPhysicalPool(PoolIdType id, PhysicalPool *out) const;
+    bool GetZone(ZoneIdType id, Zone *out) const;
+    bool GetServer(ServerIdType id, Server *out) const;
+    bool GetChunkServer(ChunkServerIdType id, ChunkServer *out) const;
+    bool GetCopySet(const CopySetKey &key, CopySetInfo *out) const;
+
+    // the pointers are valid as long as the snapshot is alive
+    const LogicalPool *FindLogicalPool(PoolIdType id) const;
+    const ChunkServer *FindChunkServer(ChunkServerIdType id) const;
+    const CopySetInfo *FindCopySet(const CopySetKey &key) const;
+
+    std::vector<PoolIdType> GetLogicalPoolInCluster(
+        LogicalPoolFilter filter = [](const LogicalPool&) {
+            return true;}) const;
+
+    std::vector<ChunkServerIdType> GetChunkServerInCluster(
+        ChunkServerFilter filter = [](const ChunkServer&) {
+            return true;}) const;
+
+    std::vector<CopySetKey> GetCopySetsInCluster(
+        CopySetFilter filter = [](const CopySetInfo&) {
+            return true;}) const;
+
+    void ForEachCopySet(
+        const std::function<void(const CopySetInfo&)> &func) const;
+
+    /**
+     * @brief get available copysets of a logical pool, the result is
+     *        maintained incrementally and sorted by copyset id
+     *
+     * @param logicalPoolId logical pool id
+     *
+     * @return copyset ids, empty if there is no available copyset
+     */
+    std::shared_ptr<const std::vector<CopySetIdType>>
+        GetAvailableCopySetsInLogicalPool(PoolIdType logicalPoolId) const;
+
+    uint64_t GetChunkServerNum() const {
+        return chunkServers_.Size();
+    }
+
+    uint64_t GetCopySetNum() const {
+        return copySets_.Size();
+    }
+
+ private:
+    friend class TopologySnapshotBuilder;
+
+    uint64_t epoch_;
+    uint64_t createTimeMs_;
+
+    // poolsets, pools, zones and servers are few and seldom changed, they
+    // are copied as a whole when changed
+    std::shared_ptr<const std::unordered_map<PoolsetIdType, Poolset>>
+        poolsets_;
+    std::shared_ptr<const std::unordered_map<PoolIdType, LogicalPool>>
+        logicalPools_;
+    std::shared_ptr<const std::unordered_map<PoolIdType, PhysicalPool>>
+        physicalPools_;
+    std::shared_ptr<const std::unordered_map<ZoneIdType, Zone>> zones_;
+    std::shared_ptr<const std::unordered_map<ServerIdType, Server>> servers_;
+
+    SnapshotMap<ChunkServerIdType, ChunkServer> chunkServers_;
+    SnapshotMap<CopySetKey, CopySetInfo, CopySetKeyHash> copySets_;
+
+    // logical pool id -> sorted available copyset ids
+    std::unordered_map<PoolIdType,
+        std::shared_ptr<const std::vector<CopySetIdType>>> availableCopySets_;
+};
+
+/**
+ * @brief build a new snapshot from the previous one and the changes
+ *        happened after it
+ */
+class TopologySnapshotBuilder {
+ public:
+    /**
+     * @param base the previous snapshot, nullptr to build from scratch
+     */
+    explicit TopologySnapshotBuilder(
+        const std::shared_ptr<const TopologySnapshot> &base);
+
+    void SetPoolsets(std::unordered_map<PoolsetIdType, Poolset> poolsets);
+    void SetLogicalPools(
+        std::unordered_map<PoolIdType, LogicalPool> logicalPools);
+    void SetPhysicalPools(
+        std::unordered_map<PoolIdType, PhysicalPool> physicalPools);
+    void SetZones(std::unordered_map<ZoneIdType, Zone> zones);
+    void SetServers(std::unordered_map<ServerIdType, Server> servers);
+
+    void PutChunkServer(const ChunkServer &data);
+    void RemoveChunkServer(ChunkServerIdType id);
+
+    void PutCopySet(const CopySetInfo &data);
+    void RemoveCopySet(const CopySetKey &key);
+
+    /**
+     * @brief finish building, the builder can not be used any more
+     *
+     * @param timeMs creation time of the snapshot
+     *
+     * @return the new snapshot whose epoch is the base epoch plus one
+     */
+    std::shared_ptr<const TopologySnapshot> Build(uint64_t timeMs);
+
+ private:
+    void UpdateAvailableCopySet(const CopySetKey &key, bool available);
+
+ private:
+    std::shared_ptr<TopologySnapshot> snapshot_;
+    // available copyset lists already copied by this builder
+    std::unordered_map<PoolIdType,
+        std::shared_ptr<std::vector<CopySetIdType>>> ownedAvailable_;
+};
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
+
+#endif  // SRC_MDS_TOPOLOGY_TOPOLOGY_SNAPSHOT_H_
@@ -83,6 +83,39 @@ bool TopologyStatImpl::GetChunkPoolSize(PoolIdType pId,
     return false;
 }
 
+namespace {
+
+template <typename Stat>
+IOLoad ToIOLoad(const Stat &stat) {
+    IOLoad load;
+    load.bandwidth = static_cast<uint64_t>(stat.readRate) + stat.writeRate;
+    load.iops = static_cast<uint64_t>(stat.readIOPS) + stat.writeIOPS;
+    // latency weighted by iops of reading and writing
+    if (load.iops > 0) {
+        load.latency = (static_cast<uint64_t>(stat.readLatency) *
+            stat.readIOPS + static_cast<uint64_t>(stat.writeLatency) *
+            stat.writeIOPS) / load.iops;
+    }
+    return load;
+}
+
+}  // namespace
+
+void TopologyStatImpl::GetIOLoads(ChunkServerLoadMap *chunkServerLoads,
+    CopySetLoadMap *copySetLoads) {
+    ReadLockGuard rLock(statsLock_);
+    chunkServerLoads->reserve(chunkServerStats_.size());
+    for (const auto &it : chunkServerStats_) {
+        (*chunkServerLoads)[it.first] = ToIOLoad(it.second);
+        for (const auto &cstat : it.second.copysetStats) {
+            if (cstat.leader == it.first) {
+                (*copySetLoads)[CopySetKey(cstat.logicalPoolId,
+                    cstat.copysetId)] = ToIOLoad(cstat);
+            }
+        }
+    }
+}
+
 int TopologyStatImpl::Init() {
     return kTopoErrCodeSuccess;
 }
@@ -27,6 +27,7 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <memory>
 
 #include "src/mds/common/mds_define.h"
@@ -54,6 +55,10 @@ struct CopysetStat {
     uint32_t readIOPS;
     // Writing IOPS
     uint32_t writeIOPS;
+    // Average reading latency(us)
+    uint32_t readLatency;
+    // Average writing latency(us)
+    uint32_t writeLatency;
     CopysetStat() :
         logicalPoolId(UNINTIALIZE_ID),
         copysetId(UNINTIALIZE_ID),
@@ -61,7 +66,9 @@ struct CopysetStat {
         readRate(0),
         writeRate(0),
         readIOPS(0),
-        writeIOPS(0) {}
+        writeIOPS(0),
+        readLatency(0),
+        writeLatency(0) {}
 };
 
 struct ChunkServerStat {
@@ -77,6 +84,10 @@ struct ChunkServerStat {
     uint32_t readIOPS;
     // Writing IOPS
     uint32_t writeIOPS;
+    // Average reading latency(us)
+    uint32_t readLatency;
+    // Average writing latency(us)
+    uint32_t writeLatency;
     // Size of chunks already used
     uint64_t chunkSizeUsedBytes;
     // Size of chunks unused
@@ -87,6 +98,8 @@ struct ChunkServerStat {
     uint64_t chunkFilepoolSize;
     // Rate of chunkfilepool format
     uint32_t chunkFilepoolFormatPercent;
+    // Bandwidth of reading snapshot for followers installing snapshot
+    uint32_t installSnapshotRate;
 
     // Copyset statistic
     std::vector<CopysetStat> copysetStats;
@@ -98,9 +111,26 @@ struct ChunkServerStat {
           writeRate(0),
           readIOPS(0),
           writeIOPS(0),
-          chunkFilepoolFormatPercent(0) {}
+          readLatency(0),
+          writeLatency(0),
+          chunkFilepoolFormatPercent(0),
+          installSnapshotRate(0) {}
 };
 
+// Recent io load of a chunkserver or a copyset
+struct IOLoad {
+    // Reading and writing bandwidth
+    uint64_t bandwidth;
+    // Reading and writing IOPS
+    uint64_t iops;
+    // Average latency of reading and writing(us)
+    uint64_t latency;
+    IOLoad() : bandwidth(0), iops(0), latency(0) {}
+};
+
+using ChunkServerLoadMap = std::unordered_map<ChunkServerIdType, IOLoad>;
+using CopySetLoadMap = std::unordered_map<CopySetKey, IOLoad, CopySetKeyHash>;
+
 /**
  * @brief Topology statistic module for managing its stats
  */
@@ -136,6 +166,16 @@ class TopologyStat {
      */    
     virtual bool GetChunkPoolSize(PoolIdType pId,
     uint64_t *chunkPoolSize) = 0;
+
+    /**
+     * @brief fetch the io load of all chunkservers and copysets reported by
+     *        heartbeat, the load of a copyset is the one reported by its leader
+     *
+     * @param[out] chunkServerLoads io load of chunkservers
+     * @param[out] copySetLoads io load of copysets
+     */
+    virtual void GetIOLoads(ChunkServerLoadMap *chunkServerLoads,
+        CopySetLoadMap *copySetLoads) = 0;
 };
 
 class TopologyStatImpl : public TopologyStat {
@@ -151,6 +191,8 @@ class TopologyStatImpl : public TopologyStat {
         ChunkServerStat *stat) override;
     bool GetChunkPoolSize(PoolIdType pId,
     uint64_t *chunkPoolSize) override;
+    void GetIOLoads(ChunkServerLoadMap *chunkServerLoads,
+        CopySetLoadMap *copySetLoads) override;
 
  private:
     /**
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-19
+ */
+
+#include "src/snapshotcloneserver/clone/clone_chunk_scheduler.h"
+
+#include <algorithm>
+
+using ::curve::common::LockGuard;
+using ::curve::common::UniqueLock;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+void CloneChunkScheduler::AddTask(const TaskIdType &taskId) {
+    LockGuard lk(mtx_);
+    tasks_.emplace(taskId, 0);
+}
+
+void CloneChunkScheduler::RemoveTask(const TaskIdType &taskId) {
+    {
+        LockGuard lk(mtx_);
+        auto it = tasks_.find(taskId);
+        if (it == tasks_.end()) {
+            return;
+        }
+        inflightChunk_ -= it->second;
+        tasks_.erase(it);
+    }
+    // 任务数变化后其他任务的份额也会变化
+    cond_.notify_all();
+}
+
+bool CloneChunkScheduler::TryAcquire(const TaskIdType &taskId) {
+    LockGuard lk(mtx_);
+    if (!CanAcquire(taskId)) {
+        return false;
+    }
+    tasks_[taskId]++;
+    inflightChunk_++;
+    return true;
+}
+
+void CloneChunkScheduler::Acquire(const TaskIdType &taskId) {
+    UniqueLock lk(mtx_);
+    cond_.wait(lk, [this, &taskId]() {
+        return CanAcquire(taskId);
+    });
+    tasks_[taskId]++;
+    inflightChunk_++;
+}
+
+void CloneChunkScheduler::Release(const TaskIdType &taskId, uint32_t num) {
+    if (0 == num) {
+        return;
+    }
+    {
+        LockGuard lk(mtx_);
+        auto it = tasks_.find(taskId);
+        if (it == tasks_.end()) {
+            return;
+        }
+        num = std::min(num, it->second);
+        it->second -= num;
+        inflightChunk_ -= num;
+    }
+    cond_.notify_all();
+}
+
+bool CloneChunkScheduler::CanAcquire(const TaskIdType &taskId) {
+    if (0 == maxInflightChunk_) {
+        return true;
+    }
+    if (inflightChunk_ >= maxInflightChunk_) {
+        return false;
+    }
+    uint32_t taskNum = std::max<uint32_t>(tasks_.size(), 1);
+    uint32_t share = (maxInflightChunk_ + taskNum - 1) / taskNum;
+    auto it = tasks_.find(taskId);
+    uint32_t taskInflight = (it == tasks_.end()) ? 0 : it->second;
+    return taskInflight < share;
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-19
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_CLONE_CLONE_CHUNK_SCHEDULER_H_
+#define SRC_SNAPSHOTCLONESERVER_CLONE_CLONE_CHUNK_SCHEDULER_H_
+
+#include <map>
+#include <memory>
+
+#include "src/common/snapshotclone/snapshotclone_define.h"
+#include "src/common/concurrent/concurrent.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+/**
+ * @brief 所有克隆/恢复任务共享的chunk配额
+ * @detail
+ *  CreateCloneChunk和RecoverChunk阶段，每个在途的chunk占用一个配额，
+ *  chunk完成后归还。配额在处于这两个阶段的任务之间平均分配，
+ *  任务占用的配额达到其份额后不能再申请，
+ *  避免大任务占满配额使小任务饿死
+ */
+class CloneChunkScheduler {
+ public:
+    /**
+     * @param maxInflightChunk 所有任务同时进行的chunk数量上限，0表示不限制
+     */
+    explicit CloneChunkScheduler(uint32_t maxInflightChunk)
+        : maxInflightChunk_(maxInflightChunk),
+          inflightChunk_(0) {}
+
+    /**
+     * @brief 任务进入chunk阶段，参与配额分配
+     *
+     * @param taskId 任务id
+     */
+    void AddTask(const TaskIdType &taskId);
+
+    /**
+     * @brief 任务离开chunk阶段，归还该任务占用的全部配额
+     *
+     * @param taskId 任务id
+     */
+    void RemoveTask(const TaskIdType &taskId);
+
+    /**
+     * @brief 尝试为任务申请一个chunk配额，不阻塞
+     *
+     * @param taskId 任务id
+     *
+     * @retVal true 申请成功
+     * @retVal false 配额已用完或任务已达到其份额
+     */
+    bool TryAcquire(const TaskIdType &taskId);
+
+    /**
+     * @brief 为任务申请一个chunk配额，拿不到时等待
+     *        只能在任务没有占用配额时调用，否则可能与其他任务互相等待
+     *
+     * @param taskId 任务id
+     */
+    void Acquire(const TaskIdType &taskId);
+
+    /**
+     * @brief 归还任务占用的chunk配额
+     *
+     * @param taskId 任务id
+     * @param num 归还的数量
+     */
+    void Release(const TaskIdType &taskId, uint32_t num = 1);
+
+    uint32_t GetInflightChunkNum() {
+        curve::common::LockGuard lk(mtx_);
+        return inflightChunk_;
+    }
+
+ private:
+    bool CanAcquire(const TaskIdType &taskId);
+
+ private:
+    // 所有任务同时进行的chunk数量上限
+    uint32_t maxInflightChunk_;
+    // 所有任务在途的chunk数量
+    uint32_t inflightChunk_;
+    // 处于chunk阶段的任务及其在途的chunk数量
+    std::map<TaskIdType, uint32_t> tasks_;
+
+    curve::common::Mutex mtx_;
+    curve::common::ConditionVariable cond_;
+};
+
+/**
+ * @brief 任务在chunk阶段期间参与配额分配，离开时归还全部配额
+ */
+class CloneChunkSchedulerGuard {
+ public:
+    CloneChunkSchedulerGuard(
+        const std::shared_ptr<CloneChunkScheduler> &scheduler,
+        const TaskIdType &taskId)
+        : scheduler_(scheduler),
+          taskId_(taskId) {
+        scheduler_->AddTask(taskId_);
+    }
+
+    ~CloneChunkSchedulerGuard() {
+        scheduler_->RemoveTask(taskId_);
+    }
+
+ private:
+    std::shared_ptr<CloneChunkScheduler> scheduler_;
+    TaskIdType taskId_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_CLONE_CLONE_CHUNK_SCHEDULER_H_
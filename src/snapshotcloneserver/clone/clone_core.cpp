@@ -749,6 +749,8 @@ int CloneCoreImpl::CreateCloneChunk(
         correctSn = fInfo.seqnum;
     }
     auto tracker = std::make_shared<CreateCloneChunkTaskTracker>();
+    CloneChunkSchedulerGuard schedulerGuard(chunkScheduler_,
+        task->GetTaskId());
     for (auto & cloneSegmentInfo : *segInfos) {
         for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
             std::string location;
@@ -774,6 +776,10 @@ int CloneCoreImpl::CreateCloneChunk(
             context->clientAsyncMethodRetryTimeSec =
                 clientAsyncMethodRetryTimeSec_;
 
+            ret = AcquireCreateCloneChunkSlot(task, tracker);
+            if (ret < 0) {
+                return kErrCodeInternalError;
+            }
             ret = StartAsyncCreateCloneChunk(task, tracker, context);
             if (ret < 0) {
                 return kErrCodeInternalError;
@@ -857,13 +863,40 @@ int CloneCoreImpl::StartAsyncCreateCloneChunk(
     return kErrCodeSuccess;
 }
 
+int CloneCoreImpl::AcquireCreateCloneChunkSlot(
+    std::shared_ptr<CloneTaskInfo> task,
+    std::shared_ptr<CreateCloneChunkTaskTracker> tracker) {
+    while (!chunkScheduler_->TryAcquire(task->GetTaskId())) {
+        // 先取在途请求数再取结果，两者都为空时本任务没有占用配额
+        uint32_t inflight = tracker->GetTaskNum();
+        std::list<CreateCloneChunkContextPtr> results =
+            tracker->PopResultContexts();
+        if (results.empty()) {
+            if (0 == inflight) {
+                chunkScheduler_->Acquire(task->GetTaskId());
+                return kErrCodeSuccess;
+            }
+            tracker->WaitSome(1);
+            continue;
+        }
+        int ret = HandleCreateCloneChunkResultsAndRetry(task, tracker, results);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    return kErrCodeSuccess;
+}
+
 int CloneCoreImpl::HandleCreateCloneChunkResultsAndRetry(
     std::shared_ptr<CloneTaskInfo> task,
     std::shared_ptr<CreateCloneChunkTaskTracker> tracker,
     const std::list<CreateCloneChunkContextPtr> &results) {
     int ret = kErrCodeSuccess;
     for (auto context : results) {
-        if (context->retCode == -LIBCURVE_ERROR::EXISTS) {
+        if (context->retCode == LIBCURVE_ERROR::OK) {
+            chunkScheduler_->Release(task->GetTaskId());
+        } else if (context->retCode == -LIBCURVE_ERROR::EXISTS) {
+            chunkScheduler_->Release(task->GetTaskId());
             LOG(INFO) << "CreateCloneChunk chunk exist"
                       << ", location = " << context->location
                       << ", logicalPoolId = " << context->cidInfo.lpid_
@@ -939,12 +972,6 @@ int CloneCoreImpl::RecoverChunk(
     int ret = kErrCodeSuccess;
     uint32_t chunkSize = fInfo.chunksize;
 
-    uint32_t totalProgress =
-        kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
-    uint32_t segNum = segInfos.size();
-    double progressPerData = static_cast<double>(totalProgress) / segNum;
-    uint32_t index = 0;
-
     if (0 == cloneChunkSplitSize_ ||
         chunkSize % cloneChunkSplitSize_ != 0) {
         LOG(ERROR) << "chunk is not align to cloneChunkSplitSize"
@@ -952,7 +979,24 @@ int CloneCoreImpl::RecoverChunk(
         return kErrCodeChunkSizeNotAligned;
     }
 
+    uint64_t totalChunkNum = 0;
+    for (auto & cloneSegmentInfo : segInfos) {
+        for (auto & cloneChunkInfo : cloneSegmentInfo.second) {
+            if (cloneChunkInfo.second.needRecover) {
+                totalChunkNum++;
+            }
+        }
+    }
+    // 按完成的chunk数更新进度
+    uint32_t totalProgress =
+        kProgressRecoverChunkEnd - kProgressRecoverChunkBegin;
+    double progressPerChunk = (0 == totalChunkNum) ? 0 :
+        static_cast<double>(totalProgress) / totalChunkNum;
+    uint64_t doneChunkNum = 0;
+
     auto tracker = std::make_shared<RecoverChunkTaskTracker>();
+    CloneChunkSchedulerGuard schedulerGuard(chunkScheduler_,
+        task->GetTaskId());
     uint64_t workingChunkNum = 0;
     // 为避免发往同一个chunk碰撞，异步请求不同的chunk
     for (auto & cloneSegmentInfo : segInfos) {
@@ -960,8 +1004,15 @@ int CloneCoreImpl::RecoverChunk(
             if (!cloneChunkInfo.second.needRecover) {
                 continue;
             }
-            // 当前并发工作的chunk数已大于要求的并发数时，先消化一部分
-            while (workingChunkNum >= recoverChunkConcurrency_) {
+            // 当前并发工作的chunk数已大于要求的并发数，
+            // 或者全局chunk配额已用完时，先消化一部分
+            while (workingChunkNum >= recoverChunkConcurrency_ ||
+                !chunkScheduler_->TryAcquire(task->GetTaskId())) {
+                if (0 == workingChunkNum) {
+                    // 本任务没有占用配额，排队等待
+                    chunkScheduler_->Acquire(task->GetTaskId());
+                    break;
+                }
                 uint64_t completeChunkNum = 0;
                 ret = ContinueAsyncRecoverChunkPartAndWaitSomeChunkEnd(task,
                     tracker,
@@ -970,6 +1021,12 @@ int CloneCoreImpl::RecoverChunk(
                     return kErrCodeInternalError;
                 }
                 workingChunkNum -= completeChunkNum;
+                chunkScheduler_->Release(task->GetTaskId(), completeChunkNum);
+                doneChunkNum += completeChunkNum;
+                task->SetProgress(static_cast<uint32_t>(
+                    kProgressRecoverChunkBegin +
+                    doneChunkNum * progressPerChunk));
+                task->UpdateMetric();
             }
             // 加入新的工作的chunk
             workingChunkNum++;
@@ -996,10 +1053,6 @@ int CloneCoreImpl::RecoverChunk(
                 return kErrCodeInternalError;
             }
         }
-        task->SetProgress(static_cast<uint32_t>(
-            kProgressRecoverChunkBegin + index * progressPerData));
-        task->UpdateMetric();
-        index++;
     }
 
     while (workingChunkNum > 0) {
@@ -1011,6 +1064,11 @@ int CloneCoreImpl::RecoverChunk(
             return kErrCodeInternalError;
         }
         workingChunkNum -= completeChunkNum;
+        chunkScheduler_->Release(task->GetTaskId(), completeChunkNum);
+        doneChunkNum += completeChunkNum;
+        task->SetProgress(static_cast<uint32_t>(
+            kProgressRecoverChunkBegin + doneChunkNum * progressPerChunk));
+        task->UpdateMetric();
     }
 
     task->GetCloneInfo().SetNextStep(CloneStep::kCompleteCloneFile);
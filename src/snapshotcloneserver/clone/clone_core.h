@@ -35,6 +35,7 @@
 #include "src/snapshotcloneserver/snapshot/snapshot_data_store.h"
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/snapshotcloneserver/clone/clone_reference.h"
+#include "src/snapshotcloneserver/clone/clone_chunk_scheduler.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
 #include "src/common/concurrent/name_lock.h"
 
@@ -239,7 +240,9 @@ class CloneCoreImpl : public CloneCore {
         recoverChunkConcurrency_(option.recoverChunkConcurrency),
         clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
         clientAsyncMethodRetryIntervalMs_(
-            option.clientAsyncMethodRetryIntervalMs) {}
+            option.clientAsyncMethodRetryIntervalMs),
+        chunkScheduler_(std::make_shared<CloneChunkScheduler>(
+            option.cloneChunkTotalConcurrency)) {}
 
     ~CloneCoreImpl() {
     }
@@ -411,7 +414,20 @@ class CloneCoreImpl : public CloneCore {
         std::shared_ptr<CreateCloneChunkContext> context);
 
     /**
-     * @brief 处理CreateCloneChunk的结果并重试
+     * @brief 申请一个chunk配额，全局配额用完时先处理本任务在途的请求，
+     *        本任务没有在途请求时排队等待
+     *
+     * @param task 任务信息
+     * @param tracker CreateCloneChunk任务追踪器
+     *
+     * @return 错误码
+     */
+    int AcquireCreateCloneChunkSlot(
+        std::shared_ptr<CloneTaskInfo> task,
+        std::shared_ptr<CreateCloneChunkTaskTracker> tracker);
+
+    /**
+     * @brief 处理CreateCloneChunk的结果并重试，完成的chunk归还配额
      *
      * @param task 任务信息
      * @param tracker CreateCloneChunk任务追踪器
@@ -601,6 +617,8 @@ class CloneCoreImpl : public CloneCore {
     uint64_t clientAsyncMethodRetryTimeSec_;
     // 调用client异步方法重试时间间隔
     uint64_t clientAsyncMethodRetryIntervalMs_;
+    // 所有任务共享的chunk配额
+    std::shared_ptr<CloneChunkScheduler> chunkScheduler_;
 };
 
 }  // namespace snapshotcloneserver
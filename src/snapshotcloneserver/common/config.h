@@ -71,6 +71,22 @@ struct SnapshotCloneServerOptions {
     uint32_t mdsSessionTimeUs;
     // ReadChunkSnapshot同时进行的异步请求数量
     uint32_t readChunkSnapshotConcurrency;
+    // 单个快照任务同时转储的chunk数量，0表示与snapshotCoreThreadNum相同
+    uint32_t snapshotTaskTransferConcurrency = 0;
+    // 构建快照索引时并发查询chunk版本号的数量，1表示串行查询
+    uint32_t buildChunkIndexConcurrency = 1;
+    // 上传转储分片的线程数，0表示与snapshotCoreThreadNum相同
+    uint32_t snapshotUploadThreadNum = 0;
+    // 所有转储任务在途分片buffer的总大小(MB)，0表示不限制
+    uint64_t snapshotTransferBufferMB = 0;
+    // 所有转储任务的上传带宽上限(MB/s)，0表示不限制
+    uint64_t snapshotTransferBandwidthMB = 0;
+    // 单个快照任务的上传带宽上限(MB/s)，0表示不限制
+    uint64_t snapshotTaskTransferBandwidthMB = 0;
+    // 是否跳过数据全零的chunk，不转储并从快照索引中去掉
+    bool snapshotSkipZeroChunk = false;
+    // 是否根据mds记录的segment写入版本跳过上个快照之后未写过的segment
+    bool snapshotSkipUnchangedSegment = false;
 
     // 用于Lazy克隆元数据部分的线程池线程数
     int stage1PoolThreadNum;
@@ -90,6 +106,8 @@ struct SnapshotCloneServerOptions {
     uint32_t createCloneChunkConcurrency;
     // RecoverChunk同时进行的异步请求数量
     uint32_t recoverChunkConcurrency;
+    // 所有克隆/恢复任务同时进行的chunk数量上限，在任务间平均分配，0表示不限制
+    uint32_t cloneChunkTotalConcurrency = 0;
     // 引用计数后台扫描每条记录间隔
     uint32_t backEndReferenceRecordScanIntervalMs;
     // 引用计数后台扫描每轮间隔
@@ -283,7 +283,8 @@ class SnapshotInfo {
         stripeUnit_(0),
         stripeCount_(0),
         time_(0),
-        status_(Status::pending) {}
+        status_(Status::pending),
+        fileId_(0) {}
 
     SnapshotInfo(UUID uuid,
             const std::string &user,
@@ -300,7 +301,8 @@ class SnapshotInfo {
         stripeUnit_(0),
         stripeCount_(0),
         time_(0),
-        status_(Status::pending) {}
+        status_(Status::pending),
+        fileId_(0) {}
     SnapshotInfo(UUID uuid,
             const std::string &user,
             const std::string &fileName,
@@ -326,7 +328,8 @@ class SnapshotInfo {
         stripeCount_(stripeCount),
         poolset_(poolset),
         time_(time),
-        status_(status) {}
+        status_(status),
+        fileId_(0) {}
 
     void SetUuid(const UUID &uuid) {
         uuid_ = uuid;
@@ -432,6 +435,14 @@ class SnapshotInfo {
         return status_;
     }
 
+    void SetFileId(uint64_t fileId) {
+        fileId_ = fileId;
+    }
+
+    uint64_t GetFileId() const {
+        return fileId_;
+    }
+
     bool SerializeToString(std::string *value) const;
 
     bool ParseFromString(const std::string &value);
@@ -463,6 +474,8 @@ class SnapshotInfo {
     uint64_t time_;
     // 快照处理的状态
     Status status_;
+    // 快照目标文件的inode id，0表示未知
+    uint64_t fileId_;
 };
 
 std::ostream& operator<<(std::ostream& os, const SnapshotInfo &snapshotInfo);
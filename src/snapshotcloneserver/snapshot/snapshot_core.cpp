@@ -44,6 +44,20 @@ int SnapshotCoreImpl::Init() {
         LOG(ERROR) << "SnapshotCoreImpl, thread start fail, ret = " << ret;
         return ret;
     }
+    ret = transferPipeline_->Start();
+    if (ret < 0) {
+        LOG(ERROR) << "SnapshotCoreImpl, transfer pipeline start fail"
+                   << ", ret = " << ret;
+        return ret;
+    }
+    if (buildChunkIndexConcurrency_ > 1) {
+        ret = chunkInfoPool_.Start(buildChunkIndexConcurrency_);
+        if (ret < 0) {
+            LOG(ERROR) << "SnapshotCoreImpl, chunk info thread start fail"
+                       << ", ret = " << ret;
+            return kErrCodeInternalError;
+        }
+    }
     return kErrCodeSuccess;
 }
 
@@ -195,6 +209,8 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             HandleCreateSnapshotSuccess(task);
             return;
         } else if (LIBCURVE_ERROR::OK == ret) {
+            info->SetFileId(snapInfo.parentid);
+            task->SetDirtyTrackingSeqNum(snapInfo.dirtyTrackingSeqNum);
             ChunkIndexDataName name(fileName, seqNum);
             // judge Is Exist indexData
             existIndexData = dataStore_->ChunkIndexDataExist(name);
@@ -285,6 +301,7 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
     task->SetProgress(kProgressBuildSnapshotMapComplete);
     task->UpdateMetric();
 
+    std::vector<ChunkIndexType> zeroChunks;
     if (existIndexData) {
         ret = TransferSnapshotData(indexData,
             *info,
@@ -292,7 +309,8 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             [this] (const ChunkDataName &chunkDataName) {
                 return dataStore_->ChunkDataExist(chunkDataName);
             },
-            task);
+            task,
+            &zeroChunks);
     } else {
         ret = TransferSnapshotData(indexData,
             *info,
@@ -300,7 +318,8 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             [&fileSnapshotMap] (const ChunkDataName &chunkDataName) {
                 return fileSnapshotMap.IsExistChunk(chunkDataName);
             },
-            task);
+            task,
+            &zeroChunks);
     }
     if (ret < 0) {
         LOG(ERROR) << "TransferSnapshotData error, "
@@ -317,6 +336,26 @@ void SnapshotCoreImpl::HandleCreateSnapshotTask(
             task, indexData, fileSnapshotMap);
     }
 
+    // 数据全零的chunk没有转储，从索引中去掉，克隆和恢复时不创建这些chunk，
+    // 必须在删除curvefs上的快照之前完成，以便任务重启后重新转储
+    if (!zeroChunks.empty()) {
+        for (auto chunkIndex : zeroChunks) {
+            indexData.EraseChunkDataName(chunkIndex);
+        }
+        ret = dataStore_->PutChunkIndexData(name, indexData);
+        if (ret < 0) {
+            LOG(ERROR) << "PutChunkIndexData without zero chunks error"
+                       << ", ret = " << ret
+                       << ", zeroChunkNum = " << zeroChunks.size()
+                       << ", uuid = " << task->GetUuid();
+            HandleCreateSnapshotError(task);
+            return;
+        }
+        LOG(INFO) << "Skip zero chunks of snapshot"
+                  << ", zeroChunkNum = " << zeroChunks.size()
+                  << ", uuid = " << task->GetUuid();
+    }
+
     ret = DeleteSnapshotOnCurvefs(*info);
     if (ret < 0) {
         LOG(ERROR) << "DeleteSnapshotOnCurvefs fail"
@@ -558,6 +597,8 @@ int SnapshotCoreImpl::CreateSnapshotOnCurvefs(
     info->SetStripeCount(snapInfo.stripeCount);
     info->SetPoolset(snapInfo.poolset);
     info->SetCreateTime(snapInfo.ctime);
+    info->SetFileId(snapInfo.parentid);
+    task->SetDirtyTrackingSeqNum(snapInfo.dirtyTrackingSeqNum);
 
     auto compareAndSet = [&](SnapshotInfo* snapinfo) {
         if (nullptr != snapinfo) {
@@ -655,6 +696,14 @@ int SnapshotCoreImpl::BuildChunkIndexData(
 
     indexData->SetFileName(fileName);
 
+    uint64_t prevSeqNum = 0;
+    ChunkIndexData prevIndexData;
+    if (skipUnchangedSegment_) {
+        GetPrevSnapshotIndex(info, task, &prevSeqNum, &prevIndexData);
+    }
+
+    uint64_t chunkPerSegment = segmentSize / chunkSize;
+    uint64_t unchangedSegmentNum = 0;
     uint64_t chunkIndex = 0;
     for (uint64_t i = 0; i < fileLength/segmentSize; i++) {
         uint64_t offset = i * segmentSize;
@@ -668,22 +717,28 @@ int SnapshotCoreImpl::BuildChunkIndexData(
 
         if (LIBCURVE_ERROR::OK == ret) {
             segInfos->emplace(i, segInfo);
+            // 上个快照之前写入版本的segment之后没有写过，chunk与上个快照相同，
+            // mds未记录版本的segment最后一次写在开始跟踪之前
+            if (prevSeqNum != 0 && segInfo.dirtySeqNum < prevSeqNum) {
+                for (uint64_t j = 0; j < chunkPerSegment; j++) {
+                    ChunkDataName chunkDataName;
+                    if (prevIndexData.GetChunkDataName(
+                            i * chunkPerSegment + j, &chunkDataName)) {
+                        indexData->PutChunkDataName(chunkDataName);
+                    }
+                }
+                unchangedSegmentNum++;
+                continue;
+            }
+            std::vector<ChunkInfoDetail> chunkInfos;
+            ret = GetSegmentChunkInfos(segInfo, task, &chunkInfos);
+            if (ret < 0) {
+                return kErrCodeInternalError;
+            }
             for (std::vector<uint64_t>::size_type j = 0;
-                j < segInfo.chunkvec.size();
+                j < chunkInfos.size();
                 j++) {
-                ChunkInfoDetail chunkInfo;
-                ChunkIDInfo cidInfo = segInfo.chunkvec[j];
-                ret = client_->GetChunkInfo(cidInfo,
-                    &chunkInfo);
-                if (ret != LIBCURVE_ERROR::OK) {
-                    LOG(ERROR) << "GetChunkInfo error, "
-                               << " ret = " << ret
-                               << ", logicalPoolId = " << cidInfo.lpid_
-                               << ", copysetId = " << cidInfo.cpid_
-                               << ", chunkId = " << cidInfo.cid_
-                               << ", uuid = " << task->GetUuid();
-                    return kErrCodeInternalError;
-                }
+                const ChunkInfoDetail &chunkInfo = chunkInfos[j];
                 // 2个sn，小的是snap sn，大的是快照之后的写
                 // 1个sn，有两种情况：
                 //    小于等于seqNum时为snap sn, 且快照之后未写过;
@@ -732,9 +787,117 @@ int SnapshotCoreImpl::BuildChunkIndexData(
         }
     }
 
+    if (prevSeqNum != 0) {
+        LOG(INFO) << "BuildChunkIndexData reuse index of snapshot"
+                  << ", prevSeqNum = " << prevSeqNum
+                  << ", unchangedSegmentNum = " << unchangedSegmentNum
+                  << ", uuid = " << task->GetUuid();
+    }
     return kErrCodeSuccess;
 }
 
+void SnapshotCoreImpl::GetPrevSnapshotIndex(
+    const SnapshotInfo &info,
+    std::shared_ptr<SnapshotTaskInfo> task,
+    uint64_t *prevSeqNum,
+    ChunkIndexData *prevIndexData) {
+    *prevSeqNum = 0;
+    // 跟踪开始之前的写没有记录，只有跟踪开始之后打的快照可以沿用
+    uint64_t trackingSeqNum = task->GetDirtyTrackingSeqNum();
+    if (0 == trackingSeqNum || 0 == info.GetFileId()) {
+        return;
+    }
+
+    std::vector<SnapshotInfo> snapVec;
+    metaStore_->GetSnapshotList(info.GetFileName(), &snapVec);
+    const SnapshotInfo *prev = nullptr;
+    for (const auto &snap : snapVec) {
+        // 同名文件可能被恢复或重新创建，inode id不同的快照不能沿用
+        if (snap.GetStatus() != Status::done ||
+            snap.GetFileId() != info.GetFileId() ||
+            snap.GetSeqNum() <= trackingSeqNum ||
+            snap.GetSeqNum() >= info.GetSeqNum() ||
+            snap.GetChunkSize() != info.GetChunkSize() ||
+            snap.GetSegmentSize() != info.GetSegmentSize()) {
+            continue;
+        }
+        if (nullptr == prev || snap.GetSeqNum() > prev->GetSeqNum()) {
+            prev = &snap;
+        }
+    }
+    if (nullptr == prev) {
+        return;
+    }
+
+    ChunkIndexDataName name(info.GetFileName(), prev->GetSeqNum());
+    int ret = dataStore_->GetChunkIndexData(name, prevIndexData);
+    if (ret < 0) {
+        LOG(WARNING) << "GetChunkIndexData of previous snapshot fail"
+                     << ", build index of all segments"
+                     << ", ret = " << ret
+                     << ", prevSeqNum = " << prev->GetSeqNum()
+                     << ", uuid = " << task->GetUuid();
+        return;
+    }
+    *prevSeqNum = prev->GetSeqNum();
+}
+
+int SnapshotCoreImpl::GetSegmentChunkInfos(
+    const SegmentInfo &segInfo,
+    std::shared_ptr<SnapshotTaskInfo> task,
+    std::vector<ChunkInfoDetail> *chunkInfos) {
+    if (buildChunkIndexConcurrency_ <= 1) {
+        for (const auto &cidInfo : segInfo.chunkvec) {
+            ChunkInfoDetail chunkInfo;
+            int ret = client_->GetChunkInfo(cidInfo, &chunkInfo);
+            if (ret != LIBCURVE_ERROR::OK) {
+                LOG(ERROR) << "GetChunkInfo error, "
+                           << " ret = " << ret
+                           << ", logicalPoolId = " << cidInfo.lpid_
+                           << ", copysetId = " << cidInfo.cpid_
+                           << ", chunkId = " << cidInfo.cid_
+                           << ", uuid = " << task->GetUuid();
+                return kErrCodeInternalError;
+            }
+            chunkInfos->emplace_back(std::move(chunkInfo));
+            if (task->IsCanceled()) {
+                break;
+            }
+        }
+        return kErrCodeSuccess;
+    }
+
+    // 各chunk的版本号互不依赖，并发查询，结果按chunk顺序写入
+    chunkInfos->resize(segInfo.chunkvec.size());
+    auto tracker = std::make_shared<TaskTracker>();
+    for (size_t j = 0; j < segInfo.chunkvec.size(); j++) {
+        if (tracker->GetTaskNum() >= buildChunkIndexConcurrency_) {
+            tracker->WaitSome(1);
+        }
+        if (tracker->GetResult() < 0) {
+            break;
+        }
+        ChunkIDInfo cidInfo = segInfo.chunkvec[j];
+        ChunkInfoDetail *chunkInfo = &(*chunkInfos)[j];
+        tracker->AddOneTrace();
+        chunkInfoPool_.Enqueue([this, tracker, task, cidInfo, chunkInfo] () {
+            int ret = client_->GetChunkInfo(cidInfo, chunkInfo);
+            if (ret != LIBCURVE_ERROR::OK) {
+                LOG(ERROR) << "GetChunkInfo error, "
+                           << " ret = " << ret
+                           << ", logicalPoolId = " << cidInfo.lpid_
+                           << ", copysetId = " << cidInfo.cpid_
+                           << ", chunkId = " << cidInfo.cid_
+                           << ", uuid = " << task->GetUuid();
+                ret = kErrCodeInternalError;
+            }
+            tracker->HandleResponse(ret);
+        });
+    }
+    tracker->Wait();
+    return tracker->GetResult();
+}
+
 int SnapshotCoreImpl::BuildSegmentInfo(
     const SnapshotInfo &info,
     std::map<uint64_t, SegmentInfo> *segInfos) {
@@ -779,7 +942,8 @@ int SnapshotCoreImpl::TransferSnapshotData(
     const SnapshotInfo &info,
     const std::map<uint64_t, SegmentInfo> &segInfos,
     const ChunkDataExistFilter &filter,
-    std::shared_ptr<SnapshotTaskInfo> task) {
+    std::shared_ptr<SnapshotTaskInfo> task,
+    std::vector<ChunkIndexType> *zeroChunks) {
     int ret = 0;
     uint64_t segmentSize = info.GetSegmentSize();
     uint64_t chunkSize = info.GetChunkSize();
@@ -827,6 +991,18 @@ int SnapshotCoreImpl::TransferSnapshotData(
         }
     }
 
+    // 快照任务的上传带宽限制，由该任务的所有chunk共享
+    std::shared_ptr<LeakyBucket> taskThrottle;
+    if (taskTransferBandwidth_ > 0) {
+        taskThrottle = std::make_shared<LeakyBucket>();
+        taskThrottle->SetLimit(taskTransferBandwidth_, 0, 0);
+    }
+
+    std::shared_ptr<ZeroChunkRecorder> zeroChunkRecorder;
+    if (skipZeroChunk_) {
+        zeroChunkRecorder = std::make_shared<ZeroChunkRecorder>();
+    }
+
     auto tracker = std::make_shared<TaskTracker>();
     for (auto &chunkIndex : chunkIndexVec) {
         ChunkDataName chunkDataName;
@@ -844,13 +1020,16 @@ int SnapshotCoreImpl::TransferSnapshotData(
                         chunkDataName, chunkSize, cidInfo, chunkSplitSize_,
                         clientAsyncMethodRetryTimeSec_,
                         clientAsyncMethodRetryIntervalMs_,
-                        readChunkSnapshotConcurrency_);
+                        readChunkSnapshotConcurrency_,
+                        taskThrottle,
+                        zeroChunkRecorder);
                 UUID taskId = UUIDGenerator().GenerateUUID();
                 auto task = new TransferSnapshotDataChunkTask(
                     taskId,
                     taskInfo,
                     client_,
-                    dataStore_);
+                    dataStore_,
+                    transferPipeline_);
                 task->SetTracker(tracker);
                 tracker->AddOneTrace();
                 threadPool_->PushTask(task);
@@ -859,7 +1038,7 @@ int SnapshotCoreImpl::TransferSnapshotData(
                            << chunkDataName.ToDataChunkKey();
             }
         }
-        if (tracker->GetTaskNum() >= snapshotCoreThreadNum_) {
+        if (tracker->GetTaskNum() >= taskTransferConcurrency_) {
             tracker->WaitSome(1);
         }
         ret = tracker->GetResult();
@@ -887,6 +1066,9 @@ int SnapshotCoreImpl::TransferSnapshotData(
                    << ", uuid = " << task->GetUuid();
         return ret;
     }
+    if (zeroChunkRecorder != nullptr) {
+        *zeroChunks = zeroChunkRecorder->GetAll();
+    }
 
     return kErrCodeSuccess;
 }
@@ -36,8 +36,11 @@
 #include "src/snapshotcloneserver/common/snapshot_reference.h"
 #include "src/common/concurrent/name_lock.h"
 #include "src/snapshotcloneserver/common/thread_pool.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+#include "src/common/bytes_convert.h"
 
 using ::curve::common::NameLock;
+using ::curve::common::kMiB;
 
 namespace curve {
 namespace snapshotcloneserver {
@@ -195,15 +198,36 @@ class SnapshotCoreImpl : public SnapshotCore {
       clientAsyncMethodRetryTimeSec_(option.clientAsyncMethodRetryTimeSec),
       clientAsyncMethodRetryIntervalMs_(
                 option.clientAsyncMethodRetryIntervalMs),
-      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency) {
+      readChunkSnapshotConcurrency_(option.readChunkSnapshotConcurrency),
+      taskTransferConcurrency_(option.snapshotTaskTransferConcurrency),
+      taskTransferBandwidth_(
+                option.snapshotTaskTransferBandwidthMB * kMiB),
+      skipZeroChunk_(option.snapshotSkipZeroChunk),
+      skipUnchangedSegment_(option.snapshotSkipUnchangedSegment),
+      buildChunkIndexConcurrency_(option.buildChunkIndexConcurrency) {
         threadPool_ = std::make_shared<ThreadPool>(
             option.snapshotCoreThreadNum);
+        if (0 == taskTransferConcurrency_ ||
+            taskTransferConcurrency_ > snapshotCoreThreadNum_) {
+            taskTransferConcurrency_ = snapshotCoreThreadNum_;
+        }
+        SnapshotTransferPipelineOption pipelineOption;
+        pipelineOption.uploadThreadNum = option.snapshotUploadThreadNum;
+        if (0 == pipelineOption.uploadThreadNum) {
+            pipelineOption.uploadThreadNum = option.snapshotCoreThreadNum;
+        }
+        pipelineOption.bufferBytes = option.snapshotTransferBufferMB * kMiB;
+        pipelineOption.bandwidth = option.snapshotTransferBandwidthMB * kMiB;
+        transferPipeline_ =
+            std::make_shared<SnapshotTransferPipeline>(pipelineOption);
     }
 
     int Init();
 
     ~SnapshotCoreImpl() {
         threadPool_->Stop();
+        transferPipeline_->Stop();
+        chunkInfoPool_.Stop();
     }
 
     // 公有接口定义见SnapshotCore接口注释
@@ -302,6 +326,37 @@ class SnapshotCoreImpl : public SnapshotCore {
         std::map<uint64_t, SegmentInfo> *segInfos,
         std::shared_ptr<SnapshotTaskInfo> task);
 
+    /**
+     * @brief 查找可以沿用索引的上一个快照，要求是同一个文件已完成的快照，
+     *        且打该快照之前mds已经在跟踪文件的segment写入版本
+     *
+     * @param info 快照信息
+     * @param task 快照任务信息
+     * @param[out] prevSeqNum 上一个快照的版本号，0表示没有可用的快照
+     * @param[out] prevIndexData 上一个快照的索引块
+     */
+    void GetPrevSnapshotIndex(
+        const SnapshotInfo &info,
+        std::shared_ptr<SnapshotTaskInfo> task,
+        uint64_t *prevSeqNum,
+        ChunkIndexData *prevIndexData);
+
+    /**
+     * @brief 获取segment中所有chunk的版本号，
+     *        buildChunkIndexConcurrency大于1时并发向chunkserver查询
+     *
+     * @param segInfo segment信息
+     * @param task 快照任务信息
+     * @param[out] chunkInfos chunk的版本号信息，与segInfo.chunkvec一一对应，
+     *             串行查询时任务被取消则只返回已查询的部分
+     *
+     * @return 错误码
+     */
+    int GetSegmentChunkInfos(
+        const SegmentInfo &segInfo,
+        std::shared_ptr<SnapshotTaskInfo> task,
+        std::vector<ChunkInfoDetail> *chunkInfos);
+
     using ChunkDataExistFilter =
         std::function<bool(const ChunkDataName &)>;
 
@@ -313,6 +368,7 @@ class SnapshotCoreImpl : public SnapshotCore {
      * @param segInfos Segment信息
      * @param filter 转储数据块过滤器
      * @param task 快照任务信息
+     * @param[out] zeroChunks 数据全零没有转储的chunk
      *
      * @return  错误码
      */
@@ -321,7 +377,8 @@ class SnapshotCoreImpl : public SnapshotCore {
         const SnapshotInfo &info,
         const std::map<uint64_t, SegmentInfo> &segInfos,
         const ChunkDataExistFilter &filter,
-        std::shared_ptr<SnapshotTaskInfo> task);
+        std::shared_ptr<SnapshotTaskInfo> task,
+        std::vector<ChunkIndexType> *zeroChunks);
 
     /**
      * @brief 开始cancel，更新任务状态，更新数据库状态
@@ -415,6 +472,10 @@ class SnapshotCoreImpl : public SnapshotCore {
 
     // 执行并发步骤的线程池
     std::shared_ptr<ThreadPool> threadPool_;
+    // 转储快照数据的流水线
+    std::shared_ptr<SnapshotTransferPipeline> transferPipeline_;
+    // 构建索引时并发查询chunk版本号的线程池
+    curve::common::TaskThreadPool<> chunkInfoPool_;
 
     // 锁住打快照的文件名，防止并发同时对其打快照，同一文件的快照需排队
     NameLock snapshotNameLock_;
@@ -435,6 +496,16 @@ class SnapshotCoreImpl : public SnapshotCore {
     uint64_t clientAsyncMethodRetryIntervalMs_;
     // 异步ReadChunkSnapshot的并发数
     uint32_t readChunkSnapshotConcurrency_;
+    // 单个快照任务同时转储的chunk数量
+    uint32_t taskTransferConcurrency_;
+    // 单个快照任务的上传带宽上限(bytes/s)，0表示不限制
+    uint64_t taskTransferBandwidth_;
+    // 是否跳过数据全零的chunk
+    bool skipZeroChunk_;
+    // 是否跳过上个快照之后未写过的segment
+    bool skipUnchangedSegment_;
+    // 构建索引时单个快照任务并发查询chunk版本号的数量
+    uint32_t buildChunkIndexConcurrency_;
 };
 
 }  // namespace snapshotcloneserver
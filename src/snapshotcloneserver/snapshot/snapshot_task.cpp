@@ -20,6 +20,8 @@
  * Author: xuchaojie
  */
 
+#include <string.h>
+
 #include <list>
 
 #include "src/common/timeutility.h"
@@ -28,6 +30,27 @@
 namespace curve {
 namespace snapshotcloneserver {
 
+namespace {
+
+bool IsZeroBuffer(const char *buf, uint64_t len) {
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf + i, sizeof(word));
+        if (word != 0) {
+            return false;
+        }
+    }
+    for (; i < len; i++) {
+        if (buf[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 void ReadChunkSnapshotClosure::Run() {
     std::unique_ptr<ReadChunkSnapshotClosure> self_guard(this);
     context_->retCode = GetRetCode();
@@ -40,7 +63,15 @@ void ReadChunkSnapshotClosure::Run() {
                      << ", chunkId = " << context_->cidInfo.cid_
                      << ", seqNum = " << context_->seqNum;
     }
-    tracker_->PushResultContext(context_);
+    if (context_->retCode >= 0 && handoff_) {
+        // 读取成功的分片直接交给上传阶段，不再经过转储线程
+        handoff_(context_);
+    } else {
+        // 等待重试的分片先归还buffer配额，重试时重新申请，
+        // 避免转储线程阻塞在申请配额时配额被失败的分片占满
+        context_->quota.reset();
+        tracker_->PushResultContext(context_);
+    }
     tracker_->HandleResponse(context_->retCode);
     return;
 }
@@ -51,11 +82,12 @@ void ReadChunkSnapshotClosure::Run() {
  *  由于单个chunk过大，chunk转储分片进行，分片大小为chunkSplitSize_，
  *  步骤如下：
  *  1. 创建一个转储任务transferTask，并调用DataChunkTranferInit初始化
- *  2. 调用ReadChunkSnapshot从curvefs读取chunk的一个分片
- *  3. 调用DataChunkTranferAddPart转储一个分片
+ *  2. 申请分片buffer配额，调用ReadChunkSnapshot从curvefs读取chunk的一个分片
+ *  3. 分片读取成功后交给上传线程池，调用DataChunkTranferAddPart转储该分片，
+ *     读取与上传流水进行
  *  4. 重复2、3直到所有分片转储完成，调用DataChunkTranferComplete结束转储任务
- *  5. 中间如有读取或转储发生错误，则调用DataChunkTranferAbort放弃转储，
- *  并返回错误码
+ *  5. 中间如有读取或转储发生错误，则等待在途的读取和上传结束后，
+ *  调用DataChunkTranferAbort放弃转储，并返回错误码
  *
  * @return 错误码
  */
@@ -80,6 +112,12 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
     }
 
     auto tracker = std::make_shared<ReadChunkSnapshotTaskTracker>();
+    auto uploadTracker = std::make_shared<TaskTracker>();
+    ReadChunkSnapshotHandoff handoff =
+        [this, uploadTracker, transferTask] (
+            const ReadChunkSnapshotContextPtr &context) {
+            PushUploadPart(uploadTracker, transferTask, context);
+        };
     for (uint64_t i = 0;
         i < chunkSize / chunkSplitSize;
         i++) {
@@ -87,52 +125,86 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
         context->cidInfo = taskInfo_->cidInfo_;
         context->seqNum = taskInfo_->name_.chunkSeqNum_;
         context->partIndex = i;
+        // 在途分片buffer达到上限时在此等待上传完成
+        context->quota = pipeline_->AcquireBuffer(chunkSplitSize);
         context->buf = std::unique_ptr<char[]>(new char[chunkSplitSize]);
         context->len = chunkSplitSize;
         context->startTime = TimeUtility::GetTimeofDaySec();
         context->clientAsyncMethodRetryTimeSec =
             taskInfo_->clientAsyncMethodRetryTimeSec_;
-        ret = StartAsyncReadChunkSnapshot(tracker, context);
+        ret = StartAsyncReadChunkSnapshot(tracker, context, handoff);
         if (ret < 0) {
             break;
         }
-        if (tracker->GetTaskNum() >= taskInfo_->readChunkSnapshotConcurrency_) {
-            tracker->WaitSome(1);
+        // 同时进行读取和上传的分片数量不超过readChunkSnapshotConcurrency_
+        if (tracker->GetTaskNum() + uploadTracker->GetTaskNum() >=
+            taskInfo_->readChunkSnapshotConcurrency_) {
+            if (tracker->GetTaskNum() > 0) {
+                tracker->WaitSome(1);
+            } else {
+                uploadTracker->WaitSome(1);
+            }
         }
         std::list<ReadChunkSnapshotContextPtr> results =
             tracker->PopResultContexts();
         ret = HandleReadChunkSnapshotResultsAndRetry(
-            tracker, transferTask, results);
+            tracker, handoff, results);
+        if (ret < 0) {
+            break;
+        }
+        ret = uploadTracker->GetResult();
         if (ret < 0) {
             break;
         }
     }
-    if (ret >= 0) {
-        do {
-            tracker->WaitSome(1);
-            std::list<ReadChunkSnapshotContextPtr> results =
-                tracker->PopResultContexts();
-            if (0 == results.size()) {
+    while (ret >= 0) {
+        // 先取在途数量再取结果，保证为0时所有结果都已返回
+        bool idle = (0 == tracker->GetTaskNum());
+        std::list<ReadChunkSnapshotContextPtr> results =
+            tracker->PopResultContexts();
+        if (0 == results.size()) {
+            if (idle) {
                 // 已经完成，没有新的结果了
                 break;
             }
-            ret = HandleReadChunkSnapshotResultsAndRetry(
-                tracker, transferTask, results);
-            if (ret < 0) {
-                break;
-            }
-        } while (true);
-        if (ret >= 0) {
-            ret =
-                dataStore_->DataChunkTranferComplete(name, transferTask);
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferComplete fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = " << name.ToDataChunkKey()
-                           << ", logicalPool = " << cidInfo.lpid_
-                           << ", copysetId = " << cidInfo.cpid_
-                           << ", chunkId = " << cidInfo.cid_;
-            }
+            tracker->WaitSome(1);
+            continue;
+        }
+        ret = HandleReadChunkSnapshotResultsAndRetry(
+            tracker, handoff, results);
+    }
+    // 等待在途的读取和上传结束，之后不会再访问本任务，
+    // ReadChunkSnapshot的回调总会被调用，即使返回失败
+    tracker->Wait();
+    uploadTracker->Wait();
+    if (ret >= 0) {
+        ret = uploadTracker->GetResult();
+    }
+    bool isZeroChunk = false;
+    if (ret >= 0) {
+        ret = UploadZeroParts(uploadTracker, transferTask, &isZeroChunk);
+    }
+    if (ret >= 0 && isZeroChunk) {
+        // chunk数据全零，不转储，克隆和恢复时不创建该chunk即可
+        taskInfo_->zeroChunks_->Add(name.chunkIndex_);
+        ret = dataStore_->DataChunkTranferAbort(name, transferTask);
+        if (ret < 0) {
+            LOG(WARNING) << "DataChunkTranferAbort fail for zero chunk"
+                         << ", ret = " << ret
+                         << ", chunkDataName = " << name.ToDataChunkKey();
+        }
+        return kErrCodeSuccess;
+    }
+    if (ret >= 0) {
+        ret =
+            dataStore_->DataChunkTranferComplete(name, transferTask);
+        if (ret < 0) {
+            LOG(ERROR) << "DataChunkTranferComplete fail"
+                       << ", ret = " << ret
+                       << ", chunkDataName = " << name.ToDataChunkKey()
+                       << ", logicalPool = " << cidInfo.lpid_
+                       << ", copysetId = " << cidInfo.cpid_
+                       << ", chunkId = " << cidInfo.cid_;
         }
     }
     if (ret < 0) {
@@ -155,9 +227,10 @@ int TransferSnapshotDataChunkTask::TransferSnapshotDataChunk() {
 
 int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-    std::shared_ptr<ReadChunkSnapshotContext> context) {
+    std::shared_ptr<ReadChunkSnapshotContext> context,
+    const ReadChunkSnapshotHandoff &handoff) {
     ReadChunkSnapshotClosure *cb =
-        new ReadChunkSnapshotClosure(tracker, context);
+        new ReadChunkSnapshotClosure(tracker, context, handoff);
     tracker->AddOneTrace();
     uint64_t offset = context->partIndex * context->len;
     LOG_EVERY_SECOND(INFO) << "Doing ReadChunkSnapshot"
@@ -188,7 +261,7 @@ int TransferSnapshotDataChunkTask::StartAsyncReadChunkSnapshot(
 
 int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-    std::shared_ptr<TransferTask> transferTask,
+    const ReadChunkSnapshotHandoff &handoff,
     const std::list<ReadChunkSnapshotContextPtr> &results) {
     int ret = kErrCodeSuccess;
     for (auto context : results) {
@@ -200,7 +273,8 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                 std::this_thread::sleep_for(
                     std::chrono::milliseconds(
                         taskInfo_->clientAsyncMethodRetryIntervalMs_));
-                ret = StartAsyncReadChunkSnapshot(tracker, context);
+                context->quota = pipeline_->AcquireBuffer(context->len);
+                ret = StartAsyncReadChunkSnapshot(tracker, context, handoff);
                 if (ret < 0) {
                     return ret;
                 }
@@ -211,24 +285,99 @@ int TransferSnapshotDataChunkTask::HandleReadChunkSnapshotResultsAndRetry(
                 return ret;
             }
         } else {
-            ret = dataStore_->DataChunkTranferAddPart(
-                taskInfo_->name_,
-                transferTask,
-                context->partIndex,
-                context->len,
-                context->buf.get());
-            if (ret < 0) {
-                LOG(ERROR) << "DataChunkTranferAddPart fail"
-                           << ", ret = " << ret
-                           << ", chunkDataName = "
-                           << taskInfo_->name_.ToDataChunkKey()
-                           << ", index = " << context->partIndex;
-                return ret;
-            }
+            handoff(context);
         }
     }
     return ret;
 }
 
+void TransferSnapshotDataChunkTask::PushUploadPart(
+    std::shared_ptr<TaskTracker> uploadTracker,
+    std::shared_ptr<TransferTask> transferTask,
+    ReadChunkSnapshotContextPtr context) {
+    pipeline_->OnReadDone(context->len);
+    uploadTracker->AddOneTrace();
+    pipeline_->PushUpload([this, uploadTracker, transferTask, context] () {
+        // 已有分片转储失败，剩余分片不再上传
+        int ret = uploadTracker->GetResult();
+        if (ret >= 0 && taskInfo_->zeroChunks_ != nullptr &&
+            IsZeroBuffer(context->buf.get(), context->len)) {
+            // 全零的分片先不上传，chunk读完后再决定
+            pipeline_->OnZeroPart(context->len);
+            std::lock_guard<Mutex> lk(zeroPartsMutex_);
+            zeroParts_.push_back(context->partIndex);
+        } else if (ret >= 0) {
+            ret = UploadPart(transferTask, context->partIndex,
+                context->len, context->buf.get());
+        }
+        context->buf.reset();
+        context->quota.reset();
+        uploadTracker->HandleResponse(ret);
+    });
+}
+
+int TransferSnapshotDataChunkTask::UploadPart(
+    std::shared_ptr<TransferTask> transferTask,
+    uint64_t partIndex,
+    uint64_t len,
+    const char *buf) {
+    pipeline_->ThrottleUpload(taskInfo_->taskThrottle_.get(), len);
+    uint64_t startUs = TimeUtility::GetTimeofDayUs();
+    int ret = dataStore_->DataChunkTranferAddPart(
+        taskInfo_->name_,
+        transferTask,
+        partIndex,
+        len,
+        buf);
+    if (ret < 0) {
+        LOG(ERROR) << "DataChunkTranferAddPart fail"
+                   << ", ret = " << ret
+                   << ", chunkDataName = "
+                   << taskInfo_->name_.ToDataChunkKey()
+                   << ", index = " << partIndex;
+        return ret;
+    }
+    pipeline_->OnUploadDone(len, TimeUtility::GetTimeofDayUs() - startUs);
+    return kErrCodeSuccess;
+}
+
+int TransferSnapshotDataChunkTask::UploadZeroParts(
+    std::shared_ptr<TaskTracker> uploadTracker,
+    std::shared_ptr<TransferTask> transferTask,
+    bool *isZeroChunk) {
+    uint64_t chunkSplitSize = taskInfo_->chunkSplitSize_;
+    std::vector<uint64_t> zeroParts;
+    {
+        std::lock_guard<Mutex> lk(zeroPartsMutex_);
+        zeroParts.swap(zeroParts_);
+    }
+    *isZeroChunk =
+        (zeroParts.size() == taskInfo_->chunkSize_ / chunkSplitSize);
+    if (*isZeroChunk || zeroParts.empty()) {
+        return kErrCodeSuccess;
+    }
+
+    // chunk中有数据，全零的分片也需要上传，共用一个全零的buffer，
+    // 等待上传完成后才释放
+    TransferBufferQuotaPtr quota = pipeline_->AcquireBuffer(chunkSplitSize);
+    std::unique_ptr<char[]> zeroBuf(new char[chunkSplitSize]());
+    const char *buf = zeroBuf.get();
+    for (auto partIndex : zeroParts) {
+        uploadTracker->AddOneTrace();
+        pipeline_->PushUpload(
+            [this, uploadTracker, transferTask, buf,
+             partIndex, chunkSplitSize] () {
+            int ret = uploadTracker->GetResult();
+            if (ret >= 0) {
+                ret = UploadPart(transferTask, partIndex,
+                    chunkSplitSize, buf);
+            }
+            uploadTracker->HandleResponse(ret);
+        });
+    }
+    uploadTracker->Wait();
+    return uploadTracker->GetResult();
+}
+
 }  // namespace snapshotcloneserver
 }  // namespace curve
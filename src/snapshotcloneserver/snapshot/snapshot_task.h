@@ -26,8 +26,11 @@
 #include <string>
 #include <memory>
 #include <list>
+#include <vector>
+#include <functional>
 
 #include "src/snapshotcloneserver/snapshot/snapshot_core.h"
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
 #include "src/common/snapshotclone/snapshotclone_define.h"
 #include "src/snapshotcloneserver/common/task.h"
 #include "src/snapshotcloneserver/common/task_info.h"
@@ -51,7 +54,8 @@ class SnapshotTaskInfo : public TaskInfo {
         std::shared_ptr<SnapshotInfoMetric> metric)
         : TaskInfo(),
           snapshotInfo_(snapInfo),
-          metric_(metric) {}
+          metric_(metric),
+          dirtyTrackingSeqNum_(0) {}
 
     /**
      * @brief 获取快照信息
@@ -84,11 +88,26 @@ class SnapshotTaskInfo : public TaskInfo {
         metric_->Update(this);
     }
 
+    void SetDirtyTrackingSeqNum(uint64_t seq) {
+        dirtyTrackingSeqNum_ = seq;
+    }
+
+    /**
+     * @brief 获取mds开始跟踪segment写入版本时文件的版本号
+     *
+     * @return 版本号，0表示文件未被跟踪
+     */
+    uint64_t GetDirtyTrackingSeqNum() const {
+        return dirtyTrackingSeqNum_;
+    }
+
  private:
     // 快照信息
     SnapshotInfo snapshotInfo_;
     // metric 信息
     std::shared_ptr<SnapshotInfoMetric> metric_;
+    // 打快照时文件的dirtyTrackingSeqNum，不持久化，任务重启后重新获取
+    uint64_t dirtyTrackingSeqNum_;
 };
 
 
@@ -182,6 +201,8 @@ struct ReadChunkSnapshotContext {
     uint64_t partIndex;
     // 分片的buffer
     std::unique_ptr<char[]> buf;
+    // 分片buffer的配额，与buf一同释放
+    TransferBufferQuotaPtr quota;
     // 分片长度
     uint64_t len;
     // 返回值
@@ -195,16 +216,42 @@ struct ReadChunkSnapshotContext {
 using ReadChunkSnapshotContextPtr = std::shared_ptr<ReadChunkSnapshotContext>;
 using ReadChunkSnapshotTaskTracker =
     ContextTaskTracker<ReadChunkSnapshotContextPtr>;
+// 读取成功的分片交给上传阶段
+using ReadChunkSnapshotHandoff =
+    std::function<void(const ReadChunkSnapshotContextPtr&)>;
 
 struct ReadChunkSnapshotClosure : public SnapCloneClosure {
     ReadChunkSnapshotClosure(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-        std::shared_ptr<ReadChunkSnapshotContext> context)
+        std::shared_ptr<ReadChunkSnapshotContext> context,
+        ReadChunkSnapshotHandoff handoff = nullptr)
         : tracker_(tracker),
-          context_(context) {}
+          context_(context),
+          handoff_(handoff) {}
     void Run() override;
     std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker_;
     std::shared_ptr<ReadChunkSnapshotContext> context_;
+    ReadChunkSnapshotHandoff handoff_;
+};
+
+/**
+ * @brief 记录数据全零的chunk，这些chunk不转储，并从快照索引中去掉
+ */
+class ZeroChunkRecorder {
+ public:
+    void Add(ChunkIndexType index) {
+        std::lock_guard<Mutex> lk(mtx_);
+        indexes_.push_back(index);
+    }
+
+    std::vector<ChunkIndexType> GetAll() {
+        std::lock_guard<Mutex> lk(mtx_);
+        return indexes_;
+    }
+
+ private:
+    Mutex mtx_;
+    std::vector<ChunkIndexType> indexes_;
 };
 
 struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
@@ -215,6 +262,10 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
     uint64_t clientAsyncMethodRetryTimeSec_;
     uint64_t clientAsyncMethodRetryIntervalMs_;
     uint32_t readChunkSnapshotConcurrency_;
+    // 快照任务的上传带宽限制，为空表示不限制
+    std::shared_ptr<LeakyBucket> taskThrottle_;
+    // 记录全零的chunk，为空表示全零的chunk也转储
+    std::shared_ptr<ZeroChunkRecorder> zeroChunks_;
 
     TransferSnapshotDataChunkTaskInfo(const ChunkDataName &name,
         uint64_t chunkSize,
@@ -222,14 +273,18 @@ struct TransferSnapshotDataChunkTaskInfo : public TaskInfo {
         uint64_t chunkSplitSize,
         uint64_t clientAsyncMethodRetryTimeSec,
         uint64_t clientAsyncMethodRetryIntervalMs,
-        uint32_t readChunkSnapshotConcurrency)
+        uint32_t readChunkSnapshotConcurrency,
+        std::shared_ptr<LeakyBucket> taskThrottle = nullptr,
+        std::shared_ptr<ZeroChunkRecorder> zeroChunks = nullptr)
         : name_(name),
           chunkSize_(chunkSize),
           cidInfo_(cidInfo),
           chunkSplitSize_(chunkSplitSize),
           clientAsyncMethodRetryTimeSec_(clientAsyncMethodRetryTimeSec),
           clientAsyncMethodRetryIntervalMs_(clientAsyncMethodRetryIntervalMs),
-          readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency) {}
+          readChunkSnapshotConcurrency_(readChunkSnapshotConcurrency),
+          taskThrottle_(taskThrottle),
+          zeroChunks_(zeroChunks) {}
 };
 
 class TransferSnapshotDataChunkTask : public TrackerTask {
@@ -237,11 +292,13 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
     TransferSnapshotDataChunkTask(const TaskIdType &taskId,
         std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo,
         std::shared_ptr<CurveFsClient> client,
-        std::shared_ptr<SnapshotDataStore> dataStore)
+        std::shared_ptr<SnapshotDataStore> dataStore,
+        std::shared_ptr<SnapshotTransferPipeline> pipeline)
         : TrackerTask(taskId),
           taskInfo_(taskInfo),
           client_(client),
-          dataStore_(dataStore) {}
+          dataStore_(dataStore),
+          pipeline_(pipeline) {}
 
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> GetTaskInfo() const {
         return taskInfo_;
@@ -266,31 +323,80 @@ class TransferSnapshotDataChunkTask : public TrackerTask {
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
      * @param context ReadSnapshotChunk上下文
+     * @param handoff 读取成功后将分片交给上传阶段
      *
      * @return 错误码
      */
     int StartAsyncReadChunkSnapshot(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-        std::shared_ptr<ReadChunkSnapshotContext> context);
+        std::shared_ptr<ReadChunkSnapshotContext> context,
+        const ReadChunkSnapshotHandoff &handoff);
 
     /**
      * @brief 处理ReadChunkSnapshot的结果并重试
      *
      * @param tracker 异步ReadSnapshotChunk追踪器
-     * @param transferTask 转储任务
+     * @param handoff 读取成功后将分片交给上传阶段
      * @param results ReadChunkSnapshot结果列表
      *
      * @return 错误码
      */
     int HandleReadChunkSnapshotResultsAndRetry(
         std::shared_ptr<ReadChunkSnapshotTaskTracker> tracker,
-        std::shared_ptr<TransferTask> transferTask,
+        const ReadChunkSnapshotHandoff &handoff,
         const std::list<ReadChunkSnapshotContextPtr> &results);
 
+    /**
+     * @brief 将读取成功的分片提交到上传线程池
+     *
+     * @param uploadTracker 上传任务追踪器
+     * @param transferTask 转储任务
+     * @param context ReadSnapshotChunk上下文
+     */
+    void PushUploadPart(
+        std::shared_ptr<TaskTracker> uploadTracker,
+        std::shared_ptr<TransferTask> transferTask,
+        ReadChunkSnapshotContextPtr context);
+
+    /**
+     * @brief 转储一个分片
+     *
+     * @param transferTask 转储任务
+     * @param partIndex 分片的索引
+     * @param len 分片长度
+     * @param buf 分片数据
+     *
+     * @return 错误码
+     */
+    int UploadPart(
+        std::shared_ptr<TransferTask> transferTask,
+        uint64_t partIndex,
+        uint64_t len,
+        const char *buf);
+
+    /**
+     * @brief 转储数据全零的分片，chunk数据全零时不转储
+     *
+     * @param uploadTracker 上传任务追踪器
+     * @param transferTask 转储任务
+     * @param[out] isZeroChunk chunk数据是否全零
+     *
+     * @return 错误码
+     */
+    int UploadZeroParts(
+        std::shared_ptr<TaskTracker> uploadTracker,
+        std::shared_ptr<TransferTask> transferTask,
+        bool *isZeroChunk);
+
  protected:
     std::shared_ptr<TransferSnapshotDataChunkTaskInfo> taskInfo_;
     std::shared_ptr<CurveFsClient> client_;
     std::shared_ptr<SnapshotDataStore> dataStore_;
+    std::shared_ptr<SnapshotTransferPipeline> pipeline_;
+
+    // 数据全零没有上传的分片
+    Mutex zeroPartsMutex_;
+    std::vector<uint64_t> zeroParts_;
 };
 
 
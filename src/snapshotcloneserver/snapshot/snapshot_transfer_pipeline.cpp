@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-18
+ */
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+
+#include <glog/logging.h>
+
+#include <utility>
+
+#include "src/common/snapshotclone/snapshotclone_define.h"
+
+using ::curve::common::UniqueLock;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TransferBufferQuota::~TransferBufferQuota() {
+    pipeline_->ReleaseBuffer(len_);
+}
+
+SnapshotTransferPipeline::SnapshotTransferPipeline(
+    const SnapshotTransferPipelineOption &option)
+    : option_(option),
+      inflightBytes_(0) {
+    if (option_.bandwidth > 0) {
+        throttle_.reset(new LeakyBucket());
+        throttle_->SetLimit(option_.bandwidth, 0, 0);
+    }
+}
+
+int SnapshotTransferPipeline::Start() {
+    int ret = uploadPool_.Start(option_.uploadThreadNum);
+    if (ret < 0) {
+        LOG(ERROR) << "SnapshotTransferPipeline, upload thread start fail"
+                   << ", ret = " << ret
+                   << ", uploadThreadNum = " << option_.uploadThreadNum;
+        return kErrCodeInternalError;
+    }
+    LOG(INFO) << "SnapshotTransferPipeline start"
+              << ", uploadThreadNum = " << option_.uploadThreadNum
+              << ", bufferBytes = " << option_.bufferBytes
+              << ", bandwidth = " << option_.bandwidth;
+    return kErrCodeSuccess;
+}
+
+void SnapshotTransferPipeline::Stop() {
+    if (throttle_ != nullptr) {
+        throttle_->Stop();
+    }
+    uploadPool_.Stop();
+}
+
+TransferBufferQuotaPtr SnapshotTransferPipeline::AcquireBuffer(
+    uint64_t len) {
+    UniqueLock lk(mtx_);
+    // 在途buffer为0时总是放行，避免单个分片超过上限时永远等待
+    cond_.wait(lk, [this, len]() {
+        uint64_t inflight = inflightBytes_.load(std::memory_order_relaxed);
+        return option_.bufferBytes == 0 || inflight == 0 ||
+            inflight + len <= option_.bufferBytes;
+    });
+    inflightBytes_.fetch_add(len, std::memory_order_relaxed);
+    metric_.inflightBytes << static_cast<int64_t>(len);
+    return TransferBufferQuotaPtr(new TransferBufferQuota(this, len));
+}
+
+void SnapshotTransferPipeline::ReleaseBuffer(uint64_t len) {
+    {
+        UniqueLock lk(mtx_);
+        inflightBytes_.fetch_sub(len, std::memory_order_relaxed);
+    }
+    metric_.inflightBytes << -static_cast<int64_t>(len);
+    cond_.notify_all();
+}
+
+void SnapshotTransferPipeline::PushUpload(std::function<void()> task) {
+    metric_.uploadQueueing << 1;
+    uploadPool_.Enqueue([this, task]() {
+        metric_.uploadQueueing << -1;
+        task();
+    });
+}
+
+void SnapshotTransferPipeline::ThrottleUpload(LeakyBucket *taskThrottle,
+                                              uint64_t len) {
+    if (taskThrottle != nullptr) {
+        taskThrottle->Add(len);
+    }
+    if (throttle_ != nullptr) {
+        throttle_->Add(len);
+    }
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -0,0 +1,199 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-18
+ */
+
+#ifndef SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+#define SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
+
+#include <bvar/bvar.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "src/common/concurrent/concurrent.h"
+#include "src/common/concurrent/task_thread_pool.h"
+#include "src/common/leaky_bucket.h"
+
+using ::curve::common::LeakyBucket;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+struct SnapshotTransferPipelineOption {
+    // 上传分片的线程数
+    uint32_t uploadThreadNum;
+    // 所有转储任务在途分片buffer的总大小(bytes)，0表示不限制
+    uint64_t bufferBytes;
+    // 所有转储任务的上传带宽上限(bytes/s)，0表示不限制
+    uint64_t bandwidth;
+};
+
+struct SnapshotTransferMetric {
+    const std::string TransferMetricPrefix =
+        "snapshotcloneserver_transfer_metric_";
+
+    // 从chunkserver读取的快照数据量
+    bvar::Adder<uint64_t> readBytes;
+    bvar::PerSecond<bvar::Adder<uint64_t>> readBps;
+    // 全零不需要上传的快照数据量
+    bvar::Adder<uint64_t> zeroBytes;
+    // 上传到s3的快照数据量
+    bvar::Adder<uint64_t> uploadBytes;
+    bvar::PerSecond<bvar::Adder<uint64_t>> uploadBps;
+    // 上传单个分片的延时
+    bvar::LatencyRecorder uploadLatency;
+    // 等待上传的分片数量
+    bvar::Adder<int64_t> uploadQueueing;
+    // 在途分片buffer的大小
+    bvar::Adder<int64_t> inflightBytes;
+
+    SnapshotTransferMetric() :
+        readBytes(TransferMetricPrefix, "read_bytes"),
+        readBps(TransferMetricPrefix, "read_bps", &readBytes, 1),
+        zeroBytes(TransferMetricPrefix, "zero_bytes"),
+        uploadBytes(TransferMetricPrefix, "upload_bytes"),
+        uploadBps(TransferMetricPrefix, "upload_bps", &uploadBytes, 1),
+        uploadLatency(TransferMetricPrefix, "upload"),
+        uploadQueueing(TransferMetricPrefix, "upload_queueing"),
+        inflightBytes(TransferMetricPrefix, "inflight_bytes") {}
+};
+
+class SnapshotTransferPipeline;
+
+/**
+ * @brief 在途分片buffer的配额，析构时归还给流水线
+ */
+class TransferBufferQuota {
+ public:
+    TransferBufferQuota(SnapshotTransferPipeline *pipeline, uint64_t len)
+        : pipeline_(pipeline), len_(len) {}
+
+    ~TransferBufferQuota();
+
+    TransferBufferQuota(const TransferBufferQuota&) = delete;
+    TransferBufferQuota& operator=(const TransferBufferQuota&) = delete;
+
+ private:
+    SnapshotTransferPipeline *pipeline_;
+    uint64_t len_;
+};
+
+using TransferBufferQuotaPtr = std::unique_ptr<TransferBufferQuota>;
+
+/**
+ * @brief 快照数据转储流水线
+ * @detail
+ *  转储分为读取和上传两个阶段：
+ *  1. 转储线程为每个分片申请buffer配额后异步ReadChunkSnapshot，
+ *     在途分片buffer达到上限时阻塞，使读取速度受限于上传速度
+ *  2. 分片读取成功后，buffer直接交给上传线程池做multipart上传，不做拷贝，
+ *     上传完成后归还buffer配额
+ *  所有快照任务共享上传线程池、buffer配额和全局带宽限制，
+ *  单个快照任务的带宽限制由任务自己的LeakyBucket实现
+ */
+class SnapshotTransferPipeline {
+ public:
+    explicit SnapshotTransferPipeline(
+        const SnapshotTransferPipelineOption &option);
+
+    ~SnapshotTransferPipeline() {
+        Stop();
+    }
+
+    /**
+     * @brief 启动上传线程池
+     *
+     * @return 错误码
+     */
+    int Start();
+
+    /**
+     * @brief 停止上传线程池
+     */
+    void Stop();
+
+    /**
+     * @brief 申请一个分片的buffer配额，在途buffer达到上限时阻塞
+     *
+     * @param len 分片大小
+     *
+     * @return buffer配额
+     */
+    TransferBufferQuotaPtr AcquireBuffer(uint64_t len);
+
+    /**
+     * @brief 提交上传任务
+     *
+     * @param task 上传任务
+     */
+    void PushUpload(std::function<void()> task);
+
+    /**
+     * @brief 上传前做带宽限制，依次经过任务和全局的限制
+     *
+     * @param taskThrottle 快照任务的带宽限制，为空表示不限制
+     * @param len 上传数据量
+     */
+    void ThrottleUpload(LeakyBucket *taskThrottle, uint64_t len);
+
+    void OnReadDone(uint64_t len) {
+        metric_.readBytes << len;
+    }
+
+    void OnZeroPart(uint64_t len) {
+        metric_.zeroBytes << len;
+    }
+
+    void OnUploadDone(uint64_t len, uint64_t latencyUs) {
+        metric_.uploadBytes << len;
+        metric_.uploadLatency << latencyUs;
+    }
+
+    uint64_t GetInflightBytes() const {
+        return inflightBytes_.load(std::memory_order_relaxed);
+    }
+
+ private:
+    friend class TransferBufferQuota;
+
+    void ReleaseBuffer(uint64_t len);
+
+ private:
+    SnapshotTransferPipelineOption option_;
+    // 上传线程池
+    curve::common::TaskThreadPool<> uploadPool_;
+
+    curve::common::Mutex mtx_;
+    curve::common::ConditionVariable cond_;
+    // 在途分片buffer的大小
+    std::atomic<uint64_t> inflightBytes_;
+
+    // 全局带宽限制
+    std::unique_ptr<LeakyBucket> throttle_;
+
+    SnapshotTransferMetric metric_;
+};
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
+
+#endif  // SRC_SNAPSHOTCLONESERVER_SNAPSHOT_SNAPSHOT_TRANSFER_PIPELINE_H_
@@ -81,6 +81,23 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                                         &serverOption->mdsSessionTimeUs);
     conf->GetValueFatalIfFail("server.readChunkSnapshotConcurrency",
             &serverOption->readChunkSnapshotConcurrency);
+    // 转储流水线的配置缺省时使用默认值，兼容旧的配置文件
+    conf->GetUInt32Value("server.snapshotTaskTransferConcurrency",
+            &serverOption->snapshotTaskTransferConcurrency);
+    conf->GetUInt32Value("server.buildChunkIndexConcurrency",
+            &serverOption->buildChunkIndexConcurrency);
+    conf->GetUInt32Value("server.snapshotUploadThreadNum",
+            &serverOption->snapshotUploadThreadNum);
+    conf->GetUInt64Value("server.snapshotTransferBufferMB",
+            &serverOption->snapshotTransferBufferMB);
+    conf->GetUInt64Value("server.snapshotTransferBandwidthMB",
+            &serverOption->snapshotTransferBandwidthMB);
+    conf->GetUInt64Value("server.snapshotTaskTransferBandwidthMB",
+            &serverOption->snapshotTaskTransferBandwidthMB);
+    conf->GetBoolValue("server.snapshotSkipZeroChunk",
+            &serverOption->snapshotSkipZeroChunk);
+    conf->GetBoolValue("server.snapshotSkipUnchangedSegment",
+            &serverOption->snapshotSkipUnchangedSegment);
 
     conf->GetValueFatalIfFail("server.stage1PoolThreadNum",
                                      &serverOption->stage1PoolThreadNum);
@@ -102,6 +119,8 @@ void InitSnapshotCloneServerOptions(std::shared_ptr<Configuration> conf,
                             &serverOption->createCloneChunkConcurrency);
     conf->GetValueFatalIfFail("server.recoverChunkConcurrency",
                             &serverOption->recoverChunkConcurrency);
+    conf->GetUInt32Value("server.cloneChunkTotalConcurrency",
+                         &serverOption->cloneChunkTotalConcurrency);
     conf->GetValueFatalIfFail("server.backEndReferenceRecordScanIntervalMs",
                         &serverOption->backEndReferenceRecordScanIntervalMs);
     conf->GetValueFatalIfFail("server.backEndReferenceFuncScanIntervalMs",
@@ -26,6 +26,7 @@
 #include <brpc/server.h>
 #include <gtest/gtest.h>
 #include <butil/endpoint.h>
+#include <vector>
 #include "src/chunkserver/heartbeat_helper.h"
 #include "src/chunkserver/chunkserver_service.h"
 #include "test/chunkserver/mock_copyset_node.h"
@@ -208,6 +209,108 @@ TEST(HeartbeatHelperTest, test_ChunkServerLoadCopySetFin) {
     delete copysetNodeManager;
 }
 
+namespace {
+void AddTrackerCopyset(ChunkServerHeartbeatRequest *request, uint32_t copysetId,
+                uint64_t epoch) {
+    auto *info = request->add_copysetinfos();
+    info->set_logicalpoolid(1);
+    info->set_copysetid(copysetId);
+    info->set_epoch(epoch);
+    info->mutable_leaderpeer()->set_address("127.0.0.1:8200:0");
+}
+
+ChunkServerHeartbeatRequest BuildTrackerRequest(const std::vector<uint64_t> &epochs) {
+    ChunkServerHeartbeatRequest request;
+    for (size_t i = 0; i < epochs.size(); i++) {
+        AddTrackerCopyset(&request, i + 1, epochs[i]);
+    }
+    return request;
+}
+}  // namespace
+
+TEST(HeartbeatHelperTest, test_CopysetHeartbeatTracker) {
+    // 1. 未开启增量心跳, 总是全量
+    {
+        CopysetHeartbeatTracker tracker(0);
+        for (int i = 0; i < 3; i++) {
+            auto request = BuildTrackerRequest({1, 1, 1});
+            tracker.Encode(&request);
+            ASSERT_FALSE(request.incremental());
+            ASSERT_EQ(3, request.copysetinfos_size());
+            tracker.Ack(false);
+        }
+    }
+
+    // 2. 开启增量心跳
+    {
+        CopysetHeartbeatTracker tracker(4);
+        // 第一次心跳为全量
+        auto request = BuildTrackerRequest({1, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_FALSE(request.incremental());
+        ASSERT_EQ(3, request.copysetinfos_size());
+
+        // 心跳未被确认, 仍然为全量
+        request = BuildTrackerRequest({1, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_FALSE(request.incremental());
+        tracker.Ack(false);
+
+        // 没有变化
+        request = BuildTrackerRequest({1, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_TRUE(request.incremental());
+        ASSERT_EQ(0, request.copysetinfos_size());
+        tracker.Ack(false);
+
+        // copyset 2 epoch变化, copyset 4新增
+        request = BuildTrackerRequest({1, 2, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_TRUE(request.incremental());
+        ASSERT_EQ(2, request.copysetinfos_size());
+        ASSERT_EQ(2, request.copysetinfos(0).copysetid());
+        ASSERT_EQ(4, request.copysetinfos(1).copysetid());
+        tracker.Ack(false);
+
+        // 正在配置变更的copyset总是上报
+        request = BuildTrackerRequest({1, 2, 1, 1});
+        auto *conf =
+            request.mutable_copysetinfos(2)->mutable_configchangeinfo();
+        conf->mutable_peer()->set_address("127.0.0.1:8201:0");
+        conf->set_type(::curve::mds::heartbeat::ADD_PEER);
+        conf->set_finished(false);
+        tracker.Encode(&request);
+        ASSERT_TRUE(request.incremental());
+        ASSERT_EQ(1, request.copysetinfos_size());
+        ASSERT_EQ(3, request.copysetinfos(0).copysetid());
+        tracker.Ack(false);
+
+        // 达到全量心跳间隔
+        request = BuildTrackerRequest({1, 2, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_FALSE(request.incremental());
+        ASSERT_EQ(4, request.copysetinfos_size());
+        tracker.Ack(false);
+
+        // mds要求全量心跳
+        request = BuildTrackerRequest({1, 2, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_TRUE(request.incremental());
+        tracker.Ack(true);
+        request = BuildTrackerRequest({1, 2, 1, 1});
+        tracker.Encode(&request);
+        ASSERT_FALSE(request.incremental());
+        tracker.Ack(false);
+
+        // copyset被删除
+        request = BuildTrackerRequest({1, 2, 1});
+        tracker.Encode(&request);
+        ASSERT_FALSE(request.incremental());
+        ASSERT_EQ(3, request.copysetinfos_size());
+        tracker.Ack(false);
+    }
+}
+
 }  // namespace chunkserver
 }  // namespace curve
 
@@ -22,12 +22,14 @@
 
 #include "src/client/mds_client.h"
 
+#include <brpc/errno.pb.h>
 #include <brpc/server.h>
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include <string>
+#include <vector>
 
 #include "test/client/mock/mock_namespace_service.h"
 #include "test/client/mock/mock_topology_service.h"
@@ -40,6 +42,7 @@ using ::testing::_;
 using ::testing::DoAll;
 using ::testing::Invoke;
 using ::testing::Return;
+using ::testing::SaveArgPointee;
 using ::testing::SetArgPointee;
 
 constexpr uint64_t kGiB = 1024ull * 1024 * 1024;
@@ -824,5 +827,108 @@ TEST_F(MDSClientTest, TestRecoverFile) {
     }
 }
 
+TEST_F(MDSClientTest, TestGetOrAllocateSegments) {
+    FInfo_t fileInfo;
+    fileInfo.fullPathName = "/TestGetOrAllocateSegments";
+    fileInfo.segmentsize = 1 * kGiB;
+    fileInfo.chunksize = 16 * 1024 * 1024;
+    FileEpoch_t fEpoch;
+    std::vector<uint64_t> offsets{1 * kGiB, 2 * kGiB};
+    std::vector<SegmentInfo> segInfos;
+
+    // empty offsets
+    ASSERT_EQ(LIBCURVE_ERROR::OK,
+              mdsClient_.GetOrAllocateSegments(true, {}, &fileInfo, &fEpoch,
+                                               &segInfos));
+
+    // rpc always failed
+    {
+        EXPECT_CALL(mockNameService_, GetOrAllocateSegments(_, _, _, _))
+            .WillRepeatedly(Invoke(FakeRpcService<true>{}));
+
+        ASSERT_EQ(LIBCURVE_ERROR::FAILED,
+                  mdsClient_.GetOrAllocateSegments(true, offsets, &fileInfo,
+                                                   &fEpoch, &segInfos));
+    }
+
+    // rpc response failed
+    {
+        curve::mds::GetOrAllocateSegmentsResponse response;
+        response.set_statuscode(curve::mds::StatusCode::kEpochTooOld);
+
+        EXPECT_CALL(mockNameService_, GetOrAllocateSegments(_, _, _, _))
+            .WillOnce(DoAll(SetArgPointee<2>(response),
+                            Invoke(FakeRpcService<false>{})));
+
+        ASSERT_EQ(LIBCURVE_ERROR::EPOCH_TOO_OLD,
+                  mdsClient_.GetOrAllocateSegments(true, offsets, &fileInfo,
+                                                   &fEpoch, &segInfos));
+    }
+
+    // allocate success
+    {
+        curve::mds::GetOrAllocateSegmentsResponse response;
+        response.set_statuscode(curve::mds::StatusCode::kOK);
+        for (const auto& offset : offsets) {
+            auto* segment = response.add_pagefilesegments();
+            segment->set_logicalpoolid(1);
+            segment->set_segmentsize(fileInfo.segmentsize);
+            segment->set_chunksize(fileInfo.chunksize);
+            segment->set_startoffset(offset);
+            for (uint64_t i = 0; i < fileInfo.segmentsize / fileInfo.chunksize;
+                 ++i) {
+                auto* chunk = segment->add_chunks();
+                chunk->set_chunkid(offset / fileInfo.chunksize + i);
+                chunk->set_copysetid(i);
+            }
+        }
+
+        curve::mds::GetOrAllocateSegmentsRequest request;
+        EXPECT_CALL(mockNameService_, GetOrAllocateSegments(_, _, _, _))
+            .WillOnce(DoAll(SaveArgPointee<1>(&request),
+                            SetArgPointee<2>(response),
+                            Invoke(FakeRpcService<false>{})));
+
+        ASSERT_EQ(LIBCURVE_ERROR::OK,
+                  mdsClient_.GetOrAllocateSegments(true, offsets, &fileInfo,
+                                                   &fEpoch, &segInfos));
+        ASSERT_EQ(2, request.offsets_size());
+        ASSERT_EQ(1 * kGiB, request.offsets(0));
+        ASSERT_EQ(2 * kGiB, request.offsets(1));
+        ASSERT_TRUE(request.allocateifnotexist());
+
+        ASSERT_EQ(2, segInfos.size());
+        for (size_t i = 0; i < segInfos.size(); ++i) {
+            ASSERT_EQ(offsets[i], segInfos[i].startoffset);
+            ASSERT_EQ(1, segInfos[i].lpcpIDInfo.lpid);
+            ASSERT_EQ(64, segInfos[i].chunkvec.size());
+        }
+    }
+
+    // mds without the batch rpc, no retry and no more rpc after that
+    {
+        EXPECT_CALL(mockNameService_, GetOrAllocateSegments(_, _, _, _))
+            .WillOnce(Invoke([](google::protobuf::RpcController* cntl_base,
+                                const curve::mds::GetOrAllocateSegmentsRequest*,
+                                curve::mds::GetOrAllocateSegmentsResponse*,
+                                google::protobuf::Closure* done) {
+                static_cast<brpc::Controller*>(cntl_base)->SetFailed(
+                    brpc::ENOMETHOD, "Fail to find method");
+                done->Run();
+            }));
+
+        auto startMs = TimeUtility::GetTimeofDayMs();
+        ASSERT_EQ(LIBCURVE_ERROR::NOT_SUPPORT,
+                  mdsClient_.GetOrAllocateSegments(true, offsets, &fileInfo,
+                                                   &fEpoch, &segInfos));
+        auto endMs = TimeUtility::GetTimeofDayMs();
+        ASSERT_GT(option_.mdsMaxRetryMS, endMs - startMs);
+
+        ASSERT_EQ(LIBCURVE_ERROR::NOT_SUPPORT,
+                  mdsClient_.GetOrAllocateSegments(true, offsets, &fileInfo,
+                                                   &fEpoch, &segInfos));
+    }
+}
+
 }  // namespace client
 }  // namespace curve
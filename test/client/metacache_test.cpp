@@ -24,13 +24,27 @@
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+#include <thread>  // NOLINT
 #include <tuple>
 #include <vector>
 
+#include "test/client/mock/mock_mdsclient.h"
+
 namespace curve {
 namespace client {
 
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::ElementsAre;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+
 class MetaCacheTest : public ::testing::Test {
  public:
     void SetUp() override {}
@@ -161,5 +175,296 @@ TEST(MetaCacheCommonTest, TestAddCopysetsInfo) {
     }
 }
 
+TEST(MetaCacheSegmentPrefetchTest, TestSequentialAllocate) {
+    MetaCacheOption option;
+    option.segmentPrefetchNum = 4;
+
+    MetaCache metaCache;
+    metaCache.Init(option, nullptr);
+
+    // no segment allocated yet
+    ASSERT_EQ(0, metaCache.GetSegmentPrefetchNum(0));
+    ASSERT_EQ(0, metaCache.GetSegmentPrefetchNum(1));
+
+    metaCache.UpdateLastAllocatedSegment(0);
+    ASSERT_EQ(4, metaCache.GetSegmentPrefetchNum(1));
+    ASSERT_EQ(0, metaCache.GetSegmentPrefetchNum(2));
+    ASSERT_EQ(0, metaCache.GetSegmentPrefetchNum(0));
+
+    // random allocate
+    metaCache.UpdateLastAllocatedSegment(10);
+    ASSERT_EQ(0, metaCache.GetSegmentPrefetchNum(1));
+    ASSERT_EQ(4, metaCache.GetSegmentPrefetchNum(11));
+
+    // disabled
+    MetaCache disabled;
+    disabled.Init(MetaCacheOption(), nullptr);
+    disabled.UpdateLastAllocatedSegment(0);
+    ASSERT_EQ(0, disabled.GetSegmentPrefetchNum(1));
+}
+
+class MetaCachePersistTest : public ::testing::Test {
+ public:
+    void SetUp() override {
+        ::mkdir(kPersistDir, 0755);
+        std::remove(kPersistPath);
+
+        option_.persistDir = kPersistDir;
+        fileInfo_.id = 100;
+        fileInfo_.ctime = 12345;
+        fileInfo_.fullPathName = "/MetaCachePersistTest";
+        fileInfo_.length = 10 * GiB;
+        fileInfo_.segmentsize = 1 * GiB;
+        fileInfo_.chunksize = 16 * MiB;
+        fEpoch_.fileId = fileInfo_.id;
+        fEpoch_.epoch = 1;
+    }
+
+    void TearDown() override {
+        std::remove(kPersistPath);
+        ::rmdir(kPersistDir);
+    }
+
+ protected:
+    void InitMetaCache(MetaCache* metaCache) {
+        metaCache->Init(option_, nullptr);
+        metaCache->UpdateFileInfo(fileInfo_);
+        metaCache->UpdateFileEpoch(fEpoch_);
+    }
+
+    void FillMetaCache(MetaCache* metaCache) {
+        std::vector<CopysetPeerInfo<ChunkServerID>> peers;
+        PeerAddr addr;
+        for (int i = 1; i <= 3; ++i) {
+            ASSERT_EQ(0, addr.Parse("127.0.0.1:820" + std::to_string(i) +
+                                    ":0"));
+            peers.emplace_back(i, addr, addr);
+        }
+
+        std::vector<CopysetInfo<ChunkServerID>> copysets;
+        for (int i = 1; i <= 2; ++i) {
+            CopysetInfo<ChunkServerID> info;
+            info.lpid_ = 1;
+            info.cpid_ = i;
+            info.leaderindex_ = i;
+            info.csinfos_ = peers;
+            copysets.emplace_back(info);
+        }
+        metaCache->AddCopysetsInfo(1, std::move(copysets));
+
+        metaCache->UpdateChunkInfoByIndex(0, ChunkIDInfo(1000, 1, 1));
+        metaCache->UpdateChunkInfoByIndex(1, ChunkIDInfo(1001, 1, 2));
+    }
+
+ protected:
+    const char* kPersistDir = "./metacache_persist_test";
+    const char* kPersistPath = "./metacache_persist_test/100";
+    MetaCacheOption option_;
+    FInfo fileInfo_;
+    FileEpoch fEpoch_;
+};
+
+TEST_F(MetaCachePersistTest, TestPersistAndLoad) {
+    {
+        MetaCache metaCache;
+        InitMetaCache(&metaCache);
+        FillMetaCache(&metaCache);
+        ASSERT_EQ(0, metaCache.Persist());
+    }
+
+    MetaCache metaCache;
+    InitMetaCache(&metaCache);
+    ASSERT_TRUE(metaCache.LoadPersisted());
+
+    // segments are not complete, and can't be validated without mds
+    ChunkIDInfo info;
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache.GetChunkInfoByIndex(0, &info));
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache.GetChunkInfoByIndex(1, &info));
+
+    for (int i = 1; i <= 2; ++i) {
+        auto copyset = metaCache.GetCopysetinfo(1, i);
+        ASSERT_EQ(3, copyset.csinfos_.size());
+        ASSERT_EQ(i, copyset.leaderindex_);
+        ASSERT_EQ("127.0.0.1:8203:0",
+                  copyset.csinfos_[2].internalAddr.ToString());
+    }
+
+    // persisted file is used only once
+    MetaCache again;
+    InitMetaCache(&again);
+    ASSERT_FALSE(again.LoadPersisted());
+}
+
+TEST_F(MetaCachePersistTest, TestPersistedSegmentsValidated) {
+    const uint64_t chunksPerSegment = fileInfo_.segmentsize /
+                                      fileInfo_.chunksize;
+    {
+        MetaCache metaCache;
+        InitMetaCache(&metaCache);
+        FillMetaCache(&metaCache);
+        for (uint64_t i = 0; i < 3 * chunksPerSegment; ++i) {
+            metaCache.UpdateChunkInfoByIndex(
+                i, ChunkIDInfo(1000 + i, 1, 1 + i % 2));
+        }
+        // not allocated segment is not persisted
+        ChunkIDInfo notExist(0, 0, 0);
+        notExist.chunkExist = false;
+        metaCache.UpdateChunkInfoByIndex(3 * chunksPerSegment, notExist);
+        ASSERT_EQ(0, metaCache.Persist());
+    }
+
+    // segment 0 is unchanged, segment 1 is reallocated with other chunks
+    // and segment 2 is deallocated
+    std::vector<SegmentInfo> segments(2);
+    for (uint64_t s = 0; s < 2; ++s) {
+        segments[s].startoffset = s * fileInfo_.segmentsize;
+        segments[s].lpcpIDInfo.lpid = 1;
+        for (uint64_t i = 0; i < chunksPerSegment; ++i) {
+            uint64_t index = s * chunksPerSegment + i;
+            segments[s].chunkvec.emplace_back(1000 + index + s * 10000, 1,
+                                              1 + index % 2);
+            segments[s].lpcpIDInfo.cpidVec.push_back(1 + index % 2);
+        }
+    }
+
+    MockMDSClient mdsClient;
+    EXPECT_CALL(mdsClient,
+                GetOrAllocateSegments(false, ElementsAre(0, 1 * GiB, 2 * GiB),
+                                      _, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(segments),
+                        Return(LIBCURVE_ERROR::OK)));
+    // copysets are persisted too
+    EXPECT_CALL(mdsClient, GetServerList(_, _, _)).Times(0);
+
+    MetaCache metaCache;
+    metaCache.Init(option_, &mdsClient);
+    metaCache.UpdateFileInfo(fileInfo_);
+    metaCache.UpdateFileEpoch(fEpoch_);
+    ASSERT_TRUE(metaCache.LoadPersisted());
+
+    ChunkIDInfo info;
+    for (uint64_t i = 0; i < chunksPerSegment; ++i) {
+        ASSERT_EQ(MetaCacheErrorType::OK,
+                  metaCache.GetChunkInfoByIndex(i, &info));
+        ASSERT_EQ(1000 + i, info.cid_);
+        ASSERT_EQ(1 + i % 2, info.cpid_);
+    }
+    for (uint64_t i = chunksPerSegment; i < 4 * chunksPerSegment; ++i) {
+        ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+                  metaCache.GetChunkInfoByIndex(i, &info));
+    }
+}
+
+TEST_F(MetaCachePersistTest, TestPersistedSegmentsWithoutServerList) {
+    const uint64_t chunksPerSegment = fileInfo_.segmentsize /
+                                      fileInfo_.chunksize;
+    {
+        MetaCache metaCache;
+        InitMetaCache(&metaCache);
+        for (uint64_t i = 0; i < 2 * chunksPerSegment; ++i) {
+            metaCache.UpdateChunkInfoByIndex(i, ChunkIDInfo(1000 + i, 1, 1));
+        }
+        ASSERT_EQ(0, metaCache.Persist());
+    }
+
+    MockMDSClient mdsClient;
+    MetaCache metaCache;
+    metaCache.Init(option_, &mdsClient);
+    metaCache.UpdateFileInfo(fileInfo_);
+    metaCache.UpdateFileEpoch(fEpoch_);
+
+    SegmentInfo segment;
+    segment.startoffset = 0;
+    segment.lpcpIDInfo.lpid = 1;
+    for (uint64_t i = 0; i < chunksPerSegment; ++i) {
+        segment.chunkvec.emplace_back(1000 + i, 1, 1);
+        segment.lpcpIDInfo.cpidVec.push_back(1);
+    }
+    EXPECT_CALL(mdsClient, GetOrAllocateSegments(false, _, _, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(std::vector<SegmentInfo>{segment}),
+                        Return(LIBCURVE_ERROR::OK)));
+    // server list of the copyset is not persisted, and can't be got
+    EXPECT_CALL(mdsClient, GetServerList(1, ElementsAre(1), _))
+        .WillOnce(Return(LIBCURVE_ERROR::FAILED));
+
+    ASSERT_TRUE(metaCache.LoadPersisted());
+    ChunkIDInfo info;
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache.GetChunkInfoByIndex(0, &info));
+}
+
+TEST_F(MetaCachePersistTest, TestPersistIfExpired) {
+    option_.persistIntervalS = 3600;
+    {
+        MetaCache metaCache;
+        InitMetaCache(&metaCache);
+        FillMetaCache(&metaCache);
+        // written by the persist thread in background
+        metaCache.PersistIfExpired();
+    }
+
+    MetaCache metaCache;
+    InitMetaCache(&metaCache);
+    int retry = 0;
+    while (::access(kPersistPath, F_OK) != 0 && retry++ < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(metaCache.LoadPersisted());
+    ASSERT_EQ(3, metaCache.GetCopysetinfo(1, 1).csinfos_.size());
+
+    // the interval is counted from open
+    FillMetaCache(&metaCache);
+    metaCache.PersistIfExpired();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_NE(0, ::access(kPersistPath, F_OK));
+}
+
+TEST_F(MetaCachePersistTest, TestOldVersionDropped) {
+    // persisted by old version with chunk ids
+    {
+        std::ofstream out(kPersistPath);
+        out << "curve_metacache_v1 100 12345 1\n"
+            << "C 0 1000 1 1\n";
+    }
+
+    MetaCache metaCache;
+    InitMetaCache(&metaCache);
+    ASSERT_FALSE(metaCache.LoadPersisted());
+    ChunkIDInfo info;
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache.GetChunkInfoByIndex(0, &info));
+    ASSERT_NE(0, ::access(kPersistPath, F_OK));
+}
+
+TEST_F(MetaCachePersistTest, TestFileRecreated) {
+    {
+        MetaCache metaCache;
+        InitMetaCache(&metaCache);
+        FillMetaCache(&metaCache);
+        ASSERT_EQ(0, metaCache.Persist());
+    }
+
+    fileInfo_.ctime += 1;
+    MetaCache metaCache;
+    InitMetaCache(&metaCache);
+    ASSERT_FALSE(metaCache.LoadPersisted());
+
+    ChunkIDInfo info;
+    ASSERT_EQ(MetaCacheErrorType::CHUNKINFO_NOT_FOUND,
+              metaCache.GetChunkInfoByIndex(0, &info));
+    ASSERT_FALSE(metaCache.GetCopysetinfo(1, 1).IsValid());
+}
+
+TEST_F(MetaCachePersistTest, TestDisabled) {
+    option_.persistDir.clear();
+    MetaCache metaCache;
+    InitMetaCache(&metaCache);
+    FillMetaCache(&metaCache);
+    ASSERT_EQ(0, metaCache.Persist());
+    ASSERT_FALSE(metaCache.LoadPersisted());
+}
+
 }  // namespace client
 }  // namespace curve
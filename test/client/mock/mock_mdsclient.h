@@ -24,6 +24,8 @@
 
 #include <gmock/gmock.h>
 
+#include <vector>
+
 #include "src/client/mds_client.h"
 
 namespace curve {
@@ -32,6 +34,17 @@ namespace client {
 class MockMDSClient : public MDSClient {
  public:
     MOCK_METHOD2(DeAllocateSegment, LIBCURVE_ERROR(const FInfo*, uint64_t));
+    MOCK_METHOD3(MarkSegmentsDirty,
+                 LIBCURVE_ERROR(const FInfo*, const std::vector<uint64_t>&,
+                                uint64_t));
+    MOCK_METHOD5(GetOrAllocateSegments,
+                 LIBCURVE_ERROR(bool, const std::vector<uint64_t>&,
+                                const FInfo_t*, const FileEpoch_t*,
+                                std::vector<SegmentInfo>*));
+    MOCK_METHOD3(GetServerList,
+                 LIBCURVE_ERROR(const LogicPoolID&,
+                                const std::vector<CopysetID>&,
+                                std::vector<CopysetInfo<ChunkServerID>>*));
 };
 
 }  // namespace client
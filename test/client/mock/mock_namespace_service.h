@@ -84,6 +84,18 @@ class MockNameService : public CurveFSService {
                       const curve::mds::IncreaseFileEpochRequest* request,
                       curve::mds::IncreaseFileEpochResponse* response,
                       ::google::protobuf::Closure* done));
+
+    MOCK_METHOD4(GetOrAllocateSegments,
+                 void(::google::protobuf::RpcController* controller,
+                      const curve::mds::GetOrAllocateSegmentsRequest* request,
+                      curve::mds::GetOrAllocateSegmentsResponse* response,
+                      ::google::protobuf::Closure* done));
+
+    MOCK_METHOD4(MarkSegmentsDirty,
+                 void(::google::protobuf::RpcController* controller,
+                      const curve::mds::MarkSegmentsDirtyRequest* request,
+                      curve::mds::MarkSegmentsDirtyResponse* response,
+                      ::google::protobuf::Closure* done));
 };
 
 }  // namespace mds
@@ -20,10 +20,16 @@
  * Author: wuhanqing
  */
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 #include "src/client/client_common.h"
+#include "src/client/io_tracker.h"
 #include "src/client/splitor.h"
+#include "test/client/mock/mock_mdsclient.h"
 
 namespace curve {
 namespace client {
@@ -62,5 +68,67 @@ TEST(SplitorTest, NeedGetOrAllocateSegmentTest_ChunkAllocatedButInvalid) {
         MetaCacheErrorType::OK, OpType::READ, chunkInfo, &metaCache));
 }
 
+TEST(SplitorTest, MarkSegmentDirtyBeforeWrite) {
+    MockMDSClient mdsClient;
+    MetaCache metaCache;
+
+    FInfo fi;
+    fi.seqnum = 5;
+    fi.chunksize = 4 * 1024 * 1024;
+    fi.segmentsize = 1 * 1024 * 1024 * 1024ul;
+    fi.length = 10 * fi.segmentsize;
+    fi.filestatus = FileStatus::Created;
+    fi.dirtyTrackingSeqNum = 3;
+    metaCache.UpdateFileInfo(fi);
+    metaCache.UpdateChunkInfoByIndex(0, ChunkIDInfo(1, 2, 3));
+    metaCache.GetFileSegment(0)->UpdateDirtySeqNum(4);
+
+    IOTracker iotracker(nullptr, &metaCache, nullptr);
+    iotracker.SetOpType(OpType::WRITE);
+    butil::IOBuf data;
+    data.append(std::string(4096, 'a'));
+    std::vector<RequestContext*> reqlist;
+
+    // mark failed, write fails
+    EXPECT_CALL(mdsClient,
+                MarkSegmentsDirty(&fi, std::vector<uint64_t>{0}, 5))
+        .WillOnce(testing::Return(LIBCURVE_ERROR::FAILED))
+        .WillOnce(testing::Return(LIBCURVE_ERROR::OK));
+    auto copy = data;
+    ASSERT_EQ(-1, Splitor::IO2ChunkRequests(&iotracker, &metaCache, &reqlist,
+                                            &copy, 0, 4096, &mdsClient, &fi,
+                                            nullptr));
+
+    // marked once for each seqnum
+    for (int i = 0; i < 2; i++) {
+        copy = data;
+        ASSERT_EQ(0, Splitor::IO2ChunkRequests(&iotracker, &metaCache,
+                                               &reqlist, &copy, 0, 4096,
+                                               &mdsClient, &fi, nullptr));
+    }
+    ASSERT_EQ(5, metaCache.GetFileSegment(0)->GetDirtySeqNum());
+    ASSERT_EQ(2, reqlist.size());
+    ASSERT_EQ(5, reqlist[0]->seq_);
+
+    // reads don't mark
+    IOTracker readTracker(nullptr, &metaCache, nullptr);
+    readTracker.SetOpType(OpType::READ);
+    fi.seqnum = 6;
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(&readTracker, &metaCache,
+                                           &reqlist, nullptr, 0, 4096,
+                                           &mdsClient, &fi, nullptr));
+
+    // untracked file doesn't mark
+    fi.dirtyTrackingSeqNum = 0;
+    copy = data;
+    ASSERT_EQ(0, Splitor::IO2ChunkRequests(&iotracker, &metaCache, &reqlist,
+                                           &copy, 0, 4096, &mdsClient, &fi,
+                                           nullptr));
+
+    for (auto* req : reqlist) {
+        delete req;
+    }
+}
+
 }  // namespace client
 }  // namespace curve
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-11
+ */
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/common/sharded_cache.h"
+
+namespace curve {
+namespace common {
+
+TEST(ShardedARCCacheTest, TestCapacityAndShardNum) {
+    ShardedARCCache<std::string, std::string> cache(8, 100);
+    ASSERT_EQ(8, cache.ShardNum());
+    ASSERT_EQ(104, cache.Capacity());
+
+    ShardedARCCache<std::string, std::string> single(0, 10);
+    ASSERT_EQ(1, single.ShardNum());
+    ASSERT_EQ(10, single.Capacity());
+
+    ShardedARCCache<std::string, std::string> tiny(16, 4);
+    ASSERT_EQ(16, tiny.ShardNum());
+    ASSERT_EQ(16, tiny.Capacity());
+}
+
+TEST(ShardedARCCacheTest, TestPutGetRemove) {
+    auto metrics = std::make_shared<CacheMetrics>("ShardedARCCacheTest");
+    ShardedARCCache<std::string, std::string> cache(4, 1000, metrics);
+
+    for (int i = 0; i < 100; i++) {
+        cache.Put(std::to_string(i), "value" + std::to_string(i));
+    }
+    ASSERT_EQ(100, cache.Size());
+    ASSERT_EQ(100, metrics->cacheCount.get_value());
+
+    for (int i = 0; i < 100; i++) {
+        std::string value;
+        ASSERT_TRUE(cache.Get(std::to_string(i), &value));
+        ASSERT_EQ("value" + std::to_string(i), value);
+    }
+    ASSERT_EQ(100, metrics->cacheHit.get_value());
+
+    std::string value;
+    ASSERT_FALSE(cache.Get("not-exist", &value));
+    ASSERT_EQ(1, metrics->cacheMiss.get_value());
+
+    // overwrite
+    cache.Put("1", "newvalue");
+    ASSERT_TRUE(cache.Get("1", &value));
+    ASSERT_EQ("newvalue", value);
+
+    for (int i = 0; i < 100; i++) {
+        cache.Remove(std::to_string(i));
+    }
+    ASSERT_EQ(0, cache.Size());
+    ASSERT_EQ(0, metrics->cacheCount.get_value());
+}
+
+TEST(ShardedARCCacheTest, TestEliminate) {
+    ShardedARCCache<int, int> cache(4, 16);
+    for (int i = 0; i < 1000; i++) {
+        cache.Put(i, i);
+    }
+    ASSERT_LE(cache.Size(), cache.Capacity());
+}
+
+TEST(ShardedARCCacheTest, TestConcurrentAccess) {
+    auto metrics = std::make_shared<CacheMetrics>("ShardedARCCacheTest2");
+    ShardedARCCache<int, int> cache(16, 10000, metrics);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 1000; i++) {
+                int key = t * 1000 + i;
+                int value;
+                cache.Put(key, key);
+                ASSERT_TRUE(cache.Get(key, &value));
+                ASSERT_EQ(key, value);
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    ASSERT_EQ(8000, cache.Size());
+    ASSERT_EQ(8000, metrics->cacheHit.get_value());
+}
+
+namespace {
+
+// keys of each thread are mapped to its own shard
+struct IdentityHash {
+    size_t operator()(int key) const { return key; }
+};
+
+const int kLoadThreads = 8;
+const int kLoadOps = 20000;
+
+// run the same contended load against the cache, return its lock waits
+uint64_t CountLockWaits(uint32_t shardNum, const std::string &name) {
+    auto metrics = std::make_shared<CacheMetrics>(name);
+    ShardedARCCache<int, int, CacheTraits<int>, CacheTraits<int>,
+                    IdentityHash>
+        cache(shardNum, 1024, metrics);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kLoadThreads; t++) {
+        threads.emplace_back([&cache, t]() {
+            int value;
+            for (int i = 0; i < kLoadOps; i++) {
+                int key = (i % 32) * 16 + t;
+                cache.Put(key, key);
+                cache.Get(key, &value);
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    return metrics->lockWaitCount.get_value();
+}
+
+}  // namespace
+
+TEST(ShardedARCCacheTest, TestLessLockWaitThanSingleShard) {
+    uint64_t single = CountLockWaits(1, "ShardedARCCacheTestSingle");
+    uint64_t sharded = CountLockWaits(16, "ShardedARCCacheTestSharded");
+    LOG(INFO) << "lock waits, single shard: " << single
+              << ", 16 shards: " << sharded;
+
+    // every operation records at most one wait
+    ASSERT_LE(single, static_cast<uint64_t>(2 * kLoadThreads * kLoadOps));
+    // threads touch disjoint shards, so they never wait for each other
+    ASSERT_EQ(0, sharded);
+    ASSERT_LE(sharded, single);
+}
+
+}  // namespace common
+}  // namespace curve
@@ -27,6 +27,9 @@
 #include <gtest/gtest.h>
 
 #include <chrono> // NOLINT
+#include <thread> // NOLINT
+
+#include "src/common/concurrent/count_down_event.h"
 
 namespace curve {
 namespace common {
@@ -195,5 +198,79 @@ TEST_F(ThrottleTest, TestIopsLimit) {
     ASSERT_LE(seconds, 11);
 }
 
+class CountDownClosure : public google::protobuf::Closure {
+ public:
+    explicit CountDownClosure(CountDownEvent* event) : event_(event) {}
+
+    void Run() override {
+        event_->Signal();
+        delete this;
+    }
+
+ private:
+    CountDownEvent* event_;
+};
+
+TEST_F(ThrottleTest, TestAsyncAdd) {
+    params_.iopsTotal = ThrottleParams(1000, 0, 0);     // iops limit is 1000
+    params_.bpsTotal = ThrottleParams(4 * 1024, 0, 0);  // bps limit is 4096
+    throttle_.UpdateThrottleParams(params_);
+
+    CountDownEvent event(2);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    // async add never blocks the caller
+    throttle_.Add(false, 4096 * 5, new CountDownClosure(&event));
+    throttle_.Add(true, 4096 * 5, new CountDownClosure(&event));
+    auto end = std::chrono::high_resolution_clock::now();
+    ASSERT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(
+                  end - start).count(), 100);
+
+    // consume 40960 bps tokens, so the second request will be done after
+    // 10 seconds
+    event.Wait();
+    end = std::chrono::high_resolution_clock::now();
+    auto seconds =
+        std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
+    ASSERT_GE(seconds, 9);
+    ASSERT_LE(seconds, 11);
+}
+
+TEST_F(ThrottleTest, TestAsyncAddPassAfterStop) {
+    params_.bpsTotal = ThrottleParams(4 * 1024, 0, 0);  // bps limit is 4096
+    throttle_.UpdateThrottleParams(params_);
+
+    // pending requests are done when throttle is stopped
+    CountDownEvent event(1);
+    throttle_.Add(true, 4096 * 100, new CountDownClosure(&event));
+    ASSERT_FALSE(event.WaitFor(1000));
+    throttle_.Stop();
+    ASSERT_TRUE(event.WaitFor(1000));
+}
+
+TEST_F(ThrottleTest, TestStopWhileRequestsResumed) {
+    params_.iopsTotal = ThrottleParams(1000, 0, 0);     // iops limit is 1000
+    params_.bpsTotal = ThrottleParams(1024 * 1024, 0, 0);  // bps limit 1MB
+    throttle_.UpdateThrottleParams(params_);
+
+    // requests are resumed by timer thread of leaky bucket while stopping
+    const int kRequests = 1000;
+    CountDownEvent event(kRequests + 1);
+    for (int i = 0; i < kRequests; i++) {
+        throttle_.Add(i % 2 == 0, 4096, new CountDownClosure(&event));
+    }
+    std::thread blocked([&event, this]() {
+        throttle_.Add(false, 4096 * 1000);
+        event.Signal();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    throttle_.Stop();
+    ASSERT_TRUE(event.WaitFor(1000));
+    blocked.join();
+
+    // requests after stop are not throttled
+    throttle_.Add(false, 4096 * 1000);
+}
+
 }  // namespace common
 }  // namespace curve
@@ -0,0 +1,475 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-15
+ */
+
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <chrono>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "src/kvstorageclient/txn_batch_client.h"
+#include "src/common/timeutility.h"
+
+namespace curve {
+namespace kvstorage {
+
+using ::curve::common::TimeUtility;
+
+namespace {
+
+/**
+ * @brief an in-process KVStorageClient. Every write request takes commitUs
+ *        and write requests are committed one by one, like proposals
+ *        committed by the raft log of etcd.
+ */
+class FakeKVStorageClient : public KVStorageClient {
+ public:
+    explicit FakeKVStorageClient(uint32_t commitUs = 0)
+        : commitUs_(commitUs), revision_(0), writeCount_(0),
+          injectErr_(EtcdErrCode::EtcdOK), blocked_(false),
+          blockedTxns_(0) {}
+
+    int Put(const std::string &key, const std::string &value) override {
+        int64_t revision;
+        return PutRewithRevision(key, value, &revision);
+    }
+
+    int PutRewithRevision(const std::string &key, const std::string &value,
+                          int64_t *revision) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        Commit();
+        kvs_[key] = value;
+        *revision = ++revision_;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int Get(const std::string &key, std::string *out) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = kvs_.find(key);
+        if (it == kvs_.end()) {
+            return EtcdErrCode::EtcdKeyNotExist;
+        }
+        *out = it->second;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int List(const std::string &startKey, const std::string &endKey,
+             std::vector<std::string> *values) override {
+        std::vector<std::pair<std::string, std::string>> kvs;
+        int ret = List(startKey, endKey, &kvs);
+        for (auto &kv : kvs) {
+            values->emplace_back(kv.second);
+        }
+        return ret;
+    }
+
+    int List(const std::string &startKey, const std::string &endKey,
+             std::vector<std::pair<std::string, std::string>> *out) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (auto it = kvs_.lower_bound(startKey);
+             it != kvs_.end() && it->first < endKey; ++it) {
+            out->emplace_back(*it);
+        }
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int Delete(const std::string &key) override {
+        int64_t revision;
+        return DeleteRewithRevision(key, &revision);
+    }
+
+    int DeleteRewithRevision(const std::string &key,
+                             int64_t *revision) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        Commit();
+        kvs_.erase(key);
+        *revision = ++revision_;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int TxnN(const std::vector<Operation> &ops) override {
+        int64_t revision;
+        return TxnNWithRevision(ops, &revision);
+    }
+
+    int TxnNWithRevision(const std::vector<Operation> &ops,
+                         int64_t *revision) override {
+        if (ops.empty() || ops.size() > kMaxTxnOps) {
+            return EtcdErrCode::EtcdInvalidArgument;
+        }
+        // etcd rejects a txn with duplicate keys
+        std::set<std::string> keys;
+        for (const auto &op : ops) {
+            if (!keys.emplace(op.key, op.keyLen).second) {
+                return EtcdErrCode::EtcdInvalidArgument;
+            }
+        }
+        WaitUnblocked();
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        Commit();
+        if (injectErr_ != EtcdErrCode::EtcdOK) {
+            return injectErr_;
+        }
+        for (const auto &op : ops) {
+            std::string key(op.key, op.keyLen);
+            if (op.opType == OpType::OpPut) {
+                kvs_[key] = std::string(op.value, op.valueLen);
+            } else {
+                kvs_.erase(key);
+            }
+        }
+        *revision = ++revision_;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    int CompareAndSwap(const std::string &key, const std::string &preV,
+                       const std::string &target) override {
+        std::lock_guard<std::mutex> lk(mutex_);
+        Commit();
+        auto it = kvs_.find(key);
+        if (it == kvs_.end() || it->second != preV) {
+            return EtcdErrCode::EtcdUnknown;
+        }
+        it->second = target;
+        ++revision_;
+        return EtcdErrCode::EtcdOK;
+    }
+
+    uint64_t GetWriteCount() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return writeCount_;
+    }
+
+    void InjectError(int errCode) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        injectErr_ = errCode;
+    }
+
+    // transactions are held until Unblock() is called
+    void Block() {
+        std::lock_guard<std::mutex> lk(gateMutex_);
+        blocked_ = true;
+    }
+
+    void Unblock() {
+        std::lock_guard<std::mutex> lk(gateMutex_);
+        blocked_ = false;
+        gateCond_.notify_all();
+    }
+
+    // wait until a transaction is held
+    void WaitTxnBlocked() {
+        std::unique_lock<std::mutex> lk(gateMutex_);
+        gateCond_.wait(lk, [this]() { return blockedTxns_ > 0; });
+    }
+
+ private:
+    void WaitUnblocked() {
+        std::unique_lock<std::mutex> lk(gateMutex_);
+        blockedTxns_++;
+        gateCond_.notify_all();
+        gateCond_.wait(lk, [this]() { return !blocked_; });
+        blockedTxns_--;
+    }
+
+    void Commit() {
+        writeCount_++;
+        if (commitUs_ > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(commitUs_));
+        }
+    }
+
+ private:
+    std::mutex mutex_;
+    uint32_t commitUs_;
+    std::map<std::string, std::string> kvs_;
+    int64_t revision_;
+    uint64_t writeCount_;
+    int injectErr_;
+
+    std::mutex gateMutex_;
+    std::condition_variable gateCond_;
+    bool blocked_;
+    int blockedTxns_;
+};
+
+// wait until the mutations are queued in the client
+void WaitPendingMutations(TxnBatchClient *client, uint64_t num) {
+    while (client->GetPendingMutationNum() < num) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+/**
+ * @brief put and delete keys concurrently, every thread operates its own
+ *        keys and checks the results
+ *
+ * @return time cost in us
+ */
+uint64_t RunConcurrentMutations(KVStorageClient *client, int threadNum,
+                                int opsPerThread) {
+    uint64_t start = TimeUtility::GetTimeofDayUs();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; t++) {
+        threads.emplace_back([=]() {
+            int64_t lastRevision = 0;
+            for (int i = 0; i < opsPerThread; i++) {
+                std::string key = "key_" + std::to_string(t) + "_" +
+                                  std::to_string(i % 8);
+                int64_t revision = 0;
+                if (i % 4 == 3) {
+                    ASSERT_EQ(EtcdErrCode::EtcdOK,
+                              client->DeleteRewithRevision(key, &revision));
+                } else {
+                    ASSERT_EQ(EtcdErrCode::EtcdOK,
+                              client->PutRewithRevision(
+                                  key, std::to_string(i), &revision));
+                }
+                // mutations of one caller are committed in order
+                ASSERT_GT(revision, lastRevision);
+                lastRevision = revision;
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    return TimeUtility::GetTimeofDayUs() - start;
+}
+
+}  // namespace
+
+TEST(TestTxnBatchClient, test_forward_before_start) {
+    auto fake = std::make_shared<FakeKVStorageClient>();
+    TxnBatchClient client(fake, TxnBatchOption());
+
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Put("k1", "v1"));
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client.PutRewithRevision("k2", "v2", &revision));
+    ASSERT_EQ(2, revision);
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Get("k1", &value));
+    ASSERT_EQ("v1", value);
+    std::vector<std::string> values;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.List("k1", "k3", &values));
+    ASSERT_EQ(2, values.size());
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.CompareAndSwap("k1", "v1", "v3"));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Delete("k1"));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.DeleteRewithRevision("k2",
+                                                               &revision));
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, client.Get("k2", &value));
+    ASSERT_EQ(5, fake->GetWriteCount());
+}
+
+TEST(TestTxnBatchClient, test_single_mutation) {
+    auto fake = std::make_shared<FakeKVStorageClient>();
+    TxnBatchClient client(fake, TxnBatchOption());
+    client.Start();
+
+    int64_t revision = 0;
+    ASSERT_EQ(EtcdErrCode::EtcdOK,
+              client.PutRewithRevision("k1", "v1", &revision));
+    ASSERT_EQ(1, revision);
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Get("k1", &value));
+    ASSERT_EQ("v1", value);
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.DeleteRewithRevision("k1",
+                                                               &revision));
+    ASSERT_EQ(2, revision);
+    ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist, client.Get("k1", &value));
+
+    client.Stop();
+    // forwarded directly after stopped
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Put("k1", "v2"));
+    ASSERT_EQ(EtcdErrCode::EtcdOK, client.Get("k1", &value));
+    ASSERT_EQ("v2", value);
+}
+
+TEST(TestTxnBatchClient, test_mutations_batched_while_committing) {
+    auto fake = std::make_shared<FakeKVStorageClient>();
+    TxnBatchOption option;
+    option.maxBatchOps = 16;
+    option.maxDelayUs = 0;
+    TxnBatchClient client(fake, option);
+    client.Start();
+
+    // the first transaction is held, so the following mutations queue up
+    fake->Block();
+    std::thread first([&client]() {
+        ASSERT_EQ(EtcdErrCode::EtcdOK, client.Put("first", "v"));
+    });
+    fake->WaitTxnBlocked();
+
+    const int threadNum = 40;
+    std::vector<std::thread> threads;
+    std::vector<int64_t> revisions(threadNum);
+    for (int t = 0; t < threadNum; t++) {
+        threads.emplace_back([&, t]() {
+            ASSERT_EQ(EtcdErrCode::EtcdOK, client.PutRewithRevision(
+                "key" + std::to_string(t), "v", &revisions[t]));
+        });
+    }
+    WaitPendingMutations(&client, threadNum);
+    fake->Unblock();
+    first.join();
+    for (auto &th : threads) {
+        th.join();
+    }
+    client.Stop();
+
+    // the held one, then batches of 16, 16 and 8 mutations
+    ASSERT_EQ(4, fake->GetWriteCount());
+    std::map<int64_t, int> batchSizes;
+    for (auto revision : revisions) {
+        batchSizes[revision]++;
+    }
+    ASSERT_EQ(3, batchSizes.size());
+    ASSERT_EQ(16, batchSizes[2]);
+    ASSERT_EQ(16, batchSizes[3]);
+    ASSERT_EQ(8, batchSizes[4]);
+}
+
+TEST(TestTxnBatchClient, test_concurrent_mutations_batched) {
+    auto fake = std::make_shared<FakeKVStorageClient>(1000);
+    TxnBatchOption option;
+    option.maxBatchOps = 16;
+    option.maxDelayUs = 200;
+    TxnBatchClient client(fake, option);
+    client.Start();
+
+    const int threadNum = 32;
+    const int opsPerThread = 20;
+    RunConcurrentMutations(&client, threadNum, opsPerThread);
+    client.Stop();
+
+    // the last mutation of every key is put
+    for (int t = 0; t < threadNum; t++) {
+        for (int i = opsPerThread - 8; i < opsPerThread; i++) {
+            std::string key = "key_" + std::to_string(t) + "_" +
+                              std::to_string(i % 8);
+            std::string value;
+            if (i % 4 == 3) {
+                ASSERT_EQ(EtcdErrCode::EtcdKeyNotExist,
+                          fake->Get(key, &value));
+            } else {
+                ASSERT_EQ(EtcdErrCode::EtcdOK, fake->Get(key, &value));
+                ASSERT_EQ(std::to_string(i), value);
+            }
+        }
+    }
+}
+
+TEST(TestTxnBatchClient, test_conflict_keys_split) {
+    auto fake = std::make_shared<FakeKVStorageClient>(500);
+    TxnBatchClient client(fake, TxnBatchOption());
+    client.Start();
+
+    // all threads put the same key, the fake rejects a txn with duplicate
+    // keys so every put fails if conflicts are not split
+    const int threadNum = 8;
+    std::vector<std::thread> threads;
+    std::vector<int64_t> revisions(threadNum);
+    for (int t = 0; t < threadNum; t++) {
+        threads.emplace_back([&, t]() {
+            ASSERT_EQ(EtcdErrCode::EtcdOK, client.PutRewithRevision(
+                "samekey", std::to_string(t), &revisions[t]));
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    client.Stop();
+
+    // every put is in its own transaction
+    ASSERT_EQ(threadNum, fake->GetWriteCount());
+    ASSERT_EQ(threadNum, std::set<int64_t>(revisions.begin(),
+                                           revisions.end()).size());
+    // the value is from the put with the largest revision
+    int last = std::max_element(revisions.begin(), revisions.end()) -
+               revisions.begin();
+    std::string value;
+    ASSERT_EQ(EtcdErrCode::EtcdOK, fake->Get("samekey", &value));
+    ASSERT_EQ(std::to_string(last), value);
+}
+
+TEST(TestTxnBatchClient, test_txn_failed) {
+    auto fake = std::make_shared<FakeKVStorageClient>(500);
+    fake->InjectError(EtcdErrCode::EtcdDeadlineExceeded);
+    TxnBatchClient client(fake, TxnBatchOption());
+    client.Start();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&, t]() {
+            int64_t revision = -1;
+            ASSERT_EQ(EtcdErrCode::EtcdDeadlineExceeded,
+                      client.PutRewithRevision("key" + std::to_string(t),
+                                               "value", &revision));
+            // revision is not changed on failure
+            ASSERT_EQ(-1, revision);
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+    client.Stop();
+}
+
+// compare the throughput of mutations issued one by one with that of
+// mutations committed in batches against a fake client
+TEST(TestTxnBatchClient, test_batch_throughput) {
+    const int threadNum = 32;
+    const int opsPerThread = 50;
+    const uint32_t commitUs = 500;
+
+    auto direct = std::make_shared<FakeKVStorageClient>(commitUs);
+    uint64_t directUs = RunConcurrentMutations(direct.get(), threadNum,
+                                               opsPerThread);
+
+    auto fake = std::make_shared<FakeKVStorageClient>(commitUs);
+    TxnBatchClient client(fake, TxnBatchOption());
+    client.Start();
+    uint64_t batchUs = RunConcurrentMutations(&client, threadNum,
+                                              opsPerThread);
+    client.Stop();
+
+    uint64_t total = threadNum * opsPerThread;
+    LOG(INFO) << "direct: " << total * 1000000 / directUs << " ops/s, "
+              << direct->GetWriteCount() << " etcd requests; "
+              << "batched: " << total * 1000000 / batchUs << " ops/s, "
+              << fake->GetWriteCount() << " etcd requests";
+    ASSERT_EQ(total, direct->GetWriteCount());
+    ASSERT_LE(fake->GetWriteCount(), total);
+}
+
+}  // namespace kvstorage
+}  // namespace curve
@@ -182,6 +182,35 @@ TEST(ChunkserverHealthyChecker, test_checkHeartBeat_interval) {
         ASSERT_EQ(OnlineState::ONLINE, info.state);
     }
 }
+
+TEST(ChunkserverHealthyChecker, test_online_state_changed_callback) {
+    HeartbeatOption option;
+    option.heartbeatIntervalMs = 1000;
+    option.heartbeatMissTimeOutMs = 3000;
+    option.offLineTimeOutMs = 5000;
+    std::shared_ptr<MockTopology> topology = std::make_shared<MockTopology>();
+    std::vector<ChunkServerIdType> changed;
+    std::shared_ptr<ChunkserverHealthyChecker> checker =
+        std::make_shared<ChunkserverHealthyChecker>(option, topology,
+            [&changed](ChunkServerIdType id) {
+                changed.emplace_back(id);
+            });
+
+    // only the chunkserver updated into topology successfully is notified
+    checker->UpdateLastReceivedHeartbeatTime(1, steady_clock::now());
+    checker->UpdateLastReceivedHeartbeatTime(2, steady_clock::now());
+    EXPECT_CALL(*topology, UpdateChunkServerOnlineState(_, 1))
+        .WillOnce(Return(kTopoErrCodeSuccess));
+    EXPECT_CALL(*topology, UpdateChunkServerOnlineState(_, 2))
+        .WillOnce(Return(kTopoErrCodeInternalError));
+    checker->CheckHeartBeatInterval();
+    ASSERT_EQ(std::vector<ChunkServerIdType>({1}), changed);
+
+    // no notification if state not changed
+    checker->CheckHeartBeatInterval();
+    ASSERT_EQ(1, changed.size());
+}
+
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
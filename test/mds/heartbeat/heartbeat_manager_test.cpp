@@ -934,6 +934,50 @@ TEST_F(TestHeartbeatManager, test_patrol_copySetInfo_return_order) {
     ASSERT_EQ(TRANSFER_LEADER, response.needupdatecopysets(0).type());
     ASSERT_EQ(3, response.needupdatecopysets(0).peers_size());
 }
+
+TEST_F(TestHeartbeatManager, test_incremental_heartbeat) {
+    auto request = GetChunkServerHeartbeatRequestForTest();
+    request.clear_copysetinfos();
+    ::curve::mds::topology::ChunkServer chunkServer1(
+        1, "hello", "", 1, "192.168.10.1", 9000, "",
+        ::curve::mds::topology::ChunkServerStatus::READWRITE);
+
+    // 1. mds has not received full heartbeat of the chunkserver
+    {
+        request.set_incremental(true);
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*topology_, GetChunkServer(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.has_statuscode());
+        ASSERT_TRUE(response.needfullheartbeat());
+        ASSERT_EQ(0, response.needupdatecopysets_size());
+    }
+
+    // 2. full heartbeat
+    {
+        request.set_incremental(false);
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*topology_, GetChunkServer(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_EQ(HeartbeatStatusCode::hbRequestNoCopyset,
+                  response.statuscode());
+        ASSERT_FALSE(response.needfullheartbeat());
+    }
+
+    // 3. incremental heartbeat without changed copyset
+    {
+        request.set_incremental(true);
+        ChunkServerHeartbeatResponse response;
+        EXPECT_CALL(*topology_, GetChunkServer(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(chunkServer1), Return(true)));
+        heartbeatManager_->ChunkServerHeartbeat(request, &response);
+        ASSERT_FALSE(response.has_statuscode());
+        ASSERT_FALSE(response.needfullheartbeat());
+        ASSERT_EQ(0, response.needupdatecopysets_size());
+    }
+}
 }  // namespace heartbeat
 }  // namespace mds
 }  // namespace curve
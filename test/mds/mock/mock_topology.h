@@ -310,6 +310,9 @@ class MockTopologyStat : public TopologyStat {
     MOCK_METHOD2(GetChunkPoolSize,
         bool(PoolIdType pId,
         uint64_t *chunkPoolSize));
+    MOCK_METHOD2(GetIOLoads,
+        void(ChunkServerLoadMap *chunkServerLoads,
+        CopySetLoadMap *copySetLoads));
     MOCK_METHOD2(updateChunkFilepoolConfig,
         void(bool useChunkFilepool_,
         bool useChunkFilePoolAsWalPool_));
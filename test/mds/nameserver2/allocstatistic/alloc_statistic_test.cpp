@@ -228,5 +228,54 @@ TEST_F(AllocStatisticTest, test_PeriodicPersist_CalculateSegmentAlloc) {
     allocStatistic_->Stop();
 }
 
+TEST_F(AllocStatisticTest, test_ChangesInOneTxnBeforeCalculateSegmentAlloc) {
+    // logicalPoolId(1):1024
+    std::vector<std::string> values{
+            NameSpaceStorageCodec::EncodeSegmentAllocValue(1, 1024)};
+    EXPECT_CALL(*mockEtcdClient_, GetCurrentRevision(_))
+        .WillOnce(DoAll(SetArgPointee<0>(2), Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_,
+                List(SEGMENTALLOCSIZEKEY, SEGMENTALLOCSIZEKEYEND,
+                     Matcher<std::vector<std::string>*>(_)))
+        .WillOnce(DoAll(SetArgPointee<2>(values), Return(EtcdErrCode::EtcdOK)));
+    ASSERT_EQ(0, allocStatistic_->Init());
+
+    // one segment of logicalPoolId(1) at revision 2 in etcd
+    PageFileSegment segment;
+    segment.set_segmentsize(1 << 30);
+    segment.set_logicalpoolid(1);
+    segment.set_chunksize(16 * 1024 * 1024);
+    segment.set_startoffset(0);
+    std::string encodeSegment;
+    ASSERT_TRUE(
+        NameSpaceStorageCodec::EncodeSegment(segment, &encodeSegment));
+    EXPECT_CALL(*mockEtcdClient_, ListWithLimitAndRevision(
+        SEGMENTINFOKEYPREFIX, SEGMENTINFOKEYEND, GETBUNDLE, 2, _, _))
+        .WillOnce(DoAll(SetArgPointee<4>(
+                            std::vector<std::string>{encodeSegment}),
+                        Return(EtcdErrCode::EtcdOK)));
+    EXPECT_CALL(*mockEtcdClient_, Put(_, _))
+        .WillRepeatedly(Return(EtcdErrCode::EtcdOK));
+
+    // segments put and deleted in batched transactions before the segments
+    // in etcd are counted, the changes in one transaction share a revision
+    allocStatistic_->AllocSpace(1, 1L << 30, 3);
+    allocStatistic_->AllocSpace(1, 1L << 30, 3);
+    allocStatistic_->AllocSpace(1, 1L << 30, 4);
+    allocStatistic_->DeAllocSpace(1, 1L << 30, 4);
+    allocStatistic_->DeAllocSpace(1, 1L << 30, 4);
+    int64_t alloc;
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(1024 + (1L << 30), alloc);
+
+    allocStatistic_->Run();
+    std::this_thread::sleep_for(std::chrono::seconds(6));
+
+    ASSERT_TRUE(allocStatistic_->GetAllocByLogicalPool(1, &alloc));
+    ASSERT_EQ(2L * (1 << 30), alloc);
+
+    allocStatistic_->Stop();
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -34,6 +34,8 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
+using ::testing::Ne;
+using ::testing::SizeIs;
 using curve::mds::topology::MockTopology;
 using ::curve::mds::chunkserverclient::ChunkServerClientOption;
 using ::curve::mds::chunkserverclient::MockChunkServerClient;
@@ -380,5 +382,186 @@ TEST_F(CleanCoreTest, TestCleanDiscardSegment) {
     }
 }
 
+TEST_F(CleanCoreTest, TestCleanFileInParallel) {
+    const int kDefaultChunkSize = 16 * 1024 * 1024;
+    const uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+    const int chunkNum = DefaultSegmentSize / kDefaultChunkSize;
+
+    CleanCoreOption option;
+    option.chunkDeleteThreadNum = 4;
+    option.chunkDeleteWindow = 3;
+    option.segmentDeleteBatchSize = 4;
+    cleanCore_ = std::make_shared<CleanCore>(storage_, client_,
+                                             allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    // chunks of a segment are spread over 8 copysets
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(DefaultSegmentSize);
+    segment.set_chunksize(kDefaultChunkSize);
+    for (int i = 0; i < chunkNum; ++i) {
+        auto* chunk = segment.add_chunks();
+        chunk->set_copysetid(i % 8);
+        chunk->set_chunkid(i);
+    }
+
+    FileInfo cleanFile;
+    cleanFile.set_id(1);
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    cleanFile.set_seqnum(1);
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+
+    // ok, segments are deleted in batches of 4, 4 and 1 (one not exist)
+    {
+        for (uint32_t i = 0; i < segmentNum; i++) {
+            if (i == segmentNum - 1) {
+                EXPECT_CALL(*storage_,
+                            GetSegment(_, i * DefaultSegmentSize, _))
+                    .WillOnce(Return(StoreStatus::KeyNotExist));
+            } else {
+                EXPECT_CALL(*storage_,
+                            GetSegment(_, i * DefaultSegmentSize, _))
+                    .WillOnce(DoAll(SetArgPointee<2>(segment),
+                                    Return(StoreStatus::OK)));
+            }
+        }
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+            .Times(chunkNum * (segmentNum - 1))
+            .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+            .Times(chunkNum * (segmentNum - 1))
+            .WillRepeatedly(Return(kMdsSuccess));
+        EXPECT_CALL(*storage_, DeleteSegments(_, SizeIs(4), _))
+            .Times(2)
+            .WillOnce(DoAll(SetArgPointee<2>(10), Return(StoreStatus::OK)))
+            .WillOnce(DoAll(SetArgPointee<2>(11), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, DeleteSegment(_, 8 * DefaultSegmentSize, _))
+            .WillOnce(DoAll(SetArgPointee<2>(12), Return(StoreStatus::OK)));
+        // the segments deleted in one transaction share its revision, the
+        // released size is reported once for each transaction
+        const int64_t kBatchDeallocSize = 4 * DefaultSegmentSize;
+        EXPECT_CALL(*allocStatistic_,
+                    DeAllocSpace(1, kBatchDeallocSize, 10))
+            .Times(1);
+        EXPECT_CALL(*allocStatistic_,
+                    DeAllocSpace(1, kBatchDeallocSize, 11))
+            .Times(1);
+        EXPECT_CALL(*allocStatistic_,
+                    DeAllocSpace(1, static_cast<int64_t>(DefaultSegmentSize),
+                                 12))
+            .Times(1);
+        EXPECT_CALL(*storage_, DeleteFile(_, _))
+            .WillOnce(Return(StoreStatus::OK));
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kOK, cleanCore_->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(100, progress.GetProgress());
+        ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+    }
+
+    // delete chunk failed, segments are not deleted
+    {
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+            .Times(4)
+            .WillRepeatedly(DoAll(SetArgPointee<2>(segment),
+                                  Return(StoreStatus::OK)));
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+            .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, 3, _, _))
+            .WillRepeatedly(Return(kMdsFail));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, Ne(3), _, _))
+            .WillRepeatedly(Return(kMdsSuccess));
+        EXPECT_CALL(*storage_, DeleteSegments(_, _, _)).Times(0);
+        EXPECT_CALL(*storage_, DeleteSegment(_, _, _)).Times(0);
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _)).Times(0);
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kCommonFileDeleteError,
+                  cleanCore_->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(TaskStatus::FAILED, progress.GetStatus());
+    }
+
+    // DeleteSegments failed
+    {
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+            .Times(4)
+            .WillRepeatedly(DoAll(SetArgPointee<2>(segment),
+                                  Return(StoreStatus::OK)));
+        EXPECT_CALL(*topology_, GetCopySet(_, _))
+            .Times(chunkNum * 4)
+            .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+        EXPECT_CALL(*csClient_, DeleteChunk(_, _, _, _, _))
+            .Times(chunkNum * 4)
+            .WillRepeatedly(Return(kMdsSuccess));
+        EXPECT_CALL(*storage_, DeleteSegments(_, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+        EXPECT_CALL(*allocStatistic_, DeAllocSpace(_, _, _)).Times(0);
+
+        TaskProgress progress;
+        ASSERT_EQ(StatusCode::kCommonFileDeleteError,
+                  cleanCore_->CleanFile(cleanFile, &progress));
+        ASSERT_EQ(TaskStatus::FAILED, progress.GetStatus());
+    }
+}
+
+TEST_F(CleanCoreTest, TestCleanSnapShotFileInParallel) {
+    const int kDefaultChunkSize = 16 * 1024 * 1024;
+    const uint32_t segmentNum = kMiniFileLength / DefaultSegmentSize;
+    const int chunkNum = DefaultSegmentSize / kDefaultChunkSize;
+
+    CleanCoreOption option;
+    option.chunkDeleteThreadNum = 4;
+    option.chunkDeleteWindow = 4;
+    option.segmentDeleteBatchSize = 3;
+    cleanCore_ = std::make_shared<CleanCore>(storage_, client_,
+                                             allocStatistic_, option);
+    client_->SetChunkServerClient(csClient_);
+
+    PageFileSegment segment;
+    segment.set_logicalpoolid(1);
+    segment.set_segmentsize(DefaultSegmentSize);
+    segment.set_chunksize(kDefaultChunkSize);
+    for (int i = 0; i < chunkNum; ++i) {
+        auto* chunk = segment.add_chunks();
+        chunk->set_copysetid(i);
+        chunk->set_chunkid(i);
+    }
+
+    FileInfo cleanFile;
+    cleanFile.set_id(2);
+    cleanFile.set_parentid(1);
+    cleanFile.set_length(kMiniFileLength);
+    cleanFile.set_segmentsize(DefaultSegmentSize);
+    cleanFile.set_seqnum(1);
+
+    CopySetInfo copyset;
+    copyset.SetLeader(1);
+
+    EXPECT_CALL(*storage_, GetSegment(1, _, _))
+        .Times(segmentNum)
+        .WillRepeatedly(DoAll(SetArgPointee<2>(segment),
+                              Return(StoreStatus::OK)));
+    EXPECT_CALL(*topology_, GetCopySet(_, _))
+        .Times(chunkNum * segmentNum)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset), Return(true)));
+    // correctSn is seqnum + 1
+    EXPECT_CALL(*csClient_, DeleteChunkSnapshotOrCorrectSn(_, _, _, _, 2))
+        .Times(chunkNum * segmentNum)
+        .WillRepeatedly(Return(kMdsSuccess));
+    EXPECT_CALL(*storage_, DeleteSegments(_, _, _)).Times(0);
+    EXPECT_CALL(*storage_, DeleteSnapshotFile(_, _))
+        .WillOnce(Return(StoreStatus::OK));
+
+    TaskProgress progress;
+    ASSERT_EQ(StatusCode::kOK,
+              cleanCore_->CleanSnapShotFile(cleanFile, &progress));
+    ASSERT_EQ(100, progress.GetProgress());
+    ASSERT_EQ(TaskStatus::SUCCESS, progress.GetStatus());
+}
+
 }  // namespace mds
 }  // namespace curve
@@ -2511,6 +2511,149 @@ TEST_F(CurveFSTest, testGetOrAllocateSegment) {
     }
 }
 
+TEST_F(CurveFSTest, testGetOrAllocateSegments) {
+    FileInfo fileInfo1;
+    fileInfo1.set_filetype(FileType::INODE_DIRECTORY);
+
+    FileInfo fileInfo2;
+    fileInfo2.set_filetype(FileType::INODE_PAGEFILE);
+    fileInfo2.set_length(kMiniFileLength);
+    fileInfo2.set_segmentsize(DefaultSegmentSize);
+    fileInfo2.set_poolset("default");
+
+    // invalid segment number
+    {
+        std::vector<PageFileSegment> segments;
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {}, true, &segments), StatusCode::kParaError);
+        std::vector<offset_t> offsets(kvstorage::kMaxTxnOps + 1, 0);
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  offsets, true, &segments), StatusCode::kParaError);
+    }
+
+    // segment offset not align file segment size
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {0, 1}, true, &segments), StatusCode::kParaError);
+    }
+
+    // get only, not allocated segments are skipped
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(2)
+        .WillOnce(Return(StoreStatus::OK))
+        .WillOnce(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .Times(0);
+
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {0, DefaultSegmentSize}, false, &segments), StatusCode::kOK);
+        ASSERT_EQ(1, segments.size());
+    }
+
+    // allocate not exist segments in one transaction
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .Times(4)
+        .WillOnce(Return(StoreStatus::OK))
+        .WillRepeatedly(Return(StoreStatus::KeyNotExist));
+        PageFileSegment segment1;
+        segment1.set_logicalpoolid(1);
+        segment1.set_segmentsize(DefaultSegmentSize);
+        PageFileSegment segment2;
+        segment2.set_logicalpoolid(2);
+        segment2.set_segmentsize(DefaultSegmentSize);
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .Times(3)
+        .WillOnce(DoAll(SetArgPointee<5>(segment1), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<5>(segment1), Return(true)))
+        .WillOnce(DoAll(SetArgPointee<5>(segment2), Return(true)));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .WillOnce(DoAll(SetArgPointee<2>(10), Return(StoreStatus::OK)));
+        // the segments put in one transaction share its revision, the
+        // allocated size of each logical pool is reported once
+        EXPECT_CALL(*allocStatistic_,
+                    AllocSpace(1, static_cast<int64_t>(2 * DefaultSegmentSize),
+                               10))
+        .Times(1);
+        EXPECT_CALL(*allocStatistic_,
+                    AllocSpace(2, static_cast<int64_t>(DefaultSegmentSize), 10))
+        .Times(1);
+
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {0, DefaultSegmentSize, 2 * DefaultSegmentSize,
+                   3 * DefaultSegmentSize}, true,
+                  &segments), StatusCode::kOK);
+        ASSERT_EQ(4, segments.size());
+    }
+
+    // allocate fail
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .WillOnce(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .WillOnce(Return(false));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .Times(0);
+
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {0}, true, &segments), StatusCode::kSegmentAllocateError);
+    }
+
+    // put segments fail
+    {
+        std::vector<PageFileSegment> segments;
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .Times(2)
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo1),
+                        Return(StoreStatus::OK)))
+        .WillOnce(DoAll(SetArgPointee<2>(fileInfo2),
+                        Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, _, _))
+        .WillOnce(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*mockChunkAllocator_,
+                   AllocateChunkSegment(_, _, _, _, _, _))
+        .WillOnce(Return(true));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+        .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(curvefs_->GetOrAllocateSegments("/user1/file2",
+                  {0}, true, &segments), StatusCode::kStorageError);
+        ASSERT_TRUE(segments.empty());
+    }
+}
+
 TEST_F(CurveFSTest, TestDeAllocateSegment) {
     const std::string filename = "/TestDeAllocateSegment";
     const uint64_t offset = 1ull * 1024 * 1024 * 1024;
@@ -2723,6 +2866,100 @@ TEST_F(CurveFSTest, TestDeAllocateSegment) {
     }
 }
 
+TEST_F(CurveFSTest, TestMarkSegmentsDirty) {
+    const std::string filename = "/TestMarkSegmentsDirty";
+
+    FileInfo fileInfo;
+    fileInfo.set_id(1);
+    fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+    fileInfo.set_length(100 * kGB);
+    fileInfo.set_segmentsize(1 * kGB);
+    fileInfo.set_seqnum(10);
+
+    // invalid segment number
+    {
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->MarkSegmentsDirty(filename, {}, 10));
+    }
+
+    // segment offset wrong
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kParaError,
+                  curvefs_->MarkSegmentsDirty(filename, {1 * kGB + 1}, 10));
+    }
+
+    // not allocated segments and segments marked already are skipped,
+    // dirtySeqNum is at least the seqNum of the file
+    {
+        PageFileSegment marked;
+        marked.set_startoffset(1 * kGB);
+        marked.set_dirtyseqnum(10);
+        PageFileSegment unmarked;
+        unmarked.set_startoffset(2 * kGB);
+        unmarked.set_dirtyseqnum(8);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, 0, _))
+            .WillOnce(Return(StoreStatus::KeyNotExist));
+        EXPECT_CALL(*storage_, GetSegment(_, 1 * kGB, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(marked), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, 2 * kGB, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(unmarked), Return(StoreStatus::OK)));
+        std::vector<PageFileSegment> putSegments;
+        EXPECT_CALL(*storage_, PutSegments(1, _, _))
+            .WillOnce(DoAll(SaveArg<1>(&putSegments),
+                            Return(StoreStatus::OK)));
+
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->MarkSegmentsDirty(
+                      filename, {0, 1 * kGB, 2 * kGB, 2 * kGB}, 9));
+        ASSERT_EQ(1, putSegments.size());
+        ASSERT_EQ(2 * kGB, putSegments[0].startoffset());
+        ASSERT_EQ(10, putSegments[0].dirtyseqnum());
+    }
+
+    // all segments marked already
+    {
+        PageFileSegment marked;
+        marked.set_startoffset(1 * kGB);
+        marked.set_dirtyseqnum(11);
+
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, 1 * kGB, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(marked), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+            .Times(0);
+
+        ASSERT_EQ(StatusCode::kOK,
+                  curvefs_->MarkSegmentsDirty(filename, {1 * kGB}, 11));
+    }
+
+    // put segments failed
+    {
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+            .WillOnce(
+                DoAll(SetArgPointee<2>(fileInfo), Return(StoreStatus::OK)));
+        EXPECT_CALL(*storage_, GetSegment(_, 1 * kGB, _))
+            .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*storage_, PutSegments(_, _, _))
+            .WillOnce(Return(StoreStatus::InternalError));
+
+        ASSERT_EQ(StatusCode::kStorageError,
+                  curvefs_->MarkSegmentsDirty(filename, {1 * kGB}, 10));
+    }
+}
+
 TEST_F(CurveFSTest, testCreateSnapshotFile) {
     {
         // test client time not expired
@@ -3685,6 +3922,55 @@ TEST_F(CurveFSTest, testOpenFile) {
             StatusCode::kOK);
     }
 
+    // client marks segments dirty, start dirty tracking
+    {
+        ProtoSession protoSession;
+        FileInfo  fileInfo;
+        fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+        fileInfo.set_seqnum(5);
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .WillOnce(Return(StoreStatus::OK));
+        FileInfo putInfo;
+        EXPECT_CALL(*storage_, PutFile(_))
+        .WillOnce(DoAll(SaveArg<0>(&putInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(curvefs_->OpenFile("/file1", "127.0.0.1", &protoSession,
+                                     &fileInfo, nullptr, true),
+                  StatusCode::kOK);
+        ASSERT_EQ(5, putInfo.dirtytrackingseqnum());
+        ASSERT_EQ(5, fileInfo.dirtytrackingseqnum());
+
+        // already tracked
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .WillOnce(Return(StoreStatus::OK));
+        EXPECT_CALL(*storage_, PutFile(_))
+        .Times(0);
+        ASSERT_EQ(curvefs_->OpenFile("/file1", "127.0.0.1", &protoSession,
+                                     &fileInfo, nullptr, true),
+                  StatusCode::kOK);
+        ASSERT_EQ(5, fileInfo.dirtytrackingseqnum());
+    }
+
+    // client doesn't mark segments dirty, stop dirty tracking
+    {
+        ProtoSession protoSession;
+        FileInfo  fileInfo;
+        fileInfo.set_filetype(FileType::INODE_PAGEFILE);
+        fileInfo.set_seqnum(5);
+        fileInfo.set_dirtytrackingseqnum(3);
+        EXPECT_CALL(*storage_, GetFile(_, _, _))
+        .WillOnce(Return(StoreStatus::OK));
+        FileInfo putInfo;
+        EXPECT_CALL(*storage_, PutFile(_))
+        .WillOnce(DoAll(SaveArg<0>(&putInfo), Return(StoreStatus::OK)));
+
+        ASSERT_EQ(curvefs_->OpenFile("/file1", "127.0.0.1", &protoSession,
+                                     &fileInfo),
+                  StatusCode::kOK);
+        ASSERT_FALSE(putInfo.has_dirtytrackingseqnum());
+        ASSERT_FALSE(fileInfo.has_dirtytrackingseqnum());
+    }
+
     // open clone file, clone source is not a valid curve file
     {
         ProtoSession protoSession;
@@ -393,6 +393,18 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus PutSegments(InodeID id,
+                            const std::vector<PageFileSegment> &segments,
+                            int64_t *revision) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (const auto &segment : segments) {
+            std::string storeKey = NameSpaceStorageCodec::EncodeSegmentStoreKey(
+                id, segment.startoffset());
+            memKvMap_[storeKey] = segment.SerializeAsString();
+        }
+        return StoreStatus::OK;
+    }
+
     StoreStatus DeleteSegment(
         InodeID id, uint64_t off, int64_t *revision) override {
         std::lock_guard<std::mutex> guard(lock_);
@@ -407,6 +419,17 @@ class FakeNameServerStorage : public NameServerStorage {
         return StoreStatus::OK;
     }
 
+    StoreStatus DeleteSegments(InodeID id,
+                               const std::vector<uint64_t> &offs,
+                               int64_t *revision) override {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (uint64_t off : offs) {
+            memKvMap_.erase(
+                NameSpaceStorageCodec::EncodeSegmentStoreKey(id, off));
+        }
+        return StoreStatus::OK;
+    }
+
     StoreStatus SnapShotFile(const FileInfo *originalFileInfo,
                             const FileInfo * snapshotFileInfo) override {
         std::lock_guard<std::mutex> guard(lock_);
@@ -35,6 +35,8 @@ using ::testing::AtLeast;
 using ::testing::SetArgPointee;
 using ::testing::DoAll;
 using ::testing::Matcher;
+using ::testing::SizeIs;
+using ::curve::kvstorage::kMaxTxnOps;
 
 namespace curve {
 namespace mds {
@@ -190,8 +192,9 @@ TEST_F(TestNameServerStorageImp, test_GetFile) {
     ASSERT_EQ(fileinfo.parentid(), getInfo.parentid());
 
     // 3. get file from cache ok
+    NameSpaceCacheValue cachedFileInfo = std::make_shared<FileInfo>(fileinfo);
     EXPECT_CALL(*cache_, Get(_, _))
-        .WillOnce(DoAll(SetArgPointee<1>(encodeFileinfo), Return(true)));
+        .WillOnce(DoAll(SetArgPointee<1>(cachedFileInfo), Return(true)));
     ASSERT_EQ(StoreStatus::OK, storage_->GetFile(fileinfo.parentid(),
                                                  fileinfo.filename(),
                                                  &getInfo));
@@ -390,8 +393,21 @@ TEST_F(TestNameServerStorageImp, test_getSegment) {
     ASSERT_EQ(segment.chunks_size(), getSegment.chunks_size());
 
     // 3. get file from cache ok
+    NameSpaceCacheValue cachedSegment =
+        std::make_shared<PageFileSegment>(segment);
     EXPECT_CALL(*cache_, Get(_, _))
-        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment), Return(true)));
+        .WillOnce(DoAll(SetArgPointee<1>(cachedSegment), Return(true)));
+    ASSERT_EQ(StoreStatus::OK, storage_->GetSegment(0, 0, &getSegment));
+    ASSERT_EQ(segment.chunksize(), getSegment.chunksize());
+    ASSERT_EQ(segment.chunks_size(), getSegment.chunks_size());
+
+    // 4. cached value of unexpected type, fallback to etcd
+    NameSpaceCacheValue cachedFileInfo = std::make_shared<FileInfo>();
+    EXPECT_CALL(*cache_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(cachedFileInfo), Return(true)));
+    EXPECT_CALL(*client_, Get(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(encodeSegment),
+                        Return(EtcdErrCode::EtcdOK)));
     ASSERT_EQ(StoreStatus::OK, storage_->GetSegment(0, 0, &getSegment));
     ASSERT_EQ(segment.chunksize(), getSegment.chunksize());
     ASSERT_EQ(segment.chunks_size(), getSegment.chunks_size());
@@ -407,6 +423,27 @@ TEST_F(TestNameServerStorageImp, test_deleteSegment) {
         storage_->DeleteSegment(0, 0, &revision));
 }
 
+TEST_F(TestNameServerStorageImp, test_deleteSegments) {
+    int64_t revision;
+    // invalid number of segments
+    std::vector<uint64_t> offs;
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage_->DeleteSegments(0, offs, &revision));
+    offs.resize(kMaxTxnOps + 1);
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage_->DeleteSegments(0, offs, &revision));
+
+    offs = {0, 1ULL << 30, 2ULL << 30};
+    EXPECT_CALL(*cache_, Remove(_)).Times(2 * offs.size());
+    EXPECT_CALL(*client_, TxnNWithRevision(SizeIs(offs.size()), _))
+        .WillOnce(DoAll(SetArgPointee<1>(10), Return(EtcdErrCode::EtcdOK)))
+        .WillOnce(Return(EtcdErrCode::EtcdAborted));
+    ASSERT_EQ(StoreStatus::OK, storage_->DeleteSegments(0, offs, &revision));
+    ASSERT_EQ(10, revision);
+    ASSERT_EQ(StoreStatus::InternalError,
+        storage_->DeleteSegments(0, offs, &revision));
+}
+
 TEST_F(TestNameServerStorageImp, test_Snapshotfile) {
     EXPECT_CALL(*client_, TxnN(_))
         .WillOnce(Return(EtcdErrCode::EtcdOK))
@@ -603,6 +603,61 @@ TEST(CoordinatorTest, test_QueryChunkServerRecoverStatus) {
     }
 }
 
+TEST(CoordinatorTest, test_IncrementalSchedule) {
+    auto topo = std::make_shared<MockTopology>();
+    auto metric = std::make_shared<ScheduleMetrics>(topo);
+    auto topoAdapter = std::make_shared<MockTopoAdapter>();
+    auto coordinator = std::make_shared<Coordinator>(topoAdapter);
+    ScheduleOption scheduleOption = GetScheduleOption();
+    scheduleOption.enableScanScheduler = false;
+    scheduleOption.enableRecoverScheduler = true;
+    // the full round will not be run during the test
+    scheduleOption.recoverSchedulerIntervalSec = 1000;
+    scheduleOption.chunkserverFailureTolerance = 3;
+    scheduleOption.scatterWithRangePerent = 0.2;
+    scheduleOption.enableIncrementalSchedule = true;
+    scheduleOption.incrementalScheduleIntervalMs = 10;
+    coordinator->InitScheduler(scheduleOption, metric);
+    gflags::SetCommandLineOption("enableRecoverScheduler", "true");
+
+    EXPECT_CALL(*topoAdapter, GetCopySetInfos()).Times(0);
+    EXPECT_CALL(*topoAdapter, GetChunkServerInfos())
+        .WillRepeatedly(Return(std::vector<ChunkServerInfo>{}));
+    EXPECT_CALL(*topoAdapter, GetCopySetInfosInChunkServer(1))
+        .WillOnce(Return(std::vector<CopySetInfo>{}));
+    EXPECT_CALL(*topoAdapter, GetCopySetInfo(CopySetKey{1, 1}, _))
+        .WillOnce(Return(false));
+
+    coordinator->Run();
+    coordinator->ChunkServerChanged(1);
+    coordinator->CopySetChanged(CopySetKey{1, 1});
+    ::usleep(200 * 1000);
+    coordinator->Stop();
+}
+
+TEST(CoordinatorTest, test_IncrementalSchedule_disabled) {
+    auto topo = std::make_shared<MockTopology>();
+    auto metric = std::make_shared<ScheduleMetrics>(topo);
+    auto topoAdapter = std::make_shared<MockTopoAdapter>();
+    auto coordinator = std::make_shared<Coordinator>(topoAdapter);
+    ScheduleOption scheduleOption = GetScheduleOption();
+    scheduleOption.enableScanScheduler = false;
+    scheduleOption.enableRecoverScheduler = true;
+    scheduleOption.recoverSchedulerIntervalSec = 1000;
+    coordinator->InitScheduler(scheduleOption, metric);
+
+    // changes are ignored if incremental schedule is disabled
+    EXPECT_CALL(*topoAdapter, GetCopySetInfos()).Times(0);
+    EXPECT_CALL(*topoAdapter, GetCopySetInfosInChunkServer(_)).Times(0);
+    EXPECT_CALL(*topoAdapter, GetCopySetInfo(_, _)).Times(0);
+
+    coordinator->Run();
+    coordinator->ChunkServerChanged(1);
+    coordinator->CopySetChanged(CopySetKey{1, 1});
+    ::usleep(200 * 1000);
+    coordinator->Stop();
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
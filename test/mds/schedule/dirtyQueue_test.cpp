@@ -0,0 +1,83 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-16
+ */
+
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>  //NOLINT
+#include <vector>
+#include "src/mds/schedule/dirtyQueue.h"
+
+using ::curve::mds::topology::CopySetIdType;
+
+namespace curve {
+namespace mds {
+namespace schedule {
+TEST(DirtyQueueTest, test_push_and_take) {
+    DirtyQueue queue;
+    std::set<CopySetKey> copysets;
+    std::set<ChunkServerIdType> chunkservers;
+    ASSERT_TRUE(queue.Empty());
+
+    // ids pushed repeatedly are merged
+    queue.PushCopySet(CopySetKey{1, 1});
+    queue.PushCopySet(CopySetKey{1, 1});
+    queue.PushCopySet(CopySetKey{1, 2});
+    queue.PushChunkServer(1);
+    queue.PushChunkServer(1);
+    ASSERT_FALSE(queue.Empty());
+    queue.Take(&copysets, &chunkservers);
+    ASSERT_TRUE(queue.Empty());
+    ASSERT_EQ(std::set<CopySetKey>({{1, 1}, {1, 2}}), copysets);
+    ASSERT_EQ(std::set<ChunkServerIdType>({1}), chunkservers);
+
+    queue.Take(&copysets, &chunkservers);
+    ASSERT_TRUE(copysets.empty());
+    ASSERT_TRUE(chunkservers.empty());
+
+    queue.PushChunkServer(2);
+    queue.Clear();
+    ASSERT_TRUE(queue.Empty());
+}
+
+TEST(DirtyQueueTest, test_concurrent_push) {
+    DirtyQueue queue;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&queue, i]() {
+            for (CopySetIdType id = 1; id <= 1000; id++) {
+                queue.PushCopySet(CopySetKey{1, id});
+                queue.PushChunkServer(i);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::set<CopySetKey> copysets;
+    std::set<ChunkServerIdType> chunkservers;
+    queue.Take(&copysets, &chunkservers);
+    ASSERT_EQ(1000, copysets.size());
+    ASSERT_EQ(4, chunkservers.size());
+}
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,168 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-17
+ */
+
+#include <gtest/gtest.h>
+#include "src/mds/schedule/recoverPlanner.h"
+#include "src/mds/schedule/operator.h"
+#include "src/mds/schedule/scheduleMetrics.h"
+#include "test/mds/schedule/mock_topoAdapter.h"
+#include "test/mds/mock/mock_topology.h"
+#include "test/mds/schedule/common.h"
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetArgPointee;
+using ::testing::DoAll;
+
+using ::curve::mds::topology::MockTopology;
+
+namespace curve {
+namespace mds {
+namespace schedule {
+
+namespace {
+const uint64_t kMB = 1024 * 1024;
+}  // namespace
+
+class TestRecoverPlanner : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        auto topo = std::make_shared<MockTopology>();
+        auto metric = std::make_shared<ScheduleMetrics>(topo);
+        opController_ = std::make_shared<OperatorController>(10, metric);
+        topoAdapter_ = std::make_shared<MockTopoAdapter>();
+
+        opt_.recoverClusterBandwidth = 100 * kMB;
+        opt_.recoverChunkServerBandwidth = 40 * kMB;
+        opt_.recoverOpDefaultBandwidth = 20 * kMB;
+    }
+
+    CopySetInfo CopySetWithLeader(CopySetIdType id, ChunkServerIdType leader) {
+        CopySetInfo info = GetCopySetInfoForTest();
+        info.id = CopySetKey{1, id};
+        info.leader = leader;
+        return info;
+    }
+
+ protected:
+    ScheduleOption opt_;
+    std::shared_ptr<MockTopoAdapter> topoAdapter_;
+    std::shared_ptr<OperatorController> opController_;
+};
+
+TEST_F(TestRecoverPlanner, test_disabled) {
+    opt_.recoverClusterBandwidth = 0;
+    RecoverPlanner planner(opt_, topoAdapter_, opController_);
+    ASSERT_FALSE(planner.Enabled());
+}
+
+TEST_F(TestRecoverPlanner, test_admission_without_observation) {
+    RecoverPlanner planner(opt_, topoAdapter_, opController_);
+    ASSERT_TRUE(planner.Enabled());
+    planner.Refresh();
+    // estimated by the default bandwidth
+    ASSERT_EQ(20 * kMB, planner.GetOpBandwidth());
+    ASSERT_EQ(5, planner.GetClusterOps());
+    ASSERT_EQ(2, planner.GetChunkServerOps());
+    ASSERT_EQ(0, planner.GetRunningNum());
+
+    planner.Admit(1, 4);
+    planner.Admit(1, 5);
+    ASSERT_FALSE(planner.Available(1));
+    ASSERT_TRUE(planner.Available(4));
+    ASSERT_EQ(std::set<ChunkServerIdType>({1}),
+              planner.SaturatedChunkServers());
+    planner.Admit(2, 4);
+    ASSERT_EQ(std::set<ChunkServerIdType>({1, 4}),
+              planner.SaturatedChunkServers());
+    planner.Admit(2, 6);
+    ASSERT_TRUE(planner.HasQuota());
+    planner.Admit(3, 7);
+    ASSERT_FALSE(planner.HasQuota());
+}
+
+TEST_F(TestRecoverPlanner, test_refresh_by_observed_throughput) {
+    // two recoveries from chunkserver-1, and a transfer leader which does
+    // not transfer data
+    ASSERT_TRUE(opController_->AddOperator(Operator(1, CopySetKey{1, 1},
+        OperatorPriority::HighPriority, steady_clock::now(),
+        std::make_shared<ChangePeer>(2, 4))));
+    ASSERT_TRUE(opController_->AddOperator(Operator(1, CopySetKey{1, 2},
+        OperatorPriority::HighPriority, steady_clock::now(),
+        std::make_shared<AddPeer>(5))));
+    ASSERT_TRUE(opController_->AddOperator(Operator(1, CopySetKey{1, 3},
+        OperatorPriority::NormalPriority, steady_clock::now(),
+        std::make_shared<TransferLeader>(1, 2))));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(CopySetKey{1, 1}, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(CopySetWithLeader(1, 1)), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(CopySetKey{1, 2}, _))
+        .WillRepeatedly(
+            DoAll(SetArgPointee<1>(CopySetWithLeader(2, 1)), Return(true)));
+    ChunkServerInfo source;
+    source.installSnapshotRate = 20 * kMB;
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(source), Return(true)));
+
+    RecoverPlanner planner(opt_, topoAdapter_, opController_);
+    planner.Refresh();
+    // 10MB/s for each recovery on chunkserver-1, smoothed with 20MB/s
+    ASSERT_EQ(15 * kMB, planner.GetOpBandwidth());
+    ASSERT_EQ(6, planner.GetClusterOps());
+    ASSERT_EQ(2, planner.GetChunkServerOps());
+    ASSERT_EQ(2, planner.GetRunningNum());
+    ASSERT_FALSE(planner.Available(1));
+    ASSERT_TRUE(planner.Available(4));
+    ASSERT_TRUE(planner.Available(5));
+
+    planner.Refresh();
+    ASSERT_EQ(25 * kMB / 2, planner.GetOpBandwidth());
+    ASSERT_EQ(8, planner.GetClusterOps());
+    ASSERT_EQ(3, planner.GetChunkServerOps());
+    ASSERT_EQ(2, planner.GetRunningNum());
+    ASSERT_TRUE(planner.Available(1));
+}
+
+TEST_F(TestRecoverPlanner, test_plan_by_turns_of_sources) {
+    RecoverPlanner planner(opt_, topoAdapter_, opController_);
+    planner.Refresh();
+    planner.Admit(1, 10);
+
+    std::vector<RecoverTask> tasks;
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(1, 1), 2});
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(2, 1), 2});
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(3, 1), 2});
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(4, 3), 2});
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(5, 2), 3});
+    tasks.emplace_back(RecoverTask{CopySetWithLeader(6, 3), 2});
+    planner.Plan(&tasks);
+
+    // chunkserver-1 is busy, so it goes last in every turn
+    std::vector<CopySetIdType> expected{5, 4, 1, 6, 2, 3};
+    ASSERT_EQ(expected.size(), tasks.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i], tasks[i].info.id.second);
+    }
+}
+
+}  // namespace schedule
+}  // namespace mds
+}  // namespace curve
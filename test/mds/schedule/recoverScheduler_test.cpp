@@ -332,6 +332,143 @@ TEST_F(TestRecoverSheduler, test_all_chunkServer_online_offline) {
         ASSERT_EQ(0, opController_->GetOperators().size());
     }
 }
+
+TEST_F(TestRecoverSheduler, test_incremental_schedule) {
+    auto testCopySetInfo = GetCopySetInfoForTest();
+    testCopySetInfo.logicalPoolWork = true;
+    ChunkServerInfo csInfo1(testCopySetInfo.peers[0], OnlineState::OFFLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo2(testCopySetInfo.peers[1], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo3(testCopySetInfo.peers[2], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    // only the copysets changed are checked
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos()).Times(0);
+
+    {
+        // 1. nothing changed
+        ASSERT_FALSE(recoverScheduler_->HasDirty());
+        recoverScheduler_->IncrementalSchedule();
+        ASSERT_EQ(0, opController_->GetOperators().size());
+    }
+
+    {
+        // 2. chunkserver-1 offline, its copysets are checked, and the copyset
+        //    marked repeatedly or not found is skipped
+        recoverScheduler_->MarkChunkServerDirty(1);
+        recoverScheduler_->MarkCopySetDirty(testCopySetInfo.id);
+        recoverScheduler_->MarkCopySetDirty(CopySetKey{1, 100});
+        ASSERT_TRUE(recoverScheduler_->HasDirty());
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfosInChunkServer(1))
+            .WillOnce(Return(std::vector<CopySetInfo>({testCopySetInfo})));
+        EXPECT_CALL(*topoAdapter_, GetCopySetInfo(CopySetKey{1, 100}, _))
+            .WillOnce(Return(false));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+            .WillOnce(Return(std::vector<ChunkServerInfo>{}));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(1, _))
+            .WillOnce(DoAll(SetArgPointee<1>(csInfo1), Return(true)));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(2, _))
+            .WillOnce(DoAll(SetArgPointee<1>(csInfo2), Return(true)));
+        EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(3, _))
+            .WillOnce(DoAll(SetArgPointee<1>(csInfo3), Return(true)));
+        EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+            .WillOnce(Return(2));
+        recoverScheduler_->IncrementalSchedule();
+        ASSERT_FALSE(recoverScheduler_->HasDirty());
+        Operator op;
+        ASSERT_TRUE(opController_->GetOperatorById(testCopySetInfo.id, &op));
+        ASSERT_TRUE(dynamic_cast<RemovePeer *>(op.step.get()) != nullptr);
+    }
+}
+
+TEST_F(TestRecoverSheduler, test_recover_limited_by_bandwidth) {
+    ScheduleOption opt;
+    opt.addPeerTimeLimitSec = 1000;
+    opt.changePeerTimeLimitSec = 1000;
+    opt.recoverSchedulerIntervalSec = 1;
+    opt.scatterWithRangePerent = 0.2;
+    opt.chunkserverFailureTolerance = 3;
+    // only one recovery can run in the cluster
+    opt.recoverClusterBandwidth = 20 * 1024 * 1024;
+    opt.recoverOpDefaultBandwidth = 20 * 1024 * 1024;
+    recoverScheduler_ = std::make_shared<RecoverScheduler>(
+        opt, topoAdapter_, opController_);
+
+    auto copyset1 = GetCopySetInfoForTest();
+    auto copyset2 = GetCopySetInfoForTest();
+    copyset2.id.second = 2;
+    ChunkServerInfo csInfo1(copyset1.peers[0], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo2(copyset1.peers[1], OnlineState::OFFLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    ChunkServerInfo csInfo3(copyset1.peers[2], OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    PeerInfo peer4(4, 4, 4, "192.168.10.4", 9000);
+    ChunkServerInfo csInfo4(peer4, OnlineState::ONLINE,
+                            DiskState::DISKNORMAL, ChunkServerStatus::READWRITE,
+                            2, 100, 100, ChunkServerStatisticInfo{});
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos())
+        .WillRepeatedly(
+            Return(std::vector<CopySetInfo>({copyset1, copyset2})));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copyset1.id, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset1), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(copyset2.id, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(copyset2), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfos())
+        .WillRepeatedly(Return(std::vector<ChunkServerInfo>{}));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(1, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo1), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(2, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo2), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerInfo(3, _))
+        .WillRepeatedly(DoAll(SetArgPointee<1>(csInfo3), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillRepeatedly(Return(3));
+    EXPECT_CALL(*topoAdapter_, GetStandardZoneNumInLogicalPool(_))
+        .WillRepeatedly(Return(3));
+    EXPECT_CALL(*topoAdapter_, GetAvgScatterWidthInLogicalPool(_))
+        .WillRepeatedly(Return(90));
+    EXPECT_CALL(*topoAdapter_, GetChunkServersInLogicalPool(_))
+        .WillRepeatedly(Return(std::vector<ChunkServerInfo>(
+            {csInfo1, csInfo2, csInfo3, csInfo4})));
+    EXPECT_CALL(*topoAdapter_, GetChunkServerScatterMap(_, _))
+        .WillRepeatedly(SetArgPointee<1>(std::map<ChunkServerIdType, int>{}));
+    EXPECT_CALL(*topoAdapter_, CreateCopySetAtChunkServer(_, 4))
+        .Times(2).WillRepeatedly(Return(true));
+
+    {
+        // 1. the recovery of copyset2 waits for bandwidth
+        recoverScheduler_->Schedule();
+        ASSERT_EQ(1, opController_->GetOperators().size());
+        Operator op;
+        ASSERT_TRUE(opController_->GetOperatorById(copyset1.id, &op));
+        ASSERT_TRUE(dynamic_cast<ChangePeer *>(op.step.get()) != nullptr);
+        ASSERT_EQ(4, op.step->GetTargetPeer());
+    }
+
+    {
+        // 2. still no bandwidth
+        recoverScheduler_->IncrementalSchedule();
+        ASSERT_EQ(1, opController_->GetOperators().size());
+    }
+
+    {
+        // 3. the recovery of copyset1 finished, copyset2 is recovered
+        opController_->RemoveOperator(copyset1.id);
+        recoverScheduler_->IncrementalSchedule();
+        ASSERT_EQ(1, opController_->GetOperators().size());
+        Operator op;
+        ASSERT_TRUE(opController_->GetOperatorById(copyset2.id, &op));
+        ASSERT_EQ(4, op.step->GetTargetPeer());
+    }
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
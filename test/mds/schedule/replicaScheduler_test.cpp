@@ -395,6 +395,29 @@ TEST_F(TestReplicaSchedule, test_copySet_has_larger_replicaNum_selectpendding) {
     ASSERT_EQ(res->GetTargetPeer(), 4);
 }
 
+TEST_F(TestReplicaSchedule, test_incremental_schedule) {
+    auto testCopySetInfo = GetCopySetInfoForTest();
+    testCopySetInfo.logicalPoolWork = true;
+    PeerInfo peer4(4, 4, 4, "192.168.10.4", 9000);
+    testCopySetInfo.peers.emplace_back(peer4);
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfos()).Times(0);
+
+    // the copyset changed has larger replica number, but the
+    // redundant replica can not be selected
+    replicaScheduler_->MarkCopySetDirty(testCopySetInfo.id);
+    EXPECT_CALL(*topoAdapter_, GetCopySetInfo(testCopySetInfo.id, _))
+        .WillOnce(DoAll(SetArgPointee<1>(testCopySetInfo), Return(true)));
+    EXPECT_CALL(*topoAdapter_, GetStandardReplicaNumInLogicalPool(_))
+        .WillOnce(Return(3)).WillOnce(Return(0));
+    replicaScheduler_->IncrementalSchedule();
+    ASSERT_FALSE(replicaScheduler_->HasDirty());
+    ASSERT_EQ(0, opController_->GetOperators().size());
+
+    // nothing to check if nothing changed
+    replicaScheduler_->IncrementalSchedule();
+    ASSERT_EQ(0, opController_->GetOperators().size());
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
@@ -39,6 +39,7 @@
 #include "src/mds/copyset/copyset_policy.h"
 #include "src/mds/copyset/copyset_manager.h"
 #include "src/mds/schedule/scheduleMetrics.h"
+#include "src/common/timeutility.h"
 #include "test/mds/schedule/schedulerPOC/mock_topology.h"
 #include "test/mds/mock/mock_topology.h"
 
@@ -60,6 +61,8 @@ using ::curve::mds::topology::OnlineState;
 
 using ::curve::mds::topology::ChunkServerFilter;
 using ::curve::mds::topology::CopySetFilter;
+using ::curve::mds::topology::ChunkServerLoadMap;
+using ::curve::mds::topology::CopySetLoadMap;
 
 using ::curve::mds::copyset::ChunkServerInfo;
 using ::curve::mds::copyset::ClusterInfo;
@@ -83,11 +86,9 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
                        std::make_shared<MockTokenGenerator>(),
                        std::make_shared<MockStorage>()) {}
 
-    void BuildMassiveTopo() {
-        constexpr int serverNum = 9;
-        constexpr int diskNumPerServer = 20;
+    void BuildMassiveTopo(int serverNum = 9, int diskNumPerServer = 20,
+                          int numCopysets = 6000) {
         constexpr int zoneNum = 3;
-        constexpr int numCopysets = 6000;
 
         // gen server
         for (int i = 1; i <= serverNum; i++) {
@@ -206,7 +207,7 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
             return true;
         }) const override {
         std::vector<CopySetKey> ret;
-        for (auto it : copySetMap_) {
+        for (const auto &it : copySetMap_) {
             if (it.second.GetCopySetMembers().count(csId) > 0) {
                 ret.push_back(it.first);
             }
@@ -263,7 +264,7 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
     bool GetLogicalPool(PoolIdType poolId, LogicalPool *out) const override {
         LogicalPool::RedundanceAndPlaceMentPolicy rap;
         rap.pageFileRAP.copysetNum = copySetMap_.size();
-        rap.pageFileRAP.replicaNum = 3;
+        rap.pageFileRAP.replicaNum = replicaNum_;
         rap.pageFileRAP.zoneNum = 3;
 
         LogicalPool pool(0, "logicalpool-0", 1, LogicalPoolType::PAGEFILE, rap,
@@ -284,6 +285,10 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
         }
     }
 
+    void SetReplicaNum(int replicaNum) {
+        replicaNum_ = replicaNum;
+    }
+
     int UpdateChunkServerRwState(const ChunkServerStatus &rwStatus,
                                  ChunkServerIdType id) {
         auto it = chunkServerMap_.find(id);
@@ -314,6 +319,7 @@ class FakeTopo : public ::curve::mds::topology::TopologyImpl {
     std::map<CopySetKey, ::curve::mds::topology::CopySetInfo> copySetMap_;
     std::set<PoolIdType> logicalPoolSet_;
     ClusterInfo cluster_;
+    int replicaNum_ = 3;
 };
 
 class FakeTopologyServiceManager : public TopologyServiceManager {
@@ -363,6 +369,8 @@ class FakeTopologyStat : public TopologyStat {
     bool GetChunkPoolSize(PoolIdType pId, uint64_t *chunkPoolSize) {
         return true;
     }
+    void GetIOLoads(ChunkServerLoadMap *chunkServerLoads,
+                    CopySetLoadMap *copySetLoads) {}
 
  private:
     std::shared_ptr<Topology> topo_;
@@ -1332,6 +1340,82 @@ TEST_F(CopysetSchedulerPOC, test_rapidleader_rebalance) {
     ASSERT_LE(GetLeaderCountRange(), 5);
     leaderCountOn = false;
 }
+
+// 大规模集群下对比全量调度和增量调度:
+// 1. 没有故障时每一轮调度的开销, 增量模式下只检查心跳上报变化的copyset
+// 2. chunkserver offline之后生成所有恢复operator的时间(time-to-recover-schedule),
+//    全量模式平均要等待半个recoverSchedulerIntervalSec才能发现,
+//    增量模式平均等待半个incrementalScheduleIntervalMs
+// 标准副本数设置为2, 恢复时直接remove offline副本, 避免选择目标chunkserver的开销
+// 掩盖扫描的开销
+TEST_F(CopysetSchedulerPOC, DISABLED_test_time_to_recover_schedule) {
+    using ::curve::common::TimeUtility;
+    constexpr int serverNum = 60;
+    constexpr int diskNumPerServer = 20;
+    constexpr int numCopysets = 100000;
+    constexpr int changedPerRound = 100;
+    opt.recoverSchedulerIntervalSec = 5;
+    opt.enableIncrementalSchedule = true;
+    opt.incrementalScheduleIntervalMs = 100;
+
+    std::shared_ptr<FakeTopo> fakeTopo = std::make_shared<FakeTopo>();
+    fakeTopo->BuildMassiveTopo(serverNum, diskNumPerServer, numCopysets);
+    fakeTopo->SetReplicaNum(2);
+    topo_ = fakeTopo;
+    topoStat_ = std::make_shared<FakeTopologyStat>(topo_);
+    std::vector<CopySetKey> copysets = topo_->GetCopySetsInCluster();
+
+    // 1. 没有故障, 每轮有changedPerRound个copyset变化
+    BuilRecoverScheduler(numCopysets);
+    uint64_t start = TimeUtility::GetTimeofDayUs();
+    recoverScheduler_->Schedule();
+    uint64_t fullRoundUs = TimeUtility::GetTimeofDayUs() - start;
+    ASSERT_EQ(0, opController_->GetOperators().size());
+
+    for (int i = 0; i < changedPerRound; i++) {
+        recoverScheduler_->MarkCopySetDirty(
+            copysets[i * copysets.size() / changedPerRound]);
+    }
+    start = TimeUtility::GetTimeofDayUs();
+    recoverScheduler_->IncrementalSchedule();
+    uint64_t incrementalRoundUs = TimeUtility::GetTimeofDayUs() - start;
+    ASSERT_EQ(0, opController_->GetOperators().size());
+    LOG(INFO) << "cluster with " << serverNum * diskNumPerServer
+              << " chunkservers and " << copysets.size()
+              << " copysets, full round cost " << fullRoundUs
+              << " us, incremental round with " << changedPerRound
+              << " changed copysets cost " << incrementalRoundUs << " us";
+
+    // 2. 一个chunkserver offline
+    ChunkServerIdType offline = 1;
+    size_t expectOpNum = topo_->GetCopySetsInChunkServer(offline).size();
+    topo_->UpdateChunkServerOnlineState(OnlineState::OFFLINE, offline);
+
+    BuilRecoverScheduler(numCopysets);
+    start = TimeUtility::GetTimeofDayUs();
+    recoverScheduler_->Schedule();
+    uint64_t fullRecoverUs = TimeUtility::GetTimeofDayUs() - start;
+    ASSERT_EQ(expectOpNum, opController_->GetOperators().size());
+
+    BuilRecoverScheduler(numCopysets);
+    recoverScheduler_->MarkChunkServerDirty(offline);
+    start = TimeUtility::GetTimeofDayUs();
+    recoverScheduler_->IncrementalSchedule();
+    uint64_t incrementalRecoverUs = TimeUtility::GetTimeofDayUs() - start;
+    ASSERT_EQ(expectOpNum, opController_->GetOperators().size());
+
+    LOG(INFO) << "chunkserver " << offline << " with " << expectOpNum
+              << " copysets offline, full mode: round cost " << fullRecoverUs
+              << " us, time-to-recover-schedule "
+              << opt.recoverSchedulerIntervalSec * 1000 / 2 +
+                 fullRecoverUs / 1000
+              << " ms on average; incremental mode: round cost "
+              << incrementalRecoverUs << " us, time-to-recover-schedule "
+              << opt.incrementalScheduleIntervalMs / 2 +
+                 incrementalRecoverUs / 1000
+              << " ms on average";
+}
+
 }  // namespace schedule
 }  // namespace mds
 }  // namespace curve
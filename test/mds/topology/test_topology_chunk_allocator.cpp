@@ -23,8 +23,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
 #include <memory>
-
+#include <random>
+#include <set>
+#include <vector>
 
 #include "src/mds/topology/topology_chunk_allocator.h"
 #include "src/mds/common/mds_define.h"
@@ -572,6 +577,77 @@ TEST_F(TestTopologyChunkAllocator,
     ASSERT_FALSE(ret);
 }
 
+TEST_F(TestTopologyChunkAllocator,
+    Test_AllocateChunkRoundRobinInSingleLogicalPool_loadAware) {
+    std::vector<CopysetIdInfo> infos;
+    PrepareAddPoolset();
+    PoolIdType logicalPoolId = 0x01;
+    PoolIdType physicalPoolId = 0x11;
+
+    PrepareAddPhysicalPool(physicalPoolId);
+    PrepareAddZone(0x21, "zone1", physicalPoolId);
+    PrepareAddZone(0x22, "zone2", physicalPoolId);
+    PrepareAddZone(0x23, "zone3", physicalPoolId);
+    PrepareAddServer(0x31, "server1", "127.0.0.1", "127.0.0.1", 0x21, 0x11);
+    PrepareAddServer(0x32, "server2", "127.0.0.1", "127.0.0.1", 0x22, 0x11);
+    PrepareAddServer(0x33, "server3", "127.0.0.1", "127.0.0.1", 0x23, 0x11);
+    PrepareAddChunkServer(0x41, "token1", "nvme", 0x31, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x42, "token2", "nvme", 0x32, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x43, "token3", "nvme", 0x33, "127.0.0.1", 8200);
+    PrepareAddChunkServer(0x44, "token4", "nvme", 0x31, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x45, "token5", "nvme", 0x32, "127.0.0.1", 8201);
+    PrepareAddChunkServer(0x46, "token6", "nvme", 0x33, "127.0.0.1", 8201);
+    PrepareAddLogicalPool(logicalPoolId, "logicalPool1", physicalPoolId,
+        PAGEFILE);
+    PrepareAddCopySet(0x51, logicalPoolId, {0x41, 0x42, 0x43});
+    PrepareAddCopySet(0x52, logicalPoolId, {0x44, 0x45, 0x46});
+
+    // chunkservers of copyset 0x51 are busy
+    for (ChunkServerIdType id = 0x41; id <= 0x46; id++) {
+        ChunkServerStat stat;
+        stat.chunkFilepoolSize = 512;
+        if (id <= 0x43) {
+            stat.writeIOPS = 10000;
+            stat.writeRate = 100 * 1024 * 1024;
+            stat.writeLatency = 5000;
+        } else {
+            stat.writeIOPS = 100;
+            stat.writeRate = 1024 * 1024;
+            stat.writeLatency = 500;
+        }
+        topoStat_->UpdateChunkServerStat(id, stat);
+    }
+
+    TopologyOption option;
+    option.PoolUsagePercentLimit = 85;
+    option.chooseCopySetPolicy =
+        static_cast<int>(ChooseCopySetPolicy::kLoadAware);
+    auto allocator = std::make_shared<TopologyChunkAllocatorImpl>(topology_,
+        allocStatistic_, topoStat_, chunkFilePoolAllocHelp_, option);
+
+    EXPECT_CALL(*allocStatistic_, GetAllocByLogicalPool(_, _))
+        .WillRepeatedly(Return(true));
+
+    bool ret =
+        allocator->AllocateChunkRoundRobinInSingleLogicalPool(INODE_PAGEFILE,
+            "testPoolset",
+            100,
+            1024,
+            &infos);
+    ASSERT_TRUE(ret);
+    ASSERT_EQ(100, infos.size());
+
+    int idleCount = 0;
+    for (const auto &info : infos) {
+        ASSERT_EQ(logicalPoolId, info.logicalPoolId);
+        if (info.copySetId == 0x52) {
+            idleCount++;
+        }
+    }
+    // copyset 0x51 is chosen only if both choices are 0x51
+    ASSERT_GT(idleCount, 50);
+}
+
 TEST(TestAllocateChunkPolicy, TestAllocateChunkRandomInSingleLogicalPoolPoc) {
     // 2000个copyset分配100000次，每次分配64个chunk
     std::vector<CopySetIdType> copySetIds;
@@ -771,6 +847,195 @@ TEST(TestAllocateChunkPolicy,
     }
 }
 
+TEST(TestAllocateChunkPolicy, TestCalcLoadScore) {
+    IOLoad avg;
+    IOLoad load;
+    // no statistics
+    ASSERT_DOUBLE_EQ(0, AllocateChunkPolicy::CalcLoadScore(load, avg));
+
+    avg.iops = 100;
+    avg.bandwidth = 1000;
+    avg.latency = 10;
+    load.iops = 200;
+    load.bandwidth = 500;
+    load.latency = 10;
+    ASSERT_DOUBLE_EQ(3.5, AllocateChunkPolicy::CalcLoadScore(load, avg));
+    ASSERT_DOUBLE_EQ(3, AllocateChunkPolicy::CalcLoadScore(avg, avg));
+}
+
+TEST(TestAllocateChunkPolicy, TestAllocateChunkByLoadInSingleLogicalPool) {
+    std::vector<CopySetIdType> copySetIds;
+    std::vector<CopysetIdInfo> infos;
+    auto loadFunc = [](CopySetIdType id) {
+        return static_cast<double>(id);
+    };
+    ASSERT_FALSE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, 1, 10, loadFunc, 0, &infos));
+
+    for (CopySetIdType i = 0; i < 10; i++) {
+        copySetIds.push_back(i);
+    }
+    std::map<CopySetIdType, int> counts;
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, 1, 10000, loadFunc, 0, &infos));
+    ASSERT_EQ(10000, infos.size());
+    for (const auto &info : infos) {
+        ASSERT_EQ(1, info.logicalPoolId);
+        counts[info.copySetId]++;
+    }
+    // copyset i is chosen with probability (19 - 2i) / 100
+    for (CopySetIdType i = 1; i < 10; i++) {
+        ASSERT_LT(counts[i], counts[i - 1]);
+    }
+    ASSERT_LT(counts[9], 300);
+
+    // with the same load, chunks allocated in this round make copysets
+    // heavier, so chunks are spread evenly
+    counts.clear();
+    ASSERT_TRUE(AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+        copySetIds, 1, 10000, [](CopySetIdType) { return 0.0; }, 0.01,
+        &infos));
+    for (const auto &info : infos) {
+        counts[info.copySetId]++;
+    }
+    for (const auto &it : counts) {
+        ASSERT_NEAR(1000, it.second, 100);
+    }
+}
+
+namespace {
+
+struct PlacementResult {
+    // max load / average load of chunkservers
+    double maxRatio;
+    // standard deviation / average load of chunkservers
+    double cv;
+};
+
+// Replay a synthetic trace: volumes with skewed iops are created one by one
+// on a cluster whose chunkservers have uneven background load, and the
+// chunkserver load is reported to the allocator periodically like
+// heartbeat does. Return the load imbalance after all volumes are created.
+PlacementResult SimulatePlacement(ChooseCopySetPolicy policy) {
+    const int kChunkServerNum = 90;
+    const int kCopySetNum = 3000;
+    const int kVolumeNum = 300;
+    const int kChunkPerVolume = 640;
+    const int kHeartbeatVolumes = 10;
+    const double kChunkServerCapacity = 20000;
+    std::mt19937 gen(1);
+
+    // copysets are placed on three chunkservers randomly
+    std::vector<std::vector<int>> members(kCopySetNum);
+    std::vector<CopySetIdType> copySetIds;
+    std::uniform_int_distribution<> csDis(0, kChunkServerNum - 1);
+    for (int i = 0; i < kCopySetNum; i++) {
+        std::set<int> peers;
+        while (peers.size() < 3) {
+            peers.emplace(csDis(gen));
+        }
+        members[i].assign(peers.begin(), peers.end());
+        copySetIds.push_back(i);
+    }
+
+    // one in ten chunkservers is busy with existing volumes
+    std::vector<double> iops(kChunkServerNum);
+    for (int i = 0; i < kChunkServerNum; i++) {
+        iops[i] = (i % 10 == 0) ? 8000 : 1000;
+    }
+
+    // load scores seen by the allocator, refreshed by heartbeat
+    std::vector<double> scores(kChunkServerNum, 0);
+    std::vector<uint32_t> allocated(kCopySetNum, 0);
+    auto heartbeat = [&]() {
+        IOLoad avg;
+        std::vector<IOLoad> loads(kChunkServerNum);
+        for (int i = 0; i < kChunkServerNum; i++) {
+            loads[i].iops = iops[i];
+            // 4KB io
+            loads[i].bandwidth = iops[i] * 4096;
+            // latency grows with utilization
+            loads[i].latency = 200 / std::max(0.05,
+                1 - iops[i] / kChunkServerCapacity);
+            avg.iops += loads[i].iops;
+            avg.bandwidth += loads[i].bandwidth;
+            avg.latency += loads[i].latency;
+        }
+        avg.iops /= kChunkServerNum;
+        avg.bandwidth /= kChunkServerNum;
+        avg.latency /= kChunkServerNum;
+        for (int i = 0; i < kChunkServerNum; i++) {
+            scores[i] = AllocateChunkPolicy::CalcLoadScore(loads[i], avg);
+        }
+        std::fill(allocated.begin(), allocated.end(), 0);
+    };
+    auto loadFunc = [&](CopySetIdType id) {
+        double score = 0;
+        for (int cs : members[id]) {
+            score = std::max(score, scores[cs]);
+        }
+        return score + allocated[id] * 0.01;
+    };
+
+    // iops of volumes follow a pareto distribution, a few are very hot
+    std::uniform_real_distribution<> uniform(0.0001, 1);
+    uint32_t nextIndex = 0;
+    heartbeat();
+    for (int v = 0; v < kVolumeNum; v++) {
+        double volumeIops = std::min(100.0 / std::pow(uniform(gen), 0.8),
+                                     20000.0);
+        std::vector<CopysetIdInfo> infos;
+        if (policy == ChooseCopySetPolicy::kLoadAware) {
+            AllocateChunkPolicy::AllocateChunkByLoadInSingleLogicalPool(
+                copySetIds, 1, kChunkPerVolume, loadFunc, 0.01, &infos);
+        } else {
+            AllocateChunkPolicy::AllocateChunkRoundRobinInSingleLogicalPool(
+                copySetIds, 1, &nextIndex, kChunkPerVolume, &infos);
+        }
+        for (const auto &info : infos) {
+            allocated[info.copySetId]++;
+            // writes go to all replicas
+            for (int cs : members[info.copySetId]) {
+                iops[cs] += volumeIops / kChunkPerVolume;
+            }
+        }
+        if ((v + 1) % kHeartbeatVolumes == 0) {
+            heartbeat();
+        }
+    }
+
+    double sum = 0;
+    double max = 0;
+    for (double load : iops) {
+        sum += load;
+        max = std::max(max, load);
+    }
+    double avg = sum / kChunkServerNum;
+    double variance = 0;
+    for (double load : iops) {
+        variance += (load - avg) * (load - avg);
+    }
+    PlacementResult result;
+    result.maxRatio = max / avg;
+    result.cv = std::sqrt(variance / kChunkServerNum) / avg;
+    return result;
+}
+
+}  // namespace
+
+TEST(TestAllocateChunkPolicy, TestAllocateChunkByLoadSimulator) {
+    PlacementResult roundRobin =
+        SimulatePlacement(ChooseCopySetPolicy::kRoundRobin);
+    PlacementResult loadAware =
+        SimulatePlacement(ChooseCopySetPolicy::kLoadAware);
+    LOG(INFO) << "chunkserver load imbalance, round robin: max/avg = "
+              << roundRobin.maxRatio << ", cv = " << roundRobin.cv
+              << "; load aware: max/avg = " << loadAware.maxRatio
+              << ", cv = " << loadAware.cv;
+    ASSERT_LT(loadAware.maxRatio, roundRobin.maxRatio);
+    ASSERT_LT(loadAware.cv, roundRobin.cv);
+}
+
 }  // namespace topology
 }  // namespace mds
 }  // namespace curve
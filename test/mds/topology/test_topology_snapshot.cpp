@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-13
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test/mds/topology/mock_topology.h"
+#include "src/mds/topology/topology.h"
+#include "src/mds/topology/topology_snapshot.h"
+#include "src/common/namespace_define.h"
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+using ::testing::Return;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::curve::common::kDefaultPoolsetId;
+
+TEST(TestSnapshotMap, test_copy_on_write) {
+    SnapshotMap<int, std::string> origin(4);
+    for (int i = 0; i < 100; i++) {
+        origin.Put(i, std::make_shared<const std::string>(std::to_string(i)));
+    }
+    ASSERT_EQ(100, origin.Size());
+
+    SnapshotMap<int, std::string> copy(origin);
+    copy.Put(1, std::make_shared<const std::string>("new"));
+    copy.Put(100, std::make_shared<const std::string>("100"));
+    ASSERT_TRUE(copy.Erase(2));
+    ASSERT_FALSE(copy.Erase(200));
+
+    // origin is not changed
+    ASSERT_EQ(100, origin.Size());
+    ASSERT_EQ("1", *origin.Find(1));
+    ASSERT_EQ("2", *origin.Find(2));
+    ASSERT_EQ(nullptr, origin.Find(100));
+
+    ASSERT_EQ(100, copy.Size());
+    ASSERT_EQ("new", *copy.Find(1));
+    ASSERT_EQ(nullptr, copy.Find(2));
+    ASSERT_EQ("100", *copy.Find(100));
+    // untouched items are shared
+    ASSERT_EQ(origin.Find(50), copy.Find(50));
+
+    int count = 0;
+    copy.ForEach([&](const std::string &) { count++; });
+    ASSERT_EQ(100, count);
+}
+
+TEST(TestTopologySnapshotBuilder, test_build_and_available_copysets) {
+    TopologySnapshotBuilder builder(nullptr);
+    std::unordered_map<PoolIdType, LogicalPool> lpools;
+    lpools[0x01] = LogicalPool(0x01, "lpool1", 0x11, PAGEFILE,
+        LogicalPool::RedundanceAndPlaceMentPolicy(),
+        LogicalPool::UserPolicy(), 0, true, true);
+    builder.SetLogicalPools(lpools);
+    builder.PutChunkServer(ChunkServer(0x41, "token", "ssd",
+        0x31, "127.0.0.1", 8200, "/"));
+    for (CopySetIdType id = 10; id > 0; id--) {
+        CopySetInfo info(0x01, id);
+        info.SetAvailableFlag(id % 2 == 0);
+        builder.PutCopySet(info);
+    }
+    auto first = builder.Build(100);
+    ASSERT_EQ(1, first->GetEpoch());
+    ASSERT_EQ(100, first->GetCreateTimeMs());
+    ASSERT_EQ(10, first->GetCopySetNum());
+    ASSERT_EQ(1, first->GetChunkServerNum());
+    ASSERT_NE(nullptr, first->FindLogicalPool(0x01));
+    ASSERT_EQ(nullptr, first->FindLogicalPool(0x02));
+
+    std::vector<CopySetIdType> expect{2, 4, 6, 8, 10};
+    ASSERT_EQ(expect, *first->GetAvailableCopySetsInLogicalPool(0x01));
+    ASSERT_TRUE(first->GetAvailableCopySetsInLogicalPool(0x02)->empty());
+
+    std::vector<CopySetKey> keys = first->GetCopySetsInCluster();
+    ASSERT_EQ(10, keys.size());
+    ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+
+    // build the next snapshot from the first one
+    TopologySnapshotBuilder next(first);
+    CopySetInfo info(0x01, 1);
+    info.SetAvailableFlag(true);
+    next.PutCopySet(info);
+    next.RemoveCopySet(CopySetKey(0x01, 2));
+    next.RemoveChunkServer(0x41);
+    auto second = next.Build(200);
+    ASSERT_EQ(2, second->GetEpoch());
+    ASSERT_EQ(9, second->GetCopySetNum());
+    ASSERT_EQ(0, second->GetChunkServerNum());
+    expect = {1, 4, 6, 8, 10};
+    ASSERT_EQ(expect, *second->GetAvailableCopySetsInLogicalPool(0x01));
+
+    // the first snapshot is not changed
+    expect = {2, 4, 6, 8, 10};
+    ASSERT_EQ(expect, *first->GetAvailableCopySetsInLogicalPool(0x01));
+    ASSERT_EQ(10, first->GetCopySetNum());
+    ASSERT_NE(nullptr, first->FindChunkServer(0x41));
+    ASSERT_NE(nullptr, first->FindCopySet(CopySetKey(0x01, 2)));
+}
+
+class TestTopologySnapshot : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        idGenerator_ = std::make_shared<NiceMock<MockIdGenerator>>();
+        tokenGenerator_ = std::make_shared<MockTokenGenerator>();
+        storage_ = std::make_shared<NiceMock<MockStorage>>();
+        topology_ = std::make_shared<TopologyImpl>(idGenerator_,
+                                                   tokenGenerator_,
+                                                   storage_);
+        ON_CALL(*storage_, LoadClusterInfo(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageClusterInfo(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadPoolset(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadLogicalPool(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadPhysicalPool(_, _))
+            .WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadZone(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadServer(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadChunkServer(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadCopySet(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StoragePoolset(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageLogicalPool(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StoragePhysicalPool(_))
+            .WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageZone(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageServer(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageChunkServer(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageCopySet(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, UpdateCopySet(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, DeleteCopySet(_)).WillByDefault(Return(true));
+    }
+
+    void InitTopology(uint32_t snapshotRefreshIntervalMs) {
+        TopologyOption option;
+        option.snapshotRefreshIntervalMs = snapshotRefreshIntervalMs;
+        // the default poolset is created by Init
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->Init(option));
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddPhysicalPool(
+            PhysicalPool(0x11, "pPool1", kDefaultPoolsetId, "desc")));
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddZone(
+            Zone(0x21, "zone1", 0x11, "desc")));
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddServer(
+            Server(0x31, "server1", "127.0.0.1", 8200,
+                   "127.0.0.1", 8200, 0x21, 0x11, "desc")));
+        for (ChunkServerIdType id = 0x41; id < 0x44; id++) {
+            ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddChunkServer(
+                ChunkServer(id, "token", "ssd", 0x31, "127.0.0.1",
+                            8200 + id, "/")));
+        }
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddLogicalPool(
+            LogicalPool(0x01, "lpool1", 0x11, PAGEFILE,
+                LogicalPool::RedundanceAndPlaceMentPolicy(),
+                LogicalPool::UserPolicy(), 0, true, true)));
+    }
+
+    void AddCopySet(CopySetIdType id) {
+        CopySetInfo info(0x01, id);
+        info.SetCopySetMembers({0x41, 0x42, 0x43});
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddCopySet(info));
+    }
+
+ protected:
+    std::shared_ptr<NiceMock<MockIdGenerator>> idGenerator_;
+    std::shared_ptr<MockTokenGenerator> tokenGenerator_;
+    std::shared_ptr<NiceMock<MockStorage>> storage_;
+    std::shared_ptr<TopologyImpl> topology_;
+};
+
+TEST_F(TestTopologySnapshot, test_snapshot_follows_topology) {
+    InitTopology(0);
+    auto first = topology_->GetSnapshot();
+    ASSERT_NE(nullptr, first);
+    ASSERT_EQ(3, first->GetChunkServerNum());
+    ASSERT_EQ(0, first->GetCopySetNum());
+    ASSERT_NE(nullptr, first->FindLogicalPool(0x01));
+    // not changed, the same snapshot is returned
+    ASSERT_EQ(first, topology_->GetSnapshot());
+
+    for (CopySetIdType id = 1; id <= 10; id++) {
+        AddCopySet(id);
+    }
+    auto second = topology_->GetSnapshot();
+    ASSERT_GT(second->GetEpoch(), first->GetEpoch());
+    ASSERT_EQ(10, second->GetCopySetNum());
+    ASSERT_EQ(10, second->GetAvailableCopySetsInLogicalPool(0x01)->size());
+    ASSERT_EQ(0, first->GetCopySetNum());
+
+    // update leader and epoch like heartbeat does
+    CopySetInfo info;
+    ASSERT_TRUE(topology_->GetCopySet(CopySetKey(0x01, 1), &info));
+    info.SetLeader(0x42);
+    info.SetEpoch(5);
+    ASSERT_EQ(kTopoErrCodeSuccess, topology_->UpdateCopySetTopo(info));
+    ASSERT_EQ(kTopoErrCodeSuccess,
+        topology_->SetCopySetAvalFlag(CopySetKey(0x01, 2), false));
+    ASSERT_EQ(kTopoErrCodeSuccess,
+        topology_->RemoveCopySet(CopySetKey(0x01, 3)));
+    ASSERT_EQ(kTopoErrCodeSuccess,
+        topology_->UpdateChunkServerOnlineState(OnlineState::ONLINE, 0x43));
+
+    auto third = topology_->GetSnapshot();
+    ASSERT_EQ(9, third->GetCopySetNum());
+    const CopySetInfo *copyset = third->FindCopySet(CopySetKey(0x01, 1));
+    ASSERT_NE(nullptr, copyset);
+    ASSERT_EQ(0x42, copyset->GetLeader());
+    ASSERT_EQ(5, copyset->GetEpoch());
+    std::vector<CopySetIdType> expect{1, 4, 5, 6, 7, 8, 9, 10};
+    ASSERT_EQ(expect, *third->GetAvailableCopySetsInLogicalPool(0x01));
+    ASSERT_EQ(OnlineState::ONLINE,
+        third->FindChunkServer(0x43)->GetOnlineState());
+
+    // the old snapshot keeps its view
+    copyset = second->FindCopySet(CopySetKey(0x01, 1));
+    ASSERT_EQ(0, copyset->GetEpoch());
+    ASSERT_EQ(10, second->GetAvailableCopySetsInLogicalPool(0x01)->size());
+    ASSERT_EQ(OnlineState::OFFLINE,
+        second->FindChunkServer(0x43)->GetOnlineState());
+}
+
+TEST_F(TestTopologySnapshot, test_refresh_interval) {
+    InitTopology(3600 * 1000);
+    // changes made before the first GetSnapshot are not visible yet
+    topology_->RefreshSnapshot();
+
+    auto first = topology_->GetSnapshot();
+    AddCopySet(1);
+    // still in refresh interval
+    ASSERT_EQ(first, topology_->GetSnapshot());
+    ASSERT_EQ(0, topology_->GetSnapshot()->GetCopySetNum());
+
+    // refresh explicitly
+    topology_->RefreshSnapshot();
+    ASSERT_EQ(1, topology_->GetSnapshot()->GetCopySetNum());
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
@@ -0,0 +1,266 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-13
+ */
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "test/mds/topology/mock_topology.h"
+#include "src/mds/topology/topology.h"
+#include "src/common/timeutility.h"
+#include "src/common/namespace_define.h"
+
+DEFINE_uint32(poc_chunkserver_num, 10000, "number of simulated chunkservers");
+DEFINE_uint32(poc_copyset_num, 1000000, "number of simulated copysets");
+DEFINE_uint32(poc_heartbeat_thread_num, 8,
+              "number of threads updating topology like heartbeat");
+DEFINE_uint32(poc_alloc_thread_num, 8,
+              "number of threads choosing copysets like chunk allocator");
+DEFINE_uint32(poc_duration_s, 10, "duration of each round in seconds");
+DEFINE_uint32(poc_snapshot_refresh_interval_ms, 100,
+              "refresh interval of the topology snapshot");
+
+namespace curve {
+namespace mds {
+namespace topology {
+
+using ::testing::Return;
+using ::testing::_;
+using ::testing::NiceMock;
+using ::curve::common::TimeUtility;
+
+namespace {
+const PoolIdType kPhysicalPoolId = 1;
+const PoolIdType kLogicalPoolId = 1;
+const uint32_t kZoneNum = 3;
+const uint32_t kChunkServerPerServer = 20;
+}  // namespace
+
+// Simulate heartbeat updates and chunk allocation at large scale in process,
+// and compare the throughput of reading from the locked maps of topology with
+// reading from topology snapshots.
+class TopologySnapshotPOC : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        idGenerator_ = std::make_shared<NiceMock<MockIdGenerator>>();
+        tokenGenerator_ = std::make_shared<NiceMock<MockTokenGenerator>>();
+        storage_ = std::make_shared<NiceMock<MockStorage>>();
+        ON_CALL(*storage_, LoadClusterInfo(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageClusterInfo(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadPoolset(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadLogicalPool(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadPhysicalPool(_, _))
+            .WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadZone(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadServer(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadChunkServer(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, LoadCopySet(_, _)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StoragePoolset(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageLogicalPool(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StoragePhysicalPool(_))
+            .WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageZone(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageServer(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageChunkServer(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, StorageCopySet(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, UpdateChunkServer(_)).WillByDefault(Return(true));
+        ON_CALL(*storage_, UpdateCopySet(_)).WillByDefault(Return(true));
+
+        topology_ = std::make_shared<TopologyImpl>(idGenerator_,
+                                                   tokenGenerator_,
+                                                   storage_);
+        TopologyOption option;
+        // copysets are updated to storage by the background thread, which
+        // is not started here
+        option.TopologyUpdateToRepoSec = 3600;
+        option.snapshotRefreshIntervalMs =
+            FLAGS_poc_snapshot_refresh_interval_ms;
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->Init(option));
+        BuildCluster();
+    }
+
+    void BuildCluster() {
+        uint64_t start = TimeUtility::GetTimeofDayMs();
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddPhysicalPool(
+            PhysicalPool(kPhysicalPoolId, "pool1",
+                         ::curve::common::kDefaultPoolsetId, "")));
+        for (ZoneIdType zone = 1; zone <= kZoneNum; zone++) {
+            ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddZone(
+                Zone(zone, "zone" + std::to_string(zone),
+                     kPhysicalPoolId, "")));
+        }
+
+        // chunkserver i is on server i / kChunkServerPerServer and servers
+        // are placed in zones by turns
+        uint32_t serverNum = (FLAGS_poc_chunkserver_num +
+            kChunkServerPerServer - 1) / kChunkServerPerServer;
+        for (ServerIdType server = 0; server < serverNum; server++) {
+            ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddServer(
+                Server(server + 1, "server" + std::to_string(server),
+                       "127.0.0.1", 0, "127.0.0.1", 0,
+                       server % kZoneNum + 1, kPhysicalPoolId, "")));
+        }
+        for (ChunkServerIdType cs = 0; cs < FLAGS_poc_chunkserver_num; cs++) {
+            ChunkServer chunkServer(cs + 1, "token", "ssd",
+                cs / kChunkServerPerServer + 1, "127.0.0.1", 8200 + cs, "/");
+            chunkServer.SetOnlineState(OnlineState::ONLINE);
+            ASSERT_EQ(kTopoErrCodeSuccess,
+                topology_->AddChunkServer(chunkServer));
+        }
+        ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddLogicalPool(
+            LogicalPool(kLogicalPoolId, "lpool1", kPhysicalPoolId, PAGEFILE,
+                LogicalPool::RedundanceAndPlaceMentPolicy(),
+                LogicalPool::UserPolicy(), 0, true, true)));
+
+        // members are on servers of different zones
+        std::mt19937 gen(0);
+        std::uniform_int_distribution<uint32_t> dis(0, serverNum - 1);
+        for (CopySetIdType id = 1; id <= FLAGS_poc_copyset_num; id++) {
+            std::set<ChunkServerIdType> members;
+            uint32_t server = dis(gen) / kZoneNum * kZoneNum;
+            for (uint32_t i = 0; i < kZoneNum; i++) {
+                ChunkServerIdType cs =
+                    ((server + i) % serverNum) * kChunkServerPerServer +
+                    dis(gen) % kChunkServerPerServer;
+                members.emplace(cs % FLAGS_poc_chunkserver_num + 1);
+            }
+            CopySetInfo info(kLogicalPoolId, id);
+            info.SetCopySetMembers(members);
+            info.SetLeader(*members.begin());
+            ASSERT_EQ(kTopoErrCodeSuccess, topology_->AddCopySet(info));
+        }
+        topology_->RefreshSnapshot();
+        LOG(INFO) << "build cluster with " << FLAGS_poc_chunkserver_num
+                  << " chunkservers and " << FLAGS_poc_copyset_num
+                  << " copysets, cost " << TimeUtility::GetTimeofDayMs() - start
+                  << " ms";
+    }
+
+    /**
+     * @brief run heartbeat and allocation threads for a round
+     *
+     * @param useSnapshot whether allocation threads read from snapshots
+     */
+    void RunRound(bool useSnapshot) {
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> heartbeatOps(0);
+        std::atomic<uint64_t> allocOps(0);
+
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < FLAGS_poc_heartbeat_thread_num; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(t);
+                std::uniform_int_distribution<CopySetIdType> copyset(
+                    1, FLAGS_poc_copyset_num);
+                std::uniform_int_distribution<ChunkServerIdType> chunkserver(
+                    1, FLAGS_poc_chunkserver_num);
+                uint64_t ops = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    CopySetInfo info;
+                    CopySetKey key(kLogicalPoolId, copyset(gen));
+                    if (topology_->GetCopySet(key, &info)) {
+                        info.SetEpoch(info.GetEpoch() + 1);
+                        topology_->UpdateCopySetTopo(info);
+                    }
+                    ChunkServerState state;
+                    state.SetDiskState(DiskState::DISKNORMAL);
+                    state.SetDiskCapacity(1024);
+                    state.SetDiskUsed(ops % 1024);
+                    topology_->UpdateChunkServerDiskStatus(state,
+                        chunkserver(gen));
+                    ops++;
+                }
+                heartbeatOps += ops;
+            });
+        }
+        for (uint32_t t = 0; t < FLAGS_poc_alloc_thread_num; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(t);
+                uint64_t ops = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    size_t num = 0;
+                    if (useSnapshot) {
+                        auto snapshot = topology_->GetSnapshot();
+                        auto copysets = snapshot->
+                            GetAvailableCopySetsInLogicalPool(kLogicalPoolId);
+                        num = copysets->size();
+                    } else {
+                        num = topology_->GetCopySetsInLogicalPool(
+                            kLogicalPoolId, [](const CopySetInfo &info) {
+                                return info.IsAvailable();
+                            }).size();
+                    }
+                    ASSERT_EQ(FLAGS_poc_copyset_num, num);
+                    ops++;
+                }
+                allocOps += ops;
+            });
+        }
+
+        std::this_thread::sleep_for(
+            std::chrono::seconds(FLAGS_poc_duration_s));
+        stop.store(true);
+        for (auto &th : threads) {
+            th.join();
+        }
+
+        LOG(INFO) << (useSnapshot ? "snapshot" : "locked")
+                  << " round: heartbeat "
+                  << heartbeatOps.load() / FLAGS_poc_duration_s
+                  << " ops/s, allocation "
+                  << allocOps.load() / FLAGS_poc_duration_s << " ops/s";
+    }
+
+ protected:
+    std::shared_ptr<NiceMock<MockIdGenerator>> idGenerator_;
+    std::shared_ptr<NiceMock<MockTokenGenerator>> tokenGenerator_;
+    std::shared_ptr<NiceMock<MockStorage>> storage_;
+    std::shared_ptr<TopologyImpl> topology_;
+};
+
+// disabled by default for it takes long, run with
+// --gtest_also_run_disabled_tests and the poc_* flags to adjust the scale
+TEST_F(TopologySnapshotPOC, DISABLED_test_heartbeat_and_allocation_throughput) {
+    RunRound(false);
+    RunRound(true);
+
+    auto snapshot = topology_->GetSnapshot();
+    ASSERT_EQ(FLAGS_poc_copyset_num, snapshot->GetCopySetNum());
+    ASSERT_EQ(FLAGS_poc_chunkserver_num, snapshot->GetChunkServerNum());
+}
+
+}  // namespace topology
+}  // namespace mds
+}  // namespace curve
+
+int main(int argc, char* argv[]) {
+    testing::InitGoogleTest(&argc, argv);
+    google::ParseCommandLineFlags(&argc, &argv, false);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-19
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <thread>  // NOLINT
+
+#include "src/snapshotcloneserver/clone/clone_chunk_scheduler.h"
+
+namespace curve {
+namespace snapshotcloneserver {
+
+TEST(TestCloneChunkScheduler, TestUnlimited) {
+    CloneChunkScheduler scheduler(0);
+    scheduler.AddTask("task1");
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(scheduler.TryAcquire("task1"));
+    }
+    ASSERT_EQ(1000, scheduler.GetInflightChunkNum());
+    scheduler.RemoveTask("task1");
+    ASSERT_EQ(0, scheduler.GetInflightChunkNum());
+}
+
+TEST(TestCloneChunkScheduler, TestFairShare) {
+    CloneChunkScheduler scheduler(4);
+    scheduler.AddTask("big");
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(scheduler.TryAcquire("big"));
+    }
+    ASSERT_FALSE(scheduler.TryAcquire("big"));
+
+    // 小任务加入后，大任务归还的配额不能再被大任务拿走
+    scheduler.AddTask("small");
+    ASSERT_FALSE(scheduler.TryAcquire("small"));
+    scheduler.Release("big");
+    ASSERT_FALSE(scheduler.TryAcquire("big"));
+    ASSERT_TRUE(scheduler.TryAcquire("small"));
+    scheduler.Release("big", 2);
+    ASSERT_TRUE(scheduler.TryAcquire("small"));
+    ASSERT_FALSE(scheduler.TryAcquire("small"));
+    ASSERT_EQ(3, scheduler.GetInflightChunkNum());
+
+    // 小任务结束后大任务可以用满配额
+    scheduler.RemoveTask("small");
+    ASSERT_TRUE(scheduler.TryAcquire("big"));
+    ASSERT_TRUE(scheduler.TryAcquire("big"));
+    ASSERT_TRUE(scheduler.TryAcquire("big"));
+    ASSERT_FALSE(scheduler.TryAcquire("big"));
+    scheduler.RemoveTask("big");
+    ASSERT_EQ(0, scheduler.GetInflightChunkNum());
+}
+
+TEST(TestCloneChunkScheduler, TestAcquireWait) {
+    auto scheduler = std::make_shared<CloneChunkScheduler>(2);
+    scheduler->AddTask("task1");
+    ASSERT_TRUE(scheduler->TryAcquire("task1"));
+    ASSERT_TRUE(scheduler->TryAcquire("task1"));
+
+    // 没有占用配额的任务排队等待其他任务归还配额
+    std::atomic<bool> acquired(false);
+    std::thread waiter([&]() {
+        CloneChunkSchedulerGuard guard(scheduler, "task2");
+        scheduler->Acquire("task2");
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+
+    scheduler->Release("task1");
+    waiter.join();
+    ASSERT_TRUE(acquired);
+    // task2离开时归还了配额
+    ASSERT_EQ(1, scheduler->GetInflightChunkNum());
+    scheduler->RemoveTask("task1");
+    ASSERT_EQ(0, scheduler->GetInflightChunkNum());
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
@@ -40,6 +40,7 @@ using ::testing::AllOf;
 using ::testing::SetArgPointee;
 using ::testing::Invoke;
 using ::testing::DoAll;
+using ::testing::SaveArg;
 
 class TestSnapshotCoreImpl : public ::testing::Test {
  public:
@@ -518,6 +519,365 @@ TEST_F(TestSnapshotCoreImpl,
     ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
 }
 
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskBuildChunkIndexConcurrently) {
+    option.buildChunkIndexConcurrency = 4;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 4 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    SegmentInfo segInfo;
+    for (ChunkID id = 1; id <= 4; id++) {
+        segInfo.chunkvec.push_back(ChunkIDInfo(id, 1, 1));
+    }
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // chunk1快照后写过，chunk2快照后未写过，chunk3快照后首次写，chunk4未写过
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(4)
+        .WillRepeatedly(Invoke([](const ChunkIDInfo &cidInfo,
+                                  ChunkInfoDetail *chunkInfo) {
+                    switch (cidInfo.cid_) {
+                        case 1:
+                            chunkInfo->chunkSn = {101, 90};
+                            break;
+                        case 2:
+                            chunkInfo->chunkSn = {80};
+                            break;
+                        case 3:
+                            chunkInfo->chunkSn = {101};
+                            break;
+                        default:
+                            break;
+                    }
+                    return LIBCURVE_ERROR::OK;
+                }));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    // 只检查构建的索引，写入索引失败后任务结束
+    ChunkIndexData putIndexData;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(DoAll(SaveArg<1>(&putIndexData),
+                    Return(kErrCodeInternalError)));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
+    ChunkDataName name;
+    ASSERT_TRUE(putIndexData.GetChunkDataName(0, &name));
+    ASSERT_EQ(90, name.chunkSeqNum_);
+    ASSERT_TRUE(putIndexData.GetChunkDataName(1, &name));
+    ASSERT_EQ(80, name.chunkSeqNum_);
+    ASSERT_FALSE(putIndexData.GetChunkDataName(2, &name));
+    ASSERT_FALSE(putIndexData.GetChunkDataName(3, &name));
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskSkipUnchangedSegment) {
+    option.snapshotSkipUnchangedSegment = true;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // 文件从版本50开始跟踪segment写入版本
+    FInfo snapInfo;
+    snapInfo.parentid = 1;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = 3 * snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    snapInfo.dirtyTrackingSeqNum = 50;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    // 版本90的快照可以沿用，版本95的快照属于另一个同名文件，
+    // 版本40的快照打在开始跟踪之前
+    std::vector<SnapshotInfo> snapInfos;
+    SnapshotInfo prev("uuid2", user, fileName, "snap2", 90,
+        snapInfo.chunksize, snapInfo.segmentsize, snapInfo.length,
+        0, 0, "", 0, Status::done);
+    prev.SetFileId(1);
+    snapInfos.push_back(prev);
+    SnapshotInfo other("uuid3", user, fileName, "snap3", 95,
+        snapInfo.chunksize, snapInfo.segmentsize, snapInfo.length,
+        0, 0, "", 0, Status::done);
+    other.SetFileId(2);
+    snapInfos.push_back(other);
+    SnapshotInfo old("uuid4", user, fileName, "snap4", 40,
+        snapInfo.chunksize, snapInfo.segmentsize, snapInfo.length,
+        0, 0, "", 0, Status::done);
+    old.SetFileId(1);
+    snapInfos.push_back(old);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    ChunkIndexData prevIndexData;
+    prevIndexData.PutChunkDataName(ChunkDataName(fileName, 80, 0));
+    prevIndexData.PutChunkDataName(ChunkDataName(fileName, 90, 2));
+    prevIndexData.PutChunkDataName(ChunkDataName(fileName, 90, 3));
+    prevIndexData.PutChunkDataName(ChunkDataName(fileName, 90, 4));
+    EXPECT_CALL(*dataStore_, GetChunkIndexData(_, _))
+        .WillOnce(Invoke([&](const ChunkIndexDataName &name,
+                             ChunkIndexData *indexData) {
+                    EXPECT_EQ(90, name.fileSeqNum_);
+                    *indexData = prevIndexData;
+                    return kErrCodeSuccess;
+                }));
+
+    // segment0在版本90之前写过，segment1在版本90之后写过，
+    // segment2没有记录写入版本，最后一次写在开始跟踪之前
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .Times(3)
+        .WillRepeatedly(Invoke([&](const std::string &filename,
+                                   const std::string &user,
+                                   uint64_t seq,
+                                   uint64_t offset,
+                                   SegmentInfo *segInfo) {
+                    uint64_t index = offset / snapInfo.segmentsize;
+                    segInfo->chunkvec.push_back(
+                        ChunkIDInfo(2 * index + 1, 1, 1));
+                    segInfo->chunkvec.push_back(
+                        ChunkIDInfo(2 * index + 2, 1, 1));
+                    segInfo->dirtySeqNum = index == 0 ? 89 :
+                                           index == 1 ? 90 : 0;
+                    return LIBCURVE_ERROR::OK;
+                }));
+
+    // 只查询segment1的chunk
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(Invoke([](const ChunkIDInfo &cidInfo,
+                                  ChunkInfoDetail *chunkInfo) {
+                    EXPECT_TRUE(cidInfo.cid_ == 3 || cidInfo.cid_ == 4);
+                    chunkInfo->chunkSn = {100};
+                    return LIBCURVE_ERROR::OK;
+                }));
+
+    // 只检查构建的索引，写入索引失败后任务结束
+    ChunkIndexData putIndexData;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .WillOnce(DoAll(SaveArg<1>(&putIndexData),
+                    Return(kErrCodeInternalError)));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::error, task->GetSnapshotInfo().GetStatus());
+    ASSERT_EQ(1, task->GetSnapshotInfo().GetFileId());
+    ChunkDataName name;
+    ASSERT_TRUE(putIndexData.GetChunkDataName(0, &name));
+    ASSERT_EQ(80, name.chunkSeqNum_);
+    ASSERT_FALSE(putIndexData.GetChunkDataName(1, &name));
+    ASSERT_TRUE(putIndexData.GetChunkDataName(2, &name));
+    ASSERT_EQ(100, name.chunkSeqNum_);
+    ASSERT_TRUE(putIndexData.GetChunkDataName(3, &name));
+    ASSERT_EQ(100, name.chunkSeqNum_);
+    ASSERT_TRUE(putIndexData.GetChunkDataName(4, &name));
+    ASSERT_EQ(90, name.chunkSeqNum_);
+    ASSERT_FALSE(putIndexData.GetChunkDataName(5, &name));
+}
+
+TEST_F(TestSnapshotCoreImpl,
+    TestHandleCreateSnapshotTaskSkipZeroChunkSuccess) {
+    option.snapshotSkipZeroChunk = true;
+    core_ = std::make_shared<SnapshotCoreImpl>(client_,
+            metaStore_,
+            dataStore_,
+            snapshotRef_,
+            option);
+    ASSERT_EQ(core_->Init(), 0);
+
+    UUID uuid = "uuid1";
+    std::string user = "user1";
+    std::string fileName = "file1";
+    std::string desc = "snap1";
+    uint64_t seqNum = 100;
+
+    SnapshotInfo info(uuid, user, fileName, desc);
+    info.SetStatus(Status::pending);
+
+    auto snapshotInfoMetric = std::make_shared<SnapshotInfoMetric>(uuid);
+    std::shared_ptr<SnapshotTaskInfo> task =
+        std::make_shared<SnapshotTaskInfo>(info, snapshotInfoMetric);
+
+    EXPECT_CALL(*client_, CreateSnapshot(fileName, user, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<2>(seqNum),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    FInfo snapInfo;
+    snapInfo.seqnum = 100;
+    snapInfo.chunksize = 2 * option.chunkSplitSize;
+    snapInfo.segmentsize = 2 * snapInfo.chunksize;
+    snapInfo.length = snapInfo.segmentsize;
+    snapInfo.ctime = 10;
+    EXPECT_CALL(*client_, GetSnapshot(fileName, user, seqNum, _))
+        .WillOnce(DoAll(
+                    SetArgPointee<3>(snapInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*metaStore_, CASSnapshot(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+    EXPECT_CALL(*metaStore_, UpdateSnapshot(_))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    SegmentInfo segInfo;
+    segInfo.chunkvec.push_back(ChunkIDInfo(1, 1, 1));
+    segInfo.chunkvec.push_back(ChunkIDInfo(2, 2, 2));
+    EXPECT_CALL(*client_, GetSnapshotSegmentInfo(fileName,
+          user,
+          seqNum,
+            _,
+            _))
+        .WillOnce(DoAll(SetArgPointee<4>(segInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    ChunkInfoDetail chunkInfo;
+    chunkInfo.chunkSn.push_back(100);
+    EXPECT_CALL(*client_, GetChunkInfo(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SetArgPointee<1>(chunkInfo),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    // 全零的chunk从索引中去掉后重新写入
+    ChunkIndexData putIndexData;
+    EXPECT_CALL(*dataStore_, PutChunkIndexData(_, _))
+        .Times(2)
+        .WillRepeatedly(DoAll(SaveArg<1>(&putIndexData),
+                    Return(kErrCodeSuccess)));
+
+    std::vector<SnapshotInfo> snapInfos;
+    info.SetSeqNum(seqNum);
+    snapInfos.push_back(info);
+    EXPECT_CALL(*metaStore_, GetSnapshotList(fileName, _))
+        .WillRepeatedly(DoAll(
+                    SetArgPointee<1>(snapInfos),
+                    Return(kErrCodeSuccess)));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferInit(_, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    // chunk1全零，chunk2只有第二个分片有数据
+    EXPECT_CALL(*client_, ReadChunkSnapshot(_, _, _, _, _, _))
+        .Times(4)
+        .WillRepeatedly(DoAll(
+                    Invoke([](ChunkIDInfo cidinfo,
+                        uint64_t seq,
+                        uint64_t offset,
+                        uint64_t len,
+                        char *buf,
+                        SnapCloneClosure* scc){
+                        bool zero = cidinfo.cid_ == 1 || offset == 0;
+                        memset(buf, zero ? 0 : 1, len);
+                        scc->SetRetCode(LIBCURVE_ERROR::OK);
+                        scc->Run();
+                        }),
+                    Return(LIBCURVE_ERROR::OK)));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferAddPart(_, _, _, _, _))
+        .Times(2)
+        .WillRepeatedly(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferComplete(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*dataStore_, DataChunkTranferAbort(_, _))
+        .WillOnce(Return(kErrCodeSuccess));
+
+    EXPECT_CALL(*client_, DeleteSnapshot(fileName, user, seqNum))
+        .WillOnce(Return(LIBCURVE_ERROR::OK));
+
+    EXPECT_CALL(*client_, CheckSnapShotStatus(_, _, _, _))
+        .WillOnce(Return(-LIBCURVE_ERROR::NOTEXIST));
+
+    core_->HandleCreateSnapshotTask(task);
+
+    ASSERT_TRUE(task->IsFinish());
+    ASSERT_EQ(Status::done, task->GetSnapshotInfo().GetStatus());
+    ChunkDataName name;
+    ASSERT_FALSE(putIndexData.GetChunkDataName(0, &name));
+    ASSERT_TRUE(putIndexData.GetChunkDataName(1, &name));
+}
+
 TEST_F(TestSnapshotCoreImpl,
     TestHandleCreateSnapshotTask_CreateSnapshotFail) {
     UUID uuid = "uuid1";
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2023 NetEase Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Project: curve
+ * Created Date: 2023-12-18
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "src/snapshotcloneserver/snapshot/snapshot_transfer_pipeline.h"
+#include "src/common/concurrent/count_down_event.h"
+
+using ::curve::common::CountDownEvent;
+
+namespace curve {
+namespace snapshotcloneserver {
+
+class TestSnapshotTransferPipeline : public ::testing::Test {
+ protected:
+    void SetUp() override {
+        option_.uploadThreadNum = 2;
+        option_.bufferBytes = 2 * kPartSize;
+        option_.bandwidth = 0;
+    }
+
+ protected:
+    const uint64_t kPartSize = 1024;
+    SnapshotTransferPipelineOption option_;
+};
+
+TEST_F(TestSnapshotTransferPipeline, TestAcquireBufferBackpressure) {
+    SnapshotTransferPipeline pipeline(option_);
+    ASSERT_EQ(0, pipeline.Start());
+
+    auto quota1 = pipeline.AcquireBuffer(kPartSize);
+    auto quota2 = pipeline.AcquireBuffer(kPartSize);
+    ASSERT_EQ(2 * kPartSize, pipeline.GetInflightBytes());
+
+    // 配额用完，第三个分片等待前面的分片归还配额
+    std::atomic<bool> acquired(false);
+    std::thread reader([&]() {
+        auto quota3 = pipeline.AcquireBuffer(kPartSize);
+        acquired = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(acquired);
+
+    quota1.reset();
+    reader.join();
+    ASSERT_TRUE(acquired);
+    ASSERT_EQ(kPartSize, pipeline.GetInflightBytes());
+
+    quota2.reset();
+    ASSERT_EQ(0, pipeline.GetInflightBytes());
+    pipeline.Stop();
+}
+
+TEST_F(TestSnapshotTransferPipeline, TestAcquireBufferLargerThanLimit) {
+    SnapshotTransferPipeline pipeline(option_);
+    ASSERT_EQ(0, pipeline.Start());
+
+    // 没有在途分片时总是放行
+    auto quota = pipeline.AcquireBuffer(4 * kPartSize);
+    ASSERT_EQ(4 * kPartSize, pipeline.GetInflightBytes());
+    quota.reset();
+
+    // 不限制在途buffer
+    option_.bufferBytes = 0;
+    SnapshotTransferPipeline unlimited(option_);
+    ASSERT_EQ(0, unlimited.Start());
+    std::vector<TransferBufferQuotaPtr> quotas;
+    for (int i = 0; i < 10; i++) {
+        quotas.emplace_back(unlimited.AcquireBuffer(kPartSize));
+    }
+    ASSERT_EQ(10 * kPartSize, unlimited.GetInflightBytes());
+    quotas.clear();
+    ASSERT_EQ(0, unlimited.GetInflightBytes());
+    pipeline.Stop();
+    unlimited.Stop();
+}
+
+TEST_F(TestSnapshotTransferPipeline, TestUploadReleaseBuffer) {
+    SnapshotTransferPipeline pipeline(option_);
+    ASSERT_EQ(0, pipeline.Start());
+
+    const int kParts = 8;
+    std::atomic<int> uploaded(0);
+    CountDownEvent done(kParts);
+    for (int i = 0; i < kParts; i++) {
+        // 读取阶段受上传阶段反压，在途buffer不超过上限
+        std::shared_ptr<TransferBufferQuota> quota =
+            pipeline.AcquireBuffer(kPartSize);
+        ASSERT_LE(pipeline.GetInflightBytes(), option_.bufferBytes);
+        pipeline.PushUpload([&, quota]() mutable {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            uploaded++;
+            quota.reset();
+            done.Signal();
+        });
+    }
+    done.Wait();
+    ASSERT_EQ(kParts, uploaded);
+    ASSERT_EQ(0, pipeline.GetInflightBytes());
+    pipeline.Stop();
+}
+
+}  // namespace snapshotcloneserver
+}  // namespace curve
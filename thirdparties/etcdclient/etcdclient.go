@@ -98,6 +98,7 @@ import (
 	"strings"
 	"sync"
 	"time"
+	"unsafe"
 )
 
 const (
@@ -108,6 +109,7 @@ const (
 	EtcdDelete     = "Delete"
 	EtcdTxn2       = "Txn2"
 	EtcdTxn3       = "Txn3"
+	EtcdTxnN       = "TxnN"
 	EtcdCmpAndSwp  = "CmpAndSwp"
 	EtcdNewMutex   = "NewMutex"
 	EtcdNewSession = "NewSession"
@@ -406,6 +408,35 @@ func EtcdClientTxn3(
 	return GetErrCode(EtcdTxn3, err)
 }
 
+// maximum number of operations in one transaction, same as the default
+// --max-txn-ops of etcd server
+const maxTxnOps = 128
+
+//export EtcdClientTxnN
+func EtcdClientTxnN(timeout C.int, ops *C.struct_Operation,
+	num C.int) (C.enum_EtcdErrCode, int64) {
+	if num <= 0 || num > maxTxnOps {
+		log.Printf("invalid txn op number: %v", num)
+		return C.EtcdInvalidArgument, 0
+	}
+	cops := (*[maxTxnOps]C.struct_Operation)(unsafe.Pointer(ops))[:num:num]
+	etcdOps, err := GenOpList(cops)
+	if err != nil {
+		log.Printf("unknown op types, err: %v", err)
+		return C.EtcdTxnUnkownOp, 0
+	}
+
+	ctx, cancel := context.WithTimeout(context.Background(),
+		time.Duration(int(timeout))*time.Millisecond)
+	defer cancel()
+
+	resp, err := globalClient.Txn(ctx).Then(etcdOps...).Commit()
+	if err == nil {
+		return GetErrCode(EtcdTxnN, err), resp.Header.Revision
+	}
+	return GetErrCode(EtcdTxnN, err), 0
+}
+
 //export EtcdClientCompareAndSwap
 func EtcdClientCompareAndSwap(timeout C.int, key, prev, target *C.char,
 	keyLen, preLen, targetLen C.int) C.enum_EtcdErrCode {